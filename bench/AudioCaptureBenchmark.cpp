@@ -0,0 +1,203 @@
+#include "../include/PcmCapture.h"
+#include "BenchUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 录音缓冲区：用一个模拟的录音设备（独立线程，按设备的方式持有、填充、交回缓冲区）驱动 PcmCapture，
+// 与原来“回调里直接 insert 到 vector”对比回调耗时。
+// 1. 按实时速率的 100 倍录满 59 s：回调的平均与最坏耗时、拼接结果逐字节校验、存储没有重新分配；
+// 2. 不限速的小缓冲区洪泛：消费线程跟不上时设备等待空闲缓冲区，数据仍不丢不乱；
+// 3. 超过最长录音时间：多出的数据被截断并计数；
+// 停止时模拟 waveInReset：设备持有的缓冲区全部交回，正在录的一个只有部分数据
+
+typedef std::chrono::steady_clock Clock;
+
+static const size_t BYTES_PER_SECOND = 16000 * 2;
+
+static char PatternByte(long long offset) {
+    return (char)(offset % 251);
+}
+
+// 模拟的录音设备：持有交给它的缓冲区，按顺序填充后通过回调交回
+class FakeWaveIn {
+public:
+    explicit FakeWaveIn(PcmCapture& capture) : capture(capture), stopped(false), stalls(0), produced(0) {
+        for (size_t i = 0; i < capture.bufferCount(); ++i) owned.push_back(i);
+    }
+
+    // 与 VoiceRecognizer::requeueBuffer 相同：停止后不再接收缓冲区
+    bool requeue(size_t index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopped) return false;
+        owned.push_back(index);
+        return true;
+    }
+
+    // 录 totalBytes 字节；bufferPeriod 为 0 时不限速
+    void record(long long totalBytes, std::chrono::nanoseconds bufferPeriod) {
+        Clock::time_point next = Clock::now();
+        while (produced < totalBytes) {
+            size_t index;
+            if (!takeBuffer(index)) {
+                stalls++;
+                std::this_thread::yield();
+                continue;
+            }
+            size_t size = (size_t)(std::min)((long long)capture.bufferBytes(), totalBytes - produced);
+            fill(index, size);
+            Clock::time_point entered = Clock::now();
+            capture.publish(index, size);
+            capture.recordCallbackTime(entered);
+            if (bufferPeriod.count() > 0) {
+                next += bufferPeriod;
+                std::this_thread::sleep_until(next);
+            }
+        }
+    }
+
+    // waveInStop + waveInReset：正在录的缓冲区带 partial 字节交回，其余为空
+    void reset(size_t partial) {
+        std::deque<size_t> remaining;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+            remaining.swap(owned);
+        }
+        for (size_t i = 0; i < remaining.size(); ++i) {
+            size_t size = i == 0 ? (std::min)(partial, capture.bufferBytes()) : 0;
+            fill(remaining[i], size);
+            capture.publish(remaining[i], size);
+        }
+    }
+
+    long stallCount() const { return stalls; }
+    long long producedBytes() const { return produced; }
+
+private:
+    PcmCapture& capture;
+    std::mutex mutex;
+    std::deque<size_t> owned;
+    bool stopped;
+    long stalls;
+    long long produced;
+
+    bool takeBuffer(size_t& index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (owned.empty()) return false;
+        index = owned.front();
+        owned.pop_front();
+        return true;
+    }
+
+    void fill(size_t index, size_t size) {
+        char* data = capture.buffer(index);
+        for (size_t i = 0; i < size; ++i) data[i] = PatternByte(produced + (long long)i);
+        produced += (long long)size;
+    }
+};
+
+struct Outcome {
+    PcmCaptureStats stats;
+    long stalls;
+    long long produced;
+    size_t pcmSize;
+    bool intact;            // 拼接结果与设备录下的数据逐字节相同（截断时比较前 maxBytes）
+    bool noRealloc;         // 存储容量仍是一开始预留的
+    double elapsedMs;
+};
+
+static Outcome Run(size_t buffers, size_t bufferBytes, size_t maxBytes, long long totalBytes,
+                   std::chrono::nanoseconds period, size_t partial) {
+    Outcome outcome;
+    PcmCapture capture(buffers, bufferBytes, maxBytes);
+    FakeWaveIn device(capture);
+    capture.start([&device](size_t index) { return device.requeue(index); });
+    BenchTimer timer;
+    std::thread driver([&]() { device.record(totalBytes, period); });
+    driver.join();
+    device.reset(partial);
+    std::vector<char> pcm = capture.finish(500);
+    outcome.elapsedMs = timer.elapsedMs();
+    outcome.stats = capture.stats();
+    outcome.stalls = device.stallCount();
+    outcome.produced = device.producedBytes();
+    outcome.pcmSize = pcm.size();
+    outcome.noRealloc = pcm.capacity() == maxBytes;
+    outcome.intact = pcm.size() == (size_t)(std::min)((long long)maxBytes, outcome.produced);
+    for (size_t i = 0; outcome.intact && i < pcm.size(); ++i) outcome.intact = pcm[i] == PatternByte((long long)i);
+    return outcome;
+}
+
+// 原实现：回调线程直接 insert 到 vector（reserved 为 false 时即最初没有预留容量的版本）
+static void RunLegacy(size_t bufferBytes, long long totalBytes, bool reserved, double& meanUs, double& maxUs) {
+    std::vector<char> buffer(bufferBytes);
+    for (size_t i = 0; i < bufferBytes; ++i) buffer[i] = PatternByte((long long)i);
+    std::vector<char> recordedData;
+    if (reserved) recordedData.reserve((size_t)totalBytes);
+    long long totalNs = 0;
+    long long maxNs = 0;
+    long callbacks = 0;
+    for (long long produced = 0; produced < totalBytes; produced += (long long)bufferBytes) {
+        Clock::time_point entered = Clock::now();
+        recordedData.insert(recordedData.end(), buffer.begin(), buffer.end());
+        long long ns = (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - entered).count();
+        totalNs += ns;
+        maxNs = (std::max)(maxNs, ns);
+        callbacks++;
+    }
+    meanUs = totalNs / 1000.0 / callbacks;
+    maxUs = maxNs / 1000.0;
+}
+
+static void Report(const char* name, const Outcome& o) {
+    std::printf("%-24s %8ld %10lld %9lld %7ld %7lu %7ld %9.2f %9.1f %6s %7s %9.1f\n", name, o.stats.buffers,
+                o.stats.bytes, o.stats.truncatedBytes, o.stats.wakeups, (unsigned long)o.stats.maxQueued, o.stalls,
+                o.stats.callbackMeanUs, o.stats.callbackMaxUs, o.intact ? "yes" : "NO", o.noRealloc ? "yes" : "NO",
+                o.elapsedMs);
+}
+
+int main() {
+    bool ok = true;
+    const size_t maxBytes = BYTES_PER_SECOND * 59;
+    std::printf("%-24s %8s %10s %9s %7s %7s %7s %9s %9s %6s %7s %9s\n", "scenario", "buffers", "bytes", "truncated",
+                "wakeups", "queued", "stalls", "cb mean", "cb max", "intact", "prealloc", "ms");
+
+    // 1. 与 VoiceRecognizer 相同的 4 x 4096 字节缓冲区，59 s 录音按 100 倍速（每 1.28 ms 一个缓冲区）
+    long long fullBytes = (long long)maxBytes - 1000;
+    Outcome realtime = Run(4, 4096, maxBytes, fullBytes, std::chrono::microseconds(1280), 1000);
+    Report("59 s at 100x realtime", realtime);
+    ok = ok && realtime.intact && realtime.noRealloc && realtime.stats.truncatedBytes == 0;
+    ok = ok && realtime.pcmSize == maxBytes;
+
+    // 2. 不限速洪泛：8 x 256 字节缓冲区共 64 MB
+    const size_t floodMax = 64u * 1024 * 1024;
+    Outcome flood = Run(8, 256, floodMax, (long long)floodMax - 300, std::chrono::nanoseconds(0), 100);
+    Report("flood 256 B buffers", flood);
+    ok = ok && flood.intact && flood.noRealloc && flood.stats.truncatedBytes == 0;
+    std::printf("flood throughput: %.0f MB/s, %.0f buffers/s\n", ThroughputMBps(flood.pcmSize, flood.elapsedMs),
+                flood.stats.buffers / (flood.elapsedMs / 1000.0));
+
+    // 3. 录音超过上限：多出的 3 s 被截断
+    Outcome overflow = Run(4, 4096, maxBytes, (long long)maxBytes + (long long)BYTES_PER_SECOND * 3,
+                           std::chrono::nanoseconds(0), 2000);
+    Report("62 s into 59 s storage", overflow);
+    ok = ok && overflow.intact && overflow.noRealloc && overflow.pcmSize == maxBytes;
+    ok = ok && overflow.stats.truncatedBytes == overflow.produced - (long long)maxBytes;
+
+    // 原实现的回调耗时：整段录音在回调线程里追加
+    double legacyMean, legacyMax, reservedMean, reservedMax;
+    RunLegacy(4096, (long long)maxBytes, false, legacyMean, legacyMax);
+    RunLegacy(4096, (long long)maxBytes, true, reservedMean, reservedMax);
+    std::printf("\nworst-case callback: legacy insert %.1f us (mean %.2f), reserved insert %.1f us (mean %.2f), "
+                "publish %.1f us (mean %.2f)\n%s\n",
+                legacyMax, legacyMean, reservedMax, reservedMean, realtime.stats.callbackMaxUs,
+                realtime.stats.callbackMeanUs, DescribePcmCaptureStats(realtime.stats).c_str());
+
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include "../include/Base64.h"
+#include "BenchUtil.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 原 ScreenCapture::encodeBase64 的逐字符追加实现，作为对照
+static std::string LegacyEncodeBase64(const std::vector<unsigned char>& data) {
+    const char* chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string result;
+
+    for (size_t i = 0; i < data.size(); i += 3) {
+        int b = (data[i] & 0xFC) >> 2;
+        result += chars[b];
+
+        b = (data[i] & 0x03) << 4;
+        if (i + 1 < data.size()) {
+            b |= (data[i + 1] & 0xF0) >> 4;
+            result += chars[b];
+            b = (data[i + 1] & 0x0F) << 2;
+            if (i + 2 < data.size()) {
+                b |= (data[i + 2] & 0xC0) >> 6;
+                result += chars[b];
+                b = data[i + 2] & 0x3F;
+                result += chars[b];
+            } else {
+                result += chars[b];
+                result += '=';
+            }
+        } else {
+            result += chars[b];
+            result += "==";
+        }
+    }
+
+    return result;
+}
+
+int main() {
+    const Base64Kernel kernels[] = {Base64Kernel::Scalar, Base64Kernel::Ssse3, Base64Kernel::Avx2, Base64Kernel::Neon};
+    const size_t sizes[] = {1000, 64 * 1024, 1024 * 1024, 8 * 1024 * 1024};
+
+    std::printf("active kernel: %s\n", Base64KernelName(Base64ActiveKernel()));
+    std::printf("%-10s %12s %12s %12s\n", "impl", "bytes", "ms", "MB/s");
+
+    for (size_t size : sizes) {
+        std::vector<unsigned char> data = RandomBytes(size);
+        std::string expected = LegacyEncodeBase64(data);
+
+        double ms = MeasureMs([&]() {
+            std::string encoded = LegacyEncodeBase64(data);
+            (void)encoded;
+        });
+        std::printf("%-10s %12zu %12.3f %12.1f\n", "legacy", size, ms, ThroughputMBps(size, ms));
+
+        for (Base64Kernel kernel : kernels) {
+            if (!Base64KernelSupported(kernel)) continue;
+
+            std::string out(Base64EncodedLength(size), '\0');
+            size_t written = Base64EncodeWithKernel(kernel, data.data(), data.size(), &out[0]);
+            if (written != expected.size() || out != expected) {
+                std::printf("%-10s output mismatch at %zu bytes\n", Base64KernelName(kernel), size);
+                return 1;
+            }
+
+            ms = MeasureMs([&]() {
+                Base64EncodeWithKernel(kernel, data.data(), data.size(), &out[0]);
+            });
+            std::printf("%-10s %12zu %12.3f %12.1f\n", Base64KernelName(kernel), size, ms, ThroughputMBps(size, ms));
+        }
+    }
+
+    return 0;
+}
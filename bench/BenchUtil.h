@@ -0,0 +1,48 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// 基准程序共用的计时与数据生成工具
+class BenchTimer {
+public:
+    BenchTimer() : start(std::chrono::steady_clock::now()) {}
+
+    double elapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+inline std::vector<unsigned char> RandomBytes(size_t size, unsigned int seed = 12345) {
+    std::mt19937 rng(seed);
+    std::vector<unsigned char> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = (unsigned char)(rng() & 0xFF);
+    }
+    return data;
+}
+
+// 重复执行 fn 直到累计时间超过 minMs，返回单次平均耗时（毫秒）
+template <typename Fn>
+double MeasureMs(Fn fn, double minMs = 200.0) {
+    fn(); // 预热
+    int iterations = 0;
+    BenchTimer timer;
+    do {
+        fn();
+        ++iterations;
+    } while (timer.elapsedMs() < minMs);
+    return timer.elapsedMs() / iterations;
+}
+
+inline double ThroughputMBps(size_t bytes, double ms) {
+    return ms > 0 ? (bytes / (1024.0 * 1024.0)) / (ms / 1000.0) : 0.0;
+}
+
+#endif // BENCHUTIL_H
@@ -0,0 +1,187 @@
+#include "../include/Executor.h"
+#include "BenchUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 共用线程池与“每个事件新建线程”的对比：
+// 1. 启动两个池的耗时；
+// 2. 派发开销：调用方（按键钩子）付出的时间，以及从派发到任务开始执行的延迟；
+// 3. 背压：慢任务持续提交时排队数不超过上限，submit 等待、trySubmit 拒绝；
+// 4. 工作窃取：一个任务在池内派生大量子任务时由其他线程窃取分担
+
+typedef std::chrono::steady_clock Clock;
+
+static double msBetween(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+struct LatencyResult {
+    double callerMeanMs, callerP99Ms;   // 调用方创建线程或提交任务的耗时
+    double startMeanMs, startP99Ms;     // 派发到任务开始执行
+};
+
+static double Percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0;
+    size_t rank = (std::min)(values.size() - 1, (size_t)(values.size() * p));
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+static double Mean(const std::vector<double>& values) {
+    double total = 0;
+    for (double value : values) total += value;
+    return values.empty() ? 0 : total / values.size();
+}
+
+// 逐个派发 events 个短任务，每个执行完再派发下一个（与按键事件一样彼此间隔）
+template <typename Dispatch>
+static LatencyResult MeasureDispatch(int events, Dispatch dispatch) {
+    std::vector<double> caller, start;
+    std::mutex mutex;
+    std::condition_variable finished;
+    for (int i = 0; i < events; ++i) {
+        bool done = false;
+        Clock::time_point started;
+        Clock::time_point submitted = Clock::now();
+        dispatch([&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            started = Clock::now();
+            done = true;
+            finished.notify_one();
+        });
+        Clock::time_point returned = Clock::now();
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&done]() { return done; });
+        caller.push_back(msBetween(submitted, returned));
+        start.push_back(msBetween(submitted, started));
+    }
+    LatencyResult r;
+    r.callerMeanMs = Mean(caller);
+    r.callerP99Ms = Percentile(caller, 0.99);
+    r.startMeanMs = Mean(start);
+    r.startP99Ms = Percentile(start, 0.99);
+    return r;
+}
+
+static void ReportLatency(const char* name, const LatencyResult& r) {
+    std::printf("%-24s %12.4f %12.4f %12.4f %12.4f\n", name, r.callerMeanMs, r.callerP99Ms, r.startMeanMs,
+                r.startP99Ms);
+}
+
+// 模拟一小段 CPU 工作（编码一个小块）
+static unsigned long Spin(int rounds) {
+    unsigned long value = 12345;
+    for (int i = 0; i < rounds; ++i) value = value * 6364136223846793005UL + 1442695040888963407UL;
+    return value;
+}
+
+int main() {
+    const int EVENTS = 2000;
+    bool ok = true;
+
+    BenchTimer startup;
+    std::unique_ptr<Executor> executor(new Executor());
+    double startupMs = startup.elapsedMs();
+    ThreadPoolStats cpuInfo = executor->cpu().stats();
+    ThreadPoolStats ioInfo = executor->io().stats();
+    std::printf("executor startup: %.3f ms (cpu %d workers, io %d workers)\n\n", startupMs, cpuInfo.workers,
+                ioInfo.workers);
+
+    std::printf("%-24s %12s %12s %12s %12s\n", "dispatch", "caller mean", "caller p99", "start mean", "start p99");
+    LatencyResult spawn = MeasureDispatch(EVENTS, [](const Task& task) { std::thread(task).detach(); });
+    ReportLatency("thread per event", spawn);
+    ThreadPool& io = executor->io();
+    LatencyResult pooled = MeasureDispatch(EVENTS, [&io](const Task& task) { io.trySubmit(task); });
+    ReportLatency("io pool trySubmit", pooled);
+    std::printf("%s\n\n", DescribeThreadPoolStats(io.name(), io.stats()).c_str());
+    // 钩子线程上的开销：提交任务应比创建线程便宜
+    ok = ok && pooled.callerMeanMs < spawn.callerMeanMs;
+    ok = ok && io.stats().completed >= EVENTS && io.stats().rejected == 0;
+
+    // 背压：4 个线程、最多排队 16 个，连续提交 200 个 2 ms 的任务
+    {
+        ThreadPool pool("slow", 4, 16, false);
+        std::atomic<int> ran(0);
+        BenchTimer timer;
+        for (int i = 0; i < 200; ++i) {
+            pool.submit([&ran]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                ran++;
+            });
+        }
+        while (ran < 200) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ThreadPoolStats stats = pool.stats();
+        std::printf("back-pressure: 200 x 2 ms tasks in %.1f ms\n%s\n", timer.elapsedMs(),
+                    DescribeThreadPoolStats(pool.name(), stats).c_str());
+        ok = ok && stats.maxQueueDepth <= stats.capacity && stats.blocked > 0 && stats.completed == 200;
+    }
+
+    // 池被占满时 trySubmit 直接拒绝，已接受的任务在放行后全部执行
+    {
+        ThreadPool pool("stalled", 4, 16, false);
+        std::mutex gateMutex;
+        std::condition_variable gateChanged;
+        bool open = false;
+        std::atomic<int> ran(0);
+        int accepted = 0;
+        for (int i = 0; i < 100; ++i) {
+            bool queued = pool.trySubmit([&]() {
+                std::unique_lock<std::mutex> lock(gateMutex);
+                gateChanged.wait(lock, [&open]() { return open; });
+                ran++;
+            });
+            if (queued) accepted++;
+        }
+        {
+            std::lock_guard<std::mutex> lock(gateMutex);
+            open = true;
+        }
+        gateChanged.notify_all();
+        while (ran < accepted) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ThreadPoolStats stats = pool.stats();
+        std::printf("burst into stalled pool: %d accepted, %ld rejected\n%s\n\n", accepted, stats.rejected,
+                    DescribeThreadPoolStats(pool.name(), stats).c_str());
+        ok = ok && accepted >= 16 && accepted <= 16 + 4 && stats.rejected == 100 - accepted;
+    }
+
+    // 工作窃取：一个任务派生 512 个子任务，全部进入它自己的队列
+    {
+        const int CHILDREN = 512;
+        const int ROUNDS = 200000;
+        BenchTimer serialTimer;
+        unsigned long sink = 0;
+        for (int i = 0; i < CHILDREN; ++i) sink ^= Spin(ROUNDS);
+        double serialMs = serialTimer.elapsedMs();
+
+        ThreadPool pool("steal", 4, 1024, true);
+        std::atomic<int> ran(0);
+        std::atomic<unsigned long> result(0);
+        BenchTimer timer;
+        pool.submit([&]() {
+            for (int i = 0; i < CHILDREN; ++i) {
+                pool.submit([&]() {
+                    result ^= Spin(ROUNDS);
+                    ran++;
+                });
+            }
+        });
+        while (ran < CHILDREN) std::this_thread::sleep_for(std::chrono::microseconds(200));
+        double parallelMs = timer.elapsedMs();
+        // run 在池线程中直接执行，不会等待自己
+        bool nested = false;
+        pool.run([&]() { pool.run([&nested]() { nested = true; }); });
+        ThreadPoolStats stats = pool.stats();
+        std::printf("work stealing: %d tasks serial %.1f ms, pool %.1f ms (%u hardware threads)\n%s\n", CHILDREN,
+                    serialMs, parallelMs, std::thread::hardware_concurrency(),
+                    DescribeThreadPoolStats(pool.name(), stats).c_str());
+        ok = ok && stats.steals > 0 && nested && result == sink;
+    }
+
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
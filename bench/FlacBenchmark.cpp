@@ -0,0 +1,167 @@
+#include "../include/FlacCodec.h"
+#include "BenchUtil.h"
+#include "SpeechCorpus.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// FLAC 编码：各预设的编码速度与压缩率（相对 WAV，含 44 字节头），解码后须与原始 PCM 逐字节一致。
+// 另估计 1 Mbit/s 上行下上传时间的缩短；噪声等压缩不了的录音原样存放，体积不应明显超过 WAV。
+// 可在命令行给出 16 kHz 单声道 16 位的 WAV 文件
+
+static const double UPLINK_BYTES_PER_SECOND = 125000;
+static const size_t WAV_HEADER_BYTES = 44;
+
+struct Preset {
+    const char* name;
+    FlacOptions options;
+};
+
+static Preset MakePreset(const char* name, int maxLpcOrder, int blockSize) {
+    Preset preset;
+    preset.name = name;
+    preset.options.maxLpcOrder = maxLpcOrder;
+    preset.options.blockSize = blockSize;
+    return preset;
+}
+
+static bool RoundTrip(const std::vector<char>& pcm, const std::string& flac) {
+    FlacStreamInfo info;
+    std::vector<char> decoded;
+    if (!DecodeFlac((const unsigned char*)flac.data(), flac.size(), info, decoded)) return false;
+    size_t samples = pcm.size() / 2;
+    return info.sampleRate == SPEECH_SAMPLE_RATE && info.channels == 1 && info.bitsPerSample == 16 &&
+           info.totalSamples == samples && decoded.size() == samples * 2 &&
+           std::equal(decoded.begin(), decoded.end(), pcm.begin());
+}
+
+static SpeechClip MakeRawClip(const char* name, size_t samples, unsigned int seed, int amplitude) {
+    SpeechClip clip;
+    clip.name = name;
+    clip.synthetic = true;
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> value(-amplitude, amplitude);
+    for (size_t i = 0; i < samples; ++i) AppendSpeechSample(clip.pcm, amplitude > 0 ? value(rng) : 0);
+    return clip;
+}
+
+int main(int argc, char** argv) {
+    std::vector<SpeechClip> clips;
+    SpeechClipOptions dictation(55, 31);
+    clips.push_back(MakeSpeechClip("dictation 55 s", dictation));
+    SpeechClipOptions fan(20, 32);
+    fan.noise = 120;
+    fan.lowFrequencyNoise = true;
+    fan.fricativeProbability = 0.6;
+    clips.push_back(MakeSpeechClip("fan noise 20 s", fan));
+    SpeechClipOptions shortClip(4, 33);
+    clips.push_back(MakeSpeechClip("short 4 s", shortClip));
+    const size_t speechClips = clips.size();
+    clips.push_back(MakeRawClip("digital silence 3 s", SPEECH_SAMPLE_RATE * 3, 34, 0));
+    clips.push_back(MakeRawClip("white noise 5 s", SPEECH_SAMPLE_RATE * 5, 35, 32767));
+    LoadSpeechWavs(argc, argv, clips);
+
+    std::vector<Preset> presets;
+    presets.push_back(MakePreset("fixed", 0, 4096));
+    presets.push_back(MakePreset("lpc4", 4, 4096));
+    presets.push_back(MakePreset("lpc8", 8, 4096));
+    presets.push_back(MakePreset("lpc12", 12, 4096));
+    presets.push_back(MakePreset("lpc8/1152", 8, 1152));
+    presets.push_back(MakePreset("lpc8/4000", 8, 4000));
+    const size_t defaultPreset = 2;
+
+    bool ok = true;
+    std::printf("%-22s %-10s %9s %9s %7s %10s %10s %10s\n", "clip", "preset", "WAV KB", "FLAC KB", "ratio",
+                "enc MB/s", "x realtime", "uplink s");
+    size_t speechWav = 0;
+    size_t speechFlac = 0;
+    for (size_t c = 0; c < clips.size(); ++c) {
+        const SpeechClip& clip = clips[c];
+        size_t wavBytes = clip.pcm.size() + WAV_HEADER_BYTES;
+        double audioSeconds = (double)clip.pcm.size() / SPEECH_BYTES_PER_SECOND;
+        for (size_t p = 0; p < presets.size(); ++p) {
+            const Preset& preset = presets[p];
+            FlacEncodeStats stats;
+            std::string flac = EncodeFlac(clip.pcm.data(), clip.pcm.size(), SPEECH_SAMPLE_RATE, preset.options, &stats);
+            bool exact = RoundTrip(clip.pcm, flac);
+            double ms = MeasureMs([&]() {
+                std::string encoded = EncodeFlac(clip.pcm.data(), clip.pcm.size(), SPEECH_SAMPLE_RATE, preset.options);
+                (void)encoded;
+            }, 100.0);
+            double ratio = (double)flac.size() / wavBytes;
+            std::printf("%-22.22s %-10s %9.0f %9.0f %6.1f%% %10.1f %10.0f %4.1f->%-4.1f%s\n", clip.name.c_str(),
+                        preset.name, wavBytes / 1024.0, flac.size() / 1024.0, 100.0 * ratio,
+                        ThroughputMBps(clip.pcm.size(), ms), audioSeconds * 1000.0 / ms,
+                        wavBytes / UPLINK_BYTES_PER_SECOND, flac.size() / UPLINK_BYTES_PER_SECOND,
+                        exact ? "" : "  ROUND TRIP FAILED");
+            ok = ok && exact;
+            if (p == defaultPreset) {
+                std::printf("  %s\n", DescribeFlacEncode(stats).c_str());
+                if (c < speechClips) {
+                    speechWav += wavBytes;
+                    speechFlac += flac.size();
+                }
+                // 压缩不了的录音原样存放，开销只有帧头与 CRC
+                if (clip.name == "white noise 5 s" && flac.size() > wavBytes + wavBytes / 100) {
+                    std::printf("  FAILED: incompressible input grew beyond 1%%\n");
+                    ok = false;
+                }
+                if (clip.name == "digital silence 3 s" && flac.size() > wavBytes / 100) {
+                    std::printf("  FAILED: silence not stored as constant subframes\n");
+                    ok = false;
+                }
+            }
+        }
+    }
+    double speechRatio = speechWav > 0 ? (double)speechFlac / speechWav : 0;
+    std::printf("\nspeech clips, default preset: %.0f KB -> %.0f KB (%.1f%% of WAV)\n", speechWav / 1024.0,
+                speechFlac / 1024.0, 100.0 * speechRatio);
+    if (speechRatio > 0.75) {
+        std::printf("FAILED: speech compresses to more than 75%% of WAV\n");
+        ok = false;
+    }
+
+    // 解码速度（默认预设）
+    const SpeechClip& longest = clips[0];
+    std::string flac = EncodeFlac(longest.pcm.data(), longest.pcm.size(), SPEECH_SAMPLE_RATE);
+    double decodeMs = MeasureMs([&]() {
+        FlacStreamInfo info;
+        std::vector<char> decoded;
+        DecodeFlac((const unsigned char*)flac.data(), flac.size(), info, decoded);
+    }, 100.0);
+    std::printf("decode: %.1f MB/s of PCM\n", ThroughputMBps(longest.pcm.size(), decodeMs));
+
+    // 边界长度（空、不足一帧、比一帧多一个样本、奇数字节）与损坏的数据
+    const size_t lengths[] = {0, 1, 2, 17, 4095, 4096, 4097, 10001};
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); ++i) {
+        std::vector<char> pcm(longest.pcm.begin(), longest.pcm.begin() + lengths[i] * 2);
+        std::string encoded = EncodeFlac(pcm.data(), pcm.size(), SPEECH_SAMPLE_RATE);
+        if (!RoundTrip(pcm, encoded)) {
+            std::printf("FAILED: round trip of %lu samples\n", (unsigned long)lengths[i]);
+            ok = false;
+        }
+    }
+    std::string odd = EncodeFlac(longest.pcm.data(), 2001, SPEECH_SAMPLE_RATE);
+    if (!RoundTrip(std::vector<char>(longest.pcm.begin(), longest.pcm.begin() + 2000), odd)) {
+        std::printf("FAILED: odd byte count\n");
+        ok = false;
+    }
+    size_t corrupted = 0;
+    for (size_t offset = 64; offset < flac.size(); offset += flac.size() / 50) {
+        std::string damaged = flac;
+        damaged[offset] = (char)(damaged[offset] ^ 0x10);
+        FlacStreamInfo info;
+        std::vector<char> decoded;
+        if (DecodeFlac((const unsigned char*)damaged.data(), damaged.size(), info, decoded) &&
+            decoded == longest.pcm) {
+            corrupted++;
+        }
+    }
+    if (corrupted > 0) {
+        std::printf("FAILED: %lu corrupted streams decoded without error\n", (unsigned long)corrupted);
+        ok = false;
+    }
+
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
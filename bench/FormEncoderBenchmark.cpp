@@ -0,0 +1,86 @@
+#include "../include/FormEncoder.h"
+#include "../include/Base64.h"
+#include "BenchUtil.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 原 callYoudaoOCR 的三段式流程：base64 -> strchr/sprintf 逐字节 URL 编码 -> 拼接请求体
+static std::string LegacyBuildBody(const std::vector<unsigned char>& png, size_t* peakBytes) {
+    std::string imgBase64 = Base64Encode(png);
+    std::string urlEncodedBase64;
+    const char* chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_.~";
+    for (char c : imgBase64) {
+        if (strchr(chars, c)) {
+            urlEncodedBase64 += c;
+        } else {
+            char hex[4];
+            std::snprintf(hex, sizeof(hex), "%%%02X", (unsigned char)c);
+            urlEncodedBase64 += hex;
+        }
+    }
+    std::string postData = "lang=auto&imgBase=base64," + urlEncodedBase64;
+    if (peakBytes) {
+        *peakBytes = png.size() + imgBase64.capacity() + urlEncodedBase64.capacity() + postData.capacity();
+    }
+    return postData;
+}
+
+static std::string FusedBuildBody(const std::vector<unsigned char>& png, size_t* peakBytes) {
+    static const char prefix[] = "lang=auto&imgBase=base64,";
+    const size_t prefixLength = sizeof(prefix) - 1;
+    std::string body(prefixLength + Base64FormEncodedLength(png.data(), png.size()), '\0');
+    std::memcpy(&body[0], prefix, prefixLength);
+    char* end = WriteBase64FormEncoded(png.data(), png.size(), &body[prefixLength]);
+    if (end != &body[0] + body.size()) {
+        std::printf("length mismatch\n");
+    }
+    if (peakBytes) {
+        *peakBytes = png.size() + body.capacity();
+    }
+    return body;
+}
+
+int main() {
+    // 正确性：与参考实现逐字节比对（覆盖分块边界和各种填充情况）
+    for (size_t size = 0; size < 7000; size += (size < 64 ? 1 : 997)) {
+        std::vector<unsigned char> data = RandomBytes(size, (unsigned int)size + 1);
+        if (LegacyBuildBody(data, nullptr) != FusedBuildBody(data, nullptr)) {
+            std::printf("output mismatch at %zu bytes\n", size);
+            return 1;
+        }
+        // 全是 '+' '/' 的输入（转义最多）与交替的字节模式
+        std::vector<unsigned char> escaped(size, 0xFF);
+        for (size_t i = 1; i < escaped.size(); i += 3) escaped[i] = (unsigned char)(i % 2 ? 0xFB : 0xEF);
+        if (LegacyBuildBody(escaped, nullptr) != FusedBuildBody(escaped, nullptr)) {
+            std::printf("output mismatch at %zu escaped bytes\n", size);
+            return 1;
+        }
+    }
+
+    const size_t sizes[] = {64 * 1024, 1024 * 1024, 8 * 1024 * 1024};
+    std::printf("%-8s %10s %10s %10s %14s\n", "impl", "png bytes", "ms", "MB/s", "peak bytes");
+
+    for (size_t size : sizes) {
+        std::vector<unsigned char> png = RandomBytes(size);
+        size_t legacyPeak = 0, fusedPeak = 0;
+        if (LegacyBuildBody(png, &legacyPeak) != FusedBuildBody(png, &fusedPeak)) {
+            std::printf("output mismatch at %zu bytes\n", size);
+            return 1;
+        }
+
+        double ms = MeasureMs([&]() { LegacyBuildBody(png, nullptr); });
+        std::printf("%-8s %10zu %10.3f %10.1f %14zu\n", "legacy", size, ms, ThroughputMBps(size, ms), legacyPeak);
+
+        ms = MeasureMs([&]() { FusedBuildBody(png, nullptr); });
+        std::printf("%-8s %10zu %10.3f %10.1f %14zu\n", "fused", size, ms, ThroughputMBps(size, ms), fusedPeak);
+
+        // 只计算长度（不编码）的开销
+        volatile size_t sink = 0;
+        ms = MeasureMs([&]() { sink = Base64FormEncodedLength(png.data(), png.size()); });
+        std::printf("%-8s %10zu %10.3f %10.1f %14s\n", "length", size, ms, ThroughputMBps(size, ms), "-");
+    }
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include "../include/ImageAnalyzer.h"
+#include "../include/PngEncoder.h"
+#include "BenchUtil.h"
+#include "ScreenshotCorpus.h"
+#include <cstdio>
+
+// 用法：FormatBenchmark [截图1.ppm ...]
+// 打印每张样本的内容特征、格式决策和输出大小，与固定的 RGB PNG (Fast) 对比。
+// 这里没有 JPEG 编码器（Windows 上由 GDI+ 提供），判定为照片的样本只显示决策、按 PNG 编码
+int main(int argc, char** argv) {
+    std::vector<CorpusImage> corpus = LoadCorpus(argc, argv);
+    PngOptions baselineOptions;
+    FormatPolicy policy;
+
+    std::printf("%-14s %-6s %-12s %-8s %10s %10s %8s %10s %10s\n", "image", "mode", "decision", "level",
+                "bytes", "rgb bytes", "saved", "analyze ms", "encode ms");
+    for (const CorpusImage& img : corpus) {
+        std::vector<unsigned char> baseline;
+        EncodePngBgra(img.bgra.data(), img.width, img.height, img.stride(), baselineOptions, baseline);
+
+        for (int mode = 0; mode < 2; ++mode) {
+            PreprocessOptions preprocess;
+            preprocess.enabled = mode == 1;
+
+            std::vector<unsigned char> out;
+            AdaptiveEncodeResult result;
+            double totalMs = MeasureMs([&]() {
+                EncodeCaptureAdaptive(img.bgra.data(), img.width, img.height, img.stride(), preprocess, policy,
+                                      JpegEncodeFunc(), out, result);
+            });
+            (void)totalMs;
+
+            FormatDecision wanted = ChooseImageFormat(result.stats, img.width, img.height, policy, preprocess.enabled);
+            static const char* levelNames[] = {"fastest", "fast", "default", "best"};
+            double saved = 100.0 * (1.0 - (double)out.size() / baseline.size());
+            std::printf("%-14s %-6s %-12s %-8s %10zu %10zu %7.1f%% %10.2f %10.2f\n", img.name.c_str(),
+                        mode ? "gray" : "color",
+                        wanted.format == ImageFormat::Jpeg ? "jpeg*" : ImageFormatName(result.decision.format),
+                        levelNames[(int)result.decision.pngLevel], out.size(), baseline.size(), saved,
+                        result.analyzeMs, result.encodeMs);
+        }
+
+        AdaptiveEncodeResult probe;
+        probe.stats = AnalyzeContent(img.bgra.data(), img.width, img.height, img.stride());
+        std::printf("  colors=%d%s gray=%d edge=%.3f flat=%.3f entropy=%.2f\n",
+                    probe.stats.distinctColors > 256 ? 256 : probe.stats.distinctColors,
+                    probe.stats.distinctColors > 256 ? "+" : "", probe.stats.isGray ? 1 : 0,
+                    probe.stats.edgeDensity, probe.stats.flatFraction, probe.stats.entropy);
+    }
+    std::printf("* 需要 JPEG 编码器，此处按 PNG 输出\n");
+    return 0;
+}
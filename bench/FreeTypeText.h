@@ -0,0 +1,106 @@
+#ifndef FREETYPETEXT_H
+#define FREETYPETEXT_H
+
+#include "ScreenshotCorpus.h"
+#include "../include/LocalOcr.h"
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <string>
+#include <vector>
+
+// 用 FreeType 渲染文字：生成本地识别的模板字体，以及带抗锯齿的单行文字截图样本
+class FreeTypeFace {
+public:
+    FreeTypeFace() : library(nullptr), face(nullptr) {}
+    ~FreeTypeFace() {
+        if (face) FT_Done_Face(face);
+        if (library) FT_Done_FreeType(library);
+    }
+
+    bool load(const std::string& path) {
+        return FT_Init_FreeType(&library) == 0 && FT_New_Face(library, path.c_str(), 0, &face) == 0;
+    }
+
+    void setPixelSize(int pixels) { FT_Set_Pixel_Sizes(face, 0, pixels); }
+
+    // 当前像素大小下的 ASCII 可见字符模板
+    GlyphFont makeGlyphFont(const std::string& name) const {
+        GlyphFont font;
+        font.name = name;
+        if (FT_Load_Char(face, ' ', FT_LOAD_DEFAULT) == 0) font.space = (int)(face->glyph->advance.x >> 6);
+        for (char ch = '!'; ch <= '~'; ++ch) {
+            if (FT_Load_Char(face, (FT_ULong)ch, FT_LOAD_RENDER | FT_LOAD_TARGET_NORMAL) != 0) continue;
+            const FT_GlyphSlot slot = face->glyph;
+            GlyphBitmap glyph;
+            glyph.ch = ch;
+            glyph.width = (int)slot->bitmap.width;
+            glyph.height = (int)slot->bitmap.rows;
+            glyph.left = slot->bitmap_left;
+            glyph.top = slot->bitmap_top;
+            glyph.advance = (int)(slot->advance.x >> 6);
+            glyph.coverage.resize((size_t)glyph.width * glyph.height);
+            for (int y = 0; y < glyph.height; ++y) {
+                for (int x = 0; x < glyph.width; ++x) {
+                    glyph.coverage[(size_t)y * glyph.width + x] = slot->bitmap.buffer[y * slot->bitmap.pitch + x];
+                }
+            }
+            if (ch == 'H') font.capHeight = glyph.height;
+            font.glyphs.push_back(glyph);
+        }
+        return font;
+    }
+
+    // 文字的像素宽度（按前进量累加）
+    int measure(const std::u32string& text) const {
+        int width = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (FT_Load_Char(face, text[i], FT_LOAD_DEFAULT) == 0) width += (int)(face->glyph->advance.x >> 6);
+        }
+        return width;
+    }
+
+    int ascender() const { return (int)(face->size->metrics.ascender >> 6); }
+    int descender() const { return (int)(-face->size->metrics.descender >> 6); }
+
+    // 以 (x, baseline) 为起点绘制，前景色按覆盖率与背景混合
+    void draw(CorpusImage& img, const std::u32string& text, int x, int baseline, const unsigned char fg[3],
+              const unsigned char bg[3]) const {
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (FT_Load_Char(face, text[i], FT_LOAD_RENDER | FT_LOAD_TARGET_NORMAL) != 0) continue;
+            const FT_GlyphSlot slot = face->glyph;
+            for (int gy = 0; gy < (int)slot->bitmap.rows; ++gy) {
+                int y = baseline - slot->bitmap_top + gy;
+                for (int gx = 0; gx < (int)slot->bitmap.width; ++gx) {
+                    int px = x + slot->bitmap_left + gx;
+                    int a = slot->bitmap.buffer[gy * slot->bitmap.pitch + gx];
+                    if (!a || px < 0 || y < 0 || px >= img.width || y >= img.height) continue;
+                    unsigned char* p = &img.bgra[((size_t)y * img.width + px) * 4];
+                    for (int c = 0; c < 3; ++c) p[2 - c] = (unsigned char)((fg[c] * a + bg[c] * (255 - a)) / 255);
+                }
+            }
+            x += (int)(slot->advance.x >> 6);
+        }
+    }
+
+private:
+    FT_Library library;
+    FT_Face face;
+
+    FreeTypeFace(const FreeTypeFace&);
+    FreeTypeFace& operator=(const FreeTypeFace&);
+};
+
+inline std::u32string DecodeUtf8(const std::string& text) {
+    std::u32string out;
+    for (size_t i = 0; i < text.size();) {
+        unsigned char c = (unsigned char)text[i];
+        int length = c < 0x80 ? 1 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+        char32_t code = length == 1 ? c : length == 2 ? (c & 0x1F) : length == 3 ? (c & 0x0F) : (c & 0x07);
+        for (int k = 1; k < length && i + k < text.size(); ++k) code = (code << 6) | ((unsigned char)text[i + k] & 0x3F);
+        out.push_back(code);
+        i += length;
+    }
+    return out;
+}
+
+#endif // FREETYPETEXT_H
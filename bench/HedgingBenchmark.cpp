@@ -0,0 +1,144 @@
+#include "../include/HttpConnectionPool.h"
+#include "../include/OcrClient.h"
+#include "../include/RequestHedger.h"
+#include "BenchUtil.h"
+#include "StubServer.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 请求对冲的长尾收益：替身服务器给每个请求固定的处理时间，另以小概率额外延迟数秒（模拟远程接口偶发的慢请求），
+// 对比关闭与开启对冲时的端到端延迟分位数、副本比例，以及被取消的一方是否及时退出、没有把坏连接放回池中
+
+static const int BASE_DELAY_MS = 20;
+static const int TAIL_DELAY_MS = 1500;
+static const double TAIL_RATE = 0.05;
+
+struct ScenarioResult {
+    int requests;
+    int failures;
+    double p50Ms, p90Ms, p99Ms, maxMs;
+    double totalMs;
+    long serverRequests;
+    HedgeStats hedge;
+    HttpPoolStats pool;
+};
+
+static double Percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0;
+    size_t index = (std::min)(values.size() - 1, (size_t)(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+static void Report(const char* name, const ScenarioResult& r) {
+    std::printf("%-16s %6d %5d %8.0f %8.0f %8.0f %8.0f %9.0f %8ld %7.1f%%\n", name, r.requests, r.failures, r.p50Ms,
+                r.p90Ms, r.p99Ms, r.maxMs, r.totalMs, r.serverRequests,
+                r.requests > 0 ? 100.0 * r.hedge.hedged / r.requests : 0.0);
+}
+
+// threads 个线程各发 perThread 个请求，共用一个对冲器与连接池
+static ScenarioResult Run(StubServer& server, bool hedging, int threads, int perThread) {
+    HttpUrl url;
+    ParseHttpUrl(server.url("/ocrapi1"), url);
+    std::vector<unsigned char> image = RandomBytes(16 * 1024);
+    std::shared_ptr<RequestBody> body = std::make_shared<RequestBody>(BuildOcrRequestBody(image));
+    const std::string expected = "stub " + std::to_string(body->size()) + " bytes";
+    long serverBefore = server.requestsServed();
+
+    HedgeOptions options;
+    options.enabled = hedging;
+    RequestHedger hedger(options);
+    // 被取消的尝试在 run() 返回后才结束，连接池与请求体必须比它们活得久
+    std::shared_ptr<HttpConnectionPool> pool = std::make_shared<HttpConnectionPool>();
+    std::shared_ptr<std::atomic<int> > inFlight = std::make_shared<std::atomic<int> >(0);
+
+    HedgedAttempt attempt = [pool, url, body, inFlight](int, RequestCancel& cancel, std::string& result) {
+        inFlight->fetch_add(1);
+        HttpResponse response;
+        bool ok = pool->post(url, OCR_REQUEST_HEADERS, *body, response, &cancel) && response.status == 200;
+        if (ok) result = ParseOcrResponse(response.body);
+        inFlight->fetch_sub(1);
+        return ok && !result.empty();
+    };
+
+    std::mutex latencyMutex;
+    std::vector<double> latencies;
+    std::atomic<int> failures(0);
+    BenchTimer timer;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&]() {
+            for (int i = 0; i < perThread; ++i) {
+                BenchTimer request;
+                std::string text;
+                if (!hedger.run(attempt, text) || text != expected) failures++;
+                double ms = request.elapsedMs();
+                std::lock_guard<std::mutex> lock(latencyMutex);
+                latencies.push_back(ms);
+            }
+        }));
+    }
+    for (size_t i = 0; i < workers.size(); ++i) workers[i].join();
+
+    ScenarioResult r;
+    r.totalMs = timer.elapsedMs();
+    // 被取消的尝试应在中断连接后立即返回，而不是等服务器的长尾延迟结束
+    BenchTimer drain;
+    while (inFlight->load() > 0 && drain.elapsedMs() < 5000) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (inFlight->load() > 0) failures++;
+
+    r.requests = threads * perThread;
+    r.failures = failures;
+    r.p50Ms = Percentile(latencies, 0.5);
+    r.p90Ms = Percentile(latencies, 0.9);
+    r.p99Ms = Percentile(latencies, 0.99);
+    r.maxMs = Percentile(latencies, 1.0);
+    r.serverRequests = server.requestsServed() - serverBefore;
+    r.hedge = hedger.stats();
+    r.pool = pool->stats();
+    return r;
+}
+
+int main() {
+    StubServer server;
+    server.setTailDelay(TAIL_RATE, TAIL_DELAY_MS);
+    if (!server.start(0, BASE_DELAY_MS)) {
+        std::printf("cannot start stub server\n");
+        return 1;
+    }
+    std::printf("stub: %d ms per request, %.0f%% of requests +%d ms\n\n", BASE_DELAY_MS, TAIL_RATE * 100, TAIL_DELAY_MS);
+    std::printf("%-16s %6s %5s %8s %8s %8s %8s %9s %8s %8s\n", "scenario", "reqs", "fail", "p50 ms", "p90 ms",
+                "p99 ms", "max ms", "total ms", "srv reqs", "hedged");
+
+    const int threads = 8, perThread = 50;
+    ScenarioResult off = Run(server, false, threads, perThread);
+    Report("hedging off", off);
+    ScenarioResult on = Run(server, true, threads, perThread);
+    Report("hedging on", on);
+
+    std::printf("\n%s\n", DescribeHedgeStats(on.hedge).c_str());
+    std::printf("pool: opened=%ld reused=%ld stale retries=%ld\n", on.pool.connectionsOpened, on.pool.connectionsReused,
+                on.pool.staleRetries);
+
+    bool ok = off.failures == 0 && on.failures == 0;
+    // 开启对冲后 p99 应从长尾延迟降到“等待时间 + 一次正常请求”的量级
+    ok = ok && off.p99Ms >= TAIL_DELAY_MS && on.p99Ms < off.p99Ms / 2;
+    // 副本比例受 maxHedgeRatio 约束（预算按 ratio * requests + 1 计）
+    ok = ok && on.hedge.hedged <= HedgeOptions().maxHedgeRatio * on.requests + 1;
+    // 服务器多处理的请求不超过副本数（副本落败时可能在上传中途被中断）；被中断的连接不放回池中，也就不会出现复用失效重发
+    ok = ok && on.serverRequests >= on.requests && on.serverRequests <= on.requests + on.hedge.hedged &&
+         on.pool.staleRetries == 0;
+    ok = ok && on.hedge.cancelled > 0 && on.hedge.failed == 0;
+    std::printf("\np99 %.0f ms -> %.0f ms, hedge rate %.1f%%\n%s\n", off.p99Ms, on.p99Ms,
+                100.0 * on.hedge.hedged / on.requests, ok ? "PASS" : "FAIL");
+    server.stop();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,245 @@
+#include "../include/InputDispatcher.h"
+#include "../include/SpscRing.h"
+#include "BenchUtil.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 按键分发器与无锁队列：用合成的按键序列代替系统钩子。
+// 1. 脚本场景：逐键核对拦截结果、产生的动作与状态切换（组件的状态报告在分发线程中模拟）；
+// 2. 钩子耗时：模拟钩子线程连续投递按键，统计回调耗时，与系统的钩子超时（默认约 300 ms）比较；
+// 3. 分发线程卡住时队列写满，钩子丢弃动作而不等待；
+// 4. 环形队列本身的顺序与吞吐
+
+static const char* const KEY_NAMES[] = {"other", "modifier", "esc", "space", "rbutton", "ctrl+shift+s",
+                                        "ctrl+shift+h"};
+
+// 模拟组件：收到动作后按应用中的方式报告状态
+struct FakeApp {
+    InputDispatcher* dispatcher;
+    std::mutex mutex;
+    std::vector<InputAction> actions;
+
+    void handle(const InputEvent& event) {
+        switch (event.action) {
+        case INPUT_ACTION_CANCEL_CAPTURE:
+            dispatcher->changeMode(INPUT_CAPTURING, INPUT_IDLE);     // 遮罩窗口关闭
+            break;
+        case INPUT_ACTION_CANCEL_RECORDING:
+            dispatcher->changeMode(INPUT_RECORDING, INPUT_IDLE);
+            break;
+        case INPUT_ACTION_STOP_RECORDING:
+            dispatcher->changeMode(INPUT_RECORDING, INPUT_IDLE);
+            dispatcher->setRecognizing(true);                         // 识别任务开始
+            break;
+        case INPUT_ACTION_CANCEL_RECOGNITION:
+            dispatcher->setRecognizing(false);
+            break;
+        default:
+            break;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        actions.push_back(event.action);
+    }
+};
+
+struct Step {
+    InputKey key;
+    bool intercept;
+    InputAction action;
+    InputMode modeAfter;    // 分发线程处理完动作后的状态
+};
+
+static void WaitDispatched(InputDispatcher& dispatcher, long count) {
+    BenchTimer timer;
+    while (dispatcher.stats().dispatched < count && timer.elapsedMs() < 1000) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+static int RunScript(const char* name, const std::vector<Step>& steps, InputMode initial) {
+    FakeApp app;
+    InputDispatcher dispatcher([&app](const InputEvent& event) { app.handle(event); });
+    app.dispatcher = &dispatcher;
+    dispatcher.start();
+    dispatcher.changeMode(INPUT_IDLE, initial);
+
+    int errors = 0;
+    long expectedActions = 0;
+    for (size_t i = 0; i < steps.size(); ++i) {
+        const Step& step = steps[i];
+        bool intercept = dispatcher.onInput(step.key);
+        if (step.action != INPUT_ACTION_NONE) expectedActions++;
+        WaitDispatched(dispatcher, expectedActions);
+        InputAction action = INPUT_ACTION_NONE;
+        {
+            std::lock_guard<std::mutex> lock(app.mutex);
+            if ((long)app.actions.size() == expectedActions && step.action != INPUT_ACTION_NONE) {
+                action = app.actions.back();
+            }
+        }
+        if (intercept != step.intercept || action != step.action || dispatcher.mode() != step.modeAfter) {
+            std::printf("  %s step %lu (%s): intercept %d action %s mode %d\n", name, (unsigned long)i,
+                        KEY_NAMES[step.key], intercept, InputActionName(action), dispatcher.mode());
+            errors++;
+        }
+    }
+    dispatcher.stop();
+    std::printf("%-28s %3lu keys %3ld actions  %s\n", name, (unsigned long)steps.size(), expectedActions,
+                errors == 0 ? "ok" : "MISMATCH");
+    return errors;
+}
+
+static Step S(InputKey key, bool intercept, InputAction action, InputMode modeAfter) {
+    Step step = {key, intercept, action, modeAfter};
+    return step;
+}
+
+int main() {
+    int errors = 0;
+
+    // 1. 脚本场景
+    {
+        std::vector<Step> capture;
+        capture.push_back(S(INPUT_KEY_OTHER, false, INPUT_ACTION_NONE, INPUT_IDLE));
+        capture.push_back(S(INPUT_KEY_ESCAPE, false, INPUT_ACTION_NONE, INPUT_IDLE));
+        capture.push_back(S(INPUT_KEY_CAPTURE_HOTKEY, true, INPUT_ACTION_START_CAPTURE, INPUT_CAPTURING));
+        capture.push_back(S(INPUT_KEY_OTHER, true, INPUT_ACTION_NONE, INPUT_CAPTURING));
+        capture.push_back(S(INPUT_KEY_MODIFIER, false, INPUT_ACTION_NONE, INPUT_CAPTURING));
+        capture.push_back(S(INPUT_KEY_RECORD_HOTKEY, true, INPUT_ACTION_NONE, INPUT_CAPTURING));
+        capture.push_back(S(INPUT_KEY_ESCAPE, true, INPUT_ACTION_CANCEL_CAPTURE, INPUT_IDLE));
+        capture.push_back(S(INPUT_KEY_ESCAPE, false, INPUT_ACTION_NONE, INPUT_IDLE));
+        capture.push_back(S(INPUT_KEY_CAPTURE_HOTKEY, true, INPUT_ACTION_START_CAPTURE, INPUT_CAPTURING));
+        capture.push_back(S(INPUT_KEY_RBUTTON, true, INPUT_ACTION_CANCEL_CAPTURE, INPUT_IDLE));
+        capture.push_back(S(INPUT_KEY_RBUTTON, false, INPUT_ACTION_NONE, INPUT_IDLE));
+        errors += RunScript("capture, cancel", capture, INPUT_IDLE);
+
+        std::vector<Step> record;
+        record.push_back(S(INPUT_KEY_SPACE, false, INPUT_ACTION_NONE, INPUT_IDLE));
+        record.push_back(S(INPUT_KEY_RECORD_HOTKEY, true, INPUT_ACTION_START_RECORDING, INPUT_RECORDING));
+        record.push_back(S(INPUT_KEY_OTHER, true, INPUT_ACTION_NONE, INPUT_RECORDING));
+        record.push_back(S(INPUT_KEY_CAPTURE_HOTKEY, true, INPUT_ACTION_NONE, INPUT_RECORDING));
+        record.push_back(S(INPUT_KEY_SPACE, true, INPUT_ACTION_STOP_RECORDING, INPUT_IDLE));
+        record.push_back(S(INPUT_KEY_SPACE, false, INPUT_ACTION_NONE, INPUT_IDLE));
+        record.push_back(S(INPUT_KEY_ESCAPE, true, INPUT_ACTION_CANCEL_RECOGNITION, INPUT_IDLE));
+        record.push_back(S(INPUT_KEY_ESCAPE, false, INPUT_ACTION_NONE, INPUT_IDLE));
+        record.push_back(S(INPUT_KEY_RECORD_HOTKEY, true, INPUT_ACTION_START_RECORDING, INPUT_RECORDING));
+        record.push_back(S(INPUT_KEY_RBUTTON, true, INPUT_ACTION_CANCEL_RECORDING, INPUT_IDLE));
+        errors += RunScript("record, stop, cancel asr", record, INPUT_IDLE);
+
+        // 双击托盘图标开始的截图：组件先报告进入截图状态
+        std::vector<Step> tray;
+        tray.push_back(S(INPUT_KEY_SPACE, true, INPUT_ACTION_NONE, INPUT_CAPTURING));
+        tray.push_back(S(INPUT_KEY_ESCAPE, true, INPUT_ACTION_CANCEL_CAPTURE, INPUT_IDLE));
+        errors += RunScript("capture from tray", tray, INPUT_CAPTURING);
+    }
+
+    // 2. 钩子耗时：100 万次按键，其中约 1/8 产生动作
+    InputStats hookStats;
+    {
+        const int EVENTS = 1000000;
+        std::atomic<long> handled(0);
+        InputDispatcher* self = nullptr;
+        InputDispatcher dispatcher([&handled, &self](const InputEvent& event) {
+            if (event.action == INPUT_ACTION_START_CAPTURE) self->changeMode(INPUT_CAPTURING, INPUT_IDLE);
+            handled++;
+        }, 4096);
+        self = &dispatcher;
+        dispatcher.start();
+        const InputKey pattern[] = {INPUT_KEY_OTHER, INPUT_KEY_MODIFIER, INPUT_KEY_OTHER, INPUT_KEY_SPACE,
+                                    INPUT_KEY_OTHER, INPUT_KEY_ESCAPE, INPUT_KEY_OTHER, INPUT_KEY_CAPTURE_HOTKEY};
+        BenchTimer timer;
+        for (int i = 0; i < EVENTS; ++i) {
+            std::chrono::steady_clock::time_point entered = std::chrono::steady_clock::now();
+            dispatcher.onInput(pattern[i % 8]);
+            dispatcher.recordHookLatency(entered);
+        }
+        double elapsedMs = timer.elapsedMs();
+        dispatcher.stop();
+        hookStats = dispatcher.stats();
+        std::printf("\n%d synthetic hook calls in %.1f ms\n%s\n", EVENTS, elapsedMs,
+                    DescribeInputStats(hookStats).c_str());
+        if (hookStats.queued != handled || hookStats.queued + hookStats.dropped == 0) errors++;
+    }
+
+    // 3. 分发线程卡住：队列 16 项写满后丢弃，钩子不等待；队列中的动作在放行后全部执行
+    InputStats stalledStats;
+    double stalledMaxUs = 0;
+    {
+        std::mutex gateMutex;
+        std::condition_variable gateChanged;
+        bool open = false;
+        std::atomic<long> handled(0);
+        InputDispatcher dispatcher([&](const InputEvent&) {
+            std::unique_lock<std::mutex> lock(gateMutex);
+            gateChanged.wait(lock, [&open]() { return open; });
+            handled++;
+        }, 16);
+        dispatcher.start();
+        dispatcher.setRecognizing(true);
+        for (int i = 0; i < 200; ++i) {
+            std::chrono::steady_clock::time_point entered = std::chrono::steady_clock::now();
+            dispatcher.onInput(INPUT_KEY_ESCAPE);
+            dispatcher.recordHookLatency(entered);
+        }
+        // 动作被丢弃时不停留在新状态
+        dispatcher.setRecognizing(false);
+        dispatcher.onInput(INPUT_KEY_CAPTURE_HOTKEY);
+        bool reverted = dispatcher.mode() == INPUT_IDLE;
+        {
+            std::lock_guard<std::mutex> lock(gateMutex);
+            open = true;
+        }
+        gateChanged.notify_all();
+        dispatcher.stop();
+        stalledStats = dispatcher.stats();
+        stalledMaxUs = stalledStats.hookMaxUs;
+        std::printf("\nstalled dispatcher, queue 16: reverted mode on drop: %s\n%s\n", reverted ? "yes" : "no",
+                    DescribeInputStats(stalledStats).c_str());
+        if (!reverted || stalledStats.dropped == 0 || stalledStats.queued != handled ||
+            stalledStats.queued > 16 + 1) {
+            errors++;
+        }
+    }
+
+    // 4. 环形队列：两个线程传递 1000 万个递增的数，核对顺序
+    {
+        const long COUNT = 10000000;
+        SpscRing<long> ring(1024);
+        std::atomic<bool> ordered(true);
+        BenchTimer timer;
+        std::thread consumer([&]() {
+            long expected = 0;
+            long value;
+            while (expected < COUNT) {
+                if (!ring.pop(value)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (value != expected) ordered = false;
+                expected++;
+            }
+        });
+        long fullRetries = 0;
+        for (long i = 0; i < COUNT; ++i) {
+            while (!ring.push(i)) {
+                fullRetries++;
+                std::this_thread::yield();
+            }
+        }
+        consumer.join();
+        double elapsedMs = timer.elapsedMs();
+        std::printf("\nspsc ring: %ld items in %.1f ms (%.1f M/s), %ld full retries, order %s\n", COUNT, elapsedMs,
+                    COUNT / elapsedMs / 1000.0, fullRetries, ordered ? "ok" : "BROKEN");
+        if (!ordered) errors++;
+    }
+
+    // 钩子超时默认约 300 ms；回调耗时须低出几个数量级
+    bool fast = hookStats.hookP99Us < 50 && hookStats.hookMaxUs < 30000 && stalledMaxUs < 30000;
+    bool ok = errors == 0 && fast;
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+#include "../include/HttpConnectionPool.h"
+#include "../include/Job.h"
+#include "../include/OcrClient.h"
+#include "../include/PngEncoder.h"
+#include "../include/RequestHedger.h"
+#include "BenchUtil.h"
+#include "ScreenshotCorpus.h"
+#include "StubServer.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 识别任务的取消延迟：本地替身服务器每个请求处理数秒（模拟卡住的远程接口），
+// 任务在上传阶段被用户取消或超过阶段时限后，测量从取消到任务线程退出的时间，并确认截图与请求体已经释放。
+// 任务按应用中的顺序分阶段执行：截图（生成 1080p 样本）、编码（PNG）、上传（可对冲）、解析
+
+struct JobSetup {
+    HttpUrl url;
+    std::shared_ptr<HttpConnectionPool> pool;
+    RequestHedger* hedger;
+    int encodeDeadlineMs;
+    int uploadDeadlineMs;
+};
+
+// 任务用到的大块内存，任务结束（包括被取消的对冲副本退出）后应全部释放
+struct Observed {
+    std::mutex mutex;
+    std::weak_ptr<CorpusImage> capture;
+    std::weak_ptr<void> upload;
+    std::string text;
+
+    bool released() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return capture.expired() && upload.expired();
+    }
+};
+
+static void RunOcrJob(Job& job, const JobSetup& setup, Observed& observed) {
+    if (!job.enterStage("capture", 2000)) return;
+    std::shared_ptr<CorpusImage> capture = std::make_shared<CorpusImage>(MakeCodeEditorImage(1920, 1080));
+
+    if (!job.enterStage("encode", setup.encodeDeadlineMs)) return;
+    struct Upload {
+        std::vector<unsigned char> image;
+        RequestBody body;
+    };
+    std::shared_ptr<Upload> upload = std::make_shared<Upload>();
+    EncodePngBgra(capture->bgra.data(), capture->width, capture->height, capture->stride(), PngOptions(),
+                  upload->image);
+    upload->body = BuildOcrRequestBody(upload->image);
+    {
+        std::lock_guard<std::mutex> lock(observed.mutex);
+        observed.capture = capture;
+        observed.upload = upload;
+    }
+
+    if (!job.enterStage("upload", setup.uploadDeadlineMs)) return;
+    std::shared_ptr<HttpConnectionPool> pool = setup.pool;
+    HttpUrl url = setup.url;
+    std::string response;
+    bool ok = setup.hedger->run([pool, url, upload](int, RequestCancel& cancel, std::string& result) {
+        HttpResponse http;
+        if (!pool->post(url, OCR_REQUEST_HEADERS, upload->body, http, &cancel) || http.status != 200) return false;
+        result.swap(http.body);
+        return true;
+    }, response, &job.token());
+
+    if (!ok || !job.enterStage("parse", 1000)) return;
+    std::lock_guard<std::mutex> lock(observed.mutex);
+    observed.text = ParseOcrResponse(response);
+}
+
+struct ScenarioResult {
+    int jobs;
+    int errors;
+    double meanMs, maxMs;       // 从取消（或超时）到任务退出
+    double releaseMaxMs;        // 任务退出后到大块内存全部释放
+    JobStats stats;
+};
+
+static void Report(const char* name, const ScenarioResult& r) {
+    std::printf("%-30s %5d %6d %10.2f %10.2f %12.2f %9ld %9ld\n", name, r.jobs, r.errors, r.meanMs, r.maxMs,
+                r.releaseMaxMs, r.stats.cancelled, r.stats.timedOut);
+}
+
+// cancelStage 为空时不取消（用于阶段时限场景）；否则在任务进入该阶段 cancelAfterMs 毫秒后取消
+static ScenarioResult Run(const JobSetup& setup, int jobs, const char* cancelStage, int cancelAfterMs,
+                          JobState expected) {
+    ScenarioResult r;
+    r.jobs = jobs;
+    r.errors = 0;
+    r.meanMs = r.maxMs = r.releaseMaxMs = 0;
+    JobRunner runner;
+    for (int i = 0; i < jobs; ++i) {
+        Observed observed;
+        std::shared_ptr<Job> job = runner.start("bench", [&setup, &observed](Job& job) {
+            RunOcrJob(job, setup, observed);
+        });
+
+        BenchTimer sinceStart;
+        double cancelledAt = 0;
+        if (cancelStage) {
+            while (std::strcmp(job->stage(), cancelStage) != 0 && job->state() == JOB_RUNNING) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(cancelAfterMs + (i % 5) * 10));
+            cancelledAt = sinceStart.elapsedMs();
+            job->cancel();
+        }
+        if (!runner.waitAll(10000)) {
+            r.errors++;
+            continue;
+        }
+        BenchTimer sinceExit;
+        while (!observed.released() && sinceExit.elapsedMs() < 1000) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        if (!observed.released()) r.errors++;
+        r.releaseMaxMs = (std::max)(r.releaseMaxMs, sinceExit.elapsedMs());
+        if (job->state() != expected) r.errors++;
+        if (cancelStage) {
+            double latency = sinceStart.elapsedMs() - sinceExit.elapsedMs() - cancelledAt;
+            r.meanMs += latency / jobs;
+            r.maxMs = (std::max)(r.maxMs, latency);
+        }
+        if (expected == JOB_FINISHED && observed.text.empty()) r.errors++;
+    }
+    r.stats = runner.stats();
+    if (!cancelStage) {
+        r.meanMs = r.stats.cancelLatencyMeanMs;
+        r.maxMs = r.stats.cancelLatencyMaxMs;
+    }
+    return r;
+}
+
+int main() {
+    StubServer slow, fast;
+    if (!slow.start(0, 3000) || !fast.start(0)) {
+        std::printf("cannot start stub server\n");
+        return 1;
+    }
+
+    JobSetup setup;
+    setup.pool = std::make_shared<HttpConnectionPool>();
+    setup.encodeDeadlineMs = 10000;
+    setup.uploadDeadlineMs = 30000;
+    HedgeOptions plain;
+    plain.enabled = false;
+    RequestHedger noHedging(plain);
+    HedgeOptions quick;
+    quick.initialDelayMs = 50;
+    quick.maxHedgeRatio = 1.0;
+    RequestHedger hedging(quick);
+
+    std::printf("slow stub: 3000 ms per request; 1920x1080 capture, PNG encode\n\n");
+    std::printf("%-30s %5s %6s %10s %10s %12s %9s %9s\n", "scenario", "jobs", "errors", "mean ms", "max ms",
+                "release ms", "cancelled", "timedout");
+
+    ParseHttpUrl(fast.url("/ocrapi1"), setup.url);
+    setup.hedger = &noHedging;
+    ScenarioResult baseline = Run(setup, 5, nullptr, 0, JOB_FINISHED);
+    Report("no cancel, fast server", baseline);
+
+    ParseHttpUrl(slow.url("/ocrapi1"), setup.url);
+    ScenarioResult upload = Run(setup, 20, "upload", 50, JOB_CANCELLED);
+    Report("Esc during upload", upload);
+
+    setup.hedger = &hedging;
+    ScenarioResult hedged = Run(setup, 10, "upload", 100, JOB_CANCELLED);
+    Report("Esc during hedged upload", hedged);
+    HedgeStats hedgeStats = hedging.stats();
+
+    setup.hedger = &noHedging;
+    ScenarioResult encode = Run(setup, 10, "encode", 0, JOB_CANCELLED);
+    Report("Esc during encode", encode);
+
+    setup.uploadDeadlineMs = 200;
+    ScenarioResult deadline = Run(setup, 10, nullptr, 0, JOB_TIMED_OUT);
+    Report("upload deadline 200 ms", deadline);
+
+    std::printf("\n%s\n", DescribeHedgeStats(hedgeStats).c_str());
+
+    bool ok = baseline.errors == 0 && upload.errors == 0 && hedged.errors == 0 && encode.errors == 0 &&
+              deadline.errors == 0;
+    // 网络阶段的取消直接中断套接字，不等服务器的处理时间
+    ok = ok && upload.maxMs < 50 && hedged.maxMs < 50 && deadline.maxMs < 50;
+    // 对冲的两次尝试都被中断（调用方取消不计入失败）
+    ok = ok && hedgeStats.aborted == hedged.jobs && hedgeStats.hedged == hedged.jobs && hedgeStats.failed == 0;
+    // 编码不可中断，任务在编码结束后的阶段边界退出
+    ok = ok && encode.stats.cancelled == encode.jobs;
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    slow.stop();
+    fast.stop();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,307 @@
+#include "../include/AsrClient.h"
+#include "../include/JsonReader.h"
+#include "../include/OcrClient.h"
+#include "BenchUtil.h"
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// 识别响应解析：基于 JsonReader 的解析与原先按 find 扫描的解析比较速度与正确性（大响应、含 \u 转义、
+// 代理对、文字中的括号与引号），并验证分段送入与一次送入结果相同
+
+// 原先的实现（保留用于对比）：\uXXXX 原样保留，遇到转义的引号时截断
+static std::string LegacyUnescape(const std::string& escaped) {
+    std::string result;
+    for (size_t i = 0; i < escaped.length(); ++i) {
+        if (escaped[i] == '\\' && i + 1 < escaped.length()) {
+            char next = escaped[i + 1];
+            switch (next) {
+                case '\\': result += '\\'; i++; break;
+                case '"': result += '"'; i++; break;
+                case '/': result += '/'; i++; break;
+                case 'n': result += '\n'; i++; break;
+                case 't': result += '\t'; i++; break;
+                case 'u':
+                    if (i + 5 < escaped.length()) {
+                        result += escaped.substr(i, 6);
+                        i += 5;
+                    } else {
+                        result += escaped[i];
+                    }
+                    break;
+                default: result += escaped[i]; break;
+            }
+        } else {
+            result += escaped[i];
+        }
+    }
+    return result;
+}
+
+static std::vector<std::string> LegacyOcrWords(const std::string& response) {
+    std::vector<std::string> words;
+    size_t linesPos = response.find("\"lines\":");
+    if (linesPos == std::string::npos) return words;
+    size_t pos = response.find('[', linesPos);
+    if (pos == std::string::npos) return words;
+    while ((pos = response.find("\"words\":", pos)) != std::string::npos) {
+        pos += 8;
+        while (pos < response.length() && (response[pos] == ' ' || response[pos] == '\t')) pos++;
+        if (pos >= response.length() || response[pos] != '"') break;
+        pos++;
+        size_t end = response.find('"', pos);
+        if (end == std::string::npos) break;
+        std::string word = response.substr(pos, end - pos);
+        if (!word.empty()) words.push_back(LegacyUnescape(word));
+        pos = end + 1;
+    }
+    return words;
+}
+
+static std::vector<std::string> LegacyAsrSentences(const std::string& response) {
+    std::vector<std::string> sentences;
+    size_t resultPos = response.find("\"result\":");
+    if (resultPos == std::string::npos) return sentences;
+    size_t arrayStart = response.find('[', resultPos);
+    size_t arrayEnd = response.find(']', arrayStart);
+    if (arrayStart == std::string::npos || arrayEnd == std::string::npos) return sentences;
+    std::string content = response.substr(arrayStart + 1, arrayEnd - arrayStart - 1);
+    size_t pos = 0;
+    while ((pos = content.find('"', pos)) != std::string::npos) {
+        pos++;
+        size_t end = content.find('"', pos);
+        if (end == std::string::npos) break;
+        sentences.push_back(content.substr(pos, end - pos));
+        pos = end + 1;
+    }
+    return sentences;
+}
+
+static void AppendUtf8(std::string& out, unsigned int code) {
+    if (code < 0x80) {
+        out += (char)code;
+    } else if (code < 0x800) {
+        out += (char)(0xC0 | (code >> 6));
+        out += (char)(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        out += (char)(0xE0 | (code >> 12));
+        out += (char)(0x80 | ((code >> 6) & 0x3F));
+        out += (char)(0x80 | (code & 0x3F));
+    } else {
+        out += (char)(0xF0 | (code >> 18));
+        out += (char)(0x80 | ((code >> 12) & 0x3F));
+        out += (char)(0x80 | ((code >> 6) & 0x3F));
+        out += (char)(0x80 | (code & 0x3F));
+    }
+}
+
+static void AppendEscapedCodePoint(std::string& out, unsigned int code) {
+    char hex[16];
+    if (code >= 0x10000) {
+        code -= 0x10000;
+        std::snprintf(hex, sizeof(hex), "\\u%04x", 0xD800 + (code >> 10));
+        out += hex;
+        code = 0xDC00 + (code & 0x3FF);
+    }
+    std::snprintf(hex, sizeof(hex), "\\u%04x", code);
+    out += hex;
+}
+
+// 文字内容：plain 只有字母与汉字（原先的解析也能正确处理）；其余两种含括号、引号、反斜杠与 emoji，
+// escaped 时非 ASCII 字符全部写成 \uXXXX（emoji 为代理对）
+enum TextKind { TEXT_PLAIN, TEXT_SPECIAL, TEXT_ESCAPED };
+
+static const char* TextKindName(TextKind kind) {
+    return kind == TEXT_PLAIN ? "plain" : kind == TEXT_SPECIAL ? "brackets/quotes" : "\\u escaped";
+}
+
+// 随机一行文字；json 为其 JSON 字面量内容
+static void MakeText(std::mt19937& rng, TextKind textKind, std::string& utf8, std::string& json) {
+    static const unsigned int special[] = {'[', ']', '{', '}', '"', '\\', ',', ':', 0x4E2D, 0x6587, 0x1F600, 0x1F4C4};
+    int length = 8 + (int)(rng() % 40);
+    for (int i = 0; i < length; ++i) {
+        unsigned int code;
+        unsigned int kind = rng() % 10;
+        if (kind < 5) code = 'a' + rng() % 26;
+        else if (kind < 8) code = 0x4E00 + rng() % 0x5000;
+        else if (textKind == TEXT_PLAIN) code = 'A' + rng() % 26;
+        else code = special[rng() % (sizeof(special) / sizeof(special[0]))];
+        AppendUtf8(utf8, code);
+        if (code == '"' || code == '\\') {
+            json += '\\';
+            json += (char)code;
+        } else if (code >= 0x80 && textKind == TEXT_ESCAPED) {
+            AppendEscapedCodePoint(json, code);
+        } else {
+            AppendUtf8(json, code);
+        }
+    }
+}
+
+struct OcrFixture {
+    std::string response;
+    std::vector<std::string> lines;
+};
+
+// regions[].lines[]，每行带 boundingBox 与逐字的 chars 数组
+static OcrFixture MakeOcrResponse(int regionCount, int linesPerRegion, TextKind textKind) {
+    std::mt19937 rng(11);
+    OcrFixture f;
+    f.response = "{\"errorCode\":\"0\",\"Result\":{\"orientation\":\"UP\",\"regions\":[";
+    for (int r = 0; r < regionCount; ++r) {
+        if (r) f.response += ",";
+        f.response += "{\"boundingBox\":\"0,0,1920,0,1920,1080,0,1080\",\"dir\":\"h\",\"lang\":\"zh\",\"lines\":[";
+        for (int l = 0; l < linesPerRegion; ++l) {
+            std::string utf8, json;
+            MakeText(rng, textKind, utf8, json);
+            f.lines.push_back(utf8);
+            int y = l * 20;
+            char box[96];
+            std::snprintf(box, sizeof(box), "12,%d,900,%d,900,%d,12,%d", y, y, y + 16, y + 16);
+            if (l) f.response += ",";
+            f.response += "{\"boundingBox\":\"";
+            f.response += box;
+            f.response += "\",\"words\":\"" + json + "\",\"chars\":[";
+            for (int c = 0; c < 6; ++c) {
+                if (c) f.response += ",";
+                f.response += "{\"boundingBox\":\"1,2,3,4\",\"word\":\"x\",\"confidence\":0.98}";
+            }
+            f.response += "]}";
+        }
+        f.response += "]}";
+    }
+    f.response += "]}}";
+    return f;
+}
+
+static OcrFixture MakeAsrResponse(int sentenceCount, TextKind textKind) {
+    std::mt19937 rng(23);
+    OcrFixture f;
+    f.response = "{\"result\":[";
+    for (int i = 0; i < sentenceCount; ++i) {
+        std::string utf8, json;
+        MakeText(rng, textKind, utf8, json);
+        f.lines.push_back(utf8);
+        if (i) f.response += ",";
+        f.response += "\"" + json + "\"";
+    }
+    f.response += "],\"errorCode\":\"0\"}";
+    return f;
+}
+
+static int CountMismatches(const std::vector<std::string>& got, const std::vector<std::string>& expected) {
+    int mismatches = (int)(got.size() > expected.size() ? got.size() - expected.size() : expected.size() - got.size());
+    for (size_t i = 0; i < got.size() && i < expected.size(); ++i) {
+        if (got[i] != expected[i]) mismatches++;
+    }
+    return mismatches;
+}
+
+static std::vector<std::string> OcrTexts(const std::vector<OcrLine>& lines) {
+    std::vector<std::string> texts;
+    for (size_t i = 0; i < lines.size(); ++i) texts.push_back(lines[i].text);
+    return texts;
+}
+
+// 按 segment 字节分段送入
+static std::vector<OcrLine> ParseOcrSegmented(const std::string& response, size_t segment) {
+    OcrResponseParser parser;
+    for (size_t pos = 0; pos < response.size(); pos += segment) {
+        parser.feed(response.data() + pos, (std::min)(segment, response.size() - pos));
+    }
+    parser.finish();
+    return parser.takeLines();
+}
+
+static bool CheckDecoding() {
+    struct Case {
+        const char* json;
+        const char* expected;
+    };
+    const Case cases[] = {
+        {"\"\\u4e2d\\u6587\"", "\xE4\xB8\xAD\xE6\x96\x87"},
+        {"\"\\ud83d\\ude00\"", "\xF0\x9F\x98\x80"},             // 代理对
+        {"\"a\\ud83dz\"", "a\xEF\xBF\xBDz"},                     // 落单的高代理项
+        {"\"\\ude00\"", "\xEF\xBF\xBD"},                         // 落单的低代理项
+        {"\"q\\\"\\\\\\/\\b\\f\\n\\r\\t\"", "q\"\\/\b\f\n\r\t"},
+    };
+    bool ok = true;
+    for (const Case& c : cases) {
+        std::string doc = c.json;
+        JsonReader reader(doc.data(), doc.size());
+        bool match = reader.next() == JSON_STRING && reader.text().str() == c.expected && reader.next() == JSON_END;
+        if (!match) std::printf("decode FAILED: %s\n", c.json);
+        ok = ok && match;
+    }
+    const char* malformed[] = {"{\"a\":}", "[1,]", "{\"a\" 1}", "\"\\x\"", "\"\\u12\"", "[", "{\"a\":1}}"};
+    for (const char* doc : malformed) {
+        std::string text = doc;
+        JsonReader reader(text.data(), text.size());
+        JsonToken token;
+        do {
+            token = reader.next();
+        } while (token != JSON_ERROR && token != JSON_END);
+        // 顶层值结束后的多余内容不再读取
+        bool expectEnd = text == "{\"a\":1}}";
+        if ((token == JSON_END) != expectEnd) {
+            std::printf("malformed input not rejected: %s\n", doc);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+int main() {
+    bool ok = CheckDecoding();
+    std::printf("escape decoding and error checks: %s\n\n", ok ? "ok" : "FAILED");
+
+    std::printf("%-38s %9s %11s %11s %11s %10s %10s\n", "response", "KB", "legacy ms", "reader ms", "1460B seg", "legacy ok",
+                "reader ok");
+    const TextKind kinds[] = {TEXT_PLAIN, TEXT_SPECIAL, TEXT_ESCAPED};
+    for (TextKind kind : kinds) {
+        OcrFixture ocr = MakeOcrResponse(8, 150, kind);
+        std::vector<std::string> legacy;
+        std::vector<OcrLine> parsed, segmented;
+        double legacyMs = MeasureMs([&]() { legacy = LegacyOcrWords(ocr.response); });
+        double readerMs = MeasureMs([&]() { parsed = ParseOcrLines(ocr.response); });
+        double segmentMs = MeasureMs([&]() { segmented = ParseOcrSegmented(ocr.response, 1460); });
+        int legacyBad = CountMismatches(legacy, ocr.lines);
+        int readerBad = CountMismatches(OcrTexts(parsed), ocr.lines);
+        int segmentBad = CountMismatches(OcrTexts(segmented), ocr.lines);
+        bool boxesOk = parsed.size() == ocr.lines.size() && parsed[3].hasBox && parsed[3].top == 60 &&
+                       parsed[3].bottom == 76 && parsed[3].left == 12 && parsed[3].right == 900;
+        char label[64];
+        std::snprintf(label, sizeof(label), "OCR %zu lines, %s", ocr.lines.size(), TextKindName(kind));
+        std::printf("%-38s %9.1f %11.3f %11.3f %11.3f %5d/%-4zu %5d/%-4zu\n", label, ocr.response.size() / 1024.0,
+                    legacyMs, readerMs, segmentMs, (int)ocr.lines.size() - legacyBad, ocr.lines.size(),
+                    (int)ocr.lines.size() - readerBad, ocr.lines.size());
+        ok = ok && readerBad == 0 && segmentBad == 0 && boxesOk;
+
+        OcrFixture asr = MakeAsrResponse(2000, kind);
+        std::vector<std::string> legacySentences;
+        AsrResult result;
+        double asrLegacyMs = MeasureMs([&]() { legacySentences = LegacyAsrSentences(asr.response); });
+        double asrReaderMs = MeasureMs([&]() { result = ParseAsrResponse(asr.response); });
+        int asrLegacyBad = CountMismatches(legacySentences, asr.lines);
+        int asrReaderBad = CountMismatches(result.sentences, asr.lines);
+        std::snprintf(label, sizeof(label), "ASR %zu sentences, %s", asr.lines.size(), TextKindName(kind));
+        std::printf("%-38s %9.1f %11.3f %11.3f %11s %5d/%-4zu %5d/%-4zu\n", label, asr.response.size() / 1024.0,
+                    asrLegacyMs, asrReaderMs, "-", (int)asr.lines.size() - asrLegacyBad, asr.lines.size(),
+                    (int)asr.lines.size() - asrReaderBad, asr.lines.size());
+        ok = ok && asrReaderBad == 0 && result.parsed && result.errorCode == "0";
+    }
+
+    // 任意切分位置（包括转义序列、代理对与数字中间）逐字节送入，结果与一次送入相同
+    OcrFixture small = MakeOcrResponse(1, 12, TEXT_ESCAPED);
+    std::vector<OcrLine> whole = ParseOcrLines(small.response);
+    bool splitOk = true;
+    for (size_t segment = 1; segment <= 17; ++segment) {
+        splitOk = splitOk && CountMismatches(OcrTexts(ParseOcrSegmented(small.response, segment)), OcrTexts(whole)) == 0;
+    }
+    std::printf("\nsegmented feeding (1..17 byte segments) matches whole-buffer parse: %s\n", splitOk ? "yes" : "NO");
+    ok = ok && splitOk;
+
+    std::printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
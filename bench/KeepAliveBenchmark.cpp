@@ -0,0 +1,171 @@
+#include "../include/HttpConnectionPool.h"
+#include "../include/OcrClient.h"
+#include "BenchUtil.h"
+#include "StubServer.h"
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 对比每请求新建连接与连接池复用：本地替身服务器统计实际接受的连接数（即握手次数）。
+// 本机回环上没有 TLS 与网络往返，节省的时间远小于访问真实 https 接口时
+
+struct ScenarioResult {
+    int requests;
+    int failures;
+    double totalMs;
+    long serverConnections;
+    HttpPoolStats pool;
+};
+
+static void Report(const char* name, const ScenarioResult& r) {
+    std::printf("%-28s %6d %6d %10.3f %8ld %8ld %8ld %8ld %8ld\n", name, r.requests, r.failures,
+                r.totalMs / r.requests, r.serverConnections, r.pool.connectionsOpened, r.pool.connectionsReused,
+                r.pool.staleRetries, r.pool.idleEvicted);
+}
+
+// 替身服务器回显收到的请求体字节数
+static bool CheckResponse(const OcrResult& result, const std::vector<unsigned char>& image) {
+    return result.ok && result.text == "stub " + std::to_string(BuildOcrRequestBody(image).size()) + " bytes";
+}
+
+// threads 个线程各发 perThread 个请求；pool 为空时每个请求用一次性连接
+static ScenarioResult Run(StubServer& server, HttpConnectionPool* pool, int threads, int perThread, int gapMs) {
+    HttpUrl url;
+    ParseHttpUrl(server.url("/ocrapi1"), url);
+    std::vector<unsigned char> image = RandomBytes(48 * 1024);
+    long connectionsBefore = server.connectionsAccepted();
+
+    std::atomic<int> failures(0);
+    BenchTimer timer;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&]() {
+            for (int i = 0; i < perThread; ++i) {
+                if (gapMs > 0 && i > 0) std::this_thread::sleep_for(std::chrono::milliseconds(gapMs));
+                OcrResult result;
+                if (pool) {
+                    result = CallOcrEndpoint(*pool, url, image);
+                } else {
+                    HttpResponse response;
+                    result.ok = HttpPost(url, OCR_REQUEST_HEADERS, BuildOcrRequestBody(image), 5000, response) &&
+                                response.status == 200;
+                    result.text = ParseOcrResponse(response.body);
+                }
+                if (!CheckResponse(result, image)) failures++;
+            }
+        }));
+    }
+    for (size_t i = 0; i < workers.size(); ++i) workers[i].join();
+
+    ScenarioResult r;
+    r.requests = threads * perThread;
+    r.failures = failures;
+    r.totalMs = timer.elapsedMs();
+    r.serverConnections = server.connectionsAccepted() - connectionsBefore;
+    if (pool) r.pool = pool->stats();
+    return r;
+}
+
+// 模拟热键触发预连接、用户框选 thinkMs 毫秒后发出请求
+static ScenarioResult RunPrewarmed(StubServer& server, HttpConnectionPool& pool, int rounds, int thinkMs) {
+    HttpUrl url;
+    ParseHttpUrl(server.url("/ocrapi1"), url);
+    std::vector<unsigned char> image = RandomBytes(48 * 1024);
+    long connectionsBefore = server.connectionsAccepted();
+
+    ScenarioResult r;
+    r.requests = rounds;
+    r.failures = 0;
+    r.totalMs = 0;
+    for (int i = 0; i < rounds; ++i) {
+        std::thread warm([&]() { pool.preconnect(url); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(thinkMs));
+        warm.join();
+        BenchTimer timer;
+        if (!CheckResponse(CallOcrEndpoint(pool, url, image), image)) r.failures++;
+        r.totalMs += timer.elapsedMs();
+    }
+    r.serverConnections = server.connectionsAccepted() - connectionsBefore;
+    r.pool = pool.stats();
+    return r;
+}
+
+static void ReportPrewarm(const char* name, const ScenarioResult& r) {
+    Report(name, r);
+    std::printf("%-28s prewarmed=%ld used=%ld expired=%ld\n", "", r.pool.prewarmed, r.pool.prewarmUsed,
+                r.pool.prewarmExpired);
+}
+
+int main() {
+    std::printf("%-28s %6s %6s %10s %8s %8s %8s %8s %8s\n", "scenario", "reqs", "fail", "ms/req", "srv conn",
+                "opened", "reused", "retries", "evicted");
+    bool ok = true;
+
+    StubServer server;
+    if (!server.start(0)) {
+        std::printf("cannot start stub server\n");
+        return 1;
+    }
+
+    ScenarioResult oneShot = Run(server, nullptr, 1, 500, 0);
+    Report("new connection per request", oneShot);
+    ok = ok && oneShot.failures == 0 && oneShot.serverConnections == 500;
+
+    HttpConnectionPool sequentialPool;
+    ScenarioResult sequential = Run(server, &sequentialPool, 1, 500, 0);
+    Report("pool, sequential", sequential);
+    ok = ok && sequential.failures == 0 && sequential.serverConnections == 1;
+
+    HttpConnectionPool concurrentPool;
+    ScenarioResult concurrent = Run(server, &concurrentPool, 8, 100, 0);
+    Report("pool, 8 threads", concurrent);
+    ok = ok && concurrent.failures == 0 && concurrent.serverConnections <= 8;
+
+    // 客户端空闲超时短于请求间隔：连接在借出前被丢弃
+    HttpPoolOptions shortIdle;
+    shortIdle.idleTimeoutMs = 20;
+    HttpConnectionPool evictingPool(shortIdle);
+    ScenarioResult evicted = Run(server, &evictingPool, 1, 10, 50);
+    Report("pool, client idle timeout", evicted);
+    ok = ok && evicted.failures == 0 && evicted.pool.idleEvicted >= 9;
+
+    // 预热的连接在框选结束时仍然有效，请求直接用上
+    HttpConnectionPool warmPool;
+    ScenarioResult warm = RunPrewarmed(server, warmPool, 5, 20);
+    ReportPrewarm("prewarm, used", warm);
+    ok = ok && warm.failures == 0 && warm.pool.prewarmUsed == 5 && warm.pool.connectionsReused == 5;
+
+    // 框选时间超过空闲超时（或用户取消），预热的连接过期
+    HttpPoolOptions warmIdle;
+    warmIdle.idleTimeoutMs = 20;
+    HttpConnectionPool expiringPool(warmIdle);
+    ScenarioResult expiring = RunPrewarmed(server, expiringPool, 3, 50);
+    ReportPrewarm("prewarm, expired", expiring);
+    ok = ok && expiring.failures == 0 && expiring.pool.prewarmExpired == 3 && expiring.pool.prewarmUsed == 0;
+    server.stop();
+
+    // 服务器先于客户端关闭空闲连接：借出前检测到对端关闭，换新连接
+    StubServer closingServer;
+    closingServer.setIdleCloseMs(30);
+    if (!closingServer.start(0)) return 1;
+    HttpConnectionPool stalePool;
+    ScenarioResult stale = Run(closingServer, &stalePool, 1, 10, 80);
+    Report("pool, server idle close", stale);
+    ok = ok && stale.failures == 0 && stale.serverConnections == 10;
+    closingServer.stop();
+
+    // 服务器在借出之后才断开连接：请求没有得到任何响应字节，用新连接重发
+    StubServer droppingServer;
+    droppingServer.setMaxRequestsPerConnection(4);
+    if (!droppingServer.start(0)) return 1;
+    HttpConnectionPool retryPool;
+    ScenarioResult retried = Run(droppingServer, &retryPool, 1, 20, 0);
+    Report("pool, server drops request", retried);
+    ok = ok && retried.failures == 0 && retried.pool.staleRetries == 4;
+    droppingServer.stop();
+
+    std::printf("%s\n", ok ? "all scenarios passed" : "FAILED");
+    return ok ? 0 : 1;
+}
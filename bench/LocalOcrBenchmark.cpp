@@ -0,0 +1,293 @@
+// 本地快速识别的准确率与延迟：用 FreeType 渲染常见短文本（工单号、错误码、IP、哈希等），
+// 统计本地采用率、采用结果的准确率和延迟；多行、非拉丁文字、照片、低对比度等样本必须交给远程识别
+#include "BenchUtil.h"
+#include "FreeTypeText.h"
+#include "../include/LocalOcr.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* const FONT_DIR = "/usr/share/fonts/truetype/dejavu/";
+
+struct FontSpec {
+    const char* file;
+    const char* name;
+    bool templated;     // 是否加入模板（未加入的用于检验没见过的字体不会被误采用）
+};
+
+const FontSpec FONTS[] = {
+    {"DejaVuSans.ttf", "DejaVu Sans", true},
+    {"DejaVuSansMono.ttf", "DejaVu Sans Mono", true},
+    {"DejaVuSerif.ttf", "DejaVu Serif", true},
+    {"DejaVuSans-Bold.ttf", "DejaVu Sans Bold", false},
+};
+
+struct Sample {
+    CorpusImage image;
+    std::string text;       // 为空表示必须交给远程识别
+    std::string category;
+    std::string detail;     // 字体、像素大小、配色，出错时打印
+};
+
+std::string randomChars(std::mt19937& rng, const char* alphabet, int count) {
+    std::string out;
+    size_t size = std::string(alphabet).size();
+    for (int i = 0; i < count; ++i) out += alphabet[rng() % size];
+    return out;
+}
+
+std::string randomText(std::mt19937& rng) {
+    const char* hex = "0123456789abcdef";
+    const char* digits = "0123456789";
+    const char* upper = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    char buffer[96];
+    switch (rng() % 9) {
+    case 0: {
+        const char* projects[] = {"JIRA", "OPS", "INFRA", "WEB", "PAY"};
+        return std::string(projects[rng() % 5]) + "-" + randomChars(rng, digits, 3 + rng() % 3);
+    }
+    case 1:
+        return "INC" + randomChars(rng, digits, 7);
+    case 2:
+        return "0x" + randomChars(rng, "0123456789ABCDEF", 8);
+    case 3: {
+        const char* codes[] = {"E_ACCESSDENIED", "ERR_CONNECTION_RESET", "HTTP 404", "HTTP 503", "ENOENT",
+                               "SIGSEGV", "Error 0x80004005", "errno=110", "Build failed", "Connection timed out",
+                               "Access denied", "Order #58213"};
+        return codes[rng() % 12];
+    }
+    case 4:
+        std::snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", (unsigned)(rng() % 256), (unsigned)(rng() % 256),
+                      (unsigned)(rng() % 256), (unsigned)(rng() % 256));
+        return buffer;
+    case 5:
+        return "fe80::" + randomChars(rng, hex, 4) + ":" + randomChars(rng, hex, 4) + ":" + randomChars(rng, hex, 4);
+    case 6:
+        return randomChars(rng, hex, 7 + rng() % 10);
+    case 7:
+        return randomChars(rng, hex, 8) + "-" + randomChars(rng, hex, 4) + "-" + randomChars(rng, hex, 4) + "-" +
+               randomChars(rng, hex, 4) + "-" + randomChars(rng, hex, 12);
+    default:
+        return randomChars(rng, upper, 2) + randomChars(rng, digits, 6);
+    }
+}
+
+struct Colors {
+    unsigned char fg[3];
+    unsigned char bg[3];
+};
+
+const Colors COLORS[] = {
+    {{0, 0, 0}, {255, 255, 255}},
+    {{30, 30, 30}, {240, 240, 240}},
+    {{212, 212, 212}, {30, 30, 30}},
+    {{255, 255, 255}, {0, 120, 215}},
+    {{0, 0, 238}, {255, 255, 255}},
+    {{206, 145, 120}, {30, 30, 30}},
+};
+
+Sample renderLine(const FreeTypeFace& face, const std::string& text, int pixelSize, const Colors& colors,
+                  std::mt19937& rng) {
+    std::u32string codes = DecodeUtf8(text);
+    int pad = 3 + rng() % 6;
+    int width = face.measure(codes) + pad * 2 + 2;
+    int height = face.ascender() + face.descender() + pad * 2;
+    Sample sample;
+    sample.image = MakeBlankImage("line", width, height, colors.bg[0], colors.bg[1], colors.bg[2]);
+    face.draw(sample.image, codes, pad, pad + face.ascender(), colors.fg, colors.bg);
+    sample.text = text;
+    (void)pixelSize;
+    return sample;
+}
+
+PixelBufferView viewOf(const CorpusImage& image) {
+    PixelBufferView view;
+    view.pixels = image.bgra.data();
+    view.width = image.width;
+    view.height = image.height;
+    view.stride = image.stride();
+    return view;
+}
+
+struct Stats {
+    int samples;
+    int accepted;
+    int correct;
+    Stats() : samples(0), accepted(0), correct(0) {}
+};
+
+} // namespace
+
+int main() {
+    std::vector<FreeTypeFace*> faces;
+    bool loaded = true;
+    for (const FontSpec& spec : FONTS) {
+        faces.push_back(new FreeTypeFace());
+        loaded = loaded && faces.back()->load(std::string(FONT_DIR) + spec.file);
+    }
+    if (!loaded) {
+        std::printf("DejaVu fonts not found in %s, skipped\n", FONT_DIR);
+        for (FreeTypeFace* face : faces) delete face;
+        return 0;
+    }
+
+    // 模板：每种字体渲染几个像素大小，识别时按大写字母高度归一化
+    LocalOcr ocr;
+    const int templateSizes[] = {11, 12, 13, 14, 15, 16, 17, 18, 20, 22, 24};
+    for (size_t f = 0; f < faces.size(); ++f) {
+        if (!FONTS[f].templated) continue;
+        for (int size : templateSizes) {
+            faces[f]->setPixelSize(size);
+            ocr.addFont(faces[f]->makeGlyphFont(FONTS[f].name));
+        }
+    }
+
+    std::mt19937 rng(2024);
+    std::vector<Sample> samples;
+    for (int i = 0; i < 1200; ++i) {
+        size_t f = rng() % (sizeof(FONTS) / sizeof(FONTS[0]));
+        int size = 11 + rng() % 14;
+        faces[f]->setPixelSize(size);
+        int colors = rng() % 6;
+        Sample sample = renderLine(*faces[f], randomText(rng), size, COLORS[colors], rng);
+        sample.category = FONTS[f].templated ? "templated fonts" : "unseen bold font";
+        sample.detail = std::string(FONTS[f].name) + " " + std::to_string(size) + "px colors " + std::to_string(colors);
+        samples.push_back(sample);
+    }
+
+    // 必须拒绝的样本
+    const char* cyrillic[] = {"Ошибка сети", "Загрузка файла", "Подождите", "Журнал событий"};
+    for (int i = 0; i < 200; ++i) {
+        size_t f = rng() % 3;
+        int size = 11 + rng() % 14;
+        faces[f]->setPixelSize(size);
+        const Colors& colors = COLORS[rng() % 6];
+        Sample sample;
+        switch (i % 5) {
+        case 0: {
+            // 两行文字
+            Sample first = renderLine(*faces[f], randomText(rng), size, colors, rng);
+            int lineHeight = faces[f]->ascender() + faces[f]->descender() + 2;
+            sample.image = MakeBlankImage("two-lines", first.image.width + 40, first.image.height + lineHeight,
+                                          colors.bg[0], colors.bg[1], colors.bg[2]);
+            faces[f]->draw(sample.image, DecodeUtf8(first.text), 5, 5 + faces[f]->ascender(), colors.fg, colors.bg);
+            faces[f]->draw(sample.image, DecodeUtf8(randomText(rng)), 5, 5 + faces[f]->ascender() + lineHeight,
+                           colors.fg, colors.bg);
+            sample.category = "two lines";
+            break;
+        }
+        case 1:
+            sample = renderLine(*faces[f], cyrillic[rng() % 4], size, colors, rng);
+            sample.category = "cyrillic";
+            break;
+        case 2: {
+            CorpusImage photo = MakePhotoImage(640, 360);
+            int w = 60 + rng() % 200, h = 14 + rng() % 30;
+            int x0 = rng() % (640 - w), y0 = rng() % (360 - h);
+            sample.image = MakeBlankImage("photo", w, h, 0, 0, 0);
+            for (int y = 0; y < h; ++y) {
+                std::copy(&photo.bgra[((size_t)(y0 + y) * 640 + x0) * 4], &photo.bgra[((size_t)(y0 + y) * 640 + x0 + w) * 4],
+                          &sample.image.bgra[(size_t)y * w * 4]);
+            }
+            sample.category = "photo";
+            break;
+        }
+        case 3: {
+            // 图标：几个实心方块与圆
+            sample.image = MakeBlankImage("icons", 120, 32, colors.bg[0], colors.bg[1], colors.bg[2]);
+            for (int k = 0; k < 4; ++k) {
+                int x = 6 + k * 28, s = 8 + rng() % 12;
+                if (k % 2) {
+                    FillRect(sample.image, x, 6, s, s, colors.fg[0], colors.fg[1], colors.fg[2]);
+                } else {
+                    for (int y = 0; y < s; ++y)
+                        for (int dx = 0; dx < s; ++dx)
+                            if ((2 * dx - s) * (2 * dx - s) + (2 * y - s) * (2 * y - s) <= s * s)
+                                FillRect(sample.image, x + dx, 6 + y, 1, 1, colors.fg[0], colors.fg[1], colors.fg[2]);
+                }
+            }
+            sample.category = "icons";
+            break;
+        }
+        default: {
+            Colors faint = {{200, 200, 200}, {230, 230, 230}};
+            sample = renderLine(*faces[f], randomText(rng), size, faint, rng);
+            sample.category = "low contrast";
+            break;
+        }
+        }
+        sample.text.clear();
+        samples.push_back(sample);
+    }
+
+    std::vector<std::string> categories;
+    std::vector<Stats> stats;
+    std::vector<double> latencies;
+    std::vector<std::string> reasons;
+    std::vector<int> reasonCounts;
+    int shown = 0;
+    for (const Sample& sample : samples) {
+        PixelBufferView view = viewOf(sample.image);
+        LocalOcrResult result;
+        BenchTimer timer;
+        bool accepted = ocr.recognize(view, result);
+        latencies.push_back(timer.elapsedMs());
+
+        size_t c = std::find(categories.begin(), categories.end(), sample.category) - categories.begin();
+        if (c == categories.size()) {
+            categories.push_back(sample.category);
+            stats.push_back(Stats());
+        }
+        stats[c].samples++;
+        if (accepted) {
+            stats[c].accepted++;
+            if (result.text == sample.text) stats[c].correct++;
+            else if (shown++ < 10) {
+                std::printf("  wrong: \"%s\" read as \"%s\" (%s; %s)\n", sample.text.c_str(), result.text.c_str(),
+                            sample.detail.c_str(), DescribeLocalOcrResult(result).c_str());
+            }
+        } else if (!sample.text.empty()) {
+            // 交给远程识别的原因
+            std::string reason = result.reason ? result.reason : "?";
+            size_t r = std::find(reasons.begin(), reasons.end(), reason) - reasons.begin();
+            if (r == reasons.size()) {
+                reasons.push_back(reason);
+                reasonCounts.push_back(0);
+            }
+            reasonCounts[r]++;
+        }
+    }
+
+    bool ok = true;
+    std::printf("%-18s %8s %9s %9s %10s\n", "category", "samples", "accepted", "correct", "accuracy");
+    for (size_t c = 0; c < categories.size(); ++c) {
+        const Stats& s = stats[c];
+        double accuracy = s.accepted ? 100.0 * s.correct / s.accepted : 100.0;
+        std::printf("%-18s %8d %9d %9d %9.1f%%\n", categories[c].c_str(), s.samples, s.accepted, s.correct, accuracy);
+        if (categories[c] == "templated fonts") {
+            ok = ok && accuracy >= 99.0 && s.accepted * 2 >= s.samples;
+        } else if (categories[c] == "unseen bold font") {
+            ok = ok && accuracy >= 99.0;
+        } else {
+            ok = ok && s.accepted == 0;
+        }
+    }
+
+    std::printf("text samples sent to remote OCR:");
+    for (size_t r = 0; r < reasons.size(); ++r) std::printf(" %s %d;", reasons[r].c_str(), reasonCounts[r]);
+    std::printf("\n");
+
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0;
+    for (double ms : latencies) total += ms;
+    std::printf("latency per capture: mean %.2f ms, p95 %.2f ms, max %.2f ms\n", total / latencies.size(),
+                latencies[latencies.size() * 95 / 100], latencies.back());
+
+    for (FreeTypeFace* face : faces) delete face;
+    std::printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,277 @@
+#include "../include/StreamingAsr.h"
+#include "../include/Executor.h"
+#include "BenchUtil.h"
+#include "SpeechCorpus.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 不限时长的听写：按实时速率把十分钟的录音送入 StreamingAsr，段识别由模拟的识别服务完成
+// （不走网络：按段的音频时长等待，再按段在录音中的位置给出文字），报告
+// 1. 结束录音到拿到文字的等待时间与最长一段的识别耗时、各段依次识别的总耗时之比；
+// 2. 同时识别的段数不超过上限，内存中的录音不随录音时长增长；服务慢于实时时排队的段写入临时文件；
+// 3. 文字完整且不重复：模拟的服务把每 250 ms 的语音识别为一个双字词，只识别完整落在段内的词，
+//    强制切开处重叠部分的词在两段中都出现，拼接后应恰好各出现一次。
+// 录音与识别都按 SPEEDUP 倍加速，报告中的毫秒数已换算回实际时间
+
+static const int SPEEDUP = 60;
+static const int SERVER_FIXED_MS = 300;
+static const size_t WORD_BYTES = SPEECH_BYTES_PER_SECOND / 4;
+static const char* TEMP_PATH = "long-dictation-spill.pcm";
+
+struct Word {
+    long long begin;
+    long long end;
+    std::string text;
+};
+
+// 两个互不相同的汉字（U+4E00 起）
+static std::string WordText(size_t index) {
+    std::string text;
+    for (unsigned code = 0x4E00 + (unsigned)index * 2; code < 0x4E00 + (unsigned)index * 2 + 2; ++code) {
+        text += (char)(0xE0 | (code >> 12));
+        text += (char)(0x80 | ((code >> 6) & 0x3F));
+        text += (char)(0x80 | (code & 0x3F));
+    }
+    return text;
+}
+
+static std::vector<Word> MakeWords(const SpeechClip& clip) {
+    std::vector<Word> words;
+    for (size_t i = 0; i < clip.speech.size(); ++i) {
+        for (long long at = clip.speech[i].first; at + (long long)WORD_BYTES <= clip.speech[i].second;
+             at += WORD_BYTES) {
+            Word word = {at, at + (long long)WORD_BYTES, WordText(words.size())};
+            words.push_back(word);
+        }
+    }
+    return words;
+}
+
+// 模拟的识别服务：耗时为固定部分加音频时长 / audioSpeed，可取消
+class FakeRecognizer {
+public:
+    FakeRecognizer(const SpeechClip& clip, const std::vector<Word>& words, double audioSpeed)
+        : clip(clip), words(words), audioSpeed(audioSpeed), active(0), maxActive(0), longestMs(0), totalMs(0) {}
+
+    bool recognize(const std::vector<char>& pcm, RequestCancel& cancel, std::string& text) {
+        int now = ++active;
+        int previous = maxActive.load();
+        while (now > previous && !maxActive.compare_exchange_weak(previous, now)) {
+        }
+        BenchTimer timer;
+        double audioMs = pcm.size() * 1000.0 / SPEECH_BYTES_PER_SECOND;
+        double serviceMs = SERVER_FIXED_MS + audioMs / audioSpeed;
+        std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() +
+            std::chrono::microseconds((long long)(serviceMs * 1000 / SPEEDUP));
+        bool ok = true;
+        while (std::chrono::steady_clock::now() < until && ok) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            ok = !cancel.cancelled();
+        }
+        // 上传的是去掉首尾静音的一段，按内容找出它在录音中的位置
+        std::vector<char>::const_iterator found = std::search(clip.pcm.begin(), clip.pcm.end(), pcm.begin(),
+                                                              pcm.begin() + (std::min)(pcm.size(), (size_t)256));
+        ok = ok && found != clip.pcm.end();
+        if (ok) {
+            long long begin = (long long)(found - clip.pcm.begin());
+            long long end = begin + (long long)pcm.size();
+            for (size_t i = 0; i < words.size(); ++i) {
+                if (words[i].begin >= begin && words[i].end <= end) text += words[i].text;
+            }
+            // 服务在每段结尾补上句号
+            if (!text.empty()) text += "\xE3\x80\x82";
+        }
+        double ms = timer.elapsedMs() * SPEEDUP;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            longestMs = (std::max)(longestMs, ms);
+            totalMs += ms;
+        }
+        --active;
+        return ok;
+    }
+
+    int maxConcurrent() const { return maxActive; }
+    double longestSegmentMs() const { return longestMs; }
+    double serialMs() const { return totalMs; }
+
+private:
+    const SpeechClip& clip;
+    const std::vector<Word>& words;
+    double audioSpeed;
+    std::atomic<int> active;
+    std::atomic<int> maxActive;
+    std::mutex mutex;
+    double longestMs;
+    double totalMs;
+};
+
+// 去掉段间的空格与句号后应恰好是所有词按顺序连接
+static std::string StripSeparators(const std::string& text) {
+    std::string stripped;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == ' ') continue;
+        if (text.compare(i, 3, "\xE3\x80\x82") == 0) {
+            i += 2;
+            continue;
+        }
+        stripped += text[i];
+    }
+    return stripped;
+}
+
+struct Scenario {
+    const char* name;
+    double audioSpeed;          // 识别速度为音频时长的倍数，低于 1 / lanes 时排队越来越长
+    int lanes;
+    bool spill;
+    bool checkLatency;
+};
+
+static bool RunScenario(const Scenario& scenario, const SpeechClip& clip, const std::vector<Word>& words) {
+    FakeRecognizer service(clip, words, scenario.audioSpeed);
+    StreamingAsrOptions options;
+    options.maxConcurrentSegments = scenario.lanes;
+    if (scenario.spill) options.spillPath = TEMP_PATH;
+    StreamingAsr streaming([&service](const std::shared_ptr<std::vector<char> >& pcm, RequestCancel& cancel,
+                                      std::string& text) {
+        return service.recognize(*pcm, cancel, text);
+    }, &SharedExecutor().io(), options);
+
+    const size_t chunk = 4096;
+    std::chrono::nanoseconds period((long long)chunk * 1000000000LL / SPEECH_BYTES_PER_SECOND / SPEEDUP);
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+    for (size_t offset = 0; offset < clip.pcm.size(); offset += chunk) {
+        next += period;
+        std::this_thread::sleep_until(next);
+        streaming.feed(clip.pcm.data() + offset, (std::min)(chunk, clip.pcm.size() - offset));
+    }
+    StreamingAsrResult result = streaming.finish(120000);
+    double finishMs = result.finishMs * SPEEDUP;
+
+    std::string expected;
+    for (size_t i = 0; i < words.size(); ++i) expected += words[i].text;
+    bool textOk = result.ok && StripSeparators(result.text) == expected;
+
+    size_t maxSegmentBytes = (size_t)SPEECH_BYTES_PER_SECOND * options.segmenter.maxSegmentMs / 1000;
+    size_t memoryBound = (size_t)(scenario.lanes + 2) * maxSegmentBytes;
+    // 排队的段留在内存中时（没有临时文件）内存随积压增长，只报告
+    bool memoryOk = !scenario.spill || result.peakBufferedBytes <= memoryBound;
+    bool parallelOk = service.maxConcurrent() <= scenario.lanes && (int)result.maxConcurrent <= scenario.lanes;
+    bool spillOk = !scenario.spill || scenario.checkLatency || result.spilledBytes > 0;
+    bool latencyOk = !scenario.checkLatency ||
+                     (finishMs <= service.longestSegmentMs() * 1.5 + 1000 && finishMs * 4 < service.serialMs());
+
+    std::printf("%-26s %8lu %6lu %7lu %5d %10.0f %10.0f %10.0f %9.0f %9.0f %6s\n", scenario.name,
+                (unsigned long)result.segments, (unsigned long)result.forcedCuts, (unsigned long)result.dedupedChars,
+                service.maxConcurrent(), finishMs, service.longestSegmentMs(), service.serialMs(),
+                result.peakBufferedBytes / 1024.0, result.spilledBytes / 1024.0, textOk ? "ok" : "BAD");
+    bool ok = textOk && memoryOk && parallelOk && spillOk && latencyOk;
+    if (!ok) {
+        std::printf("  FAILED: text=%d memory=%d (bound %lu KB) parallel=%d spill=%d latency=%d\n  %s\n", textOk,
+                    memoryOk, (unsigned long)(memoryBound / 1024), parallelOk, spillOk, latencyOk,
+                    DescribeStreamingAsr(result).c_str());
+    }
+    return ok;
+}
+
+// 交界去重的几种情形
+static bool CheckMerge() {
+    struct Case {
+        const char* previous;
+        const char* next;
+        const char* expected;
+    };
+    const Case cases[] = {
+        // 重叠的词，前一段结尾补了句号
+        {"\xE4\xBB\x8A\xE5\xA4\xA9\xE7\x9A\x84\xE4\xBC\x9A\xE8\xAE\xAE\xE3\x80\x82",
+         "\xE7\x9A\x84\xE4\xBC\x9A\xE8\xAE\xAE\xE5\xBC\x80\xE5\xA7\x8B",
+         "\xE4\xBB\x8A\xE5\xA4\xA9\xE7\x9A\x84\xE4\xBC\x9A\xE8\xAE\xAE\xE5\xBC\x80\xE5\xA7\x8B"},
+        // 没有重叠：中文之间不加空格
+        {"\xE4\xBB\x8A\xE5\xA4\xA9\xE3\x80\x82", "\xE5\xBC\x80\xE5\xA7\x8B",
+         "\xE4\xBB\x8A\xE5\xA4\xA9\xE3\x80\x82\xE5\xBC\x80\xE5\xA7\x8B"},
+        // 只重复一个字时不去掉
+        {"\xE4\xBB\x8A\xE5\xA4\xA9", "\xE5\xA4\xA9\xE6\xB0\x94", "\xE4\xBB\x8A\xE5\xA4\xA9\xE5\xA4\xA9\xE6\xB0\x94"},
+        {"we will meet on", "meet on Monday.", "we will meet on Monday."},
+        {"Thanks.", "See you", "Thanks. See you"},
+        {"", "next", "next"},
+    };
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        std::string merged = MergeOverlappingText(cases[i].previous, cases[i].next, 12);
+        if (merged != cases[i].expected) {
+            std::printf("merge case %lu: got \"%s\"\n", (unsigned long)i, merged.c_str());
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// 取消录音：销毁时排队的段不再启动，被取消的段也不会接着识别队列中的下一段
+static bool CheckDestroyStopsQueue(const SpeechClip& clip) {
+    std::atomic<int> started(0);
+    std::atomic<int> finished(0);
+    BenchTimer timer;
+    {
+        StreamingAsrOptions options;
+        options.maxConcurrentSegments = 1;
+        StreamingAsr streaming([&started, &finished](const std::shared_ptr<std::vector<char> >&, RequestCancel& cancel,
+                                                     std::string&) {
+            ++started;
+            BenchTimer wait;
+            while (!cancel.cancelled() && wait.elapsedMs() < 2000) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            ++finished;
+            return !cancel.cancelled();
+        }, &SharedExecutor().io(), options);
+        const size_t chunk = 4096;
+        for (size_t offset = 0; offset < clip.pcm.size() / 4; offset += chunk) {
+            streaming.feed(clip.pcm.data() + offset, (std::min)(chunk, clip.pcm.size() / 4 - offset));
+        }
+        timer = BenchTimer();
+    }
+    double destroyMs = timer.elapsedMs();
+    int startedAtExit = started;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    bool ok = startedAtExit == 1 && started == startedAtExit && finished == started && destroyMs < 1000;
+    std::printf("destroy while queued: %d segment(s) started, destroyed in %.0f ms %s\n", startedAtExit, destroyMs,
+                ok ? "ok" : "BAD");
+    return ok;
+}
+
+int main() {
+    bool ok = CheckMerge();
+    std::printf("boundary merge: %s\n\n", ok ? "ok" : "BAD");
+
+    // 大段连续说话（停顿少），既有停顿处的切点也有强制切点
+    SpeechClipOptions meeting(600, 41);
+    meeting.pauseProbability = 0.4;
+    SpeechClip clip = MakeSpeechClip("meeting notes 10 min", meeting);
+    std::vector<Word> words = MakeWords(clip);
+    std::printf("%s: %.0f s of audio, %lu words, %.0f KB of PCM\n\n", clip.name.c_str(),
+                (double)clip.pcm.size() / SPEECH_BYTES_PER_SECOND, (unsigned long)words.size(),
+                clip.pcm.size() / 1024.0);
+
+    ok = CheckDestroyStopsQueue(clip) && ok;
+    std::printf("\n");
+
+    const Scenario scenarios[] = {
+        {"3 parallel, 8x realtime", 8, 3, true, true},
+        {"2 parallel, 0.4x (spill)", 0.4, 2, true, false},
+        {"2 parallel, 0.4x (memory)", 0.4, 2, false, false},
+    };
+    std::printf("%-26s %8s %6s %7s %5s %10s %10s %10s %9s %9s %6s\n", "scenario", "segments", "forced", "deduped",
+                "par", "finish ms", "longest ms", "serial ms", "peak KB", "spill KB", "text");
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); ++i) {
+        ok = RunScenario(scenarios[i], clip, words) && ok;
+    }
+
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
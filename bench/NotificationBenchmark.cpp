@@ -0,0 +1,161 @@
+#include "../include/NotificationQueue.h"
+#include "BenchUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 提示队列：用无界面的显示端与模拟时钟重放应用中的提示序列，与原来“每条提示一个窗口和线程”对比。
+// 1. 录音 → 识别 → 成功的快速状态序列：同时存在的窗口数、最终显示的消息；
+// 2. 重复消息连发（例如连续识别失败）：合并为一次显示；
+// 3. 间隔较远的消息：到达即显示，不因合并而延迟；
+// 4. 多线程 post 的开销与唤醒界面线程的次数
+
+typedef std::chrono::milliseconds Ms;
+
+struct Post {
+    int atMs;
+    const char* text;
+    int durationMs;
+};
+
+struct Replay {
+    std::vector<HeadlessNotificationSink::Event> events;
+    NotificationStats stats;
+    int legacyMaxWindows;   // 原实现：每条提示一个窗口，显示期间同时存在的最大窗口数
+    int legacyThreads;
+    int endMs;              // 最后一条消息隐藏的时刻
+};
+
+// 按时间推进模拟时钟：每个 post 之后、每个 pump 返回的时刻都调用 pump
+static Replay Run(const std::vector<Post>& posts) {
+    Replay replay;
+    HeadlessNotificationSink sink;
+    NotificationQueue queue(sink);
+    NotificationTime start = NotificationTime() + std::chrono::hours(1);
+    NotificationTime next = NotificationTime::max();
+    size_t index = 0;
+    replay.endMs = 0;
+    while (index < posts.size() || next != NotificationTime::max()) {
+        NotificationTime postAt = index < posts.size() ? start + Ms(posts[index].atMs) : NotificationTime::max();
+        if (postAt <= next) {
+            queue.post(posts[index].text, posts[index].durationMs, postAt);
+            index++;
+            next = queue.pump(postAt);
+        } else {
+            NotificationTime now = next;
+            next = queue.pump(now);
+            if (!queue.visible()) replay.endMs = (int)std::chrono::duration_cast<Ms>(now - start).count();
+        }
+    }
+    replay.events = sink.events();
+    replay.stats = queue.stats();
+
+    replay.legacyThreads = (int)posts.size();
+    replay.legacyMaxWindows = 0;
+    for (size_t i = 0; i < posts.size(); ++i) {
+        int open = 0;
+        for (size_t j = 0; j < posts.size(); ++j) {
+            if (posts[j].atMs <= posts[i].atMs && posts[j].atMs + posts[j].durationMs > posts[i].atMs) open++;
+        }
+        replay.legacyMaxWindows = (std::max)(replay.legacyMaxWindows, open);
+    }
+    return replay;
+}
+
+static int CountShows(const Replay& replay) {
+    int shows = 0;
+    for (size_t i = 0; i < replay.events.size(); ++i) shows += replay.events[i].shown ? 1 : 0;
+    return shows;
+}
+
+static void Report(const char* name, const Replay& r) {
+    std::printf("%-22s %6lu %9d %8d %7d %6ld %10ld %10ld %9.0f %7d\n", name, (unsigned long)r.stats.posted,
+                r.legacyMaxWindows, r.legacyThreads, CountShows(r), r.stats.shown, r.stats.coalesced,
+                r.stats.superseded, r.stats.delayMaxMs, r.endMs);
+}
+
+int main() {
+    bool ok = true;
+    std::printf("%-22s %6s %9s %8s %7s %6s %10s %10s %9s %7s\n", "scenario", "posts", "legacy wn", "legacy th",
+                "shows", "shown", "coalesced", "superseded", "delay ms", "end ms");
+
+    // 1. 语音识别的状态序列：开始录音后 1.5 s 结束，识别 300 ms 后成功
+    std::vector<Post> voice;
+    voice.push_back({0, "开始录音...", 2000});
+    voice.push_back({1500, "正在识别...", 2000});
+    voice.push_back({1800, "识别成功！已复制到剪贴板", 2000});
+    Replay voiceReplay = Run(voice);
+    Report("record -> recognize", voiceReplay);
+    // 窗口只有一个；“正在识别”至少显示 minVisibleMs，随后由最终结果替换
+    const std::vector<HeadlessNotificationSink::Event>& ve = voiceReplay.events;
+    ok = ok && ve.size() == 4 && ve.back().shown == false && ve[ve.size() - 2].text == voice[2].text;
+    ok = ok && voiceReplay.endMs == 1500 + 700 + 2000;
+
+    // 快速连按：截图识别秒回时“正在识别”被最终结果直接取代
+    std::vector<Post> burst;
+    burst.push_back({0, "开始录音...", 2000});
+    burst.push_back({100, "正在识别...", 2000});
+    burst.push_back({150, "识别成功！已复制到剪贴板", 2000});
+    Replay burstReplay = Run(burst);
+    Report("fast status burst", burstReplay);
+    ok = ok && burstReplay.stats.superseded == 1 && CountShows(burstReplay) == 2;
+
+    // 2. 连续 50 次相同的失败提示
+    std::vector<Post> repeats;
+    for (int i = 0; i < 50; ++i) repeats.push_back({i * 40, "识别失败，未检测到文字", 2000});
+    Replay repeatReplay = Run(repeats);
+    Report("50 identical failures", repeatReplay);
+    ok = ok && CountShows(repeatReplay) == 1 && repeatReplay.stats.coalesced == 49;
+    // 合并后显示时间从最后一条算起
+    ok = ok && repeatReplay.endMs == 49 * 40 + 2000;
+
+    // 3. 间隔 3 s 的消息
+    std::vector<Post> spaced;
+    for (int i = 0; i < 5; ++i) spaced.push_back({i * 3000, i % 2 ? "识别成功！已复制到剪贴板" : "已取消识别", 2000});
+    Replay spacedReplay = Run(spaced);
+    Report("spaced 3 s apart", spacedReplay);
+    ok = ok && spacedReplay.stats.shown == 5 && spacedReplay.stats.delayMaxMs == 0;
+
+    // 4. 4 个线程各 post 25 万条，界面线程持续 pump
+    {
+        HeadlessNotificationSink sink;
+        NotificationQueue queue(sink);
+        std::atomic<bool> done(false);
+        std::atomic<long> pumps(0);
+        std::thread ui([&]() {
+            while (!done) {
+                queue.pump(std::chrono::steady_clock::now());
+                pumps++;
+                std::this_thread::yield();
+            }
+        });
+        const int THREADS = 4;
+        const int POSTS = 250000;
+        std::atomic<long> wakeups(0);
+        BenchTimer timer;
+        std::vector<std::thread> posters;
+        for (int t = 0; t < THREADS; ++t) {
+            posters.push_back(std::thread([&queue, &wakeups, t]() {
+                const std::string texts[] = {"正在识别...", "识别成功！已复制到剪贴板", "已复制第 1/3 段，其余识别中…"};
+                for (int i = 0; i < POSTS; ++i) {
+                    if (queue.post(texts[(i + t) % 3], 2000, std::chrono::steady_clock::now())) wakeups++;
+                }
+            }));
+        }
+        for (size_t t = 0; t < posters.size(); ++t) posters[t].join();
+        double elapsedMs = timer.elapsedMs();
+        done = true;
+        ui.join();
+        NotificationStats stats = queue.stats();
+        std::printf("\n%d threads x %d posts: %.1f ms, %.0f ns per post, %ld wakeups, %ld pumps, %lu sink calls\n%s\n",
+                    THREADS, POSTS, elapsedMs, elapsedMs * 1e6 / (THREADS * POSTS), wakeups.load(), pumps.load(),
+                    (unsigned long)sink.events().size(), DescribeNotificationStats(stats).c_str());
+        ok = ok && stats.posted == THREADS * POSTS && wakeups == stats.wakeups && stats.wakeups <= pumps + 1;
+    }
+
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,288 @@
+#include "../include/OcrCache.h"
+#include "../include/OcrClient.h"
+#include "../include/RequestCancel.h"
+#include "BenchUtil.h"
+#include "ScreenshotCorpus.h"
+#include "StubServer.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// OCR 结果缓存：键的计算开销、重复截图工作负载下的命中率与省下的请求、并发合并、LRU 上限与持久化、
+// 合并等待的取消
+
+static const int SERVER_DELAY_MS = 30;
+
+static std::vector<unsigned char> ToUpload(const CorpusImage& img) {
+    // 工作负载只关心是否发出请求，上传原始像素即可，省去编码
+    return std::vector<unsigned char>(img.bgra.begin(), img.bgra.begin() + (std::min)(img.bgra.size(), (size_t)64 * 1024));
+}
+
+struct WorkloadResult {
+    double wallMs;
+    long serverRequests;
+    int mismatches;
+    OcrCacheStats cache;
+};
+
+// threads 个线程按给定顺序取截图；cache 为空时每次都请求接口
+static WorkloadResult RunWorkload(StubServer& server, OcrCache* cache, const std::vector<CorpusImage>& images,
+                                  const std::vector<int>& order, int threads) {
+    HttpUrl url;
+    ParseHttpUrl(server.url("/ocrapi1"), url);
+    HttpConnectionPool pool;
+    std::vector<std::vector<unsigned char> > uploads;
+    for (size_t i = 0; i < images.size(); ++i) uploads.push_back(ToUpload(images[i]));
+
+    long requestsBefore = server.requestsServed();
+    std::atomic<size_t> next(0);
+    std::atomic<int> mismatches(0);
+    BenchTimer timer;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&]() {
+            for (;;) {
+                size_t i = next++;
+                if (i >= order.size()) return;
+                const CorpusImage& img = images[order[i]];
+                const std::vector<unsigned char>& upload = uploads[order[i]];
+                std::string expected = "stub " + std::to_string(BuildOcrRequestBody(upload).size()) + " bytes";
+
+                std::string text;
+                OcrCache::Compute compute = [&](std::string& result, size_t& requestBytes) {
+                    OcrResult ocr = CallOcrEndpoint(pool, url, upload);
+                    result = ocr.text;
+                    requestBytes = ocr.requestBytes;
+                    return ocr.ok;
+                };
+                bool ok;
+                if (cache) {
+                    OcrCacheKey key = MakeOcrCacheKey(img.bgra.data(), img.width, img.height, img.stride(), false);
+                    ok = cache->getOrCompute(key, compute, text);
+                } else {
+                    size_t requestBytes;
+                    ok = compute(text, requestBytes);
+                }
+                if (!ok || text != expected) mismatches++;
+            }
+        }));
+    }
+    for (size_t t = 0; t < workers.size(); ++t) workers[t].join();
+
+    WorkloadResult r;
+    r.wallMs = timer.elapsedMs();
+    r.serverRequests = server.requestsServed() - requestsBefore;
+    r.mismatches = mismatches;
+    if (cache) r.cache = cache->stats();
+    return r;
+}
+
+static void ReportWorkload(const char* name, const WorkloadResult& r, size_t lookups) {
+    std::printf("%-30s %8zu %9ld %10.1f %9.1f%% %9ld %10.1f\n", name, lookups, r.serverRequests, r.wallMs,
+                r.cache.hitRate() * 100.0, r.cache.coalesced, r.cache.bytesSaved / 1024.0);
+}
+
+// 在一行文字末尾改动几个像素（如光标闪烁）
+static CorpusImage Touched(const CorpusImage& img) {
+    CorpusImage copy = img;
+    FillRect(copy, img.width / 2, img.height / 3, 2, 14, 0, 0, 0);
+    return copy;
+}
+
+int main() {
+    bool ok = true;
+
+    // 1. 键的计算开销
+    std::printf("%-24s %10s %12s %12s\n", "key", "pixels", "exact ms", "dhash ms");
+    std::vector<CorpusImage> sizes;
+    sizes.push_back(MakeDialogImage(640, 480));
+    sizes.push_back(MakeCodeEditorImage(1920, 1080));
+    sizes.push_back(MakeLightTextImage(3840, 2160));
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        const CorpusImage& img = sizes[i];
+        double exactMs = MeasureMs([&]() { MakeOcrCacheKey(img.bgra.data(), img.width, img.height, img.stride(), false); });
+        double withDhashMs = MeasureMs([&]() { MakeOcrCacheKey(img.bgra.data(), img.width, img.height, img.stride(), true); });
+        char label[32];
+        std::snprintf(label, sizeof(label), "%dx%d", img.width, img.height);
+        std::printf("%-24s %10d %12.3f %12.3f  (%.1f GB/s)\n", label, img.width * img.height, exactMs,
+                    withDhashMs - exactMs, img.bgra.size() / (exactMs / 1000.0) / 1e9);
+    }
+
+    // 2. 重复截图工作负载：20 张不同截图，400 次请求按 Zipf 式分布重复，8 线程
+    std::vector<CorpusImage> images;
+    for (int i = 0; i < 20; ++i) {
+        CorpusImage img = MakeDialogImage(480 + i * 8, 320);
+        images.push_back(img);
+    }
+    std::vector<int> order;
+    std::mt19937 rng(7);
+    for (int i = 0; i < 400; ++i) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        order.push_back((int)(images.size() * u * u * u) % (int)images.size());
+    }
+
+    StubServer server;
+    if (!server.start(0, SERVER_DELAY_MS)) {
+        std::printf("cannot start stub server\n");
+        return 1;
+    }
+    std::printf("\n%-30s %8s %9s %10s %10s %9s %10s\n", "workload", "lookups", "requests", "wall ms", "hit rate",
+                "coalesced", "saved KB");
+    WorkloadResult uncached = RunWorkload(server, nullptr, images, order, 8);
+    ReportWorkload("no cache", uncached, order.size());
+    ok = ok && uncached.mismatches == 0 && uncached.serverRequests == (long)order.size();
+
+    OcrCache cache;
+    WorkloadResult cached = RunWorkload(server, &cache, images, order, 8);
+    ReportWorkload("cache + single-flight", cached, order.size());
+    // 每张不同的截图只请求一次：并发的首次请求也被合并
+    long distinct = 0;
+    std::vector<bool> seen(images.size(), false);
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (!seen[order[i]]) distinct++;
+        seen[order[i]] = true;
+    }
+    ok = ok && cached.mismatches == 0 && cached.serverRequests == distinct &&
+         cached.cache.hits + cached.cache.coalesced + cached.cache.misses == (long)order.size();
+
+    // 同一张截图 8 个线程同时请求：只发一次
+    std::vector<int> burst(8, 0);
+    OcrCache burstCache;
+    WorkloadResult coalesced = RunWorkload(server, &burstCache, images, burst, 8);
+    ReportWorkload("8 identical concurrent", coalesced, burst.size());
+    ok = ok && coalesced.mismatches == 0 && coalesced.serverRequests == 1;
+    server.stop();
+
+    // 3. LRU 字节上限
+    OcrCacheOptions small;
+    small.maxBytes = 10 * 1024;
+    OcrCache bounded(small);
+    std::string text(900, 'x');
+    for (int i = 0; i < 100; ++i) {
+        OcrCacheKey key;
+        key.hash = (uint64_t)i;
+        bounded.insert(key, text, 4096);
+    }
+    OcrCacheKey newest;
+    newest.hash = 99;
+    OcrCacheKey oldest;
+    oldest.hash = 0;
+    std::string found;
+    OcrCacheStats boundedStats = bounded.stats();
+    bool boundOk = boundedStats.bytes <= small.maxBytes && boundedStats.evictions == 100 - (long)boundedStats.entries &&
+                   bounded.lookup(newest, found) && !bounded.lookup(oldest, found);
+    std::printf("\nLRU bound: %zu entries, %zu bytes (limit %zu), %ld evicted %s\n", boundedStats.entries,
+                boundedStats.bytes, small.maxBytes, boundedStats.evictions, boundOk ? "ok" : "FAILED");
+    ok = ok && boundOk;
+
+    // 4. 持久化：保存后由新实例加载，全部命中且最近使用顺序保留
+    const std::string path = "ocr-cache-bench.bin";
+    BenchTimer saveTimer;
+    bool saved = cache.save(path);
+    double saveMs = saveTimer.elapsedMs();
+    OcrCache restored;
+    BenchTimer loadTimer;
+    bool loaded = restored.load(path);
+    double loadMs = loadTimer.elapsedMs();
+    int restoredHits = 0;
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (!seen[i]) continue;
+        const CorpusImage& img = images[i];
+        std::string cachedText;
+        if (restored.lookup(MakeOcrCacheKey(img.bgra.data(), img.width, img.height, img.stride(), false), cachedText))
+            restoredHits++;
+    }
+    std::remove(path.c_str());
+    bool persistOk = saved && loaded && restoredHits == distinct;
+    std::printf("persist: save %.2f ms, load %.2f ms, %d/%ld restored %s\n", saveMs, loadMs, restoredHits, distinct,
+                persistOk ? "ok" : "FAILED");
+    ok = ok && persistOk;
+
+    // 5. 感知哈希：细微改动的截图命中，不同截图不命中
+    OcrCacheOptions nearOptions;
+    nearOptions.perceptualMaxDistance = 2;
+    OcrCache nearCache(nearOptions);
+    const CorpusImage& base = sizes[1];
+    CorpusImage touched = Touched(base);
+    CorpusImage other = MakeLightTextImage(base.width, base.height);
+    OcrCacheKey baseKey = MakeOcrCacheKey(base.bgra.data(), base.width, base.height, base.stride(), true);
+    OcrCacheKey touchedKey = MakeOcrCacheKey(touched.bgra.data(), touched.width, touched.height, touched.stride(), true);
+    OcrCacheKey otherKey = MakeOcrCacheKey(other.bgra.data(), other.width, other.height, other.stride(), true);
+    nearCache.insert(baseKey, "base", 1000);
+    std::string nearText;
+    bool touchedHit = nearCache.lookup(touchedKey, nearText) && nearText == "base";
+    bool otherMiss = !nearCache.lookup(otherKey, nearText);
+    std::printf("perceptual: touched distance %d %s, other distance %d %s\n",
+                PerceptualDistance(baseKey.perceptual, touchedKey.perceptual), touchedHit ? "hit" : "MISS",
+                PerceptualDistance(baseKey.perceptual, otherKey.perceptual), otherMiss ? "miss" : "HIT");
+    ok = ok && touchedHit && otherMiss && baseKey.hash != touchedKey.hash;
+
+    // 6. 合并等待的取消：发起者取消后等待者自己识别；等待者取消时立即返回，不等在途请求
+    OcrCache cancelCache;
+    OcrCacheKey cancelKey;
+    cancelKey.hash = 1;
+    RequestCancel ownerCancel;
+    std::atomic<bool> ownerStarted(false);
+    std::thread owner([&]() {
+        std::string ownerText;
+        cancelCache.getOrCompute(cancelKey, [&](std::string&, size_t&) {
+            ownerStarted = true;
+            while (!ownerCancel.cancelled()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return false;
+        }, ownerText, nullptr, &ownerCancel);
+    });
+    while (!ownerStarted) std::this_thread::yield();
+    std::thread canceller([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ownerCancel.cancel();
+    });
+    RequestCancel waiterCancel;
+    std::string takenOver;
+    OcrCacheSource takenOverSource = OCR_FROM_CACHE;
+    bool takeoverOk = cancelCache.getOrCompute(cancelKey, [](std::string& result, size_t& requestBytes) {
+        result = "waiter";
+        requestBytes = 100;
+        return true;
+    }, takenOver, &takenOverSource, &waiterCancel);
+    owner.join();
+    canceller.join();
+    takeoverOk = takeoverOk && takenOver == "waiter" && takenOverSource == OCR_FROM_CALL;
+
+    OcrCacheKey slowKey;
+    slowKey.hash = 2;
+    std::atomic<bool> slowStarted(false);
+    std::thread slow([&]() {
+        std::string slowText;
+        cancelCache.getOrCompute(slowKey, [&](std::string& result, size_t&) {
+            slowStarted = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            result = "slow";
+            return true;
+        }, slowText);
+    });
+    while (!slowStarted) std::this_thread::yield();
+    RequestCancel impatient;
+    std::thread escape([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        impatient.cancel();
+    });
+    BenchTimer waitTimer;
+    std::string abandoned;
+    bool abandonedOk = cancelCache.getOrCompute(slowKey, [](std::string&, size_t&) {
+        return true;
+    }, abandoned, nullptr, &impatient);
+    double waitMs = waitTimer.elapsedMs();
+    escape.join();
+    slow.join();
+    bool escapeOk = !abandonedOk && waitMs < 200;
+    std::printf("cancel: owner cancelled -> waiter computes %s, waiter cancelled after %.0f ms %s\n",
+                takeoverOk ? "ok" : "FAILED", waitMs, escapeOk ? "ok" : "FAILED");
+    ok = ok && takeoverOk && escapeOk;
+
+    std::printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
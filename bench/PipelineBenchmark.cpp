@@ -0,0 +1,108 @@
+#include "../include/CaptureSource.h"
+#include "../include/FileReplayCaptureSource.h"
+#include "../include/ImageAnalyzer.h"
+#include "../include/RequestBody.h"
+#include "BenchUtil.h"
+#include "ScreenshotCorpus.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// 一次完整流程：采集 -> 自适应编码 -> 构建请求体并写出到空套接字
+struct StageTimes {
+    double captureMs;
+    double encodeMs;
+    double bodyMs;
+    size_t imageBytes;
+    size_t bodyBytes;
+
+    StageTimes() : captureMs(0), encodeMs(0), bodyMs(0), imageBytes(0), bodyBytes(0) {}
+};
+
+static bool RunPipeline(CaptureSource& source, int x, int y, int width, int height, StageTimes& times) {
+    BenchTimer timer;
+    PixelBufferView view;
+    if (!source.capture(x, y, width, height, view)) return false;
+    times.captureMs += timer.elapsedMs();
+
+    timer = BenchTimer();
+    PreprocessOptions preprocess;
+    preprocess.enabled = true;
+    preprocess.sourceDpi = view.dpi;
+    preprocess.targetDpi = 96;
+    std::vector<unsigned char> image;
+    AdaptiveEncodeResult result;
+    EncodeCaptureAdaptive(view.pixels, view.width, view.height, view.stride, preprocess, FormatPolicy(),
+                          JpegEncodeFunc(), image, result);
+    times.encodeMs += timer.elapsedMs();
+    times.imageBytes = image.size();
+
+    timer = BenchTimer();
+    RequestBody body;
+    body.appendOwned(std::string("lang=auto&imgBase=base64,"));
+    body.appendBase64FormEncoded(image.data(), image.size());
+    size_t written = 0;
+    body.writeTo([&written](const char*, size_t size) {
+        written += size;
+        return true;
+    });
+    times.bodyMs += timer.elapsedMs();
+    times.bodyBytes = written;
+    return true;
+}
+
+static void Report(const char* source, const std::string& name, int width, int height, const StageTimes& t, int runs) {
+    std::printf("%-7s %-14s %4dx%-5d %10.3f %10.3f %10.3f %10zu %10zu\n", source, name.c_str(), width, height,
+                t.captureMs / runs, t.encodeMs / runs, t.bodyMs / runs, t.imageBytes, t.bodyBytes);
+}
+
+// 用法：PipelineBenchmark [截图.ppm | 截图_宽x高.bgra ...]
+// 回放内置样本和给出的文件；连接了支持 MIT-SHM 的 X 服务器时再测实际屏幕截图
+int main(int argc, char** argv) {
+    const int runs = 10;
+    std::printf("%-7s %-14s %-10s %10s %10s %10s %10s %10s\n", "source", "image", "size", "capture", "encode",
+                "body", "img bytes", "body bytes");
+
+    std::vector<CorpusImage> corpus = LoadCorpus(1, argv);
+    for (const CorpusImage& img : corpus) {
+        FileReplayCaptureSource replay(144);
+        replay.addFrame(img.width, img.height, img.bgra);
+
+        StageTimes times;
+        for (int i = 0; i < runs; ++i) {
+            if (!RunPipeline(replay, 0, 0, 0, 0, times)) {
+                std::printf("replay capture failed for %s\n", img.name.c_str());
+                return 1;
+            }
+        }
+        Report("replay", img.name, img.width, img.height, times, runs);
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        FileReplayCaptureSource replay;
+        if (!replay.addFile(argv[i])) {
+            std::fprintf(stderr, "skip %s: not a PPM or sized raw BGRA file\n", argv[i]);
+            continue;
+        }
+        StageTimes times;
+        PixelBufferView view;
+        replay.capture(0, 0, 0, 0, view);
+        for (int r = 0; r < runs; ++r) RunPipeline(replay, 0, 0, 0, 0, times);
+        Report("replay", argv[i], view.width, view.height, times, runs);
+    }
+
+    std::unique_ptr<CaptureSource> screen = CreateScreenCaptureSource();
+    if (!screen) {
+        std::printf("no screen capture source available, skipping live capture\n");
+        return 0;
+    }
+    const int regions[][4] = {{0, 0, 600, 40}, {0, 0, 640, 360}, {0, 0, 1920, 1080}};
+    for (const int* region : regions) {
+        StageTimes times;
+        for (int r = 0; r < runs; ++r) {
+            if (!RunPipeline(*screen, region[0], region[1], region[2], region[3], times)) break;
+        }
+        Report(screen->name(), "screen", region[2], region[3], times, runs);
+    }
+    return 0;
+}
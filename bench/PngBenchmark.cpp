@@ -0,0 +1,98 @@
+#include "../include/PngEncoder.h"
+#include "BenchUtil.h"
+#include "PngDecode.h"
+#include "ScreenshotCorpus.h"
+#include <cstdio>
+
+// 用法：PngBenchmark [截图1.ppm 截图2.ppm ...]
+// 对每张图分别用各预设编码，报告耗时、压缩后大小和压缩率；
+// 每个结果都用独立的解码器解压、反滤波，与原像素逐一比对，不一致即 FAIL
+
+// 解码后的 RGB 与 BGRA 原图一致
+static bool MatchesBgra(const std::vector<unsigned char>& png, const CorpusImage& img) {
+    DecodedPng decoded;
+    if (!DecodePng(png.data(), png.size(), decoded)) return false;
+    if (decoded.width != img.width || decoded.height != img.height || decoded.colorType != 2 ||
+        decoded.bitDepth != 8) {
+        return false;
+    }
+    for (int y = 0; y < img.height; ++y) {
+        const unsigned char* source = &img.bgra[(size_t)y * img.stride()];
+        const unsigned char* row = &decoded.pixels[(size_t)y * decoded.rowBytes];
+        for (int x = 0; x < img.width; ++x) {
+            if (row[3 * x] != source[4 * x + 2] || row[3 * x + 1] != source[4 * x + 1] ||
+                row[3 * x + 2] != source[4 * x]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 调色板 PNG：各种调色板大小（1/2/4/8 位索引）与不是 8 的倍数的宽度
+static bool CheckIndexed(PngLevel level) {
+    const size_t paletteSizes[] = {2, 4, 16, 200};
+    for (size_t p = 0; p < sizeof(paletteSizes) / sizeof(paletteSizes[0]); ++p) {
+        std::vector<uint32_t> palette;
+        for (size_t i = 0; i < paletteSizes[p]; ++i) palette.push_back((uint32_t)(i * 0x010305));
+        const int width = 203, height = 37;
+        std::vector<unsigned char> indices((size_t)width * height);
+        for (size_t i = 0; i < indices.size(); ++i) indices[i] = (unsigned char)((i * 7 + i / width) % paletteSizes[p]);
+        PngOptions options;
+        options.level = level;
+        std::vector<unsigned char> png;
+        DecodedPng decoded;
+        if (!EncodePngIndexed(indices.data(), width, height, palette, options, png) ||
+            !DecodePng(png.data(), png.size(), decoded) || decoded.colorType != 3 || decoded.palette != palette) {
+            return false;
+        }
+        int depth = decoded.bitDepth;
+        for (int y = 0; y < height; ++y) {
+            const unsigned char* row = &decoded.pixels[(size_t)y * decoded.rowBytes];
+            for (int x = 0; x < width; ++x) {
+                int bit = x * depth;
+                int value = (row[bit / 8] >> (8 - depth - bit % 8)) & ((1 << depth) - 1);
+                if (value != indices[(size_t)y * width + x]) return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::vector<CorpusImage> corpus = LoadCorpus(argc, argv);
+    const PngLevel levels[] = {PngLevel::Fastest, PngLevel::Fast, PngLevel::Default, PngLevel::Best};
+    const char* levelNames[] = {"fastest", "fast", "default", "best"};
+
+    bool ok = true;
+    std::printf("%-14s %10s %-8s %10s %12s %8s %10s %7s\n", "image", "size", "level", "ms", "png bytes", "ratio", "MPix/s",
+                "decode");
+    for (const CorpusImage& img : corpus) {
+        size_t rawBytes = (size_t)img.width * img.height * 3;
+        char dims[32];
+        std::snprintf(dims, sizeof(dims), "%dx%d", img.width, img.height);
+
+        for (int i = 0; i < 4; ++i) {
+            PngOptions options;
+            options.level = levels[i];
+            std::vector<unsigned char> png;
+
+            double ms = MeasureMs([&]() {
+                EncodePngBgra(img.bgra.data(), img.width, img.height, img.stride(), options, png);
+            }, 300.0);
+
+            bool exact = MatchesBgra(png, img);
+            ok = ok && exact;
+            double megapixels = (double)img.width * img.height / 1e6;
+            std::printf("%-14s %10s %-8s %10.2f %12zu %7.1f%% %10.1f %7s\n", img.name.c_str(), dims, levelNames[i], ms,
+                        png.size(), 100.0 * png.size() / rawBytes, megapixels / (ms / 1000.0), exact ? "ok" : "BAD");
+        }
+    }
+    for (int i = 0; i < 4; ++i) {
+        bool exact = CheckIndexed(levels[i]);
+        std::printf("indexed %-8s %s\n", levelNames[i], exact ? "ok" : "BAD");
+        ok = ok && exact;
+    }
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
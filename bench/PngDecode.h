@@ -0,0 +1,326 @@
+#ifndef PNGDECODE_H
+#define PNGDECODE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 基准程序校验编码结果用的最小 PNG 解码器：独立实现的 zlib 解压（逐位查 Huffman 码表，
+// 慢但简单）、块 CRC 与 Adler-32 校验、扫描线反滤波。只支持 8 位及以下的非隔行图像
+
+namespace pngdecode {
+
+class BitInput {
+public:
+    BitInput(const unsigned char* data, size_t size) : data(data), size(size), pos(0), buffer(0), count(0), error(false) {}
+
+    int bits(int n) {
+        uint32_t value = buffer;
+        while (count < n) {
+            if (pos >= size) {
+                error = true;
+                return 0;
+            }
+            value |= (uint32_t)data[pos++] << count;
+            count += 8;
+        }
+        buffer = value >> n;
+        count -= n;
+        return (int)(value & ((1u << n) - 1));
+    }
+
+    // 存储块：丢弃不足一字节的位
+    void alignToByte() {
+        buffer = 0;
+        count = 0;
+    }
+
+    bool copyBytes(std::vector<unsigned char>& out, size_t n) {
+        if (pos + n > size) return false;
+        out.insert(out.end(), data + pos, data + pos + n);
+        pos += n;
+        return true;
+    }
+
+    size_t position() const { return pos; }
+    bool failed() const { return error; }
+
+private:
+    const unsigned char* data;
+    size_t size;
+    size_t pos;
+    uint32_t buffer;
+    int count;
+    bool error;
+};
+
+struct Huffman {
+    short count[16];
+    short symbol[288];
+};
+
+// 由码长构造规范 Huffman 码表；码长超额（过满）时返回 false，不完整的码表允许（只有一个距离码时）
+inline bool BuildHuffman(Huffman& h, const short* lengths, int n) {
+    std::memset(h.count, 0, sizeof(h.count));
+    for (int i = 0; i < n; ++i) h.count[lengths[i]]++;
+    int left = 1;
+    for (int len = 1; len < 16; ++len) {
+        left <<= 1;
+        left -= h.count[len];
+        if (left < 0) return false;
+    }
+    short offsets[16];
+    offsets[1] = 0;
+    for (int len = 1; len < 15; ++len) offsets[len + 1] = offsets[len] + h.count[len];
+    for (int i = 0; i < n; ++i) {
+        if (lengths[i] != 0) h.symbol[offsets[lengths[i]]++] = (short)i;
+    }
+    return true;
+}
+
+inline int DecodeSymbol(BitInput& in, const Huffman& h) {
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len < 16; ++len) {
+        code |= in.bits(1);
+        int count = h.count[len];
+        if (code - count < first) return h.symbol[index + (code - first)];
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+        if (in.failed()) return -1;
+    }
+    return -1;
+}
+
+inline bool InflateBlock(BitInput& in, std::vector<unsigned char>& out, const Huffman& lengthCodes,
+                         const Huffman& distanceCodes) {
+    static const short LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                          35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const short LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                           3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const int DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                          257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                          8193, 12289, 16385, 24577};
+    static const short DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                             7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+    for (;;) {
+        int symbol = DecodeSymbol(in, lengthCodes);
+        if (symbol < 0 || in.failed()) return false;
+        if (symbol < 256) {
+            out.push_back((unsigned char)symbol);
+            continue;
+        }
+        if (symbol == 256) return true;
+        symbol -= 257;
+        if (symbol >= 29) return false;
+        size_t length = LENGTH_BASE[symbol] + in.bits(LENGTH_EXTRA[symbol]);
+        int distanceSymbol = DecodeSymbol(in, distanceCodes);
+        if (distanceSymbol < 0 || distanceSymbol >= 30) return false;
+        size_t distance = DISTANCE_BASE[distanceSymbol] + in.bits(DISTANCE_EXTRA[distanceSymbol]);
+        if (in.failed() || distance > out.size()) return false;
+        size_t from = out.size() - distance;
+        for (size_t i = 0; i < length; ++i) out.push_back(out[from + i]);
+    }
+}
+
+inline bool InflateDynamic(BitInput& in, std::vector<unsigned char>& out) {
+    static const short ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    int literals = in.bits(5) + 257;
+    int distances = in.bits(5) + 1;
+    int codeLengthCodes = in.bits(4) + 4;
+    if (literals > 286 || distances > 30) return false;
+    short lengths[320];
+    std::memset(lengths, 0, sizeof(lengths));
+    for (int i = 0; i < codeLengthCodes; ++i) lengths[ORDER[i]] = (short)in.bits(3);
+    Huffman codeLengths;
+    if (!BuildHuffman(codeLengths, lengths, 19)) return false;
+
+    int index = 0;
+    while (index < literals + distances) {
+        int symbol = DecodeSymbol(in, codeLengths);
+        if (symbol < 0 || in.failed()) return false;
+        if (symbol < 16) {
+            lengths[index++] = (short)symbol;
+            continue;
+        }
+        short repeat = 0;
+        int times;
+        if (symbol == 16) {
+            if (index == 0) return false;
+            repeat = lengths[index - 1];
+            times = 3 + in.bits(2);
+        } else if (symbol == 17) {
+            times = 3 + in.bits(3);
+        } else {
+            times = 11 + in.bits(7);
+        }
+        if (index + times > literals + distances) return false;
+        while (times-- > 0) lengths[index++] = repeat;
+    }
+    if (lengths[256] == 0) return false;
+    Huffman lengthCodes, distanceCodes;
+    if (!BuildHuffman(lengthCodes, lengths, literals)) return false;
+    if (!BuildHuffman(distanceCodes, lengths + literals, distances)) return false;
+    return InflateBlock(in, out, lengthCodes, distanceCodes);
+}
+
+inline bool InflateFixed(BitInput& in, std::vector<unsigned char>& out) {
+    short lengths[320];
+    for (int i = 0; i < 144; ++i) lengths[i] = 8;
+    for (int i = 144; i < 256; ++i) lengths[i] = 9;
+    for (int i = 256; i < 280; ++i) lengths[i] = 7;
+    for (int i = 280; i < 288; ++i) lengths[i] = 8;
+    for (int i = 0; i < 30; ++i) lengths[288 + i] = 5;
+    Huffman lengthCodes, distanceCodes;
+    BuildHuffman(lengthCodes, lengths, 288);
+    BuildHuffman(distanceCodes, lengths + 288, 30);
+    return InflateBlock(in, out, lengthCodes, distanceCodes);
+}
+
+inline uint32_t Adler32(const std::vector<unsigned char>& data) {
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < data.size(); ++i) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+inline uint32_t Crc32(const unsigned char* data, size_t size, uint32_t crc = 0xFFFFFFFFu) {
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+    return crc;
+}
+
+inline uint32_t ReadBigEndian(const unsigned char* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+} // namespace pngdecode
+
+// 解压完整的 zlib 流（校验头部与 Adler-32）
+inline bool InflateZlib(const unsigned char* data, size_t size, std::vector<unsigned char>& out) {
+    using namespace pngdecode;
+    out.clear();
+    if (size < 6 || (data[0] & 0x0F) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20)) return false;
+    BitInput in(data + 2, size - 2);
+    int last;
+    do {
+        last = in.bits(1);
+        int type = in.bits(2);
+        bool ok;
+        if (type == 0) {
+            in.alignToByte();
+            std::vector<unsigned char> header;
+            ok = in.copyBytes(header, 4) && (header[0] | (header[1] << 8)) == ((~(header[2] | (header[3] << 8))) & 0xFFFF) &&
+                 in.copyBytes(out, (size_t)(header[0] | (header[1] << 8)));
+        } else if (type == 1) {
+            ok = InflateFixed(in, out);
+        } else if (type == 2) {
+            ok = InflateDynamic(in, out);
+        } else {
+            ok = false;
+        }
+        if (!ok || in.failed()) return false;
+    } while (!last);
+    size_t end = 2 + in.position();
+    return end + 4 <= size && ReadBigEndian(data + end) == Adler32(out);
+}
+
+struct DecodedPng {
+    int width;
+    int height;
+    int colorType;
+    int bitDepth;
+    size_t rowBytes;
+    std::vector<uint32_t> palette;          // 0xRRGGBB
+    std::vector<unsigned char> pixels;      // 反滤波后的扫描线，每行 rowBytes 字节，无滤波字节
+
+    DecodedPng() : width(0), height(0), colorType(0), bitDepth(0), rowBytes(0) {}
+};
+
+// 校验签名与每个块的 CRC，拼接 IDAT 解压并反滤波
+inline bool DecodePng(const unsigned char* data, size_t size, DecodedPng& png) {
+    using namespace pngdecode;
+    static const unsigned char SIGNATURE[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    if (size < 8 || std::memcmp(data, SIGNATURE, 8) != 0) return false;
+    std::vector<unsigned char> idat;
+    bool header = false, ended = false;
+    size_t pos = 8;
+    while (pos + 12 <= size && !ended) {
+        uint32_t length = ReadBigEndian(data + pos);
+        if (pos + 12 + (size_t)length > size) return false;
+        const unsigned char* type = data + pos + 4;
+        const unsigned char* body = type + 4;
+        if ((Crc32(type, 4 + (size_t)length) ^ 0xFFFFFFFFu) != ReadBigEndian(body + length)) return false;
+        std::string name((const char*)type, 4);
+        if (name == "IHDR") {
+            if (length != 13) return false;
+            png.width = (int)ReadBigEndian(body);
+            png.height = (int)ReadBigEndian(body + 4);
+            png.bitDepth = body[8];
+            png.colorType = body[9];
+            if (body[12] != 0 || png.bitDepth > 8) return false;
+            header = true;
+        } else if (name == "PLTE") {
+            for (uint32_t i = 0; i + 2 < length; i += 3) {
+                png.palette.push_back(((uint32_t)body[i] << 16) | ((uint32_t)body[i + 1] << 8) | body[i + 2]);
+            }
+        } else if (name == "IDAT") {
+            idat.insert(idat.end(), body, body + length);
+        } else if (name == "IEND") {
+            ended = true;
+        }
+        pos += 12 + length;
+    }
+    if (!header || !ended) return false;
+
+    int channels = png.colorType == 2 ? 3 : png.colorType == 6 ? 4 : png.colorType == 4 ? 2 : 1;
+    size_t bitsPerPixel = (size_t)channels * png.bitDepth;
+    size_t bytesPerPixel = (bitsPerPixel + 7) / 8;
+    png.rowBytes = ((size_t)png.width * bitsPerPixel + 7) / 8;
+
+    std::vector<unsigned char> raw;
+    if (!InflateZlib(idat.data(), idat.size(), raw)) return false;
+    if (raw.size() != (png.rowBytes + 1) * (size_t)png.height) return false;
+
+    png.pixels.assign(png.rowBytes * png.height, 0);
+    std::vector<unsigned char> zero(png.rowBytes, 0);
+    for (int y = 0; y < png.height; ++y) {
+        const unsigned char* in = &raw[(png.rowBytes + 1) * y];
+        unsigned char* row = &png.pixels[png.rowBytes * y];
+        const unsigned char* up = y > 0 ? row - png.rowBytes : zero.data();
+        int filter = in[0];
+        ++in;
+        for (size_t x = 0; x < png.rowBytes; ++x) {
+            int a = x >= bytesPerPixel ? row[x - bytesPerPixel] : 0;
+            int b = up[x];
+            int c = x >= bytesPerPixel ? up[x - bytesPerPixel] : 0;
+            int predicted;
+            switch (filter) {
+                case 0: predicted = 0; break;
+                case 1: predicted = a; break;
+                case 2: predicted = b; break;
+                case 3: predicted = (a + b) / 2; break;
+                case 4: {
+                    int p = a + b - c;
+                    int pa = p > a ? p - a : a - p;
+                    int pb = p > b ? p - b : b - p;
+                    int pc = p > c ? p - c : c - p;
+                    predicted = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+                    break;
+                }
+                default: return false;
+            }
+            row[x] = (unsigned char)(in[x] + predicted);
+        }
+    }
+    return true;
+}
+
+#endif // PNGDECODE_H
@@ -0,0 +1,75 @@
+#include "../include/ImagePreprocess.h"
+#include "../include/PngEncoder.h"
+#include "BenchUtil.h"
+#include "ScreenshotCorpus.h"
+#include <cstdio>
+
+struct Variant {
+    const char* name;
+    int sourceDpi;
+    int targetDpi;
+    int bitDepth;
+};
+
+// 用法：PreprocessBenchmark [截图1.ppm ...]
+// 与原始 RGB PNG 对比各预处理策略的输出大小、节省比例以及每百万像素耗时
+int main(int argc, char** argv) {
+    std::vector<CorpusImage> corpus = LoadCorpus(argc, argv);
+    const Variant variants[] = {
+        {"gray8", 96, 0, 8},
+        {"gray8@150%", 144, 96, 8},
+        {"gray8@200%", 192, 96, 8},
+        {"gray4", 96, 0, 4},
+        {"gray2", 96, 0, 2},
+        {"gray1", 96, 0, 1},
+    };
+    PngOptions pngOptions;
+
+    std::printf("%-14s %-11s %10s %8s %12s %12s %10s\n", "image", "variant", "bytes", "saved", "prep ms/MP", "total ms/MP", "out size");
+    for (const CorpusImage& img : corpus) {
+        double megapixels = (double)img.width * img.height / 1e6;
+
+        // 灰度 SIMD 实现与标量公式逐像素比对
+        std::vector<unsigned char> gray((size_t)img.width * img.height);
+        ConvertBgraToGray(img.bgra.data(), img.width, img.height, img.stride(), gray.data());
+        for (size_t i = 0; i < gray.size(); ++i) {
+            const unsigned char* p = &img.bgra[i * 4];
+            if (gray[i] != (unsigned char)((p[0] * 29 + p[1] * 150 + p[2] * 77 + 128) >> 8)) {
+                std::printf("gray mismatch in %s at pixel %zu\n", img.name.c_str(), i);
+                return 1;
+            }
+        }
+
+        std::vector<unsigned char> baseline;
+        double baselineMs = MeasureMs([&]() {
+            EncodePngBgra(img.bgra.data(), img.width, img.height, img.stride(), pngOptions, baseline);
+        });
+        std::printf("%-14s %-11s %10zu %7.1f%% %12s %12.2f %4dx%-5d\n", img.name.c_str(), "rgb", baseline.size(), 0.0, "-",
+                    baselineMs / megapixels, img.width, img.height);
+
+        for (const Variant& v : variants) {
+            PreprocessOptions options;
+            options.enabled = true;
+            options.sourceDpi = v.sourceDpi;
+            options.targetDpi = v.targetDpi;
+            options.bitDepth = v.bitDepth;
+
+            GrayImage processed;
+            double prepMs = MeasureMs([&]() {
+                PreprocessCapture(img.bgra.data(), img.width, img.height, img.stride(), options, processed);
+            });
+
+            std::vector<unsigned char> png;
+            double totalMs = MeasureMs([&]() {
+                GrayImage out;
+                PreprocessCapture(img.bgra.data(), img.width, img.height, img.stride(), options, out);
+                EncodePngGray(out, options.bitDepth, pngOptions, png);
+            });
+
+            double saved = 100.0 * (1.0 - (double)png.size() / baseline.size());
+            std::printf("%-14s %-11s %10zu %7.1f%% %12.2f %12.2f %4dx%-5d\n", img.name.c_str(), v.name, png.size(), saved,
+                        prepMs / megapixels, totalMs / megapixels, processed.width, processed.height);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,180 @@
+#include "../include/RequestBody.h"
+#include "../include/AudioFormat.h"
+#include "../include/FormEncoder.h"
+#include "BenchUtil.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const char* BOUNDARY = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
+
+// 模拟套接字写入：复制进一个固定大小的发送缓冲区
+struct SocketSink {
+    char buffer[16 * 1024];
+    size_t writes;
+    size_t bytes;
+    double firstByteMs;
+
+    SocketSink() : writes(0), bytes(0), firstByteMs(-1) {}
+
+    void write(const char* data, size_t size, const BenchTimer& timer) {
+        if (firstByteMs < 0) firstByteMs = timer.elapsedMs();
+        while (size > 0) {
+            size_t n = size < sizeof(buffer) ? size : sizeof(buffer);
+            std::memcpy(buffer, data, n);
+            data += n;
+            size -= n;
+            bytes += n;
+        }
+        writes++;
+    }
+};
+
+// 原 stopRecording -> createWavFile -> sendToYoudaoAPI 的流程：三次整段复制
+static std::string LegacyAsrBody(const std::vector<char>& recorded, size_t* peakBytes) {
+    std::vector<char> dataCopy = recorded;
+
+    std::vector<char> wavFile;
+    std::string header = BuildWavHeader(16000, 1, 16, (uint32_t)dataCopy.size());
+    wavFile.insert(wavFile.end(), header.begin(), header.end());
+    wavFile.insert(wavFile.end(), dataCopy.begin(), dataCopy.end());
+
+    std::string postData;
+    postData += "--" + std::string(BOUNDARY) + "\r\n";
+    postData += "Content-Disposition: form-data; name=\"audioData\"; filename=\"blob\"\r\n";
+    postData += "Content-Type: audio/wav\r\n\r\n";
+    postData.append(wavFile.begin(), wavFile.end());
+    postData += "\r\n--" + std::string(BOUNDARY) + "--\r\n";
+
+    if (peakBytes) *peakBytes = recorded.size() + dataCopy.capacity() + wavFile.capacity() + postData.capacity();
+    return postData;
+}
+
+static RequestBody AsrBody(const std::vector<char>& recorded) {
+    std::string preamble = "--" + std::string(BOUNDARY) + "\r\n";
+    preamble += "Content-Disposition: form-data; name=\"audioData\"; filename=\"blob\"\r\n";
+    preamble += "Content-Type: audio/wav\r\n\r\n";
+    preamble += BuildWavHeader(16000, 1, 16, (uint32_t)recorded.size());
+
+    RequestBody body;
+    body.appendOwned(std::move(preamble));
+    body.appendBorrowed(recorded.data(), recorded.size());
+    body.appendOwned("\r\n--" + std::string(BOUNDARY) + "--\r\n");
+    return body;
+}
+
+// user-002 之后的 OCR 请求体：按精确长度一次编码成整块字符串
+static std::string FlatOcrBody(const std::vector<unsigned char>& png, size_t* peakBytes) {
+    static const char prefix[] = "lang=auto&imgBase=base64,";
+    std::string body(sizeof(prefix) - 1 + Base64FormEncodedLength(png.data(), png.size()), '\0');
+    std::memcpy(&body[0], prefix, sizeof(prefix) - 1);
+    WriteBase64FormEncoded(png.data(), png.size(), &body[sizeof(prefix) - 1]);
+    if (peakBytes) *peakBytes = png.size() + body.capacity();
+    return body;
+}
+
+static RequestBody OcrBody(const std::vector<unsigned char>& png) {
+    RequestBody body;
+    body.appendOwned(std::string("lang=auto&imgBase=base64,"));
+    body.appendBase64FormEncoded(png.data(), png.size());
+    return body;
+}
+
+static void Report(const char* payload, const char* impl, size_t payloadBytes, size_t bodyBytes,
+                   double ttfbMs, double totalMs, size_t writes, size_t peakBytes) {
+    std::printf("%-5s %-8s %10zu %10zu %10.3f %10.3f %8zu %12zu\n", payload, impl, payloadBytes, bodyBytes,
+                ttfbMs, totalMs, writes, peakBytes);
+}
+
+int main() {
+    // 正确性：分段写出的内容与整块拼接结果逐字节一致（覆盖编码分块边界）
+    for (size_t size = 0; size < 200000; size += (size < 64 ? 1 : 9973)) {
+        std::vector<unsigned char> png = RandomBytes(size, (unsigned int)size + 3);
+        RequestBody body = OcrBody(png);
+        std::string flat = FlatOcrBody(png, nullptr);
+        if (body.toString() != flat || body.size() != flat.size()) {
+            std::printf("ocr body mismatch at %zu bytes\n", size);
+            return 1;
+        }
+        std::vector<unsigned char> raw = RandomBytes(size & ~(size_t)1, (unsigned int)size + 5);
+        std::vector<char> pcm(raw.begin(), raw.end());
+        RequestBody asr = AsrBody(pcm);
+        std::string legacy = LegacyAsrBody(pcm, nullptr);
+        if (asr.toString() != legacy || asr.size() != legacy.size()) {
+            std::printf("asr body mismatch at %zu bytes\n", size);
+            return 1;
+        }
+    }
+
+    std::printf("%-5s %-8s %10s %10s %10s %10s %8s %12s\n", "body", "impl", "payload", "body", "ttfb ms", "total ms",
+                "writes", "peak bytes");
+
+    // ASR：16 kHz 16 位单声道，5 秒与 56 秒（录音上限）
+    const double seconds[] = {5, 56};
+    for (double s : seconds) {
+        std::vector<unsigned char> raw = RandomBytes((size_t)(s * 32000));
+        std::vector<char> pcm(raw.begin(), raw.end());
+
+        size_t legacyPeak = 0;
+        SocketSink legacySink;
+        double legacyMs = MeasureMs([&]() {
+            SocketSink sink;
+            BenchTimer timer;
+            std::string postData = LegacyAsrBody(pcm, &legacyPeak);
+            sink.write(postData.data(), postData.size(), timer);
+            legacySink = sink;
+        });
+        Report("asr", "legacy", pcm.size(), legacySink.bytes, legacySink.firstByteMs, legacyMs, legacySink.writes, legacyPeak);
+
+        SocketSink spanSink;
+        size_t spanPeak = 0;
+        double spanMs = MeasureMs([&]() {
+            SocketSink sink;
+            BenchTimer timer;
+            RequestBody body = AsrBody(pcm);
+            body.writeTo([&](const char* data, size_t size) {
+                sink.write(data, size, timer);
+                return true;
+            });
+            spanPeak = pcm.size() + (body.size() - pcm.size()) + 16 * 1024;
+            spanSink = sink;
+        });
+        Report("asr", "spans", pcm.size(), spanSink.bytes, spanSink.firstByteMs, spanMs, spanSink.writes, spanPeak);
+    }
+
+    // OCR：PNG 大小取灰度文字截图的典型范围
+    const size_t pngSizes[] = {64 * 1024, 512 * 1024, 4 * 1024 * 1024};
+    for (size_t size : pngSizes) {
+        std::vector<unsigned char> png = RandomBytes(size);
+
+        size_t flatPeak = 0;
+        SocketSink flatSink;
+        double flatMs = MeasureMs([&]() {
+            SocketSink sink;
+            BenchTimer timer;
+            std::string postData = FlatOcrBody(png, &flatPeak);
+            sink.write(postData.data(), postData.size(), timer);
+            flatSink = sink;
+        });
+        Report("ocr", "flat", size, flatSink.bytes, flatSink.firstByteMs, flatMs, flatSink.writes, flatPeak);
+
+        SocketSink spanSink;
+        size_t spanPeak = 0;
+        double spanMs = MeasureMs([&]() {
+            SocketSink sink;
+            BenchTimer timer;
+            RequestBody body = OcrBody(png);
+            body.writeTo([&](const char* data, size_t size) {
+                sink.write(data, size, timer);
+                return true;
+            });
+            // 暂存缓冲区 + 一个编码分块的输出缓冲区
+            spanPeak = png.size() + 16 * 1024 + Base64FormEncodedLength(png.data(), size < 48 * 1024 ? size : 48 * 1024);
+            spanSink = sink;
+        });
+        Report("ocr", "spans", size, spanSink.bytes, spanSink.firstByteMs, spanMs, spanSink.writes, spanPeak);
+    }
+    return 0;
+}
@@ -0,0 +1,201 @@
+#ifndef SCREENSHOTCORPUS_H
+#define SCREENSHOTCORPUS_H
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// 基准程序用的截图样本：BGRA 像素，自上而下，stride = width * 4
+struct CorpusImage {
+    std::string name;
+    int width;
+    int height;
+    std::vector<unsigned char> bgra;
+
+    int stride() const { return width * 4; }
+};
+
+// 生成一组伪字形（8x12，带抗锯齿灰阶），用来模拟界面文字
+inline std::vector<std::vector<unsigned char> > MakeGlyphs(unsigned int seed, int count = 64) {
+    std::mt19937 rng(seed);
+    std::vector<std::vector<unsigned char> > glyphs(count, std::vector<unsigned char>(8 * 12, 0));
+    for (int g = 0; g < count; ++g) {
+        std::vector<unsigned char>& glyph = glyphs[g];
+        // 几条横竖笔画
+        int strokes = 2 + rng() % 3;
+        for (int s = 0; s < strokes; ++s) {
+            bool vertical = rng() & 1;
+            int pos = 1 + rng() % 6;
+            int from = 1 + rng() % 4, to = 6 + rng() % 5;
+            for (int t = from; t < to; ++t) {
+                int x = vertical ? pos : (t * 7) / 11;
+                int y = vertical ? t : pos + 2;
+                glyph[y * 8 + x] = 255;
+                if (x + 1 < 8 && glyph[y * 8 + x + 1] < 96) glyph[y * 8 + x + 1] = 96;
+            }
+        }
+    }
+    return glyphs;
+}
+
+inline void FillRect(CorpusImage& img, int x0, int y0, int w, int h, unsigned char r, unsigned char g, unsigned char b) {
+    for (int y = y0; y < y0 + h && y < img.height; ++y) {
+        for (int x = x0; x < x0 + w && x < img.width; ++x) {
+            unsigned char* p = &img.bgra[(size_t)(y * img.width + x) * 4];
+            p[0] = b; p[1] = g; p[2] = r; p[3] = 255;
+        }
+    }
+}
+
+// 在背景色上按字形灰度混合前景色绘制“文字行”
+inline void DrawTextLines(CorpusImage& img, int x0, int y0, int x1, int y1, int lineHeight,
+                          const unsigned char fg[3], const unsigned char bg[3], unsigned int seed) {
+    std::vector<std::vector<unsigned char> > glyphs = MakeGlyphs(seed);
+    std::mt19937 rng(seed);
+    for (int line = y0; line + 12 <= y1; line += lineHeight) {
+        int x = x0 + (rng() % 4) * 16;
+        int lineEnd = x1 - (int)(rng() % ((x1 - x0) / 3 + 1));
+        while (x + 8 <= lineEnd) {
+            if (rng() % 7 == 0) { x += 8; continue; } // 空格
+            const std::vector<unsigned char>& glyph = glyphs[rng() % glyphs.size()];
+            for (int gy = 0; gy < 12; ++gy) {
+                for (int gx = 0; gx < 8; ++gx) {
+                    int a = glyph[gy * 8 + gx];
+                    if (!a) continue;
+                    unsigned char* p = &img.bgra[(size_t)((line + gy) * img.width + x + gx) * 4];
+                    for (int c = 0; c < 3; ++c) {
+                        p[2 - c] = (unsigned char)((fg[c] * a + bg[c] * (255 - a)) / 255);
+                    }
+                }
+            }
+            x += 8;
+        }
+    }
+}
+
+inline CorpusImage MakeBlankImage(const std::string& name, int width, int height,
+                                  unsigned char r, unsigned char g, unsigned char b) {
+    CorpusImage img;
+    img.name = name;
+    img.width = width;
+    img.height = height;
+    img.bgra.resize((size_t)width * height * 4);
+    FillRect(img, 0, 0, width, height, r, g, b);
+    return img;
+}
+
+// 浅色背景的文档/网页文字
+inline CorpusImage MakeLightTextImage(int width, int height) {
+    CorpusImage img = MakeBlankImage("light-text", width, height, 255, 255, 255);
+    const unsigned char fg[3] = {20, 20, 20}, bg[3] = {255, 255, 255};
+    DrawTextLines(img, 16, 16, width - 16, height - 16, 20, fg, bg, 7);
+    return img;
+}
+
+// 单行文字（如截取的标题或一行消息）：上下只留几像素边距，高度够放一行即可
+inline CorpusImage MakeSingleLineImage(int width, int height) {
+    CorpusImage img = MakeBlankImage("single-line", width, height, 255, 255, 255);
+    const unsigned char fg[3] = {20, 20, 20}, bg[3] = {255, 255, 255};
+    int top = (height - 12) / 2;
+    DrawTextLines(img, 8, top, width - 8, top + 12, 20, fg, bg, 7);
+    return img;
+}
+
+// 深色主题的代码编辑器：几种语法高亮颜色
+inline CorpusImage MakeCodeEditorImage(int width, int height) {
+    CorpusImage img = MakeBlankImage("code-editor", width, height, 30, 30, 30);
+    FillRect(img, 0, 0, 48, height, 37, 37, 38);
+    const unsigned char colors[4][3] = {{212, 212, 212}, {86, 156, 214}, {206, 145, 120}, {106, 153, 85}};
+    const unsigned char bg[3] = {30, 30, 30};
+    for (int band = 0; band < 4; ++band) {
+        int y0 = 8 + band * (height / 4);
+        DrawTextLines(img, 64, y0, width - 8, y0 + height / 4 - 8, 18, colors[band], bg, 11 + band);
+    }
+    return img;
+}
+
+// 对话框：大块纯色面板、边框、按钮和少量文字
+inline CorpusImage MakeDialogImage(int width, int height) {
+    CorpusImage img = MakeBlankImage("dialog", width, height, 240, 240, 240);
+    FillRect(img, 0, 0, width, 32, 0, 120, 215);
+    FillRect(img, 24, 56, width - 48, height - 140, 255, 255, 255);
+    FillRect(img, 24, 56, width - 48, 1, 200, 200, 200);
+    FillRect(img, width - 200, height - 60, 80, 28, 225, 225, 225);
+    FillRect(img, width - 108, height - 60, 80, 28, 0, 120, 215);
+    const unsigned char fg[3] = {0, 0, 0}, bg[3] = {255, 255, 255};
+    DrawTextLines(img, 40, 72, width - 64, height - 100, 22, fg, bg, 23);
+    return img;
+}
+
+// 照片类内容：平滑渐变叠加噪声
+inline CorpusImage MakePhotoImage(int width, int height) {
+    CorpusImage img = MakeBlankImage("photo", width, height, 0, 0, 0);
+    std::mt19937 rng(99);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            unsigned char* p = &img.bgra[(size_t)(y * width + x) * 4];
+            int noise = (int)(rng() % 17) - 8;
+            int r = (x * 255) / width + noise;
+            int g = (y * 255) / height + noise;
+            int b = ((x + y) * 127) / (width + height) + 64 + noise;
+            p[2] = (unsigned char)(r < 0 ? 0 : r > 255 ? 255 : r);
+            p[1] = (unsigned char)(g < 0 ? 0 : g > 255 ? 255 : g);
+            p[0] = (unsigned char)(b < 0 ? 0 : b > 255 ? 255 : b);
+            p[3] = 255;
+        }
+    }
+    return img;
+}
+
+// 读取二进制 PPM (P6)，转换为 BGRA；用于加载真实截图样本
+inline bool LoadPpm(const std::string& path, CorpusImage& img) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    int width = 0, height = 0, maxValue = 0;
+    char magic[3] = {0};
+    bool ok = std::fscanf(f, "%2s %d %d %d", magic, &width, &height, &maxValue) == 4 &&
+              std::strcmp(magic, "P6") == 0 && width > 0 && height > 0 && maxValue == 255;
+    if (ok) {
+        std::fgetc(f);
+        std::vector<unsigned char> rgb((size_t)width * height * 3);
+        ok = std::fread(rgb.data(), 1, rgb.size(), f) == rgb.size();
+        if (ok) {
+            img.name = path;
+            img.width = width;
+            img.height = height;
+            img.bgra.resize((size_t)width * height * 4);
+            for (size_t i = 0; i < (size_t)width * height; ++i) {
+                img.bgra[i * 4 + 0] = rgb[i * 3 + 2];
+                img.bgra[i * 4 + 1] = rgb[i * 3 + 1];
+                img.bgra[i * 4 + 2] = rgb[i * 3 + 0];
+                img.bgra[i * 4 + 3] = 255;
+            }
+        }
+    }
+    std::fclose(f);
+    return ok;
+}
+
+// 内置样本 + 命令行给出的 PPM 文件
+inline std::vector<CorpusImage> LoadCorpus(int argc, char** argv) {
+    std::vector<CorpusImage> corpus;
+    corpus.push_back(MakeLightTextImage(1920, 1080));
+    corpus.push_back(MakeCodeEditorImage(1920, 1080));
+    corpus.push_back(MakeDialogImage(640, 360));
+    corpus.push_back(MakeSingleLineImage(600, 40));
+    corpus.push_back(MakePhotoImage(1280, 720));
+    for (int i = 1; i < argc; ++i) {
+        CorpusImage img;
+        if (LoadPpm(argv[i], img)) {
+            corpus.push_back(img);
+        } else {
+            std::fprintf(stderr, "skip %s: not a binary PPM\n", argv[i]);
+        }
+    }
+    return corpus;
+}
+
+#endif // SCREENSHOTCORPUS_H
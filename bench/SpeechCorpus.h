@@ -0,0 +1,140 @@
+#ifndef SPEECHCORPUS_H
+#define SPEECHCORPUS_H
+
+#include "../include/AudioFormat.h"
+#include "../include/MappedFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 基准程序用的录音样本：16 kHz 单声道 16 位小端 PCM
+static const int SPEECH_SAMPLE_RATE = 16000;
+static const int SPEECH_BYTES_PER_SECOND = SPEECH_SAMPLE_RATE * 2;
+
+struct SpeechClip {
+    std::string name;
+    std::vector<char> pcm;
+    std::vector<std::pair<long long, long long> > pauses;   // 合成样本的停顿区间（字节，含结尾静音）
+    std::vector<std::pair<long long, long long> > speech;   // 合成样本的语句区间（字节，含清辅音）
+    bool synthetic;
+};
+
+// 合成参数：语句 1.5~4.5 s（谐波 + 音节包络），语句间停顿 150~900 ms
+struct SpeechClipOptions {
+    double seconds;                 // 语句部分的大致时长（不含首尾静音）
+    unsigned int seed;
+    double pauseProbability;        // 语句之后停顿的概率，为 0 时整段连续说话
+    double leadSilence;             // 开头、结尾的静音（秒）
+    double trailingSilence;
+    double noise;                   // 背景噪声的标准差
+    bool lowFrequencyNoise;         // 低频噪声（风扇、空调），否则为白噪声
+    double fricativeProbability;    // 语句前后带清辅音（能量低的高频噪声，80~160 ms）的概率
+    double fricativeLevel;
+
+    SpeechClipOptions(double seconds, unsigned int seed)
+        : seconds(seconds), seed(seed), pauseProbability(0.8), leadSilence(0.3), trailingSilence(0), noise(40),
+          lowFrequencyNoise(false), fricativeProbability(0), fricativeLevel(110) {}
+};
+
+inline void AppendSpeechSample(std::vector<char>& pcm, double value) {
+    int sample = (int)std::lround((std::max)(-32768.0, (std::min)(32767.0, value)));
+    pcm.push_back((char)(sample & 0xFF));
+    pcm.push_back((char)((sample >> 8) & 0xFF));
+}
+
+inline SpeechClip MakeSpeechClip(const std::string& name, const SpeechClipOptions& options) {
+    SpeechClip clip;
+    clip.name = name;
+    clip.synthetic = true;
+    std::mt19937 rng(options.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    // 一阶低通把白噪声压到约 500 Hz 以下，标准差相应放大使输出仍为 options.noise
+    std::normal_distribution<double> noise(0.0, options.lowFrequencyNoise ? options.noise * 3 : options.noise);
+    std::normal_distribution<double> hiss(0.0, options.fricativeLevel / std::sqrt(2.0));
+    double lowPassed = 0;
+    double lastHiss = 0;
+    std::vector<char>& pcm = clip.pcm;
+    pcm.reserve((size_t)((options.seconds + options.leadSilence + options.trailingSilence + 5) * SPEECH_BYTES_PER_SECOND));
+
+    auto background = [&]() {
+        double value = noise(rng);
+        if (!options.lowFrequencyNoise) return value;
+        lowPassed += 0.2 * (value - lowPassed);
+        return lowPassed;
+    };
+    // 差分白噪声：能量集中在高频，过零率高
+    auto fricative = [&](double seconds) {
+        for (int i = 0; i < (int)(seconds * SPEECH_SAMPLE_RATE); ++i) {
+            double value = hiss(rng);
+            AppendSpeechSample(pcm, value - lastHiss + background());
+            lastHiss = value;
+        }
+    };
+    auto silence = [&](double seconds) {
+        for (int i = 0; i < (int)(seconds * SPEECH_SAMPLE_RATE); ++i) AppendSpeechSample(pcm, background());
+    };
+
+    silence(options.leadSilence);
+    size_t total = pcm.size() / 2 + (size_t)(options.seconds * SPEECH_SAMPLE_RATE);
+    while (pcm.size() / 2 < total) {
+        long long start = (long long)pcm.size();
+        if (unit(rng) < options.fricativeProbability) fricative(0.08 + 0.08 * unit(rng));
+        double phrase = 1.5 + 3.0 * unit(rng);
+        double f0 = 110 + 110 * unit(rng);
+        double syllableHz = 4 + 2 * unit(rng);
+        size_t samples = (size_t)(phrase * SPEECH_SAMPLE_RATE);
+        for (size_t i = 0; i < samples; ++i) {
+            double t = (double)i / SPEECH_SAMPLE_RATE;
+            // 音节之间能量下降但不到静音
+            double envelope = 0.35 + 0.65 * std::fabs(std::sin(3.14159265 * syllableHz * t));
+            double voice = 0;
+            for (int h = 1; h <= 5; ++h) voice += std::sin(2 * 3.14159265 * f0 * h * t) / h;
+            AppendSpeechSample(pcm, 3500 * envelope * voice + background());
+        }
+        if (unit(rng) < options.fricativeProbability) fricative(0.08 + 0.08 * unit(rng));
+        clip.speech.push_back(std::make_pair(start, (long long)pcm.size()));
+
+        if (unit(rng) >= options.pauseProbability) continue;
+        double pause = 0.15 + 0.75 * unit(rng);
+        long long pauseStart = (long long)pcm.size();
+        silence(pause);
+        clip.pauses.push_back(std::make_pair(pauseStart, (long long)pcm.size()));
+    }
+    if (options.trailingSilence > 0) {
+        long long start = (long long)pcm.size();
+        silence(options.trailingSilence);
+        clip.pauses.push_back(std::make_pair(start, (long long)pcm.size()));
+    }
+    return clip;
+}
+
+// 读取 16 kHz 单声道 16 位 PCM 的 WAV 文件
+inline bool LoadSpeechWav(const std::string& path, SpeechClip& clip) {
+    MappedFile file;
+    WavInfo info;
+    if (!file.openRead(path.c_str()) || !ParseWav(file.data(), file.size(), info)) return false;
+    if (info.sampleRate != SPEECH_SAMPLE_RATE || info.channels != 1 || info.bitsPerSample != 16) return false;
+    clip.name = path;
+    clip.synthetic = false;
+    const char* data = (const char*)file.data() + info.dataOffset;
+    clip.pcm.assign(data, data + (info.dataBytes & ~(size_t)1));
+    return true;
+}
+
+// 命令行给出的 WAV 文件（格式不符的跳过）
+inline void LoadSpeechWavs(int argc, char** argv, std::vector<SpeechClip>& clips) {
+    for (int i = 1; i < argc; ++i) {
+        SpeechClip clip;
+        if (LoadSpeechWav(argv[i], clip)) {
+            clips.push_back(clip);
+        } else {
+            std::fprintf(stderr, "skip %s: not a 16 kHz mono 16-bit PCM WAV file\n", argv[i]);
+        }
+    }
+}
+
+#endif // SPEECHCORPUS_H
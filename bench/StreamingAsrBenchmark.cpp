@@ -0,0 +1,176 @@
+#include "../include/StreamingAsr.h"
+#include "../include/AsrClient.h"
+#include "../include/AudioFormat.h"
+#include "../include/Executor.h"
+#include "../include/HttpConnectionPool.h"
+#include "BenchUtil.h"
+#include "SpeechCorpus.h"
+#include "StubServer.h"
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 边录边识别：按实时速率把录音送入 StreamingAsr，本地替身服务器的识别耗时与音频长度成正比，
+// 比较“结束录音 → 拿到文字”的等待时间：原来结束后才上传整段录音，现在只等最后一段。
+// 为缩短运行时间，录音、上行带宽与服务器处理都按 SPEEDUP 倍加速，报告中的毫秒数已换算回实际时间。
+// 音频夹具：合成的“语句”（谐波 + 音节包络 + 背景噪声，语句间有长短不一的停顿），
+// 另可在命令行给出 16 kHz 单声道 16 位的 WAV 文件。合成夹具同时校验切点都落在停顿中
+
+static const int SAMPLE_RATE = SPEECH_SAMPLE_RATE;
+static const int BYTES_PER_SECOND = SPEECH_BYTES_PER_SECOND;
+static const int SPEEDUP = 20;
+// 实际时间下的服务器参数：固定耗时 300 ms，识别速度为音频时长的 8 倍，上行 1 Mbit/s
+static const int SERVER_FIXED_MS = 300;
+static const long SERVER_AUDIO_SPEED = 8;
+static const long UPLINK_BYTES_PER_SECOND = 125000;
+static const char* BOUNDARY = "----StreamingAsrBenchmarkBoundary";
+
+static SpeechClip MakeUtterance(const char* name, double seconds, unsigned int seed, double pauseProbability,
+                                double trailingSilence) {
+    SpeechClipOptions options(seconds, seed);
+    options.pauseProbability = pauseProbability;
+    options.trailingSilence = trailingSilence;
+    return MakeSpeechClip(name, options);
+}
+
+static RequestBody BuildBody(const std::vector<char>& pcm) {
+    std::string preamble = std::string("--") + BOUNDARY + "\r\n";
+    preamble += "Content-Disposition: form-data; name=\"audioData\"; filename=\"blob\"\r\n";
+    preamble += "Content-Type: audio/wav\r\n\r\n";
+    preamble += BuildWavHeader(SAMPLE_RATE, 1, 16, (uint32_t)pcm.size());
+    RequestBody body;
+    body.appendOwned(std::move(preamble));
+    body.appendBorrowed(pcm.data(), pcm.size());
+    body.appendOwned(std::string("\r\n--") + BOUNDARY + "--\r\n");
+    return body;
+}
+
+static bool Recognize(HttpConnectionPool& pool, const HttpUrl& url, const std::vector<char>& pcm,
+                      RequestCancel* cancel, std::string& text) {
+    std::string headers = std::string("Content-Type: multipart/form-data; boundary=") + BOUNDARY + "\r\n";
+    HttpResponse response;
+    if (!pool.post(url, headers, BuildBody(pcm), response, cancel) || response.status != 200) return false;
+    AsrResult asr = ParseAsrResponse(response.body);
+    if (asr.errorCode != "0") return false;
+    text = asr.text;
+    return true;
+}
+
+// 替身服务器的回应为 "stub asr <请求体字节数> bytes"；没有语音、未上传的段没有文字
+static std::string ExpectedText(const std::vector<size_t>& uploadBytes, size_t overhead) {
+    std::string text;
+    for (size_t i = 0; i < uploadBytes.size(); ++i) {
+        if (uploadBytes[i] == 0) continue;
+        if (!text.empty()) text += " ";
+        text += "stub asr " + std::to_string(uploadBytes[i] + overhead) + " bytes";
+    }
+    return text;
+}
+
+int main(int argc, char** argv) {
+    std::vector<SpeechClip> fixtures;
+    fixtures.push_back(MakeUtterance("short 4 s", 4, 11, 0.8, 0));
+    fixtures.push_back(MakeUtterance("sentence 12 s", 12, 12, 0.8, 0));
+    fixtures.push_back(MakeUtterance("paragraph 30 s", 30, 13, 0.8, 0));
+    fixtures.push_back(MakeUtterance("dictation 55 s", 55, 14, 0.8, 0));
+    fixtures.push_back(MakeUtterance("trailing pause 20 s", 20, 15, 0.8, 1.2));
+    fixtures.push_back(MakeUtterance("no pauses 45 s", 45, 16, 0.0, 0));
+    LoadSpeechWavs(argc, argv, fixtures);
+
+    StubServer server;
+    server.setBandwidth(UPLINK_BYTES_PER_SECOND * SPEEDUP);
+    server.setProcessingRate(BYTES_PER_SECOND * SERVER_AUDIO_SPEED * SPEEDUP);
+    if (!server.start(0, SERVER_FIXED_MS / SPEEDUP)) {
+        std::printf("cannot start stub server\nFAIL\n");
+        return 1;
+    }
+    HttpUrl url;
+    ParseHttpUrl(server.url("/asr?lang=zh-CHS&mutiSentences=true"), url);
+    HttpConnectionPool pool;
+    const size_t overhead = BuildBody(std::vector<char>()).size();
+
+    bool ok = true;
+    std::printf("%-22s %7s %8s %9s %6s %11s %11s %8s %6s\n", "fixture", "audio s", "segments", "in flight",
+                "tail", "legacy ms", "stream ms", "speedup", "cuts");
+    for (size_t f = 0; f < fixtures.size(); ++f) {
+        const SpeechClip& fixture = fixtures[f];
+        double audioSeconds = (double)fixture.pcm.size() / BYTES_PER_SECOND;
+
+        // 原路径：结束录音后上传整段
+        std::string legacyText;
+        BenchTimer legacyTimer;
+        bool legacyOk = Recognize(pool, url, fixture.pcm, nullptr, legacyText);
+        double legacyMs = legacyTimer.elapsedMs() * SPEEDUP;
+
+        // 边录边识别：按录音设备的节奏（4096 字节一个缓冲区）送入
+        StreamingAsr streaming([&pool, &url](const std::shared_ptr<std::vector<char> >& pcm, RequestCancel& cancel,
+                                             std::string& text) {
+            return Recognize(pool, url, *pcm, &cancel, text);
+        }, &SharedExecutor().io());
+        const size_t chunk = 4096;
+        std::chrono::nanoseconds period((long long)chunk * 1000000000LL / BYTES_PER_SECOND / SPEEDUP);
+        std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset < fixture.pcm.size(); offset += chunk) {
+            next += period;
+            std::this_thread::sleep_until(next);
+            streaming.feed(fixture.pcm.data() + offset, (std::min)(chunk, fixture.pcm.size() - offset));
+        }
+        StreamingAsrResult result = streaming.finish(30000);
+        double streamMs = result.finishMs * SPEEDUP;
+
+        // 切点：合成夹具的每个切点都应落在停顿中（连续说话的夹具只能强制切开，不检查）
+        size_t cutsInPause = 0;
+        size_t cutCount = result.segments > 0 ? result.segments - 1 : 0;
+        for (size_t i = 0; i + 1 < result.segmentBytes.size(); ++i) {
+            long long position = result.segmentOffsets[i] + (long long)result.segmentBytes[i];
+            for (size_t p = 0; p < fixture.pauses.size(); ++p) {
+                if (position >= fixture.pauses[p].first && position <= fixture.pauses[p].second) {
+                    cutsInPause++;
+                    break;
+                }
+            }
+        }
+        // 各段首尾相接（强制切开时与前一段重叠），一直覆盖到录音结尾
+        bool covered = result.recordedBytes == (long long)fixture.pcm.size();
+        long long end = 0;
+        for (size_t i = 0; i < result.segmentOffsets.size(); ++i) {
+            covered = covered && result.segmentOffsets[i] <= end;
+            end = result.segmentOffsets[i] + (long long)result.segmentBytes[i];
+        }
+        if (result.tailSkipped) end = result.recordedBytes;
+
+        char cuts[32];
+        std::snprintf(cuts, sizeof(cuts), "%lu/%lu", (unsigned long)cutsInPause, (unsigned long)cutCount);
+        std::printf("%-22.22s %7.1f %8lu %9lu %6s %11.0f %11.0f %7.1fx %6s\n", fixture.name.c_str(), audioSeconds,
+                    (unsigned long)result.segments, (unsigned long)result.inFlightAtFinish,
+                    result.tailSkipped ? "skip" : "sent", legacyMs, streamMs, streamMs > 0 ? legacyMs / streamMs : 0,
+                    fixture.synthetic && !fixture.pauses.empty() ? cuts : "-");
+
+        // 文字按段的顺序拼接，所有录音都被切分（跳过的静音结尾除外），上传的只是各段中的语音部分
+        bool fixtureOk = legacyOk && result.ok && result.text == ExpectedText(result.uploadBytes, overhead);
+        fixtureOk = fixtureOk && covered && end == result.recordedBytes;
+        if (fixture.synthetic && !fixture.pauses.empty()) fixtureOk = fixtureOk && cutsInPause == cutCount;
+        if (fixture.synthetic && audioSeconds >= 12) fixtureOk = fixtureOk && result.segments > 1 && streamMs < legacyMs;
+        if (fixture.name == "trailing pause 20 s") fixtureOk = fixtureOk && result.tailSkipped;
+        if (!fixtureOk) std::printf("  FAILED: %s\n", DescribeStreamingAsr(result).c_str());
+        ok = ok && fixtureOk;
+    }
+
+    // 停顿检测本身的开销：录音线程上每秒音频的处理时间
+    const SpeechClip& longest = fixtures[3];
+    double segmentMs = MeasureMs([&longest]() {
+        SpeechSegmenter segmenter;
+        std::vector<SegmentCut> cuts;
+        for (size_t offset = 0; offset < longest.pcm.size(); offset += 4096) {
+            segmenter.feed(longest.pcm.data() + offset, (std::min)((size_t)4096, longest.pcm.size() - offset), cuts);
+        }
+    });
+    std::printf("\nsegmenter: %.1f MB/s, %.1f us per second of audio\n",
+                ThroughputMBps(longest.pcm.size(), segmentMs),
+                segmentMs * 1000.0 / ((double)longest.pcm.size() / BYTES_PER_SECOND));
+
+    server.stop();
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
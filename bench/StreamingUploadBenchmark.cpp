@@ -0,0 +1,136 @@
+#include "../include/ImageAnalyzer.h"
+#include "../include/OcrClient.h"
+#include "BenchUtil.h"
+#include "ScreenshotCorpus.h"
+#include "StubServer.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// 端到端对比：先完整编码再上传 vs 边编码边以 chunked 请求体上传。
+// 替身服务器按给定带宽读取请求，模拟上行；计时从开始编码到收到响应
+
+static const int RUNS = 3;
+
+// 两种方式使用相同的 PNG 选项，请求体逐字节相同
+static PngOptions MakePngOptions() {
+    PngOptions options;
+    options.idatChunkSize = 16 * 1024;
+    return options;
+}
+
+struct ModeTimes {
+    double totalMs;
+    double encodeMs;
+    size_t requestBytes;
+    bool ok;
+
+    ModeTimes() : totalMs(0), encodeMs(0), requestBytes(0), ok(true) {}
+};
+
+static PreprocessOptions MakePreprocess(bool enabled) {
+    PreprocessOptions options;
+    options.enabled = enabled;
+    options.sourceDpi = 96;
+    options.targetDpi = 96;
+    return options;
+}
+
+static ModeTimes RunBuffered(HttpConnectionPool& pool, const HttpUrl& url, const CorpusImage& img,
+                             const PreprocessOptions& preprocess, std::string& expectedBody) {
+    ModeTimes times;
+    PngOptions pngOptions = MakePngOptions();
+    for (int r = 0; r < RUNS; ++r) {
+        BenchTimer timer;
+        std::vector<unsigned char> encoded;
+        AdaptiveEncodeResult result;
+        EncodeCaptureAdaptive(img.bgra.data(), img.width, img.height, img.stride(), preprocess, FormatPolicy(),
+                              JpegEncodeFunc(), pngOptions,
+                              [&encoded](const unsigned char* data, size_t size) {
+                                  encoded.insert(encoded.end(), data, data + size);
+                              },
+                              result);
+        times.encodeMs += timer.elapsedMs();
+        OcrResult ocr = CallOcrEndpoint(pool, url, encoded);
+        times.totalMs += timer.elapsedMs();
+        times.requestBytes = ocr.requestBytes;
+        times.ok = times.ok && ocr.ok;
+        if (r == 0) expectedBody = BuildOcrRequestBody(encoded).toString();
+    }
+    times.totalMs /= RUNS;
+    times.encodeMs /= RUNS;
+    return times;
+}
+
+static ModeTimes RunStreamed(HttpConnectionPool& pool, const HttpUrl& url, const CorpusImage& img,
+                             const PreprocessOptions& preprocess, StubServer& server, const std::string& expectedBody) {
+    ModeTimes times;
+    PngOptions pngOptions = MakePngOptions();
+    for (int r = 0; r < RUNS; ++r) {
+        BenchTimer timer;
+        double encodeMs = 0;
+        OcrResult ocr = CallOcrEndpointStreaming(pool, url, [&](const ByteSink& sink) {
+            AdaptiveEncodeResult result;
+            bool ok = EncodeCaptureAdaptive(img.bgra.data(), img.width, img.height, img.stride(), preprocess,
+                                            FormatPolicy(), JpegEncodeFunc(), pngOptions, sink, result);
+            encodeMs = timer.elapsedMs();
+            return ok;
+        });
+        times.totalMs += timer.elapsedMs();
+        times.encodeMs += encodeMs;
+        times.requestBytes = ocr.requestBytes;
+        times.ok = times.ok && ocr.ok && server.lastRequestBody() == expectedBody;
+    }
+    times.totalMs /= RUNS;
+    times.encodeMs /= RUNS;
+    return times;
+}
+
+// 用法：StreamingUploadBenchmark [截图.ppm ...]
+int main(int argc, char** argv) {
+    std::vector<CorpusImage> corpus;
+    corpus.push_back(MakeLightTextImage(3840, 2160));
+    corpus.back().name = "light-text-4k";
+    corpus.push_back(MakeCodeEditorImage(1920, 1080));
+    corpus.push_back(MakePhotoImage(1920, 1080));
+    for (int i = 1; i < argc; ++i) {
+        CorpusImage img;
+        if (LoadPpm(argv[i], img)) corpus.push_back(img);
+    }
+
+    const long bandwidths[] = {0, 4 * 1024 * 1024, 1024 * 1024};
+    bool allOk = true;
+    std::printf("%-16s %-5s %10s %10s %10s %12s %12s %8s\n", "image", "gray", "uplink", "body KB", "encode",
+                "buffered", "streamed", "saved");
+    for (long bandwidth : bandwidths) {
+        StubServer server;
+        server.setBandwidth(bandwidth);
+        if (!server.start(0)) return 1;
+        HttpUrl url;
+        ParseHttpUrl(server.url("/ocrapi1"), url);
+        HttpConnectionPool pool;
+
+        for (const CorpusImage& img : corpus) {
+            for (int gray = 1; gray >= 0; --gray) {
+                PreprocessOptions preprocess = MakePreprocess(gray != 0);
+                std::string expectedBody;
+                ModeTimes buffered = RunBuffered(pool, url, img, preprocess, expectedBody);
+                ModeTimes streamed = RunStreamed(pool, url, img, preprocess, server, expectedBody);
+                bool ok = buffered.ok && streamed.ok && buffered.requestBytes == streamed.requestBytes;
+                allOk = allOk && ok;
+
+                char uplink[32];
+                if (bandwidth > 0) std::snprintf(uplink, sizeof(uplink), "%.1f MB/s", bandwidth / (1024.0 * 1024.0));
+                else std::snprintf(uplink, sizeof(uplink), "loopback");
+                std::printf("%-16s %-5s %10s %10.1f %8.1fms %10.1fms %10.1fms %7.1f%%%s\n", img.name.c_str(),
+                            gray ? "yes" : "no", uplink, buffered.requestBytes / 1024.0, buffered.encodeMs,
+                            buffered.totalMs, streamed.totalMs,
+                            100.0 * (buffered.totalMs - streamed.totalMs) / buffered.totalMs,
+                            ok ? "" : "  MISMATCH");
+            }
+        }
+        server.stop();
+    }
+    std::printf("%s\n", allOk ? "streamed bodies identical to buffered bodies" : "FAILED");
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+#include "StubServer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// 用法：StubOcrServer [--port N] [--delay-ms N] [--fail-every N] [--idle-close-ms N] [--tail-rate P --tail-ms N]
+// 启动本地替身服务器，回车后退出并打印连接数与请求数
+int main(int argc, char** argv) {
+    int port = 8089, delayMs = 0, failEvery = 0, idleCloseMs = 0, tailMs = 0;
+    double tailRate = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--port") == 0) port = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--delay-ms") == 0) delayMs = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--fail-every") == 0) failEvery = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--idle-close-ms") == 0) idleCloseMs = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--tail-rate") == 0) tailRate = std::atof(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--tail-ms") == 0) tailMs = std::atoi(argv[i + 1]);
+    }
+
+    StubServer server;
+    server.setIdleCloseMs(idleCloseMs);
+    server.setTailDelay(tailRate, tailMs);
+    if (!server.start(port, delayMs, failEvery)) {
+        std::fprintf(stderr, "cannot listen on port %d\n", port);
+        return 1;
+    }
+    std::printf("listening on %s (delay %d ms), press Enter to stop\n", server.url("/ocrapi1").c_str(), delayMs);
+    std::fflush(stdout);
+    std::getchar();
+
+    server.stop();
+    std::printf("connections=%ld requests=%ld tail_delayed=%ld\n", server.connectionsAccepted(), server.requestsServed(),
+                server.requestsTailDelayed());
+    return 0;
+}
@@ -0,0 +1,264 @@
+#ifndef STUBSERVER_H
+#define STUBSERVER_H
+
+#include "../include/Socket.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+// 本地替身服务器：模拟有道 OCR/ASR 接口的 HTTP/1.1 明文服务，用于批处理与连接池的基准。
+// 支持 keep-alive，可配置响应延迟（含偶发的长尾延迟）与失败比例，统计接受的连接数与请求数
+class StubServer {
+public:
+    StubServer() : listener(INVALID_SOCKET_HANDLE), boundPort(0), delayMs(0), failEvery(0), idleCloseMs(0), maxRequestsPerConnection(0),
+                   bandwidth(0), processingRate(0), tailProbability(0), tailMs(0), tailRng(4242), running(false),
+                   connections(0), requests(0), activeConnections(0), tailDelayed(0) {}
+    ~StubServer() { stop(); }
+
+    // port 为 0 时由系统分配；delayMs 模拟服务端处理时间；failEvery > 0 时每 N 个请求返回一次 503
+    bool start(int port, int delayMs = 0, int failEvery = 0) {
+        std::string error;
+        listener = ListenTcp("127.0.0.1", port, 128, error);
+        if (listener == INVALID_SOCKET_HANDLE) return false;
+        boundPort = LocalPort(listener);
+        this->delayMs = delayMs;
+        this->failEvery = failEvery;
+        running = true;
+        acceptThread = std::thread(&StubServer::acceptLoop, this);
+        return true;
+    }
+
+    // 模拟服务器的 keep-alive 超时：连接空闲超过 ms 毫秒后由服务器悄悄关闭（0 表示不关闭），需在 start 前设置
+    void setIdleCloseMs(int ms) { idleCloseMs = ms; }
+    // 模拟 keep-alive 竞争：每条连接处理 n 个请求后，读到下一个请求时不响应直接断开（0 表示不限制）
+    void setMaxRequestsPerConnection(int n) { maxRequestsPerConnection = n; }
+    // 模拟上行带宽：每条连接读取请求的速率不超过 bytesPerSecond（0 表示不限速）
+    void setBandwidth(long bytesPerSecond) { bandwidth = bytesPerSecond; }
+    // 模拟处理时间随请求体增长（语音识别的耗时与音频长度成正比）：每 bytesPerSecond 字节额外延迟 1 s（0 表示不延迟）
+    void setProcessingRate(long bytesPerSecond) { processingRate = bytesPerSecond; }
+    // 模拟长尾：每个请求以 probability 的概率额外延迟 ms 毫秒（随机数种子固定，结果可复现），需在 start 前设置
+    void setTailDelay(double probability, int ms) {
+        tailProbability = probability;
+        tailMs = ms;
+    }
+
+    // 连接线程每 100 ms 检查一次运行标志，停止时等它们全部退出
+    void stop() {
+        if (!running.exchange(false)) return;
+        if (acceptThread.joinable()) acceptThread.join();
+        CloseSocket(listener);
+        while (activeConnections > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    int port() const { return boundPort; }
+    std::string url(const char* path) const { return "http://127.0.0.1:" + std::to_string(port()) + path; }
+
+    long connectionsAccepted() const { return connections; }
+    long requestsServed() const { return requests; }
+    long requestsTailDelayed() const { return tailDelayed; }
+
+    // 最近一个请求的请求体（chunked 请求为解码后的内容），用于校验流式上传
+    std::string lastRequestBody() const {
+        std::lock_guard<std::mutex> lock(bodyMutex);
+        return lastBody;
+    }
+
+private:
+    SocketHandle listener;
+    int boundPort;
+    int delayMs;
+    int failEvery;
+    int idleCloseMs;
+    int maxRequestsPerConnection;
+    long bandwidth;
+    long processingRate;
+    double tailProbability;
+    int tailMs;
+    std::mutex tailMutex;
+    std::mt19937 tailRng;
+    std::atomic<bool> running;
+    std::atomic<long> connections;
+    std::atomic<long> requests;
+    std::atomic<int> activeConnections;
+    std::atomic<long> tailDelayed;
+    std::thread acceptThread;
+    mutable std::mutex bodyMutex;
+    std::string lastBody;
+
+    // 限速状态：从请求的第一个字节开始计时
+    struct Throttle {
+        bool started;
+        std::chrono::steady_clock::time_point start;
+        size_t bytes;
+
+        Throttle() : started(false), bytes(0) {}
+    };
+
+    void acceptLoop() {
+        while (running) {
+            if (!WaitReadable(listener, 100)) continue;
+            SocketHandle client = AcceptTcp(listener);
+            if (client == INVALID_SOCKET_HANDLE) continue;
+            connections++;
+            activeConnections++;
+            std::thread(&StubServer::serve, this, client).detach();
+        }
+    }
+
+    // 读一个请求：头部 + 请求体（Content-Length 或 chunked）；连接关闭或超时返回 false
+    bool readRequest(SocketHandle client, std::string& buffer, std::string& head, std::string& body) {
+        Throttle throttle;
+        size_t headerEnd;
+        while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            int idleLimit = buffer.empty() ? idleCloseMs : 0;
+            if (!receive(client, buffer, idleLimit, throttle)) return false;
+        }
+        head = buffer.substr(0, headerEnd);
+        buffer.erase(0, headerEnd + 4);
+        body.clear();
+
+        if (strcasestr_portable(head, "transfer-encoding: chunked")) {
+            for (;;) {
+                size_t lineEnd;
+                while ((lineEnd = buffer.find("\r\n")) == std::string::npos) {
+                    if (!receive(client, buffer, 0, throttle)) return false;
+                }
+                size_t size = (size_t)std::strtoull(buffer.c_str(), nullptr, 16);
+                buffer.erase(0, lineEnd + 2);
+                if (size == 0) {
+                    // 尾部头字段以空行结束
+                    for (;;) {
+                        while ((lineEnd = buffer.find("\r\n")) == std::string::npos) {
+                            if (!receive(client, buffer, 0, throttle)) return false;
+                        }
+                        buffer.erase(0, lineEnd + 2);
+                        if (lineEnd == 0) return true;
+                    }
+                }
+                while (buffer.size() < size + 2) {
+                    if (!receive(client, buffer, 0, throttle)) return false;
+                }
+                body.append(buffer, 0, size);
+                buffer.erase(0, size + 2);
+            }
+        }
+
+        size_t bodyBytes = 0;
+        const char* length = strcasestr_portable(head, "content-length:");
+        if (length) bodyBytes = (size_t)std::strtoull(length + 15, nullptr, 10);
+        while (buffer.size() < bodyBytes) {
+            if (!receive(client, buffer, 0, throttle)) return false;
+        }
+        body.assign(buffer, 0, bodyBytes);
+        buffer.erase(0, bodyBytes);
+        return true;
+    }
+
+    // idleLimitMs > 0 时等待超过该时长仍无数据则放弃连接
+    bool receive(SocketHandle client, std::string& buffer, int idleLimitMs, Throttle& throttle) {
+        char chunk[16 * 1024];
+        int step = idleLimitMs > 0 && idleLimitMs < 100 ? idleLimitMs : 100;
+        int waited = 0;
+        for (;;) {
+            if (!running) return false;
+            if (!WaitReadable(client, step)) {
+                waited += step;
+                if (idleLimitMs > 0 && waited >= idleLimitMs) return false;
+                continue;
+            }
+            long received = ReceiveSome(client, chunk, sizeof(chunk));
+            if (received <= 0) return false;
+            buffer.append(chunk, (size_t)received);
+
+            if (bandwidth > 0) {
+                if (!throttle.started) {
+                    throttle.started = true;
+                    throttle.start = std::chrono::steady_clock::now();
+                }
+                throttle.bytes += (size_t)received;
+                std::this_thread::sleep_until(throttle.start +
+                    std::chrono::microseconds((long long)(throttle.bytes * 1000000.0 / bandwidth)));
+            }
+            return true;
+        }
+    }
+
+    static const char* strcasestr_portable(const std::string& haystack, const char* needle) {
+        size_t length = std::strlen(needle);
+        for (size_t i = 0; i + length <= haystack.size(); ++i) {
+            size_t j = 0;
+            while (j < length && std::tolower((unsigned char)haystack[i + j]) == needle[j]) ++j;
+            if (j == length) return haystack.c_str() + i;
+        }
+        return nullptr;
+    }
+
+    int drawTailDelay() {
+        if (tailProbability <= 0 || tailMs <= 0) return 0;
+        std::lock_guard<std::mutex> lock(tailMutex);
+        if (std::uniform_real_distribution<double>(0.0, 1.0)(tailRng) >= tailProbability) return 0;
+        tailDelayed++;
+        return tailMs;
+    }
+
+    // 分段睡眠，服务器停止时提前返回 false，不让长尾延迟拖住 stop()
+    bool sleepWhileRunning(int ms) {
+        std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+        while (std::chrono::steady_clock::now() < until) {
+            if (!running) return false;
+            std::this_thread::sleep_for((std::min)(std::chrono::duration_cast<std::chrono::milliseconds>(
+                until - std::chrono::steady_clock::now()), std::chrono::milliseconds(10)));
+        }
+        return running;
+    }
+
+    void serve(SocketHandle client) {
+        std::string buffer, head, requestBody;
+        int served = 0;
+        while (running && readRequest(client, buffer, head, requestBody)) {
+            if (maxRequestsPerConnection > 0 && served++ == maxRequestsPerConnection) break;
+            long index = ++requests;
+            size_t bodyBytes = requestBody.size();
+            {
+                std::lock_guard<std::mutex> lock(bodyMutex);
+                lastBody.swap(requestBody);
+            }
+            bool close = strcasestr_portable(head, "connection: close") != nullptr ||
+                         head.find("HTTP/1.0") != std::string::npos;
+            int processingMs = processingRate > 0 ? (int)((long long)bodyBytes * 1000 / processingRate) : 0;
+            if (!sleepWhileRunning(delayMs + processingMs + drawTailDelay())) break;
+
+            std::string body;
+            int status = 200;
+            if (failEvery > 0 && index % failEvery == 0) {
+                status = 503;
+                body = "{\"errorCode\":\"503\"}";
+            } else if (head.find(" /asr") != std::string::npos) {
+                body = "{\"errorCode\":\"0\",\"result\":[\"stub asr " + std::to_string(bodyBytes) + " bytes\"]}";
+            } else {
+                body = "{\"errorCode\":\"0\",\"lines\":[{\"words\":\"stub\"},{\"words\":\"" +
+                       std::to_string(bodyBytes) + " bytes\"}]}";
+            }
+
+            std::string response = "HTTP/1.1 " + std::to_string(status) + (status == 200 ? " OK" : " Service Unavailable");
+            response += "\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size());
+            response += close ? "\r\nConnection: close\r\n\r\n" : "\r\nConnection: keep-alive\r\n\r\n";
+            response += body;
+            if (!SendAll(client, response.data(), response.size()) || close) break;
+        }
+        ShutdownSocket(client);
+        CloseSocket(client);
+        activeConnections--;
+    }
+};
+
+#endif // STUBSERVER_H
@@ -0,0 +1,149 @@
+#include "../include/ImageAnalyzer.h"
+#include "../include/OcrClient.h"
+#include "../include/TiledOcr.h"
+#include "BenchUtil.h"
+#include "ScreenshotCorpus.h"
+#include "StubServer.h"
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 整图一次识别 vs 分块并发识别。每个带真实编码并上传到本地替身服务器；
+// 服务端识别耗时按像素数模拟（SERVER_MS_PER_MEGAPIXEL），识别结果由已知的文字行位置生成：
+// 完整落在带内的行返回原文，被带边缘截断的行返回乱码（模拟真实识别对残行的输出）
+
+static const int LINE_HEIGHT = 20;
+static const int GLYPH_HEIGHT = 12;
+static const int TEXT_MARGIN = 16;
+static const double SERVER_MS_PER_MEGAPIXEL = 120.0;
+
+struct Scenario {
+    const char* name;
+    int sourceDpi;      // 高于 96 时编码前缩小，识别坐标需要换算回带的像素坐标
+    bool boxes;         // 响应是否带 boundingBox
+};
+
+static int TextLineCount(int height) {
+    int count = 0;
+    for (int y = TEXT_MARGIN; y + GLYPH_HEIGHT <= height - TEXT_MARGIN; y += LINE_HEIGHT) count++;
+    return count;
+}
+
+static TileRecognizer MakeRecognizer(const PixelBufferView& full, const Scenario& scenario, HttpConnectionPool& pool,
+                                     const HttpUrl& url) {
+    return [&full, scenario, &pool, url](const PixelBufferView& band, TileRecognition& result) {
+        PreprocessOptions preprocess;
+        preprocess.enabled = true;
+        preprocess.sourceDpi = band.dpi;
+        preprocess.targetDpi = 96;
+        std::vector<unsigned char> encoded;
+        AdaptiveEncodeResult encodeResult;
+        if (!EncodeCaptureAdaptive(band.pixels, band.width, band.height, band.stride, preprocess, FormatPolicy(),
+                                   JpegEncodeFunc(), encoded, encodeResult)) {
+            return false;
+        }
+        if (!CallOcrEndpoint(pool, url, encoded).ok) return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(
+            (long long)(SERVER_MS_PER_MEGAPIXEL * encodeResult.width * encodeResult.height / 1000.0)));
+
+        // 识别坐标相对于上传的（可能缩小的）图片
+        int bandTop = (int)((band.pixels - full.pixels) / full.stride);
+        double scale = (double)encodeResult.height / band.height;
+        result.imageWidth = encodeResult.width;
+        result.imageHeight = encodeResult.height;
+        int index = 0;
+        for (int y = TEXT_MARGIN; y + GLYPH_HEIGHT <= full.height - TEXT_MARGIN; y += LINE_HEIGHT, ++index) {
+            int top = (std::max)(y, bandTop);
+            int bottom = (std::min)(y + GLYPH_HEIGHT, bandTop + band.height);
+            if (bottom - top < 3) continue; // 只露出一两行像素的不会被识别
+            bool whole = top == y && bottom == y + GLYPH_HEIGHT;
+            // 没有外接矩形时无法按位置去掉残行，这里假定识别端不返回残行，只验证按文字去重
+            if (!whole && !scenario.boxes) continue;
+            OcrLine line;
+            line.text = (whole ? "line " : "#?~ ") + std::to_string(index);
+            line.hasBox = scenario.boxes;
+            line.left = (int)(TEXT_MARGIN * scale);
+            line.right = (int)((full.width - TEXT_MARGIN) * scale);
+            line.top = (int)((top - bandTop) * scale);
+            line.bottom = (int)((bottom - bandTop) * scale);
+            result.lines.push_back(line);
+        }
+        return true;
+    };
+}
+
+static bool MatchesGroundTruth(const TiledOcrResult& result, int lineCount) {
+    if ((int)result.lines.size() != lineCount) return false;
+    for (int i = 0; i < lineCount; ++i) {
+        if (result.lines[i].text != "line " + std::to_string(i)) return false;
+    }
+    return true;
+}
+
+int main() {
+    StubServer server;
+    if (!server.start(0)) {
+        std::printf("cannot start stub server\n");
+        return 1;
+    }
+    HttpUrl url;
+    ParseHttpUrl(server.url("/ocrapi1"), url);
+    HttpConnectionPool pool;
+
+    CorpusImage img = MakeLightTextImage(3840, 2160);
+    int lineCount = TextLineCount(img.height);
+
+    const Scenario scenarios[] = {
+        {"boxes, 96 dpi", 96, true},
+        {"boxes, 192 dpi (scaled)", 192, true},
+        {"no boxes, 96 dpi", 96, false},
+    };
+
+    bool ok = true;
+    std::printf("%-26s %-8s %6s %6s %10s %10s %6s  %s\n", "scenario", "mode", "bands", "dups", "first ms", "total ms",
+                "lines", "result");
+    for (const Scenario& scenario : scenarios) {
+        PixelBufferView view;
+        view.pixels = img.bgra.data();
+        view.width = img.width;
+        view.height = img.height;
+        view.stride = img.stride();
+        view.dpi = scenario.sourceDpi;
+        TileRecognizer recognize = MakeRecognizer(view, scenario, pool, url);
+
+        TilingOptions single;
+        single.minHeight = img.height + 1;
+        TilingOptions tiled;
+
+        for (int mode = 0; mode < 2; ++mode) {
+            const TilingOptions& options = mode == 0 ? single : tiled;
+            std::vector<TileBand> bands = PlanTileBands(view, options);
+            TiledOcrResult result = RunTiledOcr(view, bands, options.maxConcurrent, recognize, TileProgress());
+            bool correct = result.ok && MatchesGroundTruth(result, lineCount);
+            ok = ok && correct && (mode == 0 || result.firstBandMs < result.totalMs);
+            std::printf("%-26s %-8s %6zu %6zu %10.1f %10.1f %6zu  %s\n", scenario.name, mode == 0 ? "single" : "tiled",
+                        result.bands, result.duplicateLines, result.firstBandMs, result.totalMs, result.lines.size(),
+                        correct ? "ok" : "MISMATCH");
+        }
+    }
+
+    // 切口应落在文字行之间的空白中
+    PixelBufferView view;
+    view.pixels = img.bgra.data();
+    view.width = img.width;
+    view.height = img.height;
+    view.stride = img.stride();
+    std::vector<TileBand> bands = PlanTileBands(view, TilingOptions());
+    bool cutsInGaps = true;
+    for (size_t i = 1; i < bands.size(); ++i) {
+        int offset = (bands[i].ownTop - TEXT_MARGIN) % LINE_HEIGHT;
+        cutsInGaps = cutsInGaps && offset >= GLYPH_HEIGHT;
+    }
+    std::printf("cuts in whitespace rows: %s\n", cutsInGaps ? "yes" : "NO");
+    ok = ok && cutsInGaps;
+    server.stop();
+
+    std::printf("%s\n", ok ? "all scenarios passed" : "FAILED");
+    return ok ? 0 : 1;
+}
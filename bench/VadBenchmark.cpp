@@ -0,0 +1,200 @@
+#include "../include/VoiceActivity.h"
+#include "BenchUtil.h"
+#include "SpeechCorpus.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// 语音活动检测：
+// 1. 各内核每秒可处理的帧数（20 ms 一帧），结果须与标量实现逐位一致；
+// 2. 首尾静音裁剪在样本上省下的上传字节，合成样本同时校验不裁掉语音（含低能量的清辅音）；
+// 3. 说完自动结束：逐缓冲区送入录音，最后一句之后静音达到设定时长时结束，语句间的停顿不触发。
+// 可在命令行给出 16 kHz 单声道 16 位的 WAV 文件，只报告裁剪量
+
+static const int FRAME_MS = 20;
+static const size_t FRAME_BYTES = SPEECH_SAMPLE_RATE * FRAME_MS / 1000 * 2;
+static const int AUTO_STOP_MS = 2500;
+// 不加留白时，检测到的语音边界与实际边界允许相差的距离
+static const long long EDGE_TOLERANCE = 2 * FRAME_BYTES;
+
+static SpeechClip MakeClip(const char* name, SpeechClipOptions options, double lead, double trail) {
+    options.leadSilence = lead;
+    options.trailingSilence = trail;
+    return MakeSpeechClip(name, options);
+}
+
+static bool CheckKernels(const std::vector<char>& pcm) {
+    const VadKernel kernels[] = {VadKernel::Scalar, VadKernel::Sse2, VadKernel::Avx2, VadKernel::Neon};
+    const size_t frames = pcm.size() / FRAME_BYTES;
+    std::printf("active kernel: %s\n", VadKernelName(VadActiveKernel()));
+    std::printf("%-10s %14s %12s\n", "kernel", "frames/s", "x realtime");
+
+    // 任意长度与起始位置（含奇数地址、短于一个向量的长度）
+    std::mt19937 rng(7);
+    std::vector<std::pair<size_t, size_t> > spans;
+    for (int i = 0; i < 2000; ++i) {
+        size_t samples = rng() % 700;
+        size_t offset = rng() % (pcm.size() - samples * 2);
+        spans.push_back(std::make_pair(offset, samples));
+    }
+
+    bool ok = true;
+    for (VadKernel kernel : kernels) {
+        if (!VadKernelSupported(kernel)) continue;
+        bool same = true;
+        for (size_t f = 0; f < frames && same; ++f) {
+            FrameFeatures expected = AnalyzeFrameWithKernel(VadKernel::Scalar, pcm.data() + f * FRAME_BYTES,
+                                                            FRAME_BYTES / 2);
+            FrameFeatures actual = AnalyzeFrameWithKernel(kernel, pcm.data() + f * FRAME_BYTES, FRAME_BYTES / 2);
+            same = actual.sumSquares == expected.sumSquares && actual.zeroCrossings == expected.zeroCrossings;
+        }
+        for (size_t i = 0; i < spans.size() && same; ++i) {
+            const char* data = pcm.data() + spans[i].first;
+            FrameFeatures expected = AnalyzeFrameWithKernel(VadKernel::Scalar, data, spans[i].second);
+            FrameFeatures actual = AnalyzeFrameWithKernel(kernel, data, spans[i].second);
+            same = actual.sumSquares == expected.sumSquares && actual.zeroCrossings == expected.zeroCrossings;
+        }
+        // 整段满幅交替的样本：平方和与过零计数都取到最大
+        std::vector<char> extreme(FRAME_BYTES * 200);
+        for (size_t i = 0; i < extreme.size() / 2; ++i) {
+            extreme[2 * i] = 0;
+            extreme[2 * i + 1] = (char)(i % 2 ? 0x80 : 0x7F);
+        }
+        FrameFeatures expected = AnalyzeFrameWithKernel(VadKernel::Scalar, extreme.data(), extreme.size() / 2);
+        FrameFeatures actual = AnalyzeFrameWithKernel(kernel, extreme.data(), extreme.size() / 2);
+        same = same && actual.sumSquares == expected.sumSquares && actual.zeroCrossings == expected.zeroCrossings;
+        if (!same) {
+            std::printf("%-10s features differ from scalar\n", VadKernelName(kernel));
+            ok = false;
+            continue;
+        }
+
+        volatile long long sink = 0;
+        double ms = MeasureMs([&]() {
+            long long sum = 0;
+            for (size_t f = 0; f < frames; ++f) {
+                FrameFeatures features = AnalyzeFrameWithKernel(kernel, pcm.data() + f * FRAME_BYTES, FRAME_BYTES / 2);
+                sum += features.sumSquares + features.zeroCrossings;
+            }
+            sink = sum;
+        });
+        double framesPerSecond = frames / (ms / 1000.0);
+        std::printf("%-10s %14.0f %12.0f\n", VadKernelName(kernel), framesPerSecond, framesPerSecond * FRAME_MS / 1000.0);
+    }
+
+    double detectorMs = MeasureMs([&]() {
+        VoiceActivityDetector detector;
+        for (size_t offset = 0; offset < pcm.size(); offset += 4096) {
+            detector.feed(pcm.data() + offset, (std::min)((size_t)4096, pcm.size() - offset));
+        }
+    });
+    std::printf("detector: %.1f MB/s, %.1f us per second of audio\n", ThroughputMBps(pcm.size(), detectorMs),
+                detectorMs * 1000.0 / ((double)pcm.size() / SPEECH_BYTES_PER_SECOND));
+    return ok;
+}
+
+// 不加留白时检测到的范围应覆盖所有语句（含清辅音），且不多出明显的静音；没有语音的样本应为空
+static bool CheckRange(const SpeechClip& clip) {
+    VadOptions tight;
+    tight.leadPadMs = 0;
+    tight.trailPadMs = 0;
+    SpeechRange range = FindSpeechRange(clip.pcm.data(), clip.pcm.size(), tight);
+    if (clip.speech.empty()) return range.begin == range.end;
+    long long first = clip.speech.front().first;
+    long long last = clip.speech.back().second;
+    long long begin = (long long)range.begin;
+    long long end = (long long)range.end;
+    return begin <= first + EDGE_TOLERANCE && begin >= first - EDGE_TOLERANCE && end >= last - EDGE_TOLERANCE &&
+           end <= last + EDGE_TOLERANCE;
+}
+
+// 按录音设备的节奏（4096 字节一个缓冲区）送入，返回自动结束时已录下的字节数，不结束时为 0
+static size_t AutoStopPosition(const SpeechClip& clip) {
+    VoiceActivityDetector detector;
+    for (size_t offset = 0; offset < clip.pcm.size(); offset += 4096) {
+        size_t size = (std::min)((size_t)4096, clip.pcm.size() - offset);
+        detector.feed(clip.pcm.data() + offset, size);
+        if (detector.speechSeen() && detector.trailingSilenceMs() >= AUTO_STOP_MS) return offset + size;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    std::vector<SpeechClip> clips;
+    SpeechClipOptions quiet(8, 21);
+    clips.push_back(MakeClip("quiet room 8 s", quiet, 1.5, 2.0));
+
+    SpeechClipOptions fan(12, 22);
+    fan.noise = 120;
+    fan.lowFrequencyNoise = true;
+    fan.fricativeProbability = 0.6;
+    clips.push_back(MakeClip("fan noise 12 s", fan, 1.0, 3.0));
+
+    SpeechClipOptions hiss(10, 23);
+    hiss.fricativeProbability = 0.9;
+    clips.push_back(MakeClip("fricatives 10 s", hiss, 0.8, 1.0));
+
+    SpeechClipOptions forgot(6, 24);
+    clips.push_back(MakeClip("forgot to stop 6 s", forgot, 0.6, 25.0));
+
+    SpeechClipOptions immediate(20, 25);
+    clips.push_back(MakeClip("no lead-in 20 s", immediate, 0.0, 0.4));
+
+    SpeechClipOptions empty(0, 26);
+    empty.noise = 120;
+    empty.lowFrequencyNoise = true;
+    clips.push_back(MakeClip("no speech 5 s", empty, 5.0, 0));
+
+    const size_t syntheticClips = clips.size();
+    LoadSpeechWavs(argc, argv, clips);
+
+    SpeechClipOptions longOptions(60, 27);
+    bool ok = CheckKernels(MakeClip("dictation 60 s", longOptions, 0.3, 0).pcm);
+
+    // 裁剪：默认留白（前 250 ms、后 350 ms）下省下的字节
+    std::printf("\n%-22s %8s %8s %9s %7s %6s %10s\n", "clip", "audio s", "kept s", "saved KB", "saved", "range",
+                "auto-stop");
+    size_t totalBytes = 0;
+    size_t totalSaved = 0;
+    for (size_t i = 0; i < clips.size(); ++i) {
+        const SpeechClip& clip = clips[i];
+        std::vector<char> trimmed(clip.pcm);
+        size_t saved = TrimSilence(trimmed);
+        totalBytes += clip.pcm.size();
+        totalSaved += saved;
+
+        bool clipOk = true;
+        const char* rangeStatus = "-";
+        char stopStatus[32] = "-";
+        if (i < syntheticClips) {
+            clipOk = CheckRange(clip);
+            rangeStatus = clipOk ? "ok" : "BAD";
+
+            // 自动结束：结尾静音够长时应在最后一句之后 AUTO_STOP_MS 左右结束，否则（含没有语音的样本）不结束
+            size_t stop = AutoStopPosition(clip);
+            long long speechEnd = clip.speech.empty() ? 0 : clip.speech.back().second;
+            long long expected = speechEnd + (long long)AUTO_STOP_MS * SPEECH_BYTES_PER_SECOND / 1000;
+            bool shouldStop = !clip.speech.empty() && (long long)clip.pcm.size() >= expected + 4096 + EDGE_TOLERANCE;
+            if (stop > 0) {
+                long long lateMs = ((long long)stop - expected) * 1000 / SPEECH_BYTES_PER_SECOND;
+                std::snprintf(stopStatus, sizeof(stopStatus), "%+lld ms", lateMs);
+                // 提前不超过容差，推迟不超过一个缓冲区加容差
+                clipOk = clipOk && shouldStop && (long long)stop >= expected - EDGE_TOLERANCE &&
+                         (long long)stop <= expected + 4096 + EDGE_TOLERANCE;
+            } else {
+                std::snprintf(stopStatus, sizeof(stopStatus), "none");
+                clipOk = clipOk && !shouldStop;
+            }
+        }
+        std::printf("%-22.22s %8.1f %8.1f %9.0f %6.1f%% %6s %10s\n", clip.name.c_str(),
+                    (double)clip.pcm.size() / SPEECH_BYTES_PER_SECOND, (double)trimmed.size() / SPEECH_BYTES_PER_SECOND,
+                    saved / 1024.0, clip.pcm.empty() ? 0.0 : 100.0 * saved / clip.pcm.size(), rangeStatus, stopStatus);
+        if (!clipOk) std::printf("  FAILED: %s\n", clip.name.c_str());
+        ok = ok && clipOk;
+    }
+    std::printf("total: %.0f KB of %.0f KB saved (%.1f%%)\n", totalSaved / 1024.0, totalBytes / 1024.0,
+                totalBytes > 0 ? 100.0 * totalSaved / totalBytes : 0.0);
+
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -3,18 +3,30 @@
 
 #include <windows.h>
 #include <shellapi.h>
+#include <memory>
 #include <string>
+#include "InputDispatcher.h"
+#include "NotificationQueue.h"
 
 // 托盘消息常量
 #define WM_TRAYICON (WM_USER + 1)
+// 提示队列有新消息，主线程取出显示
+#define WM_SHOWTOAST (WM_USER + 2)
 #define ID_TRAY_EXIT 1001
 #define ID_TRAY_ABOUT 1002
 #define ID_TRAY_AUTOSTART 1003
+#define ID_TRAY_TILED_OCR 1004
+#define ID_TRAY_LOCAL_OCR 1005
+#define ID_TRAY_HEDGING 1006
+#define ID_TRAY_STREAMING_ASR 1007
+#define ID_TRAY_AUTO_STOP 1008
+#define ID_TRAY_FLAC_UPLOAD 1009
+#define ID_TRAY_PREPROCESS 1010
 
 class HotkeyManager;
 class ScreenCapture;
 class VoiceRecognizer;
-class ToastWindow;
+class ToastSink;
 
 class AppManager {
 public:
@@ -24,6 +36,10 @@ public:
     void run();
     void showToast(const std::string& message, int duration = 2000);
     void exitApplication();
+    
+    // 组件报告按键状态的变化（遮罩窗口出现/关闭、录音开始/结束、语音识别进行中），任意线程可调用
+    void changeInputMode(InputMode from, InputMode to);
+    void setRecognizing(bool recognizing);
 
     // 公共访问组件（供HotkeyManager使用）
     ScreenCapture* screenCapture;
@@ -37,6 +53,12 @@ private:
     // 功能组件
     HotkeyManager* hotkeyManager;
     
+    // 所有提示共用一个窗口，队列负责合并与替换；队列先于窗口析构
+    std::unique_ptr<ToastSink> toastSink;
+    std::unique_ptr<NotificationQueue> notifications;
+    void pumpToasts();
+    void dismissToast();
+    
     static AppManager* instance;
     
     // 托盘相关方法
@@ -49,6 +71,10 @@ private:
     void setAutoStart(bool enable);
     void toggleAutoStart();
     
+    // 截图识别与语音识别的请求对冲一起开关
+    bool isHedgingEnabled() const;
+    void setHedgingEnabled(bool enabled);
+    
     static LRESULT CALLBACK HiddenWindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
     
     friend class HotkeyManager;
@@ -0,0 +1,46 @@
+#ifndef ASRCLIENT_H
+#define ASRCLIENT_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+// 有道语音识别接口的响应解析，语音输入与基准程序共用
+
+struct AsrResult {
+    bool parsed;                        // 响应是完整有效的 JSON
+    std::string errorCode;              // 接口错误码，"0" 为成功；响应中没有时为空
+    std::vector<std::string> sentences; // result[] 中的各句
+    std::string text;                   // 各句以空格连接
+
+    AsrResult() : parsed(false) {}
+};
+
+// 只取顶层的 errorCode（字符串或数字）与 result 数组，句子中的括号、引号与 \u 转义都按 JSON 处理
+AsrResult ParseAsrResponse(const std::string& response);
+
+// 以 FLAC 上传的响应是否表示服务商不接受：成功与“未识别到语音”（4304）都不算
+bool IsAsrAudioRejected(const AsrResult& result);
+
+// 上传音频格式的选择。服务商是否接受 FLAC 由配置声明（有道接口未公开支持，默认关闭）；
+// 声明接受但 FLAC 请求被拒、改传 WAV 成功后，本次运行不再尝试 FLAC，免得每次请求都先失败一次
+class AsrAudioFormat {
+public:
+    explicit AsrAudioFormat(bool flacAccepted = false) : flacAccepted(flacAccepted), flacRejected(false) {}
+
+    bool useFlac() const { return flacAccepted && !flacRejected; }
+    bool isFlacAccepted() const { return flacAccepted; }
+    bool isFlacRejected() const { return flacRejected; }
+    // 重新打开时再给 FLAC 一次机会
+    void setFlacAccepted(bool accepted) {
+        flacAccepted = accepted;
+        if (accepted) flacRejected = false;
+    }
+    void reportFlacRejected() { flacRejected = true; }
+
+private:
+    std::atomic<bool> flacAccepted;
+    std::atomic<bool> flacRejected;
+};
+
+#endif // ASRCLIENT_H
@@ -0,0 +1,24 @@
+#ifndef AUDIOFORMAT_H
+#define AUDIOFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 44 字节的 PCM WAV 文件头（RIFF + fmt + data 块头），数据部分由调用方紧随其后发送
+std::string BuildWavHeader(int sampleRate, int channels, int bitsPerSample, uint32_t dataBytes);
+
+struct WavInfo {
+    int sampleRate;
+    int channels;
+    int bitsPerSample;
+    size_t dataOffset;      // data 块内容在文件中的偏移
+    size_t dataBytes;       // 截到文件末尾为止的实际长度
+
+    WavInfo() : sampleRate(0), channels(0), bitsPerSample(0), dataOffset(0), dataBytes(0) {}
+};
+
+// 解析 PCM WAV 文件（录音样本、基准程序的音频夹具），跳过 fmt 与 data 以外的块；不是 PCM WAV 时返回 false
+bool ParseWav(const unsigned char* data, size_t size, WavInfo& info);
+
+#endif // AUDIOFORMAT_H
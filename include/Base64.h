@@ -0,0 +1,35 @@
+#ifndef BASE64_H
+#define BASE64_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 可用的编码内核（运行时按 CPU 能力自动选择，基准测试时可手动指定）
+enum class Base64Kernel {
+    Scalar,
+    Ssse3,
+    Avx2,
+    Neon
+};
+
+// 编码后的精确长度（含 '=' 填充）
+inline size_t Base64EncodedLength(size_t inputLength) {
+    return (inputLength + 2) / 3 * 4;
+}
+
+// 将 data 编码写入 out，out 至少需要 Base64EncodedLength(size) 字节，返回写入字节数
+size_t Base64Encode(const unsigned char* data, size_t size, char* out);
+
+std::string Base64Encode(const unsigned char* data, size_t size);
+std::string Base64Encode(const std::vector<unsigned char>& data);
+
+// 指定内核编码（内核不可用时退回标量实现）
+size_t Base64EncodeWithKernel(Base64Kernel kernel, const unsigned char* data, size_t size, char* out);
+bool Base64KernelSupported(Base64Kernel kernel);
+
+// 当前自动选择的内核及其名称
+Base64Kernel Base64ActiveKernel();
+const char* Base64KernelName(Base64Kernel kernel);
+
+#endif // BASE64_H
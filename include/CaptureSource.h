@@ -0,0 +1,36 @@
+#ifndef CAPTURESOURCE_H
+#define CAPTURESOURCE_H
+
+#include <memory>
+
+// 截图得到的像素视图：BGRA，自上而下，stride 为每行字节数。
+// 内存归采集源所有，在下一次 capture 或采集源销毁前有效
+struct PixelBufferView {
+    const unsigned char* pixels;
+    int width;
+    int height;
+    int stride;
+    int dpi;        // 像素来源的 DPI，供预处理按比例缩小
+
+    PixelBufferView() : pixels(nullptr), width(0), height(0), stride(0), dpi(96) {}
+};
+
+// 截图来源：GDI（Windows）、XShm（Linux X11）或文件回放。
+// 实现不是线程安全的：多个线程共用一个采集源时由调用方加锁，并在下一次截图前用完或复制像素
+class CaptureSource {
+public:
+    virtual ~CaptureSource() {}
+
+    // 截取 (x, y) 起 width x height 的区域，超出部分被裁掉；失败返回 false
+    virtual bool capture(int x, int y, int width, int height, PixelBufferView& view) = 0;
+
+    virtual const char* name() const = 0;
+};
+
+// 当前平台的屏幕采集源；没有可用实现（例如 Linux 上未连接 X 服务器）时返回空
+std::unique_ptr<CaptureSource> CreateScreenCaptureSource();
+
+// 把请求区域裁剪到 [0, limitWidth) x [0, limitHeight)，裁剪后为空返回 false
+bool ClipCaptureRegion(int& x, int& y, int& width, int& height, int limitWidth, int limitHeight);
+
+#endif // CAPTURESOURCE_H
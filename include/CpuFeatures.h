@@ -0,0 +1,31 @@
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+// 编译目标架构
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SHOTOCR_ARCH_X86 1
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define SHOTOCR_ARCH_ARM64 1
+#endif
+
+// GCC/Clang 需要为单个函数开启指令集，MSVC 可直接使用内建函数
+#if defined(__GNUC__) || defined(__clang__)
+#define SHOTOCR_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SHOTOCR_TARGET(isa)
+#endif
+
+// 运行时检测到的 CPU 特性（首次调用时检测并缓存）
+struct CpuFeatures {
+    bool sse2;
+    bool ssse3;
+    bool sse41;
+    bool avx2;
+    bool neon;
+};
+
+const CpuFeatures& GetCpuFeatures();
+
+#endif // CPUFEATURES_H
@@ -0,0 +1,79 @@
+#ifndef DEFLATE_H
+#define DEFLATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// 压缩级别：Fastest 只做游程与上一行匹配，适合大面积纯色的截图；
+// 其余级别使用哈希链，搜索深度依次增加
+enum class DeflateLevel {
+    Fastest,
+    Fast,
+    Default,
+    Best
+};
+
+// 流式 zlib (RFC 1950/1951) 压缩器，输出通过 sink 分段交付
+class DeflateEncoder {
+public:
+    typedef std::function<void(const unsigned char* data, size_t size)> Sink;
+
+    DeflateEncoder(DeflateLevel level, Sink sink);
+
+    // 提示数据中的“行”长度（PNG 每行含滤波字节），用于尝试与上一行同位置的匹配
+    void setRowDistance(size_t distance);
+
+    void write(const unsigned char* data, size_t size);
+    void finish();
+
+    // 已交付给 sink 的压缩字节数
+    size_t outputSize() const { return totalOutput; }
+
+private:
+    struct Symbol {
+        uint16_t litLen;   // 字面量 0-255，或匹配长度 3-258
+        uint16_t distance; // 0 表示字面量
+    };
+
+    DeflateLevel level;
+    Sink sink;
+    size_t rowDistance;
+    int maxChain;
+    int niceLength;
+    bool lazyMatching;
+
+    std::vector<unsigned char> window;  // 最近 32KB 历史 + 待压缩数据
+    size_t processed;                    // window 中已压缩的位置
+    size_t insertedUpTo;                 // 已插入哈希表的位置
+    std::vector<int32_t> head;
+    std::vector<int32_t> prev;
+    std::vector<Symbol> symbols;
+
+    uint32_t adler;
+    bool headerWritten;
+    bool finished;
+
+    // 输出位缓冲
+    uint64_t bitBuffer;
+    int bitCount;
+    std::vector<unsigned char> output;
+    size_t totalOutput;
+
+    void compressBlock(size_t end, bool final);
+    void findSymbols(size_t start, size_t end);
+    void insertHash(size_t pos, size_t end);
+    size_t longestMatch(size_t pos, size_t end, size_t& distance);
+    void slideWindow();
+
+    void emitBlock(size_t start, size_t end, bool final);
+    void writeBits(uint32_t value, int count);
+    void alignToByte();
+    void flushOutput();
+};
+
+// 一次性压缩为 zlib 数据
+std::vector<unsigned char> ZlibCompress(const unsigned char* data, size_t size, DeflateLevel level);
+
+#endif // DEFLATE_H
@@ -0,0 +1,121 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 进程内共用的线程池：按键事件、识别任务等不再每次新建线程。
+// CPU 池（编码、本地识别）线程数与核数相同，每个线程一个队列，空闲时从其他队列窃取任务；
+// I/O 池（网络请求、等待录音设备、截图选区的消息循环）线程数少而固定，共用一个先进先出队列。
+// 两个池的排队任务数都有上限：submit 在队列满时等待（背压），trySubmit 直接返回 false
+
+typedef std::function<void()> Task;
+
+struct ThreadPoolStats {
+    int workers;
+    size_t capacity;
+    long submitted;
+    long completed;
+    long rejected;          // trySubmit 因队列已满被拒绝
+    long blocked;           // submit 因队列已满等待过
+    long steals;            // 空闲线程从其他线程的队列取走的任务
+    size_t queueDepth;      // 当前排队（未开始执行）的任务数
+    size_t maxQueueDepth;
+    // 最近任务从入队到开始执行的等待时间，以及执行时间
+    double waitMeanMs, waitP99Ms;
+    double runMeanMs;
+
+    ThreadPoolStats()
+        : workers(0), capacity(0), submitted(0), completed(0), rejected(0), blocked(0), steals(0), queueDepth(0),
+          maxQueueDepth(0), waitMeanMs(0), waitP99Ms(0), runMeanMs(0) {}
+};
+
+class ThreadPool {
+public:
+    // capacity 为排队任务上限（不含正在执行的）；stealing 为 true 时每个线程一个队列，
+    // 本池线程提交的任务进自己的队列（后进先出，数据还在缓存里），空闲线程从其他队列的另一端窃取
+    ThreadPool(const std::string& name, int workers, size_t capacity, bool stealing);
+    // 执行完已排队的任务后退出
+    ~ThreadPool();
+
+    // 池已停止时返回 false
+    bool submit(const Task& task);
+    bool trySubmit(const Task& task);
+    // 在池中执行 task 并等它完成；从本池的线程调用时直接执行，避免池内互相等待
+    void run(const Task& task);
+
+    bool isWorkerThread() const;
+    const std::string& name() const { return poolName; }
+    ThreadPoolStats stats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    struct Entry {
+        Task task;
+        Clock::time_point enqueued;
+    };
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Entry> entries;
+    };
+
+    std::string poolName;
+    size_t capacity;
+    bool stealing;
+    std::vector<std::unique_ptr<WorkerQueue> > queues;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> nextQueue;
+
+    // 排队计数、停止标志与统计由 mutex 保护；顺序为 mutex -> 队列锁
+    mutable std::mutex mutex;
+    std::condition_variable available;
+    std::condition_variable space;
+    size_t queued;
+    bool stopping;
+    ThreadPoolStats counters;
+    std::vector<double> waits;      // 环形缓冲，最近的等待时间
+    size_t waitNext;
+    double waitTotalMs;
+    double runTotalMs;
+
+    void enqueueLocked(const Task& task);
+    bool takeEntry(size_t self, Entry& entry, bool& stolen);
+    void workerLoop(size_t index);
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+};
+
+class Executor {
+public:
+    // 0 表示默认线程数：CPU 池为核数，I/O 池为 8
+    explicit Executor(int cpuWorkers = 0, int ioWorkers = 0);
+
+    ThreadPool& cpu() { return *cpuPool; }
+    ThreadPool& io() { return *ioPool; }
+    // 创建两个池（启动全部线程）的耗时
+    double startupMs() const { return startup; }
+
+private:
+    std::unique_ptr<ThreadPool> cpuPool;
+    std::unique_ptr<ThreadPool> ioPool;
+    double startup;
+
+    Executor(const Executor&);
+    Executor& operator=(const Executor&);
+};
+
+// 进程内共用的执行器，第一次使用时创建
+Executor& SharedExecutor();
+
+std::string DescribeThreadPoolStats(const std::string& name, const ThreadPoolStats& stats);
+
+#endif // EXECUTOR_H
@@ -0,0 +1,41 @@
+#ifndef FILEREPLAYCAPTURESOURCE_H
+#define FILEREPLAYCAPTURESOURCE_H
+
+#include "CaptureSource.h"
+#include <string>
+#include <vector>
+
+// 从文件回放截图帧，用于在没有显示器的机器上跑完整的 截图 -> 编码 -> 上传 流程。
+// 每次 capture 返回下一帧（循环）中请求的区域；width/height <= 0 表示整帧
+class FileReplayCaptureSource : public CaptureSource {
+public:
+    explicit FileReplayCaptureSource(int dpi = 96);
+
+    // 支持二进制 PPM（P6，maxval 255）与原始 BGRA；原始文件需在文件名中给出尺寸，如 frame_1920x1080.bgra
+    bool addFile(const std::string& path);
+    bool addRawFile(const std::string& path, int width, int height);
+    void addFrame(int width, int height, const std::vector<unsigned char>& bgra);
+
+    size_t frameCount() const { return frames.size(); }
+    // 下一次 capture 返回的帧
+    void rewind() { nextFrame = 0; }
+
+    bool capture(int x, int y, int width, int height, PixelBufferView& view) override;
+    const char* name() const override { return "replay"; }
+
+private:
+    struct Frame {
+        int width;
+        int height;
+        std::vector<unsigned char> bgra;
+    };
+
+    std::vector<Frame> frames;
+    size_t nextFrame;
+    int dpi;
+};
+
+// 读取二进制 PPM (P6) 为 BGRA
+bool LoadPpmAsBgra(const std::string& path, int& width, int& height, std::vector<unsigned char>& bgra);
+
+#endif // FILEREPLAYCAPTURESOURCE_H
@@ -0,0 +1,59 @@
+#ifndef FLACCODEC_H
+#define FLACCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// FLAC 无损压缩：服务商接受时录音以 FLAC 上传，体积约为 WAV 的一半。
+// 只实现语音输入用到的格式：单声道、16 位、固定块长。每块在常量、固定多项式预测（0~4 阶）
+// 与 LPC 预测之间按编码后的位数选择，都不划算时原样存放；残差用分区 Rice 编码。
+// 不计算 STREAMINFO 中的 MD5（全 0 表示未计算，解码器不做校验）
+
+struct FlacOptions {
+    int blockSize;              // 每帧的样本数
+    int maxLpcOrder;            // LPC 的最高阶数（不超过 32），0 时只用固定预测，最快
+    int qlpPrecision;           // LPC 系数的量化位数
+    int maxPartitionOrder;      // Rice 分区的最高阶数（不超过 8）
+
+    FlacOptions() : blockSize(4096), maxLpcOrder(8), qlpPrecision(12), maxPartitionOrder(6) {}
+};
+
+struct FlacEncodeStats {
+    size_t pcmBytes;
+    size_t flacBytes;
+    size_t frames;
+    size_t constantSubframes;   // 整块同一个值（数字静音）
+    size_t fixedSubframes;
+    size_t lpcSubframes;
+    size_t verbatimSubframes;   // 预测不划算（噪声），原样存放
+    double encodeMs;
+
+    FlacEncodeStats()
+        : pcmBytes(0), flacBytes(0), frames(0), constantSubframes(0), fixedSubframes(0), lpcSubframes(0),
+          verbatimSubframes(0), encodeMs(0) {}
+};
+
+// 编码 16 位单声道小端 PCM（字节数为奇数时忽略最后一个字节），返回完整的 .flac 文件内容
+std::string EncodeFlac(const char* pcm, size_t bytes, int sampleRate, const FlacOptions& options = FlacOptions(),
+                       FlacEncodeStats* stats = nullptr);
+
+struct FlacStreamInfo {
+    int sampleRate;
+    int channels;
+    int bitsPerSample;
+    uint64_t totalSamples;
+    int minBlockSize;
+    int maxBlockSize;
+
+    FlacStreamInfo() : sampleRate(0), channels(0), bitsPerSample(0), totalSamples(0), minBlockSize(0), maxBlockSize(0) {}
+};
+
+// 解码为 16 位小端 PCM（基准程序校验往返用）。支持单声道、不超过 16 位的流，校验每帧的 CRC；
+// 格式不支持或数据损坏时返回 false
+bool DecodeFlac(const unsigned char* data, size_t size, FlacStreamInfo& info, std::vector<char>& pcm);
+
+std::string DescribeFlacEncode(const FlacEncodeStats& stats);
+
+#endif // FLACCODEC_H
@@ -0,0 +1,23 @@
+#ifndef FORMENCODER_H
+#define FORMENCODER_H
+
+#include <cstddef>
+#include <string>
+
+// application/x-www-form-urlencoded 编码（表驱动，非保留字符原样输出，其余转为 %XX）
+
+// 编码后的精确长度
+size_t FormUrlEncodedLength(const char* data, size_t size);
+
+// 编码写入 out（至少 FormUrlEncodedLength 字节），返回写入结束位置
+char* FormUrlEncode(const char* data, size_t size, char* out);
+
+void AppendFormUrlEncoded(std::string& out, const std::string& value);
+
+// base64 编码后再 URL 编码的精确长度（直接由输入字节计算，不做编码）
+size_t Base64FormEncodedLength(const unsigned char* data, size_t size);
+
+// 单遍完成 base64 + URL 编码，直接写入 out（至少 Base64FormEncodedLength 字节），返回写入结束位置
+char* WriteBase64FormEncoded(const unsigned char* data, size_t size, char* out);
+
+#endif // FORMENCODER_H
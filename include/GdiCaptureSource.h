@@ -0,0 +1,30 @@
+#ifndef GDICAPTURESOURCE_H
+#define GDICAPTURESOURCE_H
+
+#include <windows.h>
+#include "CaptureSource.h"
+
+// GDI 截图：BitBlt 到 32 位自上而下的 DIB Section。
+// DIB 只在请求区域超出现有容量时重建，较小的截图复用同一块内存（stride 取容量宽度）
+class GdiCaptureSource : public CaptureSource {
+public:
+    GdiCaptureSource();
+    ~GdiCaptureSource();
+
+    bool capture(int x, int y, int width, int height, PixelBufferView& view) override;
+    const char* name() const override { return "gdi"; }
+
+private:
+    HDC screenDC;
+    HDC memDC;
+    HBITMAP bitmap;
+    HBITMAP oldBitmap;
+    void* bits;
+    int capacityWidth;
+    int capacityHeight;
+
+    bool ensureCapacity(int width, int height);
+    void releaseBitmap();
+};
+
+#endif // GDICAPTURESOURCE_H
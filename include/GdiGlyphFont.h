@@ -0,0 +1,10 @@
+#ifndef GDIGLYPHFONT_H
+#define GDIGLYPHFONT_H
+
+#include "LocalOcr.h"
+
+// 用 GDI 渲染本地识别的模板：face 为字体名（如 L"Segoe UI"），pixelHeight 为字符高度（像素）。
+// 系统没有该字体（被替换成别的字体）时返回 false
+bool RenderGdiGlyphFont(const wchar_t* face, int pixelHeight, const std::string& name, GlyphFont& font);
+
+#endif // GDIGLYPHFONT_H
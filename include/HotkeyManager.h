@@ -2,6 +2,7 @@
 #define HOTKEYMANAGER_H
 
 #include <windows.h>
+#include "InputDispatcher.h"
 
 class AppManager;
 
@@ -12,17 +13,25 @@ public:
     
     void startListening();
     void stopListening();
+    
+    // 组件通过它报告截图、录音、识别状态的变化
+    InputDispatcher& input() { return dispatcher; }
 
 private:
     AppManager* appManager;
     HHOOK keyboardHook;
     HHOOK mouseHook;  // 新增：鼠标钩子
+    // 钩子只向它投递按键，动作在其分发线程中执行
+    InputDispatcher dispatcher;
     
     static HotkeyManager* instance;
     static LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam);
     static LRESULT CALLBACK LowLevelMouseProc(int nCode, WPARAM wParam, LPARAM lParam);  // 新增：鼠标钩子处理函数
     
-    bool isCtrlShiftPressed();
+    static bool isCtrlShiftPressed();
+    void handleInput(const InputEvent& event);
+    // 热键触发时在后台预先连接识别接口
+    static void prewarmConnection();
 };
 
 #endif // HOTKEYMANAGER_H
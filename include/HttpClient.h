@@ -0,0 +1,101 @@
+#ifndef HTTPCLIENT_H
+#define HTTPCLIENT_H
+
+#include "RequestBody.h"
+#include "Socket.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+
+// 平台无关的 HTTP/1.1 客户端（BSD 套接字 / Winsock），只支持明文 http://。
+// Windows 程序访问 https 接口仍走 WinINet；此客户端用于 Linux 上的批处理与本地替身服务器
+
+struct HttpUrl {
+    std::string scheme;
+    std::string host;
+    int port;
+    std::string path;       // 含查询串，至少为 "/"
+
+    HttpUrl() : port(80), path("/") {}
+};
+
+// 解析 http://host[:port][/path]，失败返回 false
+bool ParseHttpUrl(const std::string& url, HttpUrl& out);
+
+struct HttpResponse {
+    int status;             // 0 表示没有收到响应
+    std::string body;
+    std::string error;      // 传输层错误描述，成功时为空
+    bool keepAlive;         // 服务器允许复用连接
+
+    HttpResponse() : status(0), keepAlive(false) {}
+};
+
+// 增量解析响应：支持 Content-Length、chunked 与读到连接关闭三种分帧方式
+class HttpResponseParser {
+public:
+    HttpResponseParser();
+
+    // 送入收到的数据，返回本次消费的字节数；complete() 后剩余字节不再消费
+    size_t feed(const char* data, size_t size);
+    // 连接被对端关闭；以“读到关闭”分帧的响应由此结束
+    void finishOnClose();
+
+    bool complete() const { return state == STATE_DONE; }
+    bool failed() const { return state == STATE_ERROR; }
+    const std::string& errorMessage() const { return error; }
+
+    // 完成后取出结果
+    void takeResponse(HttpResponse& response);
+
+private:
+    enum State {
+        STATE_HEADERS,
+        STATE_BODY_LENGTH,
+        STATE_CHUNK_SIZE,
+        STATE_CHUNK_DATA,
+        STATE_CHUNK_DATA_END,
+        STATE_TRAILERS,
+        STATE_BODY_UNTIL_CLOSE,
+        STATE_DONE,
+        STATE_ERROR
+    };
+
+    State state;
+    std::string line;           // 未完成的头部行 / 块大小行
+    std::string headerBlock;
+    int status;
+    bool keepAlive;
+    size_t remaining;
+    std::string body;
+    std::string error;
+
+    bool parseHeaders();
+    void fail(const std::string& message);
+};
+
+// 在已连接的套接字上写出请求行、请求头与请求体；keepAlive 为 false 时附带 Connection: close
+bool WriteHttpRequest(SocketHandle socket, const char* method, const HttpUrl& url, const std::string& headers,
+                      const RequestBody& body, bool keepAlive);
+
+// 只写出请求行与请求头；contentLength < 0 时使用 chunked 传输编码
+bool WriteHttpRequestHead(SocketHandle socket, const char* method, const HttpUrl& url, const std::string& headers,
+                          long long contentLength, bool keepAlive);
+
+// 流式请求体：边产生边通过 write 写出，写出失败或产生失败时返回 false。不可重放
+typedef std::function<bool(const RequestBody::Writer& write)> BodyStream;
+
+// 写出流式请求体。contentLength < 0 时每次写出包装为一个 chunk 并以零长度块结束；
+// 否则原样写出并核对总字节数
+bool WriteStreamBody(SocketHandle socket, const BodyStream& stream, long long contentLength);
+
+// 读取一个完整响应。closedBeforeResponse 表示连接在收到任何响应字节前被关闭或重置（而非超时），
+// 复用的连接失效时据此判断能否安全重发
+bool ReadHttpResponse(SocketHandle socket, HttpResponse& response, bool& closedBeforeResponse);
+
+// 发送一个 POST 请求并读取完整响应（每次新建连接并在结束后关闭；需要复用连接时用 HttpConnectionPool）。
+// headers 为以 \r\n 结尾的附加请求头；返回 false 时 response.error 给出原因
+bool HttpPost(const HttpUrl& url, const std::string& headers, const RequestBody& body,
+              int timeoutMs, HttpResponse& response);
+
+#endif // HTTPCLIENT_H
@@ -0,0 +1,91 @@
+#ifndef HTTPCONNECTIONPOOL_H
+#define HTTPCONNECTIONPOOL_H
+
+#include "HttpClient.h"
+#include "Socket.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class RequestCancel;
+
+// 按 host:port 缓存 keep-alive 连接的 HTTP/1.1 客户端，可被多个线程同时使用。
+// 连接只在一个请求完成、服务器允许复用时放回池中；借出前检查空闲时长与对端是否已关闭
+
+struct HttpPoolOptions {
+    int connectTimeoutMs;
+    int requestTimeoutMs;   // 单次收发的超时
+    int idleTimeoutMs;      // 空闲超过此时长的连接直接关闭，应短于服务器的 keep-alive 超时
+    int maxIdlePerHost;     // 为 0 时不复用连接（每个请求带 Connection: close）
+
+    HttpPoolOptions() : connectTimeoutMs(10000), requestTimeoutMs(30000), idleTimeoutMs(30000), maxIdlePerHost(8) {}
+};
+
+struct HttpPoolStats {
+    long requests;
+    long connectionsOpened;     // 新建的 TCP 连接数，即握手次数
+    long connectionsReused;
+    long staleRetries;          // 复用连接已被对端关闭、换新连接重发的次数
+    long idleEvicted;           // 因超时或对端关闭而丢弃的空闲连接
+    long prewarmed;             // preconnect 新建并放入池中的连接
+    long prewarmUsed;           // 其中被请求用上的
+    long prewarmExpired;        // 其中未被使用就超时或被对端关闭的
+
+    HttpPoolStats() : requests(0), connectionsOpened(0), connectionsReused(0), staleRetries(0), idleEvicted(0),
+                      prewarmed(0), prewarmUsed(0), prewarmExpired(0) {}
+};
+
+class HttpConnectionPool {
+public:
+    explicit HttpConnectionPool(const HttpPoolOptions& options = HttpPoolOptions());
+    ~HttpConnectionPool();
+
+    // 发送 POST 并读取完整响应；返回 false 时 response.error 给出原因。
+    // cancel 非空时可从其他线程中断请求（中断的连接不放回池中）
+    bool post(const HttpUrl& url, const std::string& headers, const RequestBody& body, HttpResponse& response,
+              RequestCancel* cancel = nullptr);
+
+    // 发送流式请求体（contentLength < 0 时用 chunked 编码）。请求体不可重放，复用连接失效时不重发
+    bool postStream(const HttpUrl& url, const std::string& headers, long long contentLength,
+                    const BodyStream& stream, HttpResponse& response);
+
+    // 预先建立一条到 url 所在主机的连接放入池中，供随后的请求复用（阻塞到连接完成，应在后台线程调用）。
+    // 池中已有尚未使用的预热连接时不再新建；返回池中是否有预热连接
+    bool preconnect(const HttpUrl& url);
+
+    // 关闭所有空闲连接
+    void closeIdle();
+
+    HttpPoolStats stats() const;
+    const HttpPoolOptions& options() const { return poolOptions; }
+
+private:
+    struct IdleConnection {
+        SocketHandle socket;
+        std::chrono::steady_clock::time_point idleSince;
+        bool warm;          // 预热后尚未被请求使用
+    };
+
+    HttpPoolOptions poolOptions;
+    mutable std::mutex mutex;
+    std::map<std::string, std::vector<IdleConnection> > idle;
+    HttpPoolStats counters;
+
+    HttpConnectionPool(const HttpConnectionPool&);
+    HttpConnectionPool& operator=(const HttpConnectionPool&);
+
+    // 取一条可用的空闲连接（allowReuse 为 false 时总是新建）；reused 表示是否来自池中
+    SocketHandle acquire(const HttpUrl& url, bool allowReuse, bool& reused, std::string& error);
+    void release(const std::string& key, SocketHandle socket);
+    // 调用方持有 mutex；把超时的空闲连接移到 expired 中，在锁外关闭
+    void collectExpired(std::chrono::steady_clock::time_point now, std::vector<SocketHandle>& expired);
+    // 调用方持有 mutex；记录一条空闲连接被丢弃
+    void countEvicted(const IdleConnection& connection);
+};
+
+// 进程内共用的连接池，OCR 与语音识别请求都通过它复用连接
+HttpConnectionPool& SharedHttpConnectionPool();
+
+#endif // HTTPCONNECTIONPOOL_H
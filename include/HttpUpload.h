@@ -0,0 +1,83 @@
+#ifndef HTTPUPLOAD_H
+#define HTTPUPLOAD_H
+
+#include <windows.h>
+#include <wininet.h>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include "RequestBody.h"
+
+class RequestCancel;
+
+// 用 HttpSendRequestEx + InternetWriteFile 按片段发送请求体，不在内存中拼接完整负载。
+// headers 为以 \r\n 结尾的附加请求头；成功后可直接用 InternetReadFile 读取响应
+bool SendRequestBody(HINTERNET request, const std::string& headers, const RequestBody& body);
+
+// 有道接口所在主机，截图识别、语音识别与热键预连接共用
+const char YOUDAO_API_HOST[] = "aidemo.youdao.com";
+
+// 进程内共用的 WinINet 会话，OCR 与语音识别请求都通过它发送。
+// InternetOpen 只调用一次并按服务器缓存 InternetConnect 句柄，WinINet 在同一会话内复用
+// keep-alive 连接（含 TLS 会话），空闲连接由 WinINet 按其 keep-alive 超时关闭
+class WinInetSession {
+public:
+    static WinInetSession& instance();
+
+    // 连接、发送、接收超时（毫秒），对之后的请求生效
+    void setTimeouts(DWORD connectMs, DWORD sendMs, DWORD receiveMs);
+
+    // 发送 POST 并读完响应体（读完后连接才会回到 WinINet 的连接池）；传输失败返回 false。
+    // cancel 非空时可从其他线程关闭请求句柄来中断请求（WinINet 中止阻塞调用的方式）
+    bool post(const char* host, INTERNET_PORT port, const char* path, bool secure,
+              const std::string& headers, const RequestBody& body, std::string& response,
+              RequestCancel* cancel = nullptr);
+
+    // 请求体由 stream 边生成边写出，以 chunked 格式发送（长度事先未知）。
+    // 传输失败或服务器拒绝（状态码 >= 400，如不支持分块请求的 411）返回 false，response 中为已收到的响应体。
+    // status 非空时返回响应的状态码，没有收到响应（连接或传输失败）时为 0
+    typedef std::function<bool(const RequestBody::Writer& write)> BodyWriter;
+    bool postStream(const char* host, INTERNET_PORT port, const char* path, bool secure,
+                    const std::string& headers, const BodyWriter& stream, std::string& response,
+                    RequestCancel* cancel = nullptr, DWORD* status = nullptr);
+
+    // 预连接：发一个 HEAD 请求完成 DNS 解析、TCP 与 TLS 握手，连接留在 WinINet 的连接池中。
+    // 阻塞到握手完成，应在后台线程调用
+    bool prewarm(const char* host, INTERNET_PORT port, bool secure);
+
+    // 建立过的 TCP 连接数（https 下即 TLS 握手次数）与请求数，用于观察连接复用
+    long connectionCount() const { return connections; }
+    long requestCount() const { return requests; }
+    // 预连接次数；之后的第一个请求没有新建连接记为用上，新建了连接记为过期
+    long prewarmCount() const { return prewarms; }
+    long prewarmUsedCount() const { return prewarmUsed; }
+    long prewarmExpiredCount() const { return prewarmExpired; }
+
+private:
+    HINTERNET session;
+    std::mutex mutex;
+    std::map<std::string, HINTERNET> servers;
+    std::atomic<long> connections;
+    std::atomic<long> requests;
+    std::atomic<long> prewarms;
+    std::atomic<long> prewarmUsed;
+    std::atomic<long> prewarmExpired;
+    std::atomic<bool> prewarmPending;
+
+    WinInetSession();
+    ~WinInetSession();
+    WinInetSession(const WinInetSession&);
+    WinInetSession& operator=(const WinInetSession&);
+
+    HINTERNET connectHandle(const char* host, INTERNET_PORT port);
+    HINTERNET openRequest(const char* host, INTERNET_PORT port, const char* verb, const char* path, bool secure);
+    // 读完响应体、关闭请求句柄并更新预连接统计；句柄已被 cancel 关闭时不再关闭
+    void finishRequest(HINTERNET request, long requestIndex, bool sent, std::string& response,
+                       RequestCancel* cancel = nullptr, int cancelId = 0);
+    static void CALLBACK statusCallback(HINTERNET handle, DWORD_PTR context, DWORD status,
+                                        LPVOID info, DWORD infoLength);
+};
+
+#endif // HTTPUPLOAD_H
@@ -0,0 +1,91 @@
+#ifndef IMAGEANALYZER_H
+#define IMAGEANALYZER_H
+
+#include "PngEncoder.h"
+#include "ImagePreprocess.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 截图内容特征，编码前直接在原始 BGRA 像素上统计
+struct ContentStats {
+    int distinctColors;     // 不同颜色数，超过 256 时停止计数（记为 257）
+    bool isGray;            // 所有像素 R == G == B
+    double edgeDensity;     // 抽样行中亮度跳变（相邻差 > 32）的比例
+    double flatFraction;    // 抽样行中与左侧像素完全相同的比例
+    double entropy;         // 抽样亮度直方图的香农熵（位/像素）
+
+    ContentStats() : distinctColors(0), isGray(true), edgeDensity(0), flatFraction(0), entropy(0) {}
+};
+
+ContentStats AnalyzeContent(const unsigned char* bgra, int width, int height, int stride);
+
+enum class ImageFormat {
+    PngPalette,
+    PngGray,
+    PngRgb,
+    Jpeg
+};
+
+const char* ImageFormatName(ImageFormat format);
+
+// 选择策略的阈值
+struct FormatPolicy {
+    bool allowJpeg;             // 没有可用的 JPEG 编码器时关闭
+    int jpegQuality;
+    double photoMinEntropy;     // 亮度熵高于此值、平坦比例低于 photoMaxFlat 才视为照片
+    double photoMaxFlat;
+    double photoMaxEdgeDensity; // 锐利边缘过多的（彩色抗锯齿文字）仍用 PNG，避免 JPEG 振铃影响识别
+
+    FormatPolicy()
+        : allowJpeg(true), jpegQuality(85), photoMinEntropy(6.0), photoMaxFlat(0.5), photoMaxEdgeDensity(0.15) {}
+};
+
+struct FormatDecision {
+    ImageFormat format;
+    PngLevel pngLevel;
+    int jpegQuality;
+    std::string reason;
+
+    FormatDecision() : format(ImageFormat::PngRgb), pngLevel(PngLevel::Fast), jpegQuality(0) {}
+};
+
+// 按内容特征选择格式：照片 -> JPEG；预处理启用 -> 灰度；不超过 256 色 -> 调色板；纯灰 -> 灰度；其余 RGB。
+// PNG 压缩级别按像素数选择，小图用更高级别（耗时可忽略），大图优先速度
+FormatDecision ChooseImageFormat(const ContentStats& stats, int width, int height,
+                                 const FormatPolicy& policy, bool preprocessEnabled);
+
+// JPEG 编码由平台提供（Windows 上为 GDI+），失败时返回 false
+typedef std::function<bool(const unsigned char* bgra, int width, int height, int stride, int quality,
+                           std::vector<unsigned char>& out)> JpegEncodeFunc;
+
+struct AdaptiveEncodeResult {
+    FormatDecision decision;
+    ContentStats stats;
+    int width;              // 实际编码的尺寸（预处理可能缩小）
+    int height;
+    size_t encodedBytes;
+    double analyzeMs;
+    double encodeMs;
+
+    AdaptiveEncodeResult() : width(0), height(0), encodedBytes(0), analyzeMs(0), encodeMs(0) {}
+};
+
+// 分析、选择格式并编码；jpegEncoder 为空时不会选择 JPEG。out 为编码结果
+bool EncodeCaptureAdaptive(const unsigned char* bgra, int width, int height, int stride,
+                           const PreprocessOptions& preprocess, const FormatPolicy& policy,
+                           const JpegEncodeFunc& jpegEncoder, std::vector<unsigned char>& out,
+                           AdaptiveEncodeResult& result);
+
+// 流式版本：编码输出边产生边交给 sink（JPEG 整块给出）。pngBase 提供级别以外的 PNG 选项（如 IDAT 块大小）
+bool EncodeCaptureAdaptive(const unsigned char* bgra, int width, int height, int stride,
+                           const PreprocessOptions& preprocess, const FormatPolicy& policy,
+                           const JpegEncodeFunc& jpegEncoder, const PngOptions& pngBase,
+                           const PngEncoder::Sink& sink, AdaptiveEncodeResult& result);
+
+// 一行日志：格式、原因、特征与大小
+std::string DescribeEncodeResult(const AdaptiveEncodeResult& result);
+
+#endif // IMAGEANALYZER_H
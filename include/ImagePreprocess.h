@@ -0,0 +1,47 @@
+#ifndef IMAGEPREPROCESS_H
+#define IMAGEPREPROCESS_H
+
+#include "PngEncoder.h"
+#include <cstddef>
+#include <vector>
+
+// 上传前的预处理策略：灰度化、按 DPI 面积平均缩小、降低位深
+struct PreprocessOptions {
+    bool enabled;       // 启用后总是转为灰度（OCR 只需要亮度）
+    int sourceDpi;      // 截图所在屏幕的 DPI（通常为 96 * 缩放比例）
+    int targetDpi;      // 缩小到的目标 DPI，0 表示不缩放；只缩小不放大
+    int minHeight;      // 缩小后高度下限，避免小图被缩得无法识别
+    int bitDepth;       // 灰度位深：8/4/2/1，低于 8 时做量化
+
+    PreprocessOptions()
+        : enabled(false), sourceDpi(96), targetDpi(0), minHeight(24), bitDepth(8) {}
+};
+
+// 8 位灰度图
+struct GrayImage {
+    int width;
+    int height;
+    std::vector<unsigned char> pixels; // width * height，自上而下
+
+    GrayImage() : width(0), height(0) {}
+};
+
+// BGRA 转灰度（BT.601 权重，定点运算），按 CPU 能力选择 SSE2/NEON/标量实现
+void ConvertBgraToGray(const unsigned char* bgra, int width, int height, int stride, unsigned char* gray);
+
+// 面积平均缩小（每个目标像素取其覆盖的源像素按面积加权平均），只支持缩小
+GrayImage DownscaleGrayArea(const GrayImage& source, int targetWidth, int targetHeight);
+
+// 量化到 1/2/4 位并按 PNG 灰度格式打包（高位在前），返回打包后的行；
+// 1 位时使用 Otsu 阈值，其余位深均匀量化
+std::vector<unsigned char> PackGrayRows(const GrayImage& image, int bitDepth, size_t& rowBytes);
+
+// 按策略执行灰度化与缩放；返回 false 表示策略未启用或不适用，调用方应使用原图
+bool PreprocessCapture(const unsigned char* bgra, int width, int height, int stride,
+                       const PreprocessOptions& options, GrayImage& out);
+
+// 编码为灰度 PNG，bitDepth 为 8/4/2/1
+bool EncodePngGray(const GrayImage& image, int bitDepth, const PngOptions& pngOptions, std::vector<unsigned char>& out);
+bool EncodePngGray(const GrayImage& image, int bitDepth, const PngOptions& pngOptions, const PngEncoder::Sink& sink);
+
+#endif // IMAGEPREPROCESS_H
@@ -0,0 +1,141 @@
+#ifndef INPUTDISPATCHER_H
+#define INPUTDISPATCHER_H
+
+#include "SpscRing.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 低级键盘/鼠标钩子与后台分发线程之间的输入事件队列。
+// 钩子回调必须在系统的超时时间内返回，且要当场决定是否拦截按键：回调里只做一次查表与一次原子状态切换，
+// 需要执行的动作（开始截图、结束录音……）压入无锁环形队列后立即返回，由分发线程取出执行。
+// 状态（空闲、截图中、录音中）只由查表结果与组件的状态报告改变，钩子不再读取各组件的成员
+
+enum InputMode {
+    INPUT_IDLE,
+    INPUT_CAPTURING,    // 截图选区或识别进行中（遮罩窗口存在）
+    INPUT_RECORDING,
+    INPUT_MODE_COUNT
+};
+
+// 钩子按下的键分类后查表
+enum InputKey {
+    INPUT_KEY_OTHER,
+    INPUT_KEY_MODIFIER,         // Ctrl、Shift、Alt
+    INPUT_KEY_ESCAPE,
+    INPUT_KEY_SPACE,
+    INPUT_KEY_RBUTTON,          // 鼠标右键按下
+    INPUT_KEY_CAPTURE_HOTKEY,   // Ctrl+Shift+S
+    INPUT_KEY_RECORD_HOTKEY,    // Ctrl+Shift+H
+    INPUT_KEY_COUNT
+};
+
+enum InputAction {
+    INPUT_ACTION_NONE,
+    INPUT_ACTION_START_CAPTURE,
+    INPUT_ACTION_CANCEL_CAPTURE,
+    INPUT_ACTION_START_RECORDING,
+    INPUT_ACTION_STOP_RECORDING,
+    INPUT_ACTION_CANCEL_RECORDING,
+    INPUT_ACTION_CANCEL_RECOGNITION
+};
+
+struct InputTransition {
+    bool intercept;         // 钩子返回 1，按键不再传给其他程序
+    InputAction action;
+    InputMode next;
+};
+
+// 状态表：recognizing 表示空闲状态下语音识别仍在进行（此时 Esc 取消识别）
+const InputTransition& LookupInputTransition(InputMode mode, bool recognizing, InputKey key);
+const char* InputActionName(InputAction action);
+
+// 队列中的事件记录
+struct InputEvent {
+    InputKey key;
+    InputAction action;
+    std::chrono::steady_clock::time_point posted;
+};
+
+struct InputStats {
+    long hookCalls;
+    long intercepted;
+    long queued;
+    long dropped;           // 队列已满丢弃的动作
+    long dispatched;
+    // 钩子回调耗时（进入回调到返回），p99 为直方图桶的上界
+    double hookMeanUs, hookP99Us, hookMaxUs;
+    // 入队到分发线程开始执行
+    double dispatchMeanMs, dispatchMaxMs;
+
+    InputStats()
+        : hookCalls(0), intercepted(0), queued(0), dropped(0), dispatched(0), hookMeanUs(0), hookP99Us(0),
+          hookMaxUs(0), dispatchMeanMs(0), dispatchMaxMs(0) {}
+};
+
+class InputDispatcher {
+public:
+    typedef std::function<void(const InputEvent& event)> Handler;
+
+    explicit InputDispatcher(const Handler& handler, size_t queueCapacity = 256);
+    ~InputDispatcher();
+
+    void start();
+    // 执行完已入队的动作后停止分发线程
+    void stop();
+
+    // 钩子线程调用（队列唯一的生产者）：查表、切换状态、动作入队，不等待；返回是否拦截
+    bool onInput(InputKey key);
+    // 钩子在返回前记录本次回调的耗时
+    void recordHookLatency(std::chrono::steady_clock::time_point entered);
+
+    // 组件报告状态变化：当前状态为 from 时切换为 to，否则不变（例如已被按键切换走）
+    bool changeMode(InputMode from, InputMode to);
+    void setRecognizing(bool recognizing);
+    InputMode mode() const { return (InputMode)currentMode.load(); }
+
+    InputStats stats() const;
+
+private:
+    static const int LATENCY_BUCKETS = 40;
+
+    Handler handler;
+    SpscRing<InputEvent> queue;
+    std::atomic<int> currentMode;
+    std::atomic<bool> recognizing;
+
+    // 分发线程空闲时在条件变量上等待；钩子只在它等待时才取锁唤醒
+    std::thread worker;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<bool> sleeping;
+    std::atomic<bool> stopping;
+
+    // 钩子一侧的计数只用原子操作
+    std::atomic<long> hookCalls;
+    std::atomic<long> intercepted;
+    std::atomic<long> queued;
+    std::atomic<long> dropped;
+    std::atomic<long long> hookTotalNs;
+    std::atomic<long long> hookMaxNs;
+    std::atomic<long> hookBuckets[LATENCY_BUCKETS];     // 第 i 桶：[2^i, 2^(i+1)) 纳秒
+
+    // 分发线程一侧的统计
+    mutable std::mutex statsMutex;
+    long dispatched;
+    double dispatchTotalMs;
+    double dispatchMaxMs;
+
+    void run();
+
+    InputDispatcher(const InputDispatcher&);
+    InputDispatcher& operator=(const InputDispatcher&);
+};
+
+std::string DescribeInputStats(const InputStats& stats);
+
+#endif // INPUTDISPATCHER_H
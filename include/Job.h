@@ -0,0 +1,109 @@
+#ifndef JOB_H
+#define JOB_H
+
+#include "RequestCancel.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 可取消、分阶段限时的后台任务（截图识别、语音识别各一次即一个任务）。
+// 任务按阶段执行（截图、编码、上传、解析……），每个阶段有自己的时限；用户取消或阶段超时都会触发任务的取消令牌，
+// 令牌中断进行中的网络请求（关闭套接字或 WinINet 句柄），任务在下一个阶段边界退出并释放缓冲区
+
+enum JobState {
+    JOB_RUNNING,
+    JOB_FINISHED,
+    JOB_CANCELLED,      // 用户取消
+    JOB_TIMED_OUT       // 某个阶段超过时限
+};
+
+struct JobRunnerShared;
+class ThreadPool;
+
+class Job {
+public:
+    // 进入下一阶段：deadlineMs > 0 时该阶段超过此时长仍未进入下一阶段（或结束）即取消任务；
+    // 任务已取消时返回 false，调用方应尽快返回
+    bool enterStage(const char* stage, int deadlineMs);
+
+    // 用户取消；任务已结束或已取消时无效
+    void cancel();
+    bool cancelled() const { return cancelToken.cancelled(); }
+    // 网络请求在阻塞前登记中断动作
+    RequestCancel& token() { return cancelToken; }
+
+    JobState state() const;
+    // 当前阶段（取消或超时后为当时所在的阶段）
+    const char* stage() const;
+    const std::string& name() const { return jobName; }
+    double elapsedMs() const;
+
+private:
+    friend class JobRunner;
+    friend struct JobRunnerShared;
+
+    std::string jobName;
+    std::shared_ptr<JobRunnerShared> shared;    // 状态与时限由所属运行器的锁保护
+    RequestCancel cancelToken;
+    JobState jobState;
+    const char* stageName;
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point deadline;
+    bool hasDeadline;
+    std::chrono::steady_clock::time_point cancelRequested;
+    bool done;
+    std::chrono::steady_clock::time_point ended;
+
+    Job(const std::string& name, const std::shared_ptr<JobRunnerShared>& shared);
+    Job(const Job&);
+    Job& operator=(const Job&);
+};
+
+struct JobStats {
+    long started;
+    long finished;
+    long cancelled;
+    long timedOut;
+    long active;
+    // 从取消（或超时）到任务线程退出的时间
+    double cancelLatencyMeanMs;
+    double cancelLatencyMaxMs;
+
+    JobStats()
+        : started(0), finished(0), cancelled(0), timedOut(0), active(0), cancelLatencyMeanMs(0), cancelLatencyMaxMs(0) {}
+};
+
+// 在线程池（未指定时为独立线程）中运行任务，一个看门狗线程负责阶段时限。析构时取消所有任务并等它们退出
+class JobRunner {
+public:
+    // 任务会阻塞在网络请求上，应使用 I/O 池；池满时 start 等待空位
+    explicit JobRunner(ThreadPool* pool = nullptr);
+    ~JobRunner();
+
+    // 启动任务；返回的句柄用于取消，任务结束后仍可安全使用
+    std::shared_ptr<Job> start(const std::string& name, const std::function<void(Job& job)>& body);
+
+    void cancelAll();
+    // 等待所有任务退出；超时返回 false
+    bool waitAll(int timeoutMs);
+
+    JobStats stats() const;
+
+private:
+    std::shared_ptr<JobRunnerShared> shared;
+    ThreadPool* pool;
+    std::thread watchdog;
+
+    JobRunner(const JobRunner&);
+    JobRunner& operator=(const JobRunner&);
+};
+
+std::string DescribeJob(const Job& job);
+std::string DescribeJobStats(const JobStats& stats);
+
+#endif // JOB_H
@@ -0,0 +1,100 @@
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 拉取式 JSON 读取器：调用 next() 逐个取出记号，字符串与数字以指向缓冲区的片段给出，不为每个值分配内存。
+// 可以一次给出完整文档（不复制），也可以随收到的数据分段 feed()，数据不足时 next() 返回 JSON_NEED_MORE
+
+enum JsonToken {
+    JSON_NEED_MORE,     // 需要更多数据（分段模式）
+    JSON_BEGIN_OBJECT,
+    JSON_END_OBJECT,
+    JSON_BEGIN_ARRAY,
+    JSON_END_ARRAY,
+    JSON_KEY,           // 对象的键，text() 为解码后的内容
+    JSON_STRING,        // text() 为解码后的内容
+    JSON_NUMBER,        // text() 为数字原文
+    JSON_TRUE,
+    JSON_FALSE,
+    JSON_NULL,
+    JSON_END,           // 顶层值已读完
+    JSON_ERROR          // 格式错误，之后一直返回 JSON_ERROR
+};
+
+// 一段文字，下次调用 next() 或 feed() 前有效
+struct JsonText {
+    const char* data;
+    size_t size;
+
+    JsonText() : data(nullptr), size(0) {}
+    JsonText(const char* d, size_t n) : data(d), size(n) {}
+
+    template <size_t N>
+    bool equals(const char (&literal)[N]) const {
+        return size == N - 1 && std::memcmp(data, literal, N - 1) == 0;
+    }
+    std::string str() const { return std::string(data, size); }
+};
+
+class JsonReader {
+public:
+    // 分段模式：用 feed() 送入数据，最后调用 finish()
+    JsonReader();
+    // 完整文档：直接读取调用方的数据，data 在读取期间须保持有效
+    JsonReader(const char* data, size_t size);
+
+    void feed(const char* data, size_t size);
+    // 不会再有数据；此后数据不足按格式错误处理
+    void finish();
+
+    JsonToken next();
+    // 刚读到 BEGIN_OBJECT/BEGIN_ARRAY 时调用：不再逐个给出其中的记号，之后的 next() 快速跳到
+    // 配对的结束处并返回 END_OBJECT/END_ARRAY。跳过的内容只检查括号配对
+    void skipContainer();
+    JsonText text() const { return value; }
+    // 当前所在的对象/数组层数（BEGIN 之后加一，END 之后减一）
+    int depth() const { return (int)stack.size(); }
+
+private:
+    enum State {
+        STATE_VALUE,            // 期待一个值
+        STATE_VALUE_OR_END,     // '[' 之后
+        STATE_KEY,              // ',' 之后的键
+        STATE_KEY_OR_END,       // '{' 之后
+        STATE_COLON,
+        STATE_COMMA_OR_END,
+        STATE_DONE,
+        STATE_ERROR
+    };
+
+    std::string buffer;         // 分段模式下的数据
+    const char* data;
+    size_t size;
+    size_t pos;
+    size_t scanPos;             // 未结束的字符串已扫描到的位置，数据补齐后从这里继续
+    int skipLevel;              // 正在跳过的容器内已进入的层数，0 表示没有在跳过
+    bool escaped;               // 未结束的字符串中出现过转义
+    bool finished;
+    State state;
+    std::vector<char> stack;    // '{' 或 '['
+    std::string scratch;        // 含转义的字符串解码到这里（重复使用）
+    JsonText value;
+
+    JsonToken continueSkip();
+    JsonToken readValue(char c);
+    JsonToken readString(bool key);
+    JsonToken readNumber();
+    JsonToken readLiteral(const char* literal, size_t length, JsonToken token);
+    JsonToken afterValue(JsonToken token);
+    JsonToken fail();
+};
+
+// 把 JSON 字符串内容（不含引号）解码后追加到 out：处理全部转义，\uXXXX 转为 UTF-8，
+// 代理对合成一个码点，落单的代理项写为 U+FFFD。转义不完整返回 false
+bool AppendJsonUnescaped(std::string& out, const char* data, size_t size);
+
+#endif // JSONREADER_H
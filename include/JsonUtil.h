@@ -0,0 +1,12 @@
+#ifndef JSONUTIL_H
+#define JSONUTIL_H
+
+#include <string>
+
+// 处理 JSON 字符串字面量中的转义，\uXXXX（含代理对）转为 UTF-8；转义不完整时返回已解码的部分
+std::string UnescapeJsonString(const std::string& escapedStr);
+
+// 把 value 作为带引号的 JSON 字符串追加到 out，控制字符、引号与反斜杠转义，UTF-8 原样输出
+void AppendJsonString(std::string& out, const std::string& value);
+
+#endif // JSONUTIL_H
@@ -0,0 +1,91 @@
+#ifndef LOCALOCR_H
+#define LOCALOCR_H
+
+#include "CaptureSource.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 本地快速识别：只处理单行的 ASCII 文字（工单号、错误码、IP、哈希等短文本）。
+// 按连通域切分字形，与常用界面字体渲染出的模板做归一化相关匹配；置信度不够时交给远程识别
+
+// 渲染好的一个字形：灰度覆盖率位图（紧贴墨迹的外接矩形）及其相对基线的位置
+struct GlyphBitmap {
+    char ch;
+    int width;
+    int height;
+    int left;                               // 位图左边相对笔位置的像素数
+    int top;                                // 位图顶边在基线之上的像素数
+    int advance;                            // 前进量（像素）
+    std::vector<unsigned char> coverage;    // width * height，0..255
+};
+
+// 一种字体在某个像素大小下渲染出的 ASCII 可见字符（'!'..'~'）
+struct GlyphFont {
+    std::string name;
+    int capHeight;          // 'H' 的高度（像素）
+    int space;              // 空格的前进量（像素）
+    std::vector<GlyphBitmap> glyphs;
+
+    GlyphFont() : capHeight(0), space(0) {}
+};
+
+struct LocalOcrOptions {
+    double minConfidence;   // 达到该值才采用本地结果
+    int maxHeight;          // 96 DPI 下选区高于该值不尝试（多行或大字）
+    int maxWidth;
+    int minCapHeight;       // 字太小（像素）时不尝试
+    int minContrast;        // 文字与背景的亮度差
+
+    LocalOcrOptions() : minConfidence(0.80), maxHeight(96), maxWidth(2400), minCapHeight(7), minContrast(60) {}
+};
+
+struct LocalOcrResult {
+    bool eligible;          // 选区看起来是单行文字
+    std::string text;
+    double confidence;      // 0..1，各字符置信度的最小值
+    std::string font;       // 匹配最好的模板字体
+    int glyphs;
+    const char* reason;     // 没有采用本地结果的原因，采用时为空
+
+    LocalOcrResult() : eligible(false), confidence(0), glyphs(0), reason(nullptr) {}
+};
+
+class LocalOcr {
+public:
+    explicit LocalOcr(const LocalOcrOptions& options = LocalOcrOptions());
+
+    // 加入一种模板字体。同名字体的不同像素大小合并为一组模板（小字号的笔画经过微调，形状与大字号不同）
+    void addFont(const GlyphFont& font);
+    size_t fontCount() const { return fonts.size(); }
+    const LocalOcrOptions& getOptions() const { return options; }
+
+    // 识别单行文字；返回 true 表示结果可信（confidence >= minConfidence），否则应交给远程识别。
+    // 可在多个线程上同时调用
+    bool recognize(const PixelBufferView& view, LocalOcrResult& result) const;
+
+private:
+    struct Template {
+        char ch;
+        std::vector<int16_t> feature;   // 归一化的形状特征
+        bool solid;                     // 外接正方形内几乎全是墨迹（如小号的 '.'），没有形状可比
+        float width;                    // 以下以大写字母高度为单位
+        float height;
+        float top;
+        int capPixels;                  // 渲染时的大写字母高度（像素），优先与同样大小的文字比较
+        float leftBearing;              // 墨迹左右两侧到前进量边界的空白，用来判断空格
+        float rightBearing;
+    };
+    struct FontTemplates {
+        std::string name;
+        float space;                    // 空格宽度（大写字母高度为单位）
+        std::vector<Template> glyphs;
+    };
+
+    LocalOcrOptions options;
+    std::vector<FontTemplates> fonts;
+};
+
+std::string DescribeLocalOcrResult(const LocalOcrResult& result);
+
+#endif // LOCALOCR_H
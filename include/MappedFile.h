@@ -0,0 +1,43 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// 内存映射文件的最小封装（POSIX mmap / Windows 文件映射），用于持久化缓存的整体读写。
+// 路径为 UTF-8
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // 只读映射已有文件；文件为空时也返回 false
+    bool openRead(const std::string& path);
+    // 新建（或截断）文件为 size 字节并以读写方式映射
+    bool create(const std::string& path, size_t size);
+    // 解除映射并关闭文件，写入的内容在此之前已同步给系统
+    void close();
+
+    const unsigned char* data() const { return view; }
+    unsigned char* mutableData() { return writable ? view : nullptr; }
+    size_t size() const { return length; }
+
+private:
+    unsigned char* view;
+    size_t length;
+    bool writable;
+#if defined(_WIN32)
+    void* file;
+    void* mapping;
+#else
+    int fd;
+#endif
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+// 用 from 原子地替换 to（to 已存在时覆盖），用于先写临时文件再替换
+bool ReplaceFileAtomically(const std::string& from, const std::string& to);
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,101 @@
+#ifndef NOTIFICATIONQUEUE_H
+#define NOTIFICATIONQUEUE_H
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 提示消息队列：所有提示共用一个窗口，由界面线程按时间驱动。
+// 任意线程 post 消息；界面线程在被唤醒或定时器到期时调用 pump，由 pump 通过显示端（sink）显示、替换或隐藏。
+// 合并规则：与正在显示的消息相同则延长显示时间；与等待中的消息相同则合并；
+// 等待中的消息超过上限时丢弃较早的（“开始录音”→“正在识别”→“识别成功”这类状态，只需显示最新的）。
+// 正在显示的消息至少显示 minVisibleMs 才会被替换，避免一闪而过
+
+typedef std::chrono::steady_clock::time_point NotificationTime;
+
+// 显示端：Windows 上是常驻的提示窗口，无界面环境下记录显示过程
+class NotificationSink {
+public:
+    virtual ~NotificationSink() {}
+    // 显示（或替换为）text；只在调用 pump 的线程中调用
+    virtual void show(const std::string& text) = 0;
+    virtual void hide() = 0;
+};
+
+struct NotificationOptions {
+    int minVisibleMs;
+    size_t maxPending;
+
+    NotificationOptions() : minVisibleMs(700), maxPending(1) {}
+};
+
+struct NotificationStats {
+    long posted;
+    long shown;
+    long coalesced;         // 与显示中或等待中的消息相同而合并
+    long superseded;        // 等待中被更新的消息取代
+    long dismissed;         // 用户点击提前关闭
+    long wakeups;           // post 要求唤醒界面线程的次数
+    // 从 post 到显示的等待
+    double delayMeanMs, delayMaxMs;
+
+    NotificationStats()
+        : posted(0), shown(0), coalesced(0), superseded(0), dismissed(0), wakeups(0), delayMeanMs(0), delayMaxMs(0) {}
+};
+
+class NotificationQueue {
+public:
+    explicit NotificationQueue(NotificationSink& sink, const NotificationOptions& options = NotificationOptions());
+
+    // 任意线程调用；返回 true 时调用方应唤醒界面线程执行 pump（已有未处理的唤醒时返回 false）
+    bool post(const std::string& text, int durationMs, NotificationTime now);
+    // 界面线程调用：显示、替换或隐藏；返回下次需要 pump 的时间，没有时为 NotificationTime::max()
+    NotificationTime pump(NotificationTime now);
+    // 用户点击提示：立即关闭当前消息（有等待中的消息时接着显示），之后应调用 pump
+    void dismiss(NotificationTime now);
+
+    bool visible() const;
+    NotificationStats stats() const;
+
+private:
+    struct Entry {
+        std::string text;
+        int durationMs;
+        NotificationTime posted;
+    };
+
+    NotificationSink& sink;
+    NotificationOptions options;
+    mutable std::mutex mutex;
+    std::deque<Entry> pending;
+    bool showing;
+    std::string currentText;
+    NotificationTime shownAt;
+    NotificationTime hideAt;
+    bool wakePending;
+    NotificationStats counters;
+    double delayTotalMs;
+};
+
+// 无界面的显示端：按调用顺序记录显示与隐藏，供命令行工具与基准程序使用
+class HeadlessNotificationSink : public NotificationSink {
+public:
+    struct Event {
+        bool shown;             // false 表示隐藏
+        std::string text;
+    };
+
+    void show(const std::string& text) override;
+    void hide() override;
+    std::vector<Event> events() const;
+
+private:
+    mutable std::mutex mutex;
+    std::vector<Event> recorded;
+};
+
+std::string DescribeNotificationStats(const NotificationStats& stats);
+
+#endif // NOTIFICATIONQUEUE_H
@@ -0,0 +1,140 @@
+#ifndef OCRCACHE_H
+#define OCRCACHE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+class RequestCancel;
+
+// 按截图内容寻址的 OCR 结果缓存：同一区域短时间内重复截图时直接返回上次的识别结果，
+// 不再编码与上传。并发的相同请求合并为一次调用（single-flight）
+
+struct OcrCacheKey {
+    uint64_t hash;          // 原始像素（或已编码文件字节）的 64 位哈希
+    uint64_t perceptual;    // 感知哈希（差值哈希）
+    bool hasPerceptual;
+    int width;
+    int height;
+
+    OcrCacheKey() : hash(0), perceptual(0), hasPerceptual(false), width(0), height(0) {}
+};
+
+// 对 BGRA 像素计算键：只哈希每行的有效像素并忽略 alpha（GDI 截图的 alpha 不确定）。
+// perceptual 为 true 时同时计算 64 位差值哈希，用于匹配只有细微差别的截图
+OcrCacheKey MakeOcrCacheKey(const unsigned char* bgra, int width, int height, int stride, bool perceptual);
+// 对已编码的图片文件按字节计算键（无感知哈希）
+OcrCacheKey MakeOcrCacheKeyForBytes(const unsigned char* data, size_t size);
+
+// 任意字节的 64 位哈希（非加密，每次 32 字节四路并行）
+uint64_t HashBytes64(const void* data, size_t size, uint64_t seed = 0);
+
+// 两个感知哈希的汉明距离
+int PerceptualDistance(uint64_t a, uint64_t b);
+
+struct OcrCacheOptions {
+    size_t maxBytes;            // 条目总字节数上限（文字 + 固定开销），超出时按 LRU 淘汰
+    int perceptualMaxDistance;  // 精确未命中时，感知哈希距离不超过该值且尺寸相近即视为命中；< 0 关闭
+
+    OcrCacheOptions() : maxBytes(4 * 1024 * 1024), perceptualMaxDistance(-1) {}
+};
+
+struct OcrCacheStats {
+    long lookups;
+    long hits;              // 含感知哈希命中
+    long perceptualHits;
+    long coalesced;         // 等待同一键的在途请求而未发起新请求
+    long misses;
+    long insertions;
+    long evictions;
+    long long bytesSaved;   // 命中与合并省下的上传字节数
+    size_t entries;
+    size_t bytes;
+
+    OcrCacheStats()
+        : lookups(0), hits(0), perceptualHits(0), coalesced(0), misses(0), insertions(0), evictions(0),
+          bytesSaved(0), entries(0), bytes(0) {}
+
+    // 命中（含合并）占查询的比例
+    double hitRate() const { return lookups > 0 ? (double)(hits + coalesced) / lookups : 0.0; }
+};
+
+// 一行日志：条目数、命中率与省下的字节数
+std::string DescribeOcrCacheStats(const OcrCacheStats& stats);
+
+// 结果来源
+enum OcrCacheSource {
+    OCR_FROM_CALL,      // 本次调用了 compute
+    OCR_FROM_CACHE,
+    OCR_FROM_IN_FLIGHT  // 等到了另一线程的同键请求
+};
+
+class OcrCache {
+public:
+    explicit OcrCache(const OcrCacheOptions& options = OcrCacheOptions());
+
+    // 计算识别结果；返回 false 表示失败（不写入缓存）。requestBytes 为本次上传的字节数
+    typedef std::function<bool(std::string& text, size_t& requestBytes)> Compute;
+
+    // 命中时直接返回；同键请求在途时等待其结果；否则调用 compute 并缓存成功的结果。
+    // 在途请求失败时，等待它的调用同样返回 false；在途请求因其调用方取消而失败时，等待者自己调用 compute。
+    // cancel 为调用方的取消令牌：等待中被取消时立即返回 false
+    bool getOrCompute(const OcrCacheKey& key, const Compute& compute, std::string& text,
+                      OcrCacheSource* source = nullptr, RequestCancel* cancel = nullptr);
+
+    bool lookup(const OcrCacheKey& key, std::string& text);
+    void insert(const OcrCacheKey& key, const std::string& text, size_t requestBytes);
+    void clear();
+
+    // 持久化：save 先写临时文件（内存映射）再替换，load 映射文件并按最近使用顺序恢复条目。
+    // 文件损坏或版本不符时 load 返回 false，已读到的完整条目保留
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    OcrCacheStats stats() const;
+
+private:
+    struct Entry {
+        OcrCacheKey key;
+        std::string text;
+        size_t requestBytes;
+    };
+    struct InFlight {
+        bool done;
+        bool ok;
+        bool cancelled;     // 失败是因为发起者取消，不代表识别本身失败
+        std::string text;
+        size_t requestBytes;
+
+        InFlight() : done(false), ok(false), cancelled(false), requestBytes(0) {}
+    };
+
+    OcrCacheOptions options;
+    mutable std::mutex mutex;
+    std::condition_variable flightDone;
+    std::list<Entry> entries;   // 表头为最近使用
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    std::unordered_map<uint64_t, std::shared_ptr<InFlight> > inFlight;
+    size_t bytes;
+    OcrCacheStats counters;
+
+    // 以下均需持有 mutex
+    bool findLocked(const OcrCacheKey& key, std::string& text);
+    void insertLocked(const OcrCacheKey& key, const std::string& text, size_t requestBytes);
+    void evictLocked();
+    static size_t entryBytes(const std::string& text);
+    // 记录在途请求的结果、唤醒等待者，成功时写入缓存（内部加锁）
+    void completeFlight(const OcrCacheKey& key, const std::shared_ptr<InFlight>& flight, bool ok, bool cancelled,
+                        const std::string& text, size_t requestBytes);
+
+    OcrCache(const OcrCache&);
+    OcrCache& operator=(const OcrCache&);
+};
+
+#endif // OCRCACHE_H
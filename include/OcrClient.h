@@ -0,0 +1,93 @@
+#ifndef OCRCLIENT_H
+#define OCRCLIENT_H
+
+#include "HttpClient.h"
+#include "HttpConnectionPool.h"
+#include "JsonReader.h"
+#include "RequestBody.h"
+#include "StreamingUpload.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 有道 OCR 接口的请求构建与响应解析，截图界面（WinINet）与批处理（套接字）共用
+
+// 请求附加头
+extern const char OCR_REQUEST_HEADERS[];
+
+// 表单前缀之后借用图片字节，发送时分块做 base64 + URL 编码；imageData 需在发送完成前保持有效
+RequestBody BuildOcrRequestBody(const std::vector<unsigned char>& imageData);
+
+// 流式写出与 BuildOcrRequestBody 相同的表单：encodeImage 在后台线程产生图片字节，
+// 调用线程边编码边交给 write。bytesWritten 返回已写出的请求体字节数
+bool WriteOcrRequestStream(const ByteProducer& encodeImage, const RequestBody::Writer& write, size_t& bytesWritten);
+
+// 识别出的一行文字；boundingBox 给出时记录外接矩形（上传图片的像素坐标）
+struct OcrLine {
+    std::string text;
+    bool hasBox;
+    int left;
+    int top;
+    int right;
+    int bottom;
+
+    OcrLine() : hasBox(false), left(0), top(0), right(0), bottom(0) {}
+};
+
+// 增量解析识别响应：可随收到的数据分段 feed()，也可由完整响应直接构造（不复制）。
+// "lines" 数组（可在任意层，如 Result.regions[].lines）中每个含字符串 words 的对象为一行，
+// boundingBox 取自同一对象；行对象内部的数组与对象（如逐字结果）整体跳过
+class OcrResponseParser {
+public:
+    OcrResponseParser();
+    OcrResponseParser(const char* data, size_t size);
+
+    void feed(const char* data, size_t size);
+    // 数据结束；响应是完整有效的 JSON 时返回 true，否则已解析出的行仍保留
+    bool finish();
+    const std::vector<OcrLine>& lines() const { return parsed; }
+    std::vector<OcrLine> takeLines();
+
+private:
+    enum Field { FIELD_NONE, FIELD_LINES, FIELD_WORDS, FIELD_BOX };
+
+    JsonReader reader;
+    Field pendingField;     // 上一个记号是关心的键时，下一个值归它
+    int linesDepth;         // 所在 lines 数组的层数，0 表示不在其中
+    bool inLine;            // 正在读 lines 数组中的一个对象
+    bool hasWords;
+    OcrLine line;
+    std::vector<OcrLine> parsed;
+    bool failed;
+
+    void drain();
+};
+
+// 按响应顺序取出非空的 words 及其 boundingBox
+std::vector<OcrLine> ParseOcrLines(const std::string& response);
+std::string JoinOcrLines(const std::vector<OcrLine>& lines);
+
+// 从响应 JSON 中取出所有 words，以空格连接
+std::string ParseOcrResponse(const std::string& response);
+
+struct OcrResult {
+    bool ok;                // 收到 200 响应
+    int status;
+    std::string text;
+    std::vector<OcrLine> lines;
+    std::string error;
+    double latencyMs;
+    size_t requestBytes;
+    size_t responseBytes;
+
+    OcrResult() : ok(false), status(0), latencyMs(0), requestBytes(0), responseBytes(0) {}
+};
+
+// 通过连接池调用 OCR 接口（只支持 http://，用于批处理与本地替身服务器），超时由连接池选项决定
+OcrResult CallOcrEndpoint(HttpConnectionPool& pool, const HttpUrl& url, const std::vector<unsigned char>& imageData);
+
+// 边编码边上传：encodeImage 在后台线程运行并输出图片字节，已产生的部分立即编码为表单字段，
+// 以 chunked 请求体发出（总长度事先未知）。服务器需支持 chunked 请求
+OcrResult CallOcrEndpointStreaming(HttpConnectionPool& pool, const HttpUrl& url, const ByteProducer& encodeImage);
+
+#endif // OCRCLIENT_H
@@ -0,0 +1,108 @@
+#ifndef PCMCAPTURE_H
+#define PCMCAPTURE_H
+
+#include "SpscRing.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 录音缓冲区与 PCM 拼接：录音设备的回调线程只把填满的缓冲区编号写入无锁环形队列，
+// 消费线程把数据拷入预先按最长录音时间分配好的连续存储，再把缓冲区交还设备（Windows 上为 waveInAddBuffer）。
+// 回调中不分配内存、不拷贝整段录音、不与停止录音的线程争用同一个 vector
+
+// 缓冲区内容已取走；重新交给设备时返回 true（停止录音后返回 false）
+typedef std::function<bool(size_t index)> PcmRecycler;
+// 新录下的一段 PCM，在消费线程中调用。通常指向连续存储（录音期间不会移动）；
+// 存储已满后指向设备缓冲区，只在调用期间有效（边录边识别的录音长度不受存储大小限制）
+typedef std::function<void(const char* data, size_t size)> PcmListener;
+
+struct PcmCaptureStats {
+    long buffers;               // 回调发布的缓冲区
+    long long bytes;            // 拼接进存储的字节
+    long long truncatedBytes;   // 超过最长录音时间被丢弃的字节
+    long wakeups;               // 回调唤醒消费线程的次数
+    size_t maxQueued;           // 环形队列中同时等待拷贝的缓冲区数
+    // 设备回调的耗时（由回调在返回前记录）
+    double callbackMeanUs, callbackMaxUs;
+
+    PcmCaptureStats()
+        : buffers(0), bytes(0), truncatedBytes(0), wakeups(0), maxQueued(0), callbackMeanUs(0), callbackMaxUs(0) {}
+};
+
+class PcmCapture {
+public:
+    // bufferCount 个设备缓冲区，每个 bufferBytes 字节（按缓存行对齐）；整段录音最多 maxBytes
+    PcmCapture(size_t bufferCount, size_t bufferBytes, size_t maxBytes);
+    ~PcmCapture();
+
+    size_t bufferCount() const { return count; }
+    size_t bufferBytes() const { return bytesPerBuffer; }
+    // 交给设备的缓冲区
+    char* buffer(size_t index) { return buffers + index * stride; }
+
+    // 边录边处理（例如边录边识别）时在 start 之前设置
+    void setListener(const PcmListener& listener) { this->listener = listener; }
+    // 启动消费线程；此时所有缓冲区都视为已交给设备
+    void start(const PcmRecycler& recycle);
+
+    // 设备回调线程（唯一的生产者）：缓冲区 index 已填入 size 字节。不加锁、不分配
+    void publish(size_t index, size_t size);
+    void recordCallbackTime(std::chrono::steady_clock::time_point entered);
+
+    // 等设备交回所有缓冲区（最多 timeoutMs），拷完队列中的数据后停止消费线程，返回连续的 PCM
+    std::vector<char> finish(int timeoutMs);
+
+    PcmCaptureStats stats() const;
+
+private:
+    struct Filled {
+        size_t index;
+        size_t size;
+    };
+
+    size_t count;
+    size_t bytesPerBuffer;
+    size_t stride;
+    size_t maxBytes;
+    std::vector<char> bufferStorage;
+    char* buffers;
+    std::vector<char> pcm;
+    SpscRing<Filled> queue;
+    PcmRecycler recycle;
+    PcmListener listener;
+
+    std::thread consumer;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<bool> sleeping;
+    std::atomic<bool> stopping;
+
+    // 设备持有的缓冲区数 = count + 交还次数 - 发布次数；为 0 时录音数据已全部发布
+    std::atomic<long> published;
+    std::atomic<long> requeued;
+    std::atomic<long> wakeups;
+    std::atomic<long long> callbackTotalNs;
+    std::atomic<long long> callbackMaxNs;
+    std::atomic<long> callbacks;
+
+    // 消费线程一侧
+    mutable std::mutex statsMutex;
+    long long assembled;
+    long long truncated;
+    size_t maxQueued;
+
+    void run();
+    long drain();
+
+    PcmCapture(const PcmCapture&);
+    PcmCapture& operator=(const PcmCapture&);
+};
+
+std::string DescribePcmCaptureStats(const PcmCaptureStats& stats);
+
+#endif // PCMCAPTURE_H
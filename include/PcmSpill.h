@@ -0,0 +1,47 @@
+#ifndef PCMSPILL_H
+#define PCMSPILL_H
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 录音段的临时文件：长时间听写时已切下、还在排队等待识别的段写入磁盘，轮到时再读回，
+// 内存中只保留正在识别的段。文件在关闭（或进程退出）时由系统删除，不留残余。
+// 路径为 UTF-8；可在多个线程上同时读写
+class PcmSpill {
+public:
+    PcmSpill();
+    ~PcmSpill();
+
+    // 新建（或截断）临时文件
+    bool open(const std::string& path);
+    bool isOpen() const;
+    // 追加一段，index 为之后读回用的编号；写入失败返回 false
+    bool write(const std::vector<char>& pcm, size_t& index);
+    // 读回第 index 段
+    bool read(size_t index, std::vector<char>& pcm);
+    // 已写入的字节数
+    unsigned long long bytes() const;
+    void close();
+
+private:
+    struct Extent {
+        unsigned long long offset;
+        size_t size;
+    };
+
+    mutable std::mutex mutex;
+    std::vector<Extent> extents;
+    unsigned long long end;
+#if defined(_WIN32)
+    void* file;
+#else
+    int fd;
+#endif
+
+    PcmSpill(const PcmSpill&);
+    PcmSpill& operator=(const PcmSpill&);
+};
+
+#endif // PCMSPILL_H
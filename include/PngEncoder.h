@@ -0,0 +1,85 @@
+#ifndef PNGENCODER_H
+#define PNGENCODER_H
+
+#include "Deflate.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// PNG 颜色类型（取值与规范一致）
+enum class PngColorType {
+    Gray = 0,
+    Rgb = 2,
+    Palette = 3,
+    RgbAlpha = 6
+};
+
+// 面向截图内容的预设：
+// Fastest - 相同行用 Up、其余用 Sub 滤波，压缩只做游程与上一行匹配
+// Fast    - 逐行选绝对差和最小的滤波，短哈希链
+// Default/Best - 同上，更深的哈希链与惰性匹配
+enum class PngLevel {
+    Fastest,
+    Fast,
+    Default,
+    Best
+};
+
+struct PngOptions {
+    PngLevel level;
+    size_t idatChunkSize;   // 压缩数据攒够此大小输出一个 IDAT 块；边编码边上传时调小，让数据更早送出
+
+    PngOptions() : level(PngLevel::Fast), idatChunkSize(64 * 1024) {}
+};
+
+// 流式 PNG 编码器：begin 写入文件头，逐行提供已按颜色类型与位深打包的扫描线，finish 收尾
+class PngEncoder {
+public:
+    typedef std::function<void(const unsigned char* data, size_t size)> Sink;
+
+    PngEncoder(const PngOptions& options, Sink sink);
+
+    // palette 为 0xRRGGBB，仅 Palette 类型需要
+    void begin(int width, int height, PngColorType colorType, int bitDepth,
+               const std::vector<uint32_t>& palette = std::vector<uint32_t>());
+    void writeRow(const unsigned char* row);
+    void finish();
+
+    // 每行打包后的字节数
+    size_t rowBytes() const { return rowSize; }
+
+private:
+    PngOptions options;
+    Sink sink;
+    DeflateEncoder deflater;
+
+    int height;
+    int rowsWritten;
+    size_t rowSize;
+    size_t bytesPerPixel;
+    bool adaptiveFilter;
+
+    std::vector<unsigned char> previousRow;
+    std::vector<unsigned char> filtered[5];
+    std::vector<unsigned char> idat;
+
+    void writeChunk(const char* type, const unsigned char* data, size_t size);
+    void flushIdat();
+    int chooseFilter(const unsigned char* row);
+};
+
+// 便捷函数：GDI 的 BGRA 像素（自上而下，stride 为每行字节数）编码为 RGB PNG
+bool EncodePngBgra(const unsigned char* bgra, int width, int height, int stride,
+                   const PngOptions& options, std::vector<unsigned char>& out);
+// 同上，编码输出边产生边交给 sink
+bool EncodePngBgra(const unsigned char* bgra, int width, int height, int stride,
+                   const PngOptions& options, const PngEncoder::Sink& sink);
+
+// 调色板 PNG：indices 每像素一个字节（width * height），按调色板大小自动选 1/2/4/8 位索引
+bool EncodePngIndexed(const unsigned char* indices, int width, int height, const std::vector<uint32_t>& palette,
+                      const PngOptions& options, std::vector<unsigned char>& out);
+bool EncodePngIndexed(const unsigned char* indices, int width, int height, const std::vector<uint32_t>& palette,
+                      const PngOptions& options, const PngEncoder::Sink& sink);
+
+#endif // PNGENCODER_H
@@ -0,0 +1,54 @@
+#ifndef REQUESTBODY_H
+#define REQUESTBODY_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 分段请求体：由若干借用或持有的片段组成，发送时按顺序写出而不拼接成一整块。
+// 借用片段只保存指针，调用方需保证在发送完成前数据有效
+class RequestBody {
+public:
+    // 返回 false 表示写出失败，停止发送
+    typedef std::function<bool(const char* data, size_t size)> Writer;
+
+    RequestBody();
+
+    void appendBorrowed(const void* data, size_t size);
+    void appendOwned(const std::string& data);
+    void appendOwned(std::string&& data);
+
+    // 借用 data，写出时分块做 base64 + URL 编码（用于表单中的图片字段）
+    void appendBase64FormEncoded(const unsigned char* data, size_t size);
+
+    // 写出后的总字节数（Content-Length）
+    size_t size() const { return totalSize; }
+    size_t spanCount() const { return spans.size(); }
+
+    // 依次写出所有片段；小片段先合并到暂存缓冲区，减少底层写调用次数
+    bool writeTo(const Writer& writer) const;
+
+    // 拼接为连续字符串，仅用于调试与校验
+    std::string toString() const;
+
+private:
+    enum SpanKind {
+        SPAN_BORROWED,
+        SPAN_OWNED,
+        SPAN_BASE64_FORM
+    };
+
+    struct Span {
+        SpanKind kind;
+        const char* data;   // 借用片段与待编码数据的指针
+        size_t size;        // 源数据字节数
+        size_t outputSize;  // 写出的字节数
+        std::string owned;
+    };
+
+    std::vector<Span> spans;
+    size_t totalSize;
+};
+
+#endif // REQUESTBODY_H
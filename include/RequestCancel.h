@@ -0,0 +1,33 @@
+#ifndef REQUESTCANCEL_H
+#define REQUESTCANCEL_H
+
+#include <functional>
+#include <map>
+#include <mutex>
+
+// 取消一个进行中的请求或任务。请求在阻塞调用前登记取消动作（关闭套接字、关闭 WinINet 句柄等），
+// cancel() 执行所有已登记的动作；登记时已取消则立即执行。可跨线程使用。
+// 同一令牌可同时登记多个动作：分块识别的并发请求、对冲的两次尝试共用所属任务的令牌
+class RequestCancel {
+public:
+    RequestCancel() : flag(false), nextId(1) {}
+
+    void cancel();
+    bool cancelled() const;
+
+    // 登记取消动作，返回注销用的编号；已取消时立即执行动作并返回 0
+    int addAction(const std::function<void()>& action);
+    // 请求结束、释放资源前注销取消动作；返回 false 表示动作已被执行（资源已被关闭，不能再用）
+    bool removeAction(int id);
+
+private:
+    mutable std::mutex mutex;
+    bool flag;
+    int nextId;
+    std::map<int, std::function<void()> > actions;
+
+    RequestCancel(const RequestCancel&);
+    RequestCancel& operator=(const RequestCancel&);
+};
+
+#endif // REQUESTCANCEL_H
@@ -0,0 +1,84 @@
+#ifndef REQUESTHEDGER_H
+#define REQUESTHEDGER_H
+
+#include "RequestCancel.h"
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 请求对冲：请求在自适应的等待时间（最近请求延迟的高分位数）内没有结果时，另开一条连接发出副本，
+// 先得到有效结果的一方获胜，另一方被取消。用来削减远程接口偶发的数秒长尾
+
+struct HedgeOptions {
+    bool enabled;
+    double percentile;      // 以最近请求延迟的该分位数作为发出副本前的等待时间
+    int initialDelayMs;     // 延迟样本不足 minSamples 时的等待时间
+    int minDelayMs;
+    int maxDelayMs;
+    int minSamples;
+    int window;             // 参与统计的最近请求数
+    double maxHedgeRatio;   // 副本数不超过请求数的这个比例，服务整体变慢时不让请求量翻倍
+
+    HedgeOptions()
+        : enabled(true), percentile(0.9), initialDelayMs(1500), minDelayMs(150), maxDelayMs(5000), minSamples(16),
+          window(128), maxHedgeRatio(0.2) {}
+};
+
+struct HedgeStats {
+    long requests;
+    long hedged;            // 发出了副本的请求
+    long hedgeWins;         // 副本先得到有效结果
+    long cancelled;         // 取消的较慢请求
+    long failed;            // 所有尝试都没有得到有效结果
+    long budgetSkipped;     // 到了等待时间但超出副本比例，没有发副本
+    long aborted;           // 调用方取消的请求（不计入失败与延迟统计）
+    int delayMs;            // 当前的等待时间
+    // 最近请求的单次尝试延迟（被取消的按取消时已等待的时长计，是下限）与端到端延迟，
+    // 两者高分位数之差即对冲削减的长尾（下限）
+    double attemptP50Ms, attemptP90Ms, attemptP99Ms;
+    double requestP50Ms, requestP90Ms, requestP99Ms;
+
+    HedgeStats()
+        : requests(0), hedged(0), hedgeWins(0), cancelled(0), failed(0), budgetSkipped(0), aborted(0), delayMs(0),
+          attemptP50Ms(0), attemptP90Ms(0), attemptP99Ms(0), requestP50Ms(0), requestP90Ms(0), requestP99Ms(0) {}
+};
+
+// 一次尝试：得到有效结果时写入 result 并返回 true；attempt 为 0（原请求）或 1（副本）。
+// 原请求在调用 run() 的线程上运行，副本在共用的 I/O 池中运行；run() 返回后被取消的副本可能仍在收尾，
+// 只能捕获按值复制或共享所有权的数据
+typedef std::function<bool(int attempt, RequestCancel& cancel, std::string& result)> HedgedAttempt;
+
+class RequestHedger {
+public:
+    explicit RequestHedger(const HedgeOptions& options = HedgeOptions());
+
+    // 执行请求，超过等待时间仍无结果时发出副本；返回先到的有效结果，全部失败返回 false。
+    // cancel 非空时调用方取消会中断所有进行中的尝试（run() 等原请求被中断返回后才返回）
+    bool run(const HedgedAttempt& attempt, std::string& result, RequestCancel* cancel = nullptr);
+
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+
+    // 当前发出副本前的等待时间
+    int delayMs() const;
+    HedgeStats stats() const;
+
+private:
+    HedgeOptions options;
+    mutable std::mutex mutex;
+    HedgeStats counters;
+    std::vector<double> attemptLatencies;   // 环形缓冲，最近 options.window 个
+    std::vector<double> requestLatencies;
+    size_t attemptNext;
+    size_t requestNext;
+
+    int delayLocked() const;
+    // 发副本前检查副本比例，允许时计入 hedged，否则计入 budgetSkipped
+    bool reserveHedge();
+    void record(std::vector<double>& ring, size_t& next, double ms);
+};
+
+std::string DescribeHedgeStats(const HedgeStats& stats);
+
+#endif // REQUESTHEDGER_H
@@ -2,8 +2,20 @@
 #define SCREENCAPTURE_H
 
 #include <windows.h>
+#include <atomic>
 #include <string>
 #include <vector>
+#include <memory>
+#include <mutex>
+#include "PngEncoder.h"
+#include "ImagePreprocess.h"
+#include "ImageAnalyzer.h"
+#include "CaptureSource.h"
+#include "OcrCache.h"
+#include "TiledOcr.h"
+#include "LocalOcr.h"
+#include "RequestHedger.h"
+#include "Job.h"
 
 class AppManager;
 
@@ -17,6 +29,22 @@ public:
     // 新增：按键事件处理接口
     void onKeyPressed(int vkCode);
     
+    // 大图分块识别开关（托盘菜单）
+    bool isTiledOcrEnabled() const { return tiledOcrEnabled; }
+    void setTiledOcrEnabled(bool enabled) { tiledOcrEnabled = enabled; }
+    
+    // 本地快速识别开关（托盘菜单）
+    bool isLocalOcrEnabled() const { return localOcrEnabled; }
+    void setLocalOcrEnabled(bool enabled) { localOcrEnabled = enabled; }
+    
+    // 上传前灰度化与缩小（托盘菜单）
+    bool isPreprocessEnabled() const { return preprocessEnabled; }
+    void setPreprocessEnabled(bool enabled) { preprocessEnabled = enabled; }
+    
+    // 慢请求自动发副本（托盘菜单）
+    bool isHedgingEnabled() const { return ocrHedger.isEnabled(); }
+    void setHedgingEnabled(bool enabled) { ocrHedger.setEnabled(enabled); }
+    
     // 公共访问（供HotkeyManager使用）
     bool windowCreated;
 
@@ -26,18 +54,55 @@ private:
     int startX, startY, endX, endY;
     bool dragging;
     int screenWidth, screenHeight;
+    std::unique_ptr<CaptureSource> captureSource;
+    // 采集源的 DC 与像素缓冲区在所有任务间共用，截图与复制像素在锁内进行
+    std::mutex captureMutex;
+    // 预处理的策略；是否启用由 preprocessEnabled 决定，每次截图时取一份
+    std::atomic<bool> preprocessEnabled;
+    PreprocessOptions preprocessOptions;
+    FormatPolicy formatPolicy;
+    // 服务器以 411/501/505 拒绝过分块请求后不再尝试流式上传
+    std::atomic<bool> chunkedUploadRejected;
+    // 按截图像素缓存识别结果，每次得到新结果后写回磁盘
+    OcrCache ocrCache;
+    std::string cachePath;
+    std::mutex cacheFileMutex;
+    // 选区高度达到 tilingOptions.minHeight 时切成水平带并发识别
+    std::atomic<bool> tiledOcrEnabled;
+    TilingOptions tilingOptions;
+    // 单行短文本先在本地识别，置信度不够再走远程
+    std::atomic<bool> localOcrEnabled;
+    LocalOcr localOcr;
+    // 整块上传的识别请求超过最近延迟的 p90 仍未返回时另发一个副本
+    RequestHedger ocrHedger;
+    // 当前的识别任务（Esc 取消用）。放在最后：析构时先于上面的成员等任务退出
+    std::mutex ocrJobMutex;
+    std::shared_ptr<Job> ocrJob;
+    JobRunner ocrJobs;
     
     void createOverlayWindow();
     void closeOverlay();
     void onMousePress(int x, int y);
     void onMouseDrag(int x, int y);
     void onMouseRelease(int x, int y);
-    void captureAndOCR(int x1, int y1, int x2, int y2);
+    void captureAndOCR(Job& job, int x1, int y1, int x2, int y2);
     
-    std::string captureScreenRegion(int x, int y, int width, int height);
-    std::string callYoudaoOCR(const std::string& imgBase64);
-    std::string encodeBase64(const std::vector<unsigned char>& data);
-    std::string unescapeJsonString(const std::string& escapedStr);
+    // 截取区域并把像素复制到 pixels，view 指向这份副本：被取消的任务仍在编码时，
+    // 下一次截图可能覆盖或重建采集源的缓冲区，任务只读自己的副本
+    bool captureRegion(int x, int y, int width, int height, std::vector<unsigned char>& pixels,
+                       PixelBufferView& view);
+    std::vector<unsigned char> encodeCapture(const PixelBufferView& view, AdaptiveEncodeResult& result);
+    // requestBytes 返回上传的请求体字节数（供缓存统计省下的流量）
+    // cancel 为所属任务的取消令牌，取消时中断进行中的请求。
+    // 图像按值传入并移交给各次尝试共同持有，调用方不再使用时应 std::move 进来，避免复制
+    std::string callYoudaoOCR(std::vector<unsigned char> pngData, size_t& requestBytes, RequestCancel& cancel);
+    // 边编码边以 chunked 请求上传；失败时重新编码改发定长请求
+    std::string callYoudaoOCRStreaming(const PixelBufferView& view, size_t& requestBytes, RequestCancel& cancel);
+    // 分块识别；第一个带完成后先把已识别的文字放进剪贴板（partialCopied 置为 true，得到完整结果后复位）。
+    // 有带失败时整张图改发一次请求
+    std::string callYoudaoOCRTiled(const PixelBufferView& view, const std::vector<TileBand>& bands, size_t& requestBytes,
+                                   RequestCancel& cancel, bool& partialCopied);
+    void saveOcrCache();
     void copyToClipboard(const std::string& text);
     
     static LRESULT CALLBACK OverlayWindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
@@ -0,0 +1,43 @@
+#ifndef SOCKET_H
+#define SOCKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 对 BSD 套接字与 Winsock 的最小封装（阻塞 TCP），供 HTTP 客户端与本地替身服务器使用
+
+// Winsock 的 SOCKET 为无符号指针宽度整数，INVALID_SOCKET 转换后同为 -1
+typedef intptr_t SocketHandle;
+const SocketHandle INVALID_SOCKET_HANDLE = -1;
+
+// Windows 上初始化 Winsock（只执行一次），其他平台无需初始化（发送时用 MSG_NOSIGNAL 避免 SIGPIPE）
+bool InitSockets();
+
+// 连接 host:port，timeoutMs > 0 时限制连接耗时并设置收发超时
+SocketHandle ConnectTcp(const std::string& host, int port, int timeoutMs, std::string& error);
+
+// 在 host:port 上监听（port 为 0 时由系统分配），返回监听套接字
+SocketHandle ListenTcp(const std::string& host, int port, int backlog, std::string& error);
+SocketHandle AcceptTcp(SocketHandle listener);
+int LocalPort(SocketHandle socket);
+
+void SetSocketTimeout(SocketHandle socket, int timeoutMs);
+bool SendAll(SocketHandle socket, const char* data, size_t size);
+
+// 返回读到的字节数；0 表示对端关闭，负数表示出错或超时
+long ReceiveSome(SocketHandle socket, char* buffer, size_t size);
+
+// 当前线程最近一次收发失败是否因超时（SO_RCVTIMEO/SO_SNDTIMEO 到期）
+bool SocketTimedOut();
+
+// 等待可读（数据到达或对端关闭），超时返回 false
+bool WaitReadable(SocketHandle socket, int timeoutMs);
+
+// 关闭发送方向后再关闭，让对端读到 EOF
+void ShutdownSocket(SocketHandle socket);
+// 关闭收发两个方向，让其他线程中阻塞的收发立即返回（用于取消请求），之后仍需 CloseSocket
+void AbortSocket(SocketHandle socket);
+void CloseSocket(SocketHandle socket);
+
+#endif // SOCKET_H
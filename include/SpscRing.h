@@ -0,0 +1,57 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// 单生产者、单消费者的无锁环形队列：push 只能由一个线程调用，pop 只能由另一个线程调用。
+// 两端都不加锁、不分配内存，队列满时 push 直接返回 false（适合按键钩子这类不能等待的生产者）
+template <typename T>
+class SpscRing {
+public:
+    // 容量向上取整为 2 的幂
+    explicit SpscRing(size_t capacity) : head(0), tail(0) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    bool push(const T& item) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        if (position - head.load(std::memory_order_acquire) > mask) return false;
+        slots[position & mask] = item;
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        size_t position = head.load(std::memory_order_relaxed);
+        if (position == tail.load(std::memory_order_acquire)) return false;
+        item = slots[position & mask];
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    std::vector<T> slots;
+    size_t mask;
+    // 读写位置各占一条缓存行，生产者与消费者不互相使对方的缓存失效
+    char padHead[64];
+    std::atomic<size_t> head;   // 消费者写
+    char padTail[64];
+    std::atomic<size_t> tail;   // 生产者写
+    char padEnd[64];
+
+    SpscRing(const SpscRing&);
+    SpscRing& operator=(const SpscRing&);
+};
+
+#endif // SPSCRING_H
@@ -0,0 +1,175 @@
+#ifndef STREAMINGASR_H
+#define STREAMINGASR_H
+
+#include "Job.h"
+#include "PcmSpill.h"
+#include "VoiceActivity.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 边录边识别：录音过程中在停顿处切段，已完成的段在后台上传识别，结果按段的顺序拼接。
+// 按空格结束时只剩最后一小段（停顿之后再按结束则一段都不剩）需要等待，不必再上传整段录音。
+// 每段都短于服务商的单次请求上限，录音长度因此不受限制：同时识别的段数有上限，其余的排队
+// （可写入临时文件，不占内存），结束录音后的等待取决于最长的一段而不是录音总长
+
+// 停顿检测的参数。音频为 16 位单声道小端 PCM，逐帧的语音判定见 VadOptions
+struct SegmenterOptions {
+    VadOptions vad;
+    int minSegmentMs;           // 段短于此不切，避免大量很短的请求
+    int maxSegmentMs;           // 一直没有停顿时在最安静的一帧强制切开
+    int minPauseMs;             // 连续静音达到此时长视为停顿，在停顿中间切开
+
+    SegmenterOptions() : minSegmentMs(3000), maxSegmentMs(20000), minPauseMs(400) {}
+};
+
+struct SegmentCut {
+    long long offset;           // 相对整段录音的字节偏移，按帧对齐
+    bool forced;                // 没有停顿，在最安静的一帧强制切开（切点处可能正在说话）
+};
+
+// 增量的停顿检测：按到达顺序送入 PCM，给出切点
+class SpeechSegmenter {
+public:
+    explicit SpeechSegmenter(const SegmenterOptions& options = SegmenterOptions());
+
+    // 送入任意长度的数据（不足一帧的部分留到下次），新确定的切点追加到 cuts
+    void feed(const char* data, size_t size, std::vector<SegmentCut>& cuts);
+    // 上一个切点之后是否出现过非静音帧；没有时最后一段不必上传
+    bool voicedSinceCut() const { return lastVoiced >= segmentStart; }
+    double noiseFloor() const { return vad.noiseFloor(); }
+
+private:
+    SegmenterOptions options;
+    VoiceActivityDetector vad;
+    size_t frameBytes;
+    std::vector<char> partial;      // 不足一帧的剩余字节
+    long long frame;                // 已处理的帧数
+    long long segmentStart;         // 当前段的起始帧
+    long long silenceStart;         // 当前静音段的起始帧，-1 表示不在静音中
+    long long quietestFrame;        // 可强制切开的范围内最安静的一帧
+    double quietestEnergy;
+    long long lastVoiced;           // 最近一个非静音帧
+
+    void processFrame(const char* data, std::vector<SegmentCut>& cuts);
+    void cutAt(long long cutFrame, bool forced, std::vector<SegmentCut>& cuts);
+};
+
+// 强制切开的两段有一小段重叠的录音，切点上的字不会被截成两半；拼接时去掉 previous 末尾与 next 开头
+// 重复的文字（逐字比较，忽略交界处的标点和空格，至少 2 个字、最多 maxOverlapChars 个字）。
+// 找不到重复时按原样连接，两边都是中文等非 ASCII 字符时不加空格。removedChars 为去掉的字数
+std::string MergeOverlappingText(const std::string& previous, const std::string& next, size_t maxOverlapChars,
+                                 size_t* removedChars = nullptr);
+
+// 识别一段 PCM，在 I/O 池的线程上调用。成功返回 true，text 为该段文字（没有语音时为空）
+typedef std::function<bool(const std::shared_ptr<std::vector<char> >& pcm, RequestCancel& cancel,
+                           std::string& text)> AsrSegmentRecognizer;
+
+struct StreamingAsrOptions {
+    SegmenterOptions segmenter;
+    int segmentDeadlineMs;          // 每段识别的时限（从开始识别算起，不含排队）
+    int maxConcurrentSegments;      // 同时识别的段数，其余的按顺序排队
+    int overlapMs;                  // 强制切开时下一段从切点之前这么多开始
+    size_t maxOverlapChars;         // 去重时交界处比较的最多字数
+    std::string spillPath;          // 非空时排队的段写入此临时文件；打不开时留在内存中
+
+    StreamingAsrOptions()
+        : segmentDeadlineMs(30000), maxConcurrentSegments(3), overlapMs(600), maxOverlapChars(12) {}
+};
+
+struct StreamingAsrResult {
+    bool ok;                    // 所有段都识别成功
+    std::string text;           // 各段文字按顺序以空格连接（重叠的交界已去重）；有段失败时为其余段的文字
+    size_t segments;
+    size_t failedSegments;
+    std::vector<long long> segmentOffsets;  // 各段在整段录音中的起点
+    std::vector<size_t> segmentBytes;   // 各段切下的长度（强制切开的段含与前一段重叠的部分）
+    std::vector<size_t> uploadBytes;    // 各段去掉首尾静音后实际上传的长度，没有语音的段为 0
+    size_t trimmedBytes;                // 各段去掉的静音合计
+    bool tailSkipped;           // 最后一段全是静音，没有上传
+    size_t tailBytes;
+    long long recordedBytes;    // 送入的录音总长
+    size_t forcedCuts;
+    size_t dedupedChars;        // 重叠交界处去掉的重复字数
+    size_t inFlightAtFinish;    // 结束录音时尚未完成的段（含最后一段）
+    size_t maxConcurrent;       // 同时识别的最多段数
+    size_t peakBufferedBytes;   // 内存中的录音（当前段与识别中、排队中的段）的峰值
+    unsigned long long spilledBytes;    // 排队时写入临时文件的字节
+    double finishMs;            // finish 的等待时间，即结束录音到拿到文字
+
+    StreamingAsrResult()
+        : ok(false), segments(0), failedSegments(0), trimmedBytes(0), tailSkipped(false), tailBytes(0),
+          recordedBytes(0), forcedCuts(0), dedupedChars(0), inFlightAtFinish(0), maxConcurrent(0),
+          peakBufferedBytes(0), spilledBytes(0), finishMs(0) {}
+};
+
+class StreamingAsr {
+public:
+    // 段识别作为任务在 pool 上运行
+    StreamingAsr(const AsrSegmentRecognizer& recognize, ThreadPool* pool,
+                 const StreamingAsrOptions& options = StreamingAsrOptions());
+    ~StreamingAsr();
+
+    // 录音时按顺序送入新录下的 PCM（同一时刻只能有一个线程调用）。不等待识别：段数超过并发上限时排队
+    void feed(const char* data, size_t size);
+    // 录音结束：提交最后一段并等待所有段完成，最多 timeoutMs；超时的段被取消，结果 ok 为 false
+    StreamingAsrResult finish(int timeoutMs);
+    // 取消所有进行中的段（取消录音或识别）
+    void cancel();
+
+private:
+    typedef std::shared_ptr<std::vector<char> > Pcm;
+
+    struct Segment {
+        bool done;
+        bool ok;
+        bool overlapsPrevious;      // 开头与前一段重叠（前一个切点是强制的）
+        long long offset;
+        size_t bytes;
+        size_t uploadBytes;
+        Pcm queued;                 // 排队中、留在内存里的录音
+        bool spilled;               // 排队中的录音已写入临时文件
+        size_t spillIndex;
+        std::string text;
+    };
+
+    AsrSegmentRecognizer recognize;
+    StreamingAsrOptions options;
+    SpeechSegmenter segmenter;
+    size_t overlapBytes;
+    std::vector<char> current;      // 上一个切点之后的录音
+    long long currentStart;         // current 在整段录音中的字节偏移
+    bool currentOverlaps;
+    size_t forcedCuts;
+    std::vector<SegmentCut> cuts;
+    PcmSpill spill;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<Segment> segments;
+    std::deque<size_t> pending;     // 排队的段，按顺序
+    size_t running;
+    size_t maxRunning;
+    size_t bufferedBytes;           // 识别中与排队中留在内存里的录音
+    size_t peakBufferedBytes;
+    bool stopping;                  // 已取消或超时，不再启动排队的段
+    // 放在最后：析构时先取消并等待段任务退出，它们还在使用上面的成员
+    JobRunner jobs;
+
+    void submit(const Pcm& pcm, long long offset, bool overlapsPrevious);
+    void startSegment(size_t index, const Pcm& pcm);
+    // 一段完成后取出下一个排队的段；没有时返回 false，并发名额归还
+    bool takePending(size_t& index, Pcm& pcm);
+
+    StreamingAsr(const StreamingAsr&);
+    StreamingAsr& operator=(const StreamingAsr&);
+};
+
+std::string DescribeStreamingAsr(const StreamingAsrResult& result);
+
+#endif // STREAMINGASR_H
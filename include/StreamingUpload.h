@@ -0,0 +1,67 @@
+#ifndef STREAMINGUPLOAD_H
+#define STREAMINGUPLOAD_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 边编码边上传：编码器在后台线程产生数据，调用线程把已产生的部分编码成表单字段并发出，
+// 压缩后续行与上传已压缩数据重叠进行
+
+// 增量 base64 + URL 编码：跨调用保留不足 3 字节的尾部，
+// 全部输出拼接后与对整段数据调用 WriteBase64FormEncoded 相同
+class Base64FormStreamEncoder {
+public:
+    Base64FormStreamEncoder();
+
+    // 追加编码结果到 out
+    void update(const unsigned char* data, size_t size, std::string& out);
+    // 输出剩余尾部（含 base64 填充）
+    void finish(std::string& out);
+
+private:
+    unsigned char carry[3];
+    size_t carrySize;
+};
+
+// 有界字节管道：生产者线程写入，消费者线程取走当前缓冲的全部数据。
+// 缓冲达到 capacity 时写入方阻塞，防止上行慢时编码结果无限堆积
+class BytePipe {
+public:
+    explicit BytePipe(size_t capacity);
+
+    // 读取方已放弃时返回 false（数据被丢弃）
+    bool write(const unsigned char* data, size_t size);
+    // 生产者写完
+    void close();
+    // 读取方放弃，唤醒阻塞的写入方
+    void cancel();
+
+    // 取出当前缓冲的全部数据（必要时等待）；管道已关闭且为空时返回 false
+    bool read(std::vector<unsigned char>& block);
+
+private:
+    size_t capacity;
+    std::vector<unsigned char> buffer;
+    bool closed;
+    bool cancelled;
+    std::mutex mutex;
+    std::condition_variable readable;
+    std::condition_variable writable;
+};
+
+typedef std::function<void(const unsigned char* data, size_t size)> ByteSink;
+// 生产者把输出依次交给 sink，成功返回 true
+typedef std::function<bool(const ByteSink& sink)> ByteProducer;
+// 消费者处理一块数据，返回 false 表示失败（如发送出错）
+typedef std::function<bool(const unsigned char* data, size_t size)> ByteConsumer;
+
+// 在共用的 CPU 池中运行 producer，调用线程把输出逐块交给 consume，两者重叠执行
+// （从 CPU 池的线程调用时在本线程依次执行，不重叠）。
+// pipeCapacity 为两者之间最多缓冲的字节数；任一方失败都返回 false
+bool RunPipelined(const ByteProducer& producer, size_t pipeCapacity, const ByteConsumer& consume);
+
+#endif // STREAMINGUPLOAD_H
@@ -0,0 +1,70 @@
+#ifndef TILEDOCR_H
+#define TILEDOCR_H
+
+#include "CaptureSource.h"
+#include "OcrClient.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 大选区分块识别：按水平带切开（切口尽量落在空白行），各带并发编码与上传，
+// 按带的顺序合并结果。相邻带有重叠，重叠区内的行按外接矩形中心只归属一个带
+
+struct TilingOptions {
+    int minHeight;          // 选区高度达到该值才分块
+    int bandHeight;         // 目标带高
+    int overlap;            // 每个切口上下各多传的像素，保证跨切口的行至少在一个带里完整
+    int searchRange;        // 在目标切口上下该范围内寻找空白行
+    int blankTolerance;     // 行内亮度极差不超过该值视为空白行
+    int maxConcurrent;      // 同时进行的带请求数
+
+    TilingOptions()
+        : minHeight(1400), bandHeight(640), overlap(32), searchRange(160), blankTolerance(16), maxConcurrent(4) {}
+};
+
+// 一个带：上传 [top, bottom) 行，只保留中心落在 [ownTop, ownBottom) 的识别行
+struct TileBand {
+    int top;
+    int bottom;
+    int ownTop;
+    int ownBottom;
+};
+
+// 规划切分；高度不足 minHeight 时返回覆盖整图的一个带
+std::vector<TileBand> PlanTileBands(const PixelBufferView& view, const TilingOptions& options);
+
+// 一个带的识别结果。lines 的坐标相对于上传的图片；imageWidth/imageHeight 为该图片尺寸
+// （预处理缩小时与带的像素尺寸不同），为 0 表示与带相同
+struct TileRecognition {
+    std::vector<OcrLine> lines;
+    int imageWidth;
+    int imageHeight;
+
+    TileRecognition() : imageWidth(0), imageHeight(0) {}
+};
+
+// 识别一个带（编码并请求接口），在调用 RunTiledOcr 的线程或共用 I/O 池的线程上调用；失败返回 false
+typedef std::function<bool(const PixelBufferView& band, TileRecognition& result)> TileRecognizer;
+// 前 completedBands 个带都已完成时调用，text 为到目前为止按顺序合并的文字。
+// 在识别带的线程上、合并结果的锁外按顺序调用，RunTiledOcr 返回前所有调用都已结束
+typedef std::function<void(size_t completedBands, size_t bandCount, const std::string& text)> TileProgress;
+
+struct TiledOcrResult {
+    bool ok;                // 所有带都识别成功
+    std::string text;
+    std::vector<OcrLine> lines;     // 合并后的行，坐标为整张选区的像素坐标（无外接矩形的行除外）
+    size_t bands;
+    size_t failedBands;
+    size_t duplicateLines;  // 因重叠被去掉的行数
+    double firstBandMs;     // 第一个带的文字可用的时间
+    double totalMs;
+
+    TiledOcrResult() : ok(false), bands(0), failedBands(0), duplicateLines(0), firstBandMs(0), totalMs(0) {}
+};
+
+// 最多 maxConcurrent 个带同时识别（调用线程加上 I/O 池中的帮手）；progress 可为空
+TiledOcrResult RunTiledOcr(const PixelBufferView& view, const std::vector<TileBand>& bands, int maxConcurrent,
+                           const TileRecognizer& recognize, const TileProgress& progress);
+
+#endif // TILEDOCR_H
@@ -0,0 +1,103 @@
+#ifndef VOICEACTIVITY_H
+#define VOICEACTIVITY_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 语音活动检测（VAD）：16 位单声道小端 PCM 按帧计算能量与过零率，对照自适应的背景噪声判定语音帧。
+// 用于裁掉录音首尾的静音、在停顿处切段，以及说完一段时间后自动结束录音
+
+// 可用的帧特征内核（运行时按 CPU 能力自动选择，基准测试时可手动指定）
+enum class VadKernel {
+    Scalar,
+    Sse2,
+    Avx2,
+    Neon
+};
+
+// 一帧的特征：各内核结果逐位一致
+struct FrameFeatures {
+    long long sumSquares;       // 样本平方和
+    int zeroCrossings;          // 相邻样本符号（< 0 与 >= 0）不同的次数
+};
+
+FrameFeatures AnalyzeFrame(const char* pcm, size_t samples);
+// 指定内核计算（内核不可用时退回标量实现）
+FrameFeatures AnalyzeFrameWithKernel(VadKernel kernel, const char* pcm, size_t samples);
+bool VadKernelSupported(VadKernel kernel);
+
+// 当前自动选择的内核及其名称
+VadKernel VadActiveKernel();
+const char* VadKernelName(VadKernel kernel);
+
+// 一帧样本的均方能量
+double FrameEnergy(const char* pcm, size_t samples);
+
+struct VadOptions {
+    int sampleRate;
+    int frameMs;
+    double speechRatio;         // 能量超过背景噪声的该倍数为语音
+    double fricativeRatio;      // 能量只超过该倍数、但过零率高于 fricativeZcr 的帧也算语音（清辅音）
+    double fricativeZcr;
+    double minSpeechEnergy;     // 语音能量（均方值）的下限，数字静音等噪声极低的录音靠它判定
+    double loudEnergy;          // 能量超过该值总算语音，背景噪声估计偏高时也不会把说话当成静音
+    int leadPadMs;              // 裁剪时语音前后保留的静音
+    int trailPadMs;
+
+    VadOptions()
+        : sampleRate(16000), frameMs(20), speechRatio(8.0), fricativeRatio(2.5), fricativeZcr(0.3),
+          minSpeechEnergy(400.0), loudEnergy(100000.0), leadPadMs(250), trailPadMs(350) {}
+};
+
+class VoiceActivityDetector {
+public:
+    explicit VoiceActivityDetector(const VadOptions& options = VadOptions());
+
+    size_t frameBytes() const { return bytesPerFrame; }
+
+    // 判定一帧（frameBytes() 字节），返回是否为语音
+    bool processFrame(const char* frame);
+    // 已算好特征的帧（整段分析时先批量计算特征）
+    bool processFeatures(const FrameFeatures& features);
+    // 送入任意长度的数据逐帧判定，不足一帧的部分留到下次
+    void feed(const char* data, size_t size);
+    // 以已知的背景噪声能量开始；不调用时以第一帧为准
+    void seedNoiseFloor(double energy);
+
+    long long frames() const { return frame; }
+    long long firstSpeechFrame() const { return firstSpeech; }   // -1 表示还没有语音
+    long long lastSpeechFrame() const { return lastSpeech; }
+    bool speechSeen() const { return lastSpeech >= 0; }
+    // 最后一个语音帧之后的静音时长；还没有语音时为 0
+    int trailingSilenceMs() const;
+    double lastEnergy() const { return energy; }
+    double noiseFloor() const { return floor; }
+
+private:
+    VadOptions options;
+    size_t bytesPerFrame;
+    std::vector<char> partial;
+    long long frame;
+    long long firstSpeech;
+    long long lastSpeech;
+    double energy;
+    double floor;
+    bool seeded;
+};
+
+// 整段录音中语音所在的字节范围（含前后留白，按样本对齐）；没有语音时 begin == end
+struct SpeechRange {
+    size_t begin;
+    size_t end;
+};
+
+// 先算出所有帧的特征，以能量的低分位数作为背景噪声，录音一开始就说话也能正确判定
+SpeechRange FindSpeechRange(const char* pcm, size_t size, const VadOptions& options = VadOptions());
+
+// 去掉首尾的静音，返回去掉的字节数；没有语音时清空
+size_t TrimSilence(std::vector<char>& pcm, const VadOptions& options = VadOptions());
+
+std::string DescribeSilenceTrim(size_t totalBytes, size_t trimmedBytes, int sampleRate);
+
+#endif // VOICEACTIVITY_H
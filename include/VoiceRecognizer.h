@@ -7,6 +7,15 @@
 #include <vector>
 #include <thread>
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include "AsrClient.h"
+#include "RequestBody.h"
+#include "RequestHedger.h"
+#include "Job.h"
+#include "PcmCapture.h"
+#include "StreamingAsr.h"
+#include "VoiceActivity.h"
 
 class AppManager;
 
@@ -22,6 +31,27 @@ public:
     // 新增：按键事件处理接口
     void onKeyPressed(int vkCode);
     
+    // 录音结束后识别请求是否仍在进行；Esc 可取消
+    bool isRecognizing();
+    void cancelRecognition();
+    
+    // 慢请求自动发副本（托盘菜单）
+    bool isHedgingEnabled() const { return asrHedger.isEnabled(); }
+    void setHedgingEnabled(bool enabled) { asrHedger.setEnabled(enabled); }
+    
+    // 边录边识别（托盘菜单）：录音中在停顿处切段上传，结束时只等最后一段
+    bool isStreamingEnabled() const { return streamingEnabled; }
+    void setStreamingEnabled(bool enabled) { streamingEnabled = enabled; }
+    
+    // 说完自动结束（托盘菜单）：检测到语音后静音达到该时长即结束录音，0 为关闭。下次录音起生效
+    static const int DEFAULT_AUTO_STOP_MS = 2500;
+    int autoStopSilenceMs() const { return autoStopMs; }
+    void setAutoStopSilenceMs(int ms) { autoStopMs = ms; }
+    
+    // 录音以 FLAC 上传（托盘菜单）：服务商不接受时自动改回 WAV
+    bool isFlacUploadEnabled() const { return audioFormat.isFlacAccepted(); }
+    void setFlacUploadEnabled(bool enabled) { audioFormat.setFlacAccepted(enabled); }
+    
     // 公共访问（供HotkeyManager使用）
     std::atomic<bool> keyListeningActive;
 
@@ -33,32 +63,58 @@ private:
     WAVEFORMATEX waveFormat;
     
     std::vector<WAVEHDR> waveHeaders;
-    std::vector<std::vector<char>> audioBuffers;
-    std::vector<char> recordedData;
+    // 设备缓冲区与整段录音的存储；回调只发布填满的缓冲区，由它的消费线程拼接
+    std::unique_ptr<PcmCapture> capture;
+    // 消费线程交还缓冲区与停止录音互斥：停止后不会再有缓冲区交给设备
+    std::mutex deviceMutex;
+    // 本次录音的分段识别，由 capture 的消费线程送入录音；结束录音时移交给识别任务
+    std::atomic<bool> streamingEnabled;
+    std::unique_ptr<StreamingAsr> streaming;
+    // 自动结束用的语音检测，同样在消费线程中送入；每次录音只请求一次结束
+    std::atomic<int> autoStopMs;
+    std::unique_ptr<VoiceActivityDetector> autoStopDetector;
+    std::atomic<bool> autoStopRequested;
+    // 每次开始录音加一，排队中的自动结束据此判断录音是否还是同一次
+    std::atomic<unsigned> recordingId;
     
     std::atomic<bool> isRecording;
     std::atomic<bool> shouldStop;
     std::thread recordingThread;
     std::thread timerThread;
     
+    // 识别请求超过最近延迟的 p90 仍未返回时另发一个副本
+    RequestHedger asrHedger;
+    AsrAudioFormat audioFormat;
+    
+    // 当前的识别任务（Esc 取消用）。放在最后：析构时先于上面的成员等任务退出
+    std::mutex asrJobMutex;
+    std::shared_ptr<Job> asrJob;
+    JobRunner asrJobs;
+    
     static const int SAMPLE_RATE = 16000;
     static const int CHANNELS = 1;
     static const int BITS_PER_SAMPLE = 16;
     static const int BUFFER_SIZE = 4096;
     static const int NUM_BUFFERS = 4;
-    static const int MAX_RECORD_TIME = 59; // 最大录音时间（秒）
+    static const int MAX_RECORD_TIME = 59; // 最大录音时间（秒）；边录边识别时只限制整段重传用的存储
     
     void initializeWaveFormat();
     void setupRecording();
     void cleanupRecording();
-    void timerLoop();
+    bool requeueBuffer(size_t index);
+    void onRecorded(const char* data, size_t size);
+    std::vector<char> finishCapture();
+    // limited 为 false 时（边录边识别）不限录音时长
+    void timerLoop(bool limited);
     
     // 移除 recordingLoop，改为事件驱动
     // void recordingLoop();  // 删除这一行
     
-    std::vector<char> createWavFile(const std::vector<char>& audioData);
-    std::string sendToYoudaoAPI(const std::vector<char>& audioData);
-    void processResult(const std::string& result);
+    RequestBody buildAsrRequestBody(const std::vector<char>& pcmData, const std::string& boundary, bool& flac);
+    std::string sendToYoudaoAPI(const std::shared_ptr<std::vector<char>>& pcmData, RequestCancel& cancel);
+    std::string postAsrRequest(const std::shared_ptr<std::vector<char>>& pcmData, bool& flac, RequestCancel& cancel);
+    bool recognizeSegment(const std::shared_ptr<std::vector<char>>& pcmData, RequestCancel& cancel, std::string& text);
+    void processResult(const AsrResult& asr);
     void insertTextAtCursor(const std::string& text);
     void copyToClipboard(const std::string& text);
     
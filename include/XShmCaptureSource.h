@@ -0,0 +1,27 @@
+#ifndef XSHMCAPTURESOURCE_H
+#define XSHMCAPTURESOURCE_H
+
+#include "CaptureSource.h"
+#include <memory>
+
+// X11 MIT-SHM 截图：X 服务器直接把像素写入共享内存段，客户端零拷贝读取。
+// 共享段按根窗口大小只分配一次，XImage 头只在截图尺寸变化时重建。
+// X11 头文件的宏（None、Bool、Status 等）不泄漏到包含方，实现细节放在 Impl 中
+class XShmCaptureSource : public CaptureSource {
+public:
+    // displayName 为空时使用 DISPLAY 环境变量
+    explicit XShmCaptureSource(const char* displayName = nullptr);
+    ~XShmCaptureSource();
+
+    // 连接 X 服务器并建立共享段是否成功（要求 24/32 位 TrueColor 与 MIT-SHM 扩展）
+    bool isOpen() const;
+
+    bool capture(int x, int y, int width, int height, PixelBufferView& view) override;
+    const char* name() const override { return "xshm"; }
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+#endif // XSHMCAPTURESOURCE_H
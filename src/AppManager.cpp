@@ -3,7 +3,8 @@
 #include "../include/ScreenCapture.h"
 #include "../include/VoiceRecognizer.h"
 #include "../include/StringUtils.h"
-#include <thread>
+#include <algorithm>
+#include <functional>
 #include <gdiplus.h>
 #include <windowsx.h>
 
@@ -16,38 +17,48 @@
 
 AppManager* AppManager::instance = nullptr;
 
-// ToastWindow 类实现
-class ToastWindow {
+namespace {
+
+const UINT_PTR TOAST_TIMER_ID = 1;
+const int TOAST_WIDTH = 500;
+const int TOAST_HEIGHT = 120;
+
+} // namespace
+
+// 常驻的提示窗口：第一次显示时创建，之后只替换文字、显示或隐藏；窗口类、字体与画刷只创建一次
+class ToastSink : public NotificationSink {
 public:
-    ToastWindow(const std::string& message, int duration = 2000);
-    ~ToastWindow();
-    void show();
-    void close();
+    explicit ToastSink(const std::function<void()>& onClick);
+    ~ToastSink();
+    void show(const std::string& text) override;
+    void hide() override;
 
 private:
     HWND hwnd;
-    std::string message;
-    int duration;
+    std::wstring message;
+    HFONT font;
+    HBRUSH background;
+    std::function<void()> onClick;
+    bool createWindow();
     static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
-    void createWindow();
-    static void CALLBACK TimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime);
 };
 
-ToastWindow::ToastWindow(const std::string& message, int duration) 
-    : hwnd(nullptr), message(message), duration(duration) {
+ToastSink::ToastSink(const std::function<void()>& onClick)
+    : hwnd(nullptr), font(nullptr), background(CreateSolidBrush(RGB(51, 51, 51))), onClick(onClick) {
 }
 
-ToastWindow::~ToastWindow() {
-    close();
+ToastSink::~ToastSink() {
+    if (hwnd) DestroyWindow(hwnd);
+    if (font) DeleteObject(font);
+    DeleteObject(background);
 }
 
-void ToastWindow::createWindow() {
+bool ToastSink::createWindow() {
     WNDCLASSEX wc = {};
     wc.cbSize = sizeof(WNDCLASSEX);
     wc.lpfnWndProc = WindowProc;
     wc.hInstance = GetModuleHandle(nullptr);
     wc.lpszClassName = "ToastWindow";
-    wc.hbrBackground = CreateSolidBrush(RGB(51, 51, 51));
     wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
     
     RegisterClassEx(&wc);
@@ -57,61 +68,49 @@ void ToastWindow::createWindow() {
         "ToastWindow",
         "Toast",
         WS_POPUP,
-        0, 0, 500, 120,
+        0, 0, TOAST_WIDTH, TOAST_HEIGHT,
         nullptr, nullptr, GetModuleHandle(nullptr), this
     );
+    if (!hwnd) return false;
     
-    if (hwnd) {
-        SetLayeredWindowAttributes(hwnd, 0, (BYTE)(255 * 0.9), LWA_ALPHA);
-        
-        int screenWidth = GetSystemMetrics(SM_CXSCREEN);
-        int screenHeight = GetSystemMetrics(SM_CYSCREEN);
-        int x = (screenWidth - 500) / 2;
-        int y = screenHeight - 200;
-        
-        SetWindowPos(hwnd, HWND_TOPMOST, x, y, 500, 120, SWP_SHOWWINDOW);
-        SetTimer(hwnd, 1, duration, TimerProc);
-    }
+    SetLayeredWindowAttributes(hwnd, 0, (BYTE)(255 * 0.9), LWA_ALPHA);
+    font = CreateFont(30, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
+        DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
+        DEFAULT_QUALITY, DEFAULT_PITCH | FF_DONTCARE, "Arial");
+    return true;
 }
 
-void ToastWindow::show() {
-    createWindow();
-    
-    if (hwnd) {
-        MSG msg;
-        while (GetMessage(&msg, nullptr, 0, 0)) {
-            if (msg.hwnd == hwnd || IsChild(hwnd, msg.hwnd)) {
-                TranslateMessage(&msg);
-                DispatchMessage(&msg);
-                if (msg.message == WM_QUIT) break;
-            } else {
-                TranslateMessage(&msg);
-                DispatchMessage(&msg);
-            }
-        }
-    }
+void ToastSink::show(const std::string& text) {
+    message = Utf8ToWide(text);
+    if (!hwnd && !createWindow()) return;
+    
+    // 每次显示时重新取屏幕尺寸，分辨率变化后位置仍然正确
+    int screenWidth = GetSystemMetrics(SM_CXSCREEN);
+    int screenHeight = GetSystemMetrics(SM_CYSCREEN);
+    int x = (screenWidth - TOAST_WIDTH) / 2;
+    int y = screenHeight - 200;
+    SetWindowPos(hwnd, HWND_TOPMOST, x, y, TOAST_WIDTH, TOAST_HEIGHT, SWP_SHOWWINDOW | SWP_NOACTIVATE);
+    InvalidateRect(hwnd, nullptr, FALSE);
 }
 
-void ToastWindow::close() {
-    if (hwnd) {
-        KillTimer(hwnd, 1);
-        DestroyWindow(hwnd);
-        hwnd = nullptr;
-    }
+void ToastSink::hide() {
+    if (hwnd) ShowWindow(hwnd, SW_HIDE);
 }
 
-LRESULT CALLBACK ToastWindow::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
-    ToastWindow* toast = nullptr;
+LRESULT CALLBACK ToastSink::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    ToastSink* toast = nullptr;
     
     if (uMsg == WM_CREATE) {
         CREATESTRUCT* cs = reinterpret_cast<CREATESTRUCT*>(lParam);
-        toast = static_cast<ToastWindow*>(cs->lpCreateParams);
+        toast = static_cast<ToastSink*>(cs->lpCreateParams);
         SetWindowLongPtr(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(toast));
     } else {
-        toast = reinterpret_cast<ToastWindow*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+        toast = reinterpret_cast<ToastSink*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
     }
     
     switch (uMsg) {
+    case WM_ERASEBKGND:
+        return 1;  // WM_PAINT 整个窗口重画
     case WM_PAINT: {
         PAINTSTRUCT ps;
         HDC hdc = BeginPaint(hwnd, &ps);
@@ -119,50 +118,28 @@ LRESULT CALLBACK ToastWindow::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LP
         RECT rect;
         GetClientRect(hwnd, &rect);
         
-        HBRUSH bgBrush = CreateSolidBrush(RGB(51, 51, 51));
-        FillRect(hdc, &rect, bgBrush);
-        DeleteObject(bgBrush);
-        
         if (toast) {
+            FillRect(hdc, &rect, toast->background);
             SetTextColor(hdc, RGB(255, 255, 255));
             SetBkMode(hdc, TRANSPARENT);
             
-            HFONT font = CreateFont(30, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
-                DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
-                DEFAULT_QUALITY, DEFAULT_PITCH | FF_DONTCARE, "Arial");
-            HFONT oldFont = (HFONT)SelectObject(hdc, font);
-            
-            std::wstring wMessage = Utf8ToWide(toast->message); 
-            DrawTextW(hdc, wMessage.c_str(), -1, &rect, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
-            
+            HFONT oldFont = (HFONT)SelectObject(hdc, toast->font);
+            DrawTextW(hdc, toast->message.c_str(), -1, &rect, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
             SelectObject(hdc, oldFont);
-            DeleteObject(font);
         }
         
         EndPaint(hwnd, &ps);
         return 0;
     }
     case WM_LBUTTONDOWN:
-        if (toast) toast->close();
-        return 0;
-    case WM_TIMER:
-        if (toast) toast->close();
-        return 0;
-    case WM_DESTROY:
-        PostQuitMessage(0);
+        // 点击提前关闭，交给提示队列决定隐藏还是显示下一条
+        if (toast && toast->onClick) toast->onClick();
         return 0;
     }
     
     return DefWindowProc(hwnd, uMsg, wParam, lParam);
 }
 
-void CALLBACK ToastWindow::TimerProc(HWND hwnd, UINT /*uMsg*/, UINT_PTR /*idEvent*/, DWORD /*dwTime*/) {
-    ToastWindow* toast = reinterpret_cast<ToastWindow*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
-    if (toast) {
-        toast->close();
-    }
-}
-
 // AppManager 实现
 AppManager::AppManager() 
     : hiddenWindow(nullptr), hotkeyManager(nullptr), 
@@ -176,6 +153,10 @@ AppManager::AppManager()
     ULONG_PTR gdiplusToken;
     Gdiplus::GdiplusStartup(&gdiplusToken, &gdiplusStartupInput, nullptr);
     
+    // 提示窗口由主线程持有，各组件的提示都经由队列显示
+    toastSink.reset(new ToastSink([this]() { dismissToast(); }));
+    notifications.reset(new NotificationQueue(*toastSink));
+    
     // 创建功能组件
     screenCapture = new ScreenCapture(this);
     voiceRecognizer = new VoiceRecognizer(this);
@@ -188,9 +169,9 @@ AppManager::AppManager()
 }
 
 AppManager::~AppManager() {
+    // 先停止按键钩子与分发线程；组件析构时还会报告状态变化，分发器最后释放
     if (hotkeyManager) {
-        delete hotkeyManager;
-        hotkeyManager = nullptr;
+        hotkeyManager->stopListening();
     }
     if (screenCapture) {
         delete screenCapture;
@@ -200,16 +181,46 @@ AppManager::~AppManager() {
         delete voiceRecognizer;
         voiceRecognizer = nullptr;
     }
+    if (hotkeyManager) {
+        delete hotkeyManager;
+        hotkeyManager = nullptr;
+    }
     
     removeTrayIcon();
     instance = nullptr;
+    
+    std::string log = DescribeNotificationStats(notifications->stats()) + "\n";
+    OutputDebugStringA(log.c_str());
 }
 
 void AppManager::showToast(const std::string& message, int duration) {
-    std::thread([message, duration]() {
-        ToastWindow toast(message, duration);
-        toast.show();
-    }).detach();
+    // 任意线程调用：消息进入队列，由主线程显示；已有未处理的唤醒时不再重复投递
+    if (notifications->post(message, duration, std::chrono::steady_clock::now()) && hiddenWindow) {
+        PostMessage(hiddenWindow, WM_SHOWTOAST, 0, 0);
+    }
+}
+
+void AppManager::pumpToasts() {
+    NotificationTime now = std::chrono::steady_clock::now();
+    NotificationTime next = notifications->pump(now);
+    KillTimer(hiddenWindow, TOAST_TIMER_ID);
+    if (next != NotificationTime::max()) {
+        long long delayMs = std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count() + 1;
+        SetTimer(hiddenWindow, TOAST_TIMER_ID, (UINT)(std::max)(delayMs, 1LL), nullptr);
+    }
+}
+
+void AppManager::dismissToast() {
+    notifications->dismiss(std::chrono::steady_clock::now());
+    pumpToasts();
+}
+
+void AppManager::changeInputMode(InputMode from, InputMode to) {
+    if (hotkeyManager) hotkeyManager->input().changeMode(from, to);
+}
+
+void AppManager::setRecognizing(bool recognizing) {
+    if (hotkeyManager) hotkeyManager->input().setRecognizing(recognizing);
 }
 
 void AppManager::run() {
@@ -280,6 +291,12 @@ LRESULT CALLBACK AppManager::HiddenWindowProc(HWND hwnd, UINT uMsg, WPARAM wPara
     }
     
     switch (uMsg) {
+    case WM_SHOWTOAST:
+        if (app) app->pumpToasts();
+        return 0;
+    case WM_TIMER:
+        if (app && wParam == TOAST_TIMER_ID) app->pumpToasts();
+        return 0;
     case WM_TRAYICON:
         if (app) {
             switch (lParam) {
@@ -308,6 +325,40 @@ LRESULT CALLBACK AppManager::HiddenWindowProc(HWND hwnd, UINT uMsg, WPARAM wPara
             case ID_TRAY_AUTOSTART:
                 app->toggleAutoStart();
                 break;
+            case ID_TRAY_TILED_OCR:
+                if (app->screenCapture) {
+                    app->screenCapture->setTiledOcrEnabled(!app->screenCapture->isTiledOcrEnabled());
+                }
+                break;
+            case ID_TRAY_LOCAL_OCR:
+                if (app->screenCapture) {
+                    app->screenCapture->setLocalOcrEnabled(!app->screenCapture->isLocalOcrEnabled());
+                }
+                break;
+            case ID_TRAY_PREPROCESS:
+                if (app->screenCapture) {
+                    app->screenCapture->setPreprocessEnabled(!app->screenCapture->isPreprocessEnabled());
+                }
+                break;
+            case ID_TRAY_HEDGING:
+                app->setHedgingEnabled(!app->isHedgingEnabled());
+                break;
+            case ID_TRAY_STREAMING_ASR:
+                if (app->voiceRecognizer) {
+                    app->voiceRecognizer->setStreamingEnabled(!app->voiceRecognizer->isStreamingEnabled());
+                }
+                break;
+            case ID_TRAY_AUTO_STOP:
+                if (app->voiceRecognizer) {
+                    bool enabled = app->voiceRecognizer->autoStopSilenceMs() > 0;
+                    app->voiceRecognizer->setAutoStopSilenceMs(enabled ? 0 : VoiceRecognizer::DEFAULT_AUTO_STOP_MS);
+                }
+                break;
+            case ID_TRAY_FLAC_UPLOAD:
+                if (app->voiceRecognizer) {
+                    app->voiceRecognizer->setFlacUploadEnabled(!app->voiceRecognizer->isFlacUploadEnabled());
+                }
+                break;
             }
         }
         return 0;
@@ -316,6 +367,16 @@ LRESULT CALLBACK AppManager::HiddenWindowProc(HWND hwnd, UINT uMsg, WPARAM wPara
     return DefWindowProc(hwnd, uMsg, wParam, lParam);
 }
 
+bool AppManager::isHedgingEnabled() const {
+    if (screenCapture) return screenCapture->isHedgingEnabled();
+    return voiceRecognizer && voiceRecognizer->isHedgingEnabled();
+}
+
+void AppManager::setHedgingEnabled(bool enabled) {
+    if (screenCapture) screenCapture->setHedgingEnabled(enabled);
+    if (voiceRecognizer) voiceRecognizer->setHedgingEnabled(enabled);
+}
+
 void AppManager::showContextMenu(int x, int y) {
     HMENU hMenu = CreatePopupMenu();
     AppendMenuW(hMenu, MF_STRING, ID_TRAY_ABOUT, L"关于");
@@ -327,6 +388,55 @@ void AppManager::showContextMenu(int x, int y) {
     }
     AppendMenuW(hMenu, flags, ID_TRAY_AUTOSTART, L"开机自启动");
     
+    // 超高选区切成多段并发识别
+    flags = MF_STRING;
+    if (screenCapture && screenCapture->isTiledOcrEnabled()) {
+        flags |= MF_CHECKED;
+    }
+    AppendMenuW(hMenu, flags, ID_TRAY_TILED_OCR, L"大图分块识别");
+    
+    // 单行短文本先在本地识别
+    flags = MF_STRING;
+    if (screenCapture && screenCapture->isLocalOcrEnabled()) {
+        flags |= MF_CHECKED;
+    }
+    AppendMenuW(hMenu, flags, ID_TRAY_LOCAL_OCR, L"本地快速识别");
+    
+    // 上传前转为灰度并把高 DPI 截图缩小，默认关闭（缩小可能影响小字的识别）
+    flags = MF_STRING;
+    if (screenCapture && screenCapture->isPreprocessEnabled()) {
+        flags |= MF_CHECKED;
+    }
+    AppendMenuW(hMenu, flags, ID_TRAY_PREPROCESS, L"截图灰度化并缩小后上传");
+    
+    // 识别请求明显慢于平时时另发一个副本，先返回的为准
+    flags = MF_STRING;
+    if (isHedgingEnabled()) {
+        flags |= MF_CHECKED;
+    }
+    AppendMenuW(hMenu, flags, ID_TRAY_HEDGING, L"慢请求自动重发");
+    
+    // 录音中在停顿处分段上传，结束录音后只等最后一段
+    flags = MF_STRING;
+    if (voiceRecognizer && voiceRecognizer->isStreamingEnabled()) {
+        flags |= MF_CHECKED;
+    }
+    AppendMenuW(hMenu, flags, ID_TRAY_STREAMING_ASR, L"边录边识别（不限时长）");
+    
+    // 说完后静音一段时间自动结束录音，不必按空格
+    flags = MF_STRING;
+    if (voiceRecognizer && voiceRecognizer->autoStopSilenceMs() > 0) {
+        flags |= MF_CHECKED;
+    }
+    AppendMenuW(hMenu, flags, ID_TRAY_AUTO_STOP, L"说完自动结束");
+    
+    // 录音压缩为 FLAC 上传，约为原来的一半；识别服务不接受时自动改回 WAV
+    flags = MF_STRING;
+    if (voiceRecognizer && voiceRecognizer->isFlacUploadEnabled()) {
+        flags |= MF_CHECKED;
+    }
+    AppendMenuW(hMenu, flags, ID_TRAY_FLAC_UPLOAD, L"压缩上传录音（FLAC）");
+    
     AppendMenuW(hMenu, MF_SEPARATOR, 0, nullptr);
     AppendMenuW(hMenu, MF_STRING, ID_TRAY_EXIT, L"退出");
     
@@ -0,0 +1,47 @@
+#include "../include/AsrClient.h"
+#include "../include/JsonReader.h"
+
+AsrResult ParseAsrResponse(const std::string& response) {
+    AsrResult result;
+    JsonReader reader(response.data(), response.size());
+    enum { FIELD_NONE, FIELD_ERROR_CODE, FIELD_RESULT } field = FIELD_NONE;
+    bool inResult = false;
+
+    for (;;) {
+        JsonToken token = reader.next();
+        if (token == JSON_END) {
+            result.parsed = true;
+            break;
+        }
+        if (token == JSON_ERROR || token == JSON_NEED_MORE) break;
+
+        int depth = reader.depth();
+        if (token == JSON_KEY) {
+            // 顶层对象中的键
+            JsonText key = reader.text();
+            field = FIELD_NONE;
+            if (depth == 1 && key.equals("errorCode")) field = FIELD_ERROR_CODE;
+            else if (depth == 1 && key.equals("result")) field = FIELD_RESULT;
+            continue;
+        }
+
+        if (field == FIELD_ERROR_CODE && (token == JSON_STRING || token == JSON_NUMBER)) {
+            result.errorCode = reader.text().str();
+        } else if (field == FIELD_RESULT && token == JSON_BEGIN_ARRAY) {
+            inResult = true;
+        } else if (inResult && token == JSON_END_ARRAY && depth == 1) {
+            inResult = false;
+        } else if (inResult && token == JSON_STRING && depth == 2) {
+            JsonText sentence = reader.text();
+            result.sentences.push_back(sentence.str());
+            if (!result.text.empty()) result.text += " ";
+            result.text.append(sentence.data, sentence.size);
+        }
+        field = FIELD_NONE;
+    }
+    return result;
+}
+
+bool IsAsrAudioRejected(const AsrResult& result) {
+    return !result.parsed || (result.errorCode != "0" && result.errorCode != "4304");
+}
@@ -0,0 +1,73 @@
+#include "../include/AudioFormat.h"
+#include <cstring>
+
+namespace {
+
+void appendLittleEndian(std::string& out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back((char)((value >> (8 * i)) & 0xFF));
+    }
+}
+
+uint32_t readLittleEndian(const unsigned char* data, int bytes) {
+    uint32_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+} // namespace
+
+std::string BuildWavHeader(int sampleRate, int channels, int bitsPerSample, uint32_t dataBytes) {
+    uint32_t blockAlign = (uint32_t)(channels * bitsPerSample / 8);
+
+    std::string header;
+    header.reserve(44);
+    header.append("RIFF", 4);
+    appendLittleEndian(header, 36 + dataBytes, 4);
+    header.append("WAVE", 4);
+
+    header.append("fmt ", 4);
+    appendLittleEndian(header, 16, 4);
+    appendLittleEndian(header, 1, 2); // PCM
+    appendLittleEndian(header, (uint32_t)channels, 2);
+    appendLittleEndian(header, (uint32_t)sampleRate, 4);
+    appendLittleEndian(header, (uint32_t)sampleRate * blockAlign, 4);
+    appendLittleEndian(header, blockAlign, 2);
+    appendLittleEndian(header, (uint32_t)bitsPerSample, 2);
+
+    header.append("data", 4);
+    appendLittleEndian(header, dataBytes, 4);
+    return header;
+}
+
+bool ParseWav(const unsigned char* data, size_t size, WavInfo& info) {
+    if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) return false;
+    bool haveFormat = false;
+    size_t offset = 12;
+    while (offset + 8 <= size) {
+        const unsigned char* chunk = data + offset;
+        size_t chunkBytes = readLittleEndian(chunk + 4, 4);
+        size_t body = offset + 8;
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            if (chunkBytes < 16 || body + 16 > size) return false;
+            // 1 为 PCM；WAVE_FORMAT_EXTENSIBLE 的子格式不再细查
+            uint32_t tag = readLittleEndian(data + body, 2);
+            if (tag != 1 && tag != 0xFFFE) return false;
+            info.channels = (int)readLittleEndian(data + body + 2, 2);
+            info.sampleRate = (int)readLittleEndian(data + body + 4, 4);
+            info.bitsPerSample = (int)readLittleEndian(data + body + 14, 2);
+            haveFormat = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat) return false;
+            info.dataOffset = body;
+            // 录音中断的文件 data 长度可能未回填（0 或大于文件），按文件实际长度截取
+            info.dataBytes = chunkBytes == 0 || body + chunkBytes > size ? size - body : chunkBytes;
+            return info.channels > 0 && info.sampleRate > 0 && info.bitsPerSample > 0;
+        }
+        // 块按偶数字节对齐
+        offset = body + chunkBytes + (chunkBytes & 1);
+    }
+    return false;
+}
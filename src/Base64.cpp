@@ -0,0 +1,243 @@
+#include "../include/Base64.h"
+#include "../include/CpuFeatures.h"
+
+#if defined(SHOTOCR_ARCH_X86)
+#include <immintrin.h>
+#endif
+
+#if defined(SHOTOCR_ARCH_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+const char kBase64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// 标量实现：每 3 字节输出 4 字符，最后补齐 '='
+size_t encodeScalar(const unsigned char* src, size_t size, char* out) {
+    char* dst = out;
+    size_t i = 0;
+
+    for (; i + 3 <= size; i += 3) {
+        unsigned int v = (src[i] << 16) | (src[i + 1] << 8) | src[i + 2];
+        dst[0] = kBase64Chars[(v >> 18) & 0x3F];
+        dst[1] = kBase64Chars[(v >> 12) & 0x3F];
+        dst[2] = kBase64Chars[(v >> 6) & 0x3F];
+        dst[3] = kBase64Chars[v & 0x3F];
+        dst += 4;
+    }
+
+    size_t rest = size - i;
+    if (rest == 1) {
+        unsigned int v = src[i] << 16;
+        dst[0] = kBase64Chars[(v >> 18) & 0x3F];
+        dst[1] = kBase64Chars[(v >> 12) & 0x3F];
+        dst[2] = '=';
+        dst[3] = '=';
+        dst += 4;
+    } else if (rest == 2) {
+        unsigned int v = (src[i] << 16) | (src[i + 1] << 8);
+        dst[0] = kBase64Chars[(v >> 18) & 0x3F];
+        dst[1] = kBase64Chars[(v >> 12) & 0x3F];
+        dst[2] = kBase64Chars[(v >> 6) & 0x3F];
+        dst[3] = '=';
+        dst += 4;
+    }
+
+    return dst - out;
+}
+
+#if defined(SHOTOCR_ARCH_X86)
+
+// SSSE3 内核：每次读取 16 字节、消耗 12 字节，输出 16 字符
+// 需要 pshufb 完成字节重排，纯 SSE2 没有等价指令，因此最低要求为 SSSE3
+SHOTOCR_TARGET("ssse3")
+size_t encodeSsse3(const unsigned char* src, size_t size, char* out) {
+    char* dst = out;
+    const __m128i shuffle = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m128i maskAc = _mm_set1_epi32(0x0fc0fc00);
+    const __m128i mulAc = _mm_set1_epi32(0x04000040);
+    const __m128i maskBd = _mm_set1_epi32(0x003f03f0);
+    const __m128i mulBd = _mm_set1_epi32(0x01000010);
+    const __m128i offsetLut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                            '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                            '/' - 63, 'A', 0, 0);
+
+    while (size >= 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        in = _mm_shuffle_epi8(in, shuffle);
+
+        // 把每 3 字节拆成 4 个 6 位索引
+        __m128i ac = _mm_mulhi_epu16(_mm_and_si128(in, maskAc), mulAc);
+        __m128i bd = _mm_mullo_epi16(_mm_and_si128(in, maskBd), mulBd);
+        __m128i indices = _mm_or_si128(ac, bd);
+
+        // 索引映射到 ASCII：按区间查偏移表后相加
+        __m128i reduced = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        __m128i isUpper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+        reduced = _mm_or_si128(reduced, _mm_and_si128(isUpper, _mm_set1_epi8(13)));
+        __m128i result = _mm_add_epi8(_mm_shuffle_epi8(offsetLut, reduced), indices);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), result);
+        src += 12;
+        size -= 12;
+        dst += 16;
+    }
+
+    return (dst - out) + encodeScalar(src, size, dst);
+}
+
+// AVX2 内核：两个 128 位通道各处理 12 字节，输出 32 字符
+SHOTOCR_TARGET("avx2")
+size_t encodeAvx2(const unsigned char* src, size_t size, char* out) {
+    char* dst = out;
+    const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                             1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m256i maskAc = _mm256_set1_epi32(0x0fc0fc00);
+    const __m256i mulAc = _mm256_set1_epi32(0x04000040);
+    const __m256i maskBd = _mm256_set1_epi32(0x003f03f0);
+    const __m256i mulBd = _mm256_set1_epi32(0x01000010);
+    const __m256i offsetLut = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                               '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                               '/' - 63, 'A', 0, 0,
+                                               'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                               '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                               '/' - 63, 'A', 0, 0);
+
+    // 高通道从 src + 12 读取 16 字节，因此至少需要 28 字节可读
+    while (size >= 28) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 12));
+        __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        in = _mm256_shuffle_epi8(in, shuffle);
+
+        __m256i ac = _mm256_mulhi_epu16(_mm256_and_si256(in, maskAc), mulAc);
+        __m256i bd = _mm256_mullo_epi16(_mm256_and_si256(in, maskBd), mulBd);
+        __m256i indices = _mm256_or_si256(ac, bd);
+
+        __m256i reduced = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        __m256i isUpper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        reduced = _mm256_or_si256(reduced, _mm256_and_si256(isUpper, _mm256_set1_epi8(13)));
+        __m256i result = _mm256_add_epi8(_mm256_shuffle_epi8(offsetLut, reduced), indices);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), result);
+        src += 24;
+        size -= 24;
+        dst += 32;
+    }
+
+    return (dst - out) + encodeSsse3(src, size, dst);
+}
+
+#endif // SHOTOCR_ARCH_X86
+
+#if defined(SHOTOCR_ARCH_ARM64)
+
+// NEON 内核：vld3 解交织 48 字节，查 64 字节表后 vst4 交织写回 64 字符
+size_t encodeNeon(const unsigned char* src, size_t size, char* out) {
+    char* dst = out;
+    const unsigned char* table = reinterpret_cast<const unsigned char*>(kBase64Chars);
+    uint8x16x4_t lut;
+    lut.val[0] = vld1q_u8(table);
+    lut.val[1] = vld1q_u8(table + 16);
+    lut.val[2] = vld1q_u8(table + 32);
+    lut.val[3] = vld1q_u8(table + 48);
+    const uint8x16_t mask = vdupq_n_u8(0x3F);
+
+    while (size >= 48) {
+        uint8x16x3_t in = vld3q_u8(src);
+        uint8x16x4_t result;
+        result.val[0] = vshrq_n_u8(in.val[0], 2);
+        result.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), mask);
+        result.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), mask);
+        result.val[3] = vandq_u8(in.val[2], mask);
+
+        result.val[0] = vqtbl4q_u8(lut, result.val[0]);
+        result.val[1] = vqtbl4q_u8(lut, result.val[1]);
+        result.val[2] = vqtbl4q_u8(lut, result.val[2]);
+        result.val[3] = vqtbl4q_u8(lut, result.val[3]);
+
+        vst4q_u8(reinterpret_cast<unsigned char*>(dst), result);
+        src += 48;
+        size -= 48;
+        dst += 64;
+    }
+
+    return (dst - out) + encodeScalar(src, size, dst);
+}
+
+#endif // SHOTOCR_ARCH_ARM64
+
+Base64Kernel selectKernel() {
+    const CpuFeatures& cpu = GetCpuFeatures();
+    if (cpu.avx2) return Base64Kernel::Avx2;
+    if (cpu.ssse3) return Base64Kernel::Ssse3;
+    if (cpu.neon) return Base64Kernel::Neon;
+    return Base64Kernel::Scalar;
+}
+
+} // namespace
+
+bool Base64KernelSupported(Base64Kernel kernel) {
+    const CpuFeatures& cpu = GetCpuFeatures();
+    switch (kernel) {
+        case Base64Kernel::Scalar: return true;
+#if defined(SHOTOCR_ARCH_X86)
+        case Base64Kernel::Ssse3: return cpu.ssse3;
+        case Base64Kernel::Avx2: return cpu.avx2 && cpu.ssse3;
+#endif
+#if defined(SHOTOCR_ARCH_ARM64)
+        case Base64Kernel::Neon: return cpu.neon;
+#endif
+        default: break;
+    }
+    (void)cpu;
+    return false;
+}
+
+Base64Kernel Base64ActiveKernel() {
+    static const Base64Kernel kernel = selectKernel();
+    return kernel;
+}
+
+const char* Base64KernelName(Base64Kernel kernel) {
+    switch (kernel) {
+        case Base64Kernel::Ssse3: return "ssse3";
+        case Base64Kernel::Avx2: return "avx2";
+        case Base64Kernel::Neon: return "neon";
+        default: return "scalar";
+    }
+}
+
+size_t Base64EncodeWithKernel(Base64Kernel kernel, const unsigned char* data, size_t size, char* out) {
+    if (!Base64KernelSupported(kernel)) {
+        kernel = Base64Kernel::Scalar;
+    }
+
+    switch (kernel) {
+#if defined(SHOTOCR_ARCH_X86)
+        case Base64Kernel::Avx2: return encodeAvx2(data, size, out);
+        case Base64Kernel::Ssse3: return encodeSsse3(data, size, out);
+#endif
+#if defined(SHOTOCR_ARCH_ARM64)
+        case Base64Kernel::Neon: return encodeNeon(data, size, out);
+#endif
+        default: return encodeScalar(data, size, out);
+    }
+}
+
+size_t Base64Encode(const unsigned char* data, size_t size, char* out) {
+    return Base64EncodeWithKernel(Base64ActiveKernel(), data, size, out);
+}
+
+std::string Base64Encode(const unsigned char* data, size_t size) {
+    std::string result(Base64EncodedLength(size), '\0');
+    if (!result.empty()) {
+        Base64Encode(data, size, &result[0]);
+    }
+    return result;
+}
+
+std::string Base64Encode(const std::vector<unsigned char>& data) {
+    return Base64Encode(data.data(), data.size());
+}
@@ -0,0 +1,33 @@
+#include "../include/CaptureSource.h"
+
+#if defined(_WIN32)
+#include "../include/GdiCaptureSource.h"
+#elif defined(SHOTOCR_HAVE_XSHM)
+#include "../include/XShmCaptureSource.h"
+#endif
+
+std::unique_ptr<CaptureSource> CreateScreenCaptureSource() {
+#if defined(_WIN32)
+    return std::unique_ptr<CaptureSource>(new GdiCaptureSource());
+#elif defined(SHOTOCR_HAVE_XSHM)
+    std::unique_ptr<XShmCaptureSource> source(new XShmCaptureSource());
+    if (!source->isOpen()) return std::unique_ptr<CaptureSource>();
+    return std::unique_ptr<CaptureSource>(source.release());
+#else
+    return std::unique_ptr<CaptureSource>();
+#endif
+}
+
+bool ClipCaptureRegion(int& x, int& y, int& width, int& height, int limitWidth, int limitHeight) {
+    if (x < 0) {
+        width += x;
+        x = 0;
+    }
+    if (y < 0) {
+        height += y;
+        y = 0;
+    }
+    if (x + width > limitWidth) width = limitWidth - x;
+    if (y + height > limitHeight) height = limitHeight - y;
+    return width > 0 && height > 0;
+}
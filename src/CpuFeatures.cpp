@@ -0,0 +1,53 @@
+#include "../include/CpuFeatures.h"
+
+#if defined(SHOTOCR_ARCH_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+
+CpuFeatures detectCpuFeatures() {
+    CpuFeatures features = {};
+
+#if defined(SHOTOCR_ARCH_X86)
+#if defined(_MSC_VER)
+    int info[4] = {0, 0, 0, 0};
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    features.sse2 = (info[3] & (1 << 26)) != 0;
+    features.ssse3 = (info[2] & (1 << 9)) != 0;
+    features.sse41 = (info[2] & (1 << 19)) != 0;
+
+    // AVX2 还需要操作系统保存 YMM 寄存器（OSXSAVE + XCR0）
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(info, 7, 0);
+        features.avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    features.sse2 = __builtin_cpu_supports("sse2") != 0;
+    features.ssse3 = __builtin_cpu_supports("ssse3") != 0;
+    features.sse41 = __builtin_cpu_supports("sse4.1") != 0;
+    features.avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+#endif
+
+#if defined(SHOTOCR_ARCH_ARM64)
+    // AArch64 上 NEON 为必选特性
+    features.neon = true;
+#endif
+
+    return features;
+}
+
+} // namespace
+
+const CpuFeatures& GetCpuFeatures() {
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
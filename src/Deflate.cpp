@@ -0,0 +1,690 @@
+#include "../include/Deflate.h"
+#include <algorithm>
+#include <cstring>
+#include <queue>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+const size_t WINDOW_SIZE = 32768;
+const size_t WINDOW_MASK = WINDOW_SIZE - 1;
+const int HASH_BITS = 15;
+const size_t HASH_SIZE = (size_t)1 << HASH_BITS;
+const size_t MIN_MATCH = 3;
+const size_t MAX_MATCH = 258;
+const size_t TOO_FAR = 4096;          // 超过该距离的 3 字节匹配不如直接输出字面量
+const size_t BLOCK_SIZE = 65535;      // 每块输入上限，恰好能放进一个 stored 块
+const int MAX_CODE_BITS = 15;
+const int MAX_CODE_LENGTH_BITS = 7;
+
+const int LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                             35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const int LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                              3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const int DIST_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                           257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const int DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+const int CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+uint16_t reverseBits(uint32_t code, int length) {
+    uint32_t result = 0;
+    for (int i = 0; i < length; ++i) {
+        result = (result << 1) | (code & 1);
+        code >>= 1;
+    }
+    return (uint16_t)result;
+}
+
+// 由码长生成规范 Huffman 码（已按位反转，便于 LSB 优先输出）
+void buildCanonicalCodes(const unsigned char* lengths, int count, uint16_t* codes) {
+    int lengthCount[MAX_CODE_BITS + 1] = {0};
+    for (int i = 0; i < count; ++i) {
+        lengthCount[lengths[i]]++;
+    }
+    lengthCount[0] = 0;
+
+    uint32_t nextCode[MAX_CODE_BITS + 1] = {0};
+    uint32_t code = 0;
+    for (int bits = 1; bits <= MAX_CODE_BITS; ++bits) {
+        code = (code + lengthCount[bits - 1]) << 1;
+        nextCode[bits] = code;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        codes[i] = lengths[i] ? reverseBits(nextCode[lengths[i]]++, lengths[i]) : 0;
+    }
+}
+
+// 按频率构造限长 Huffman 码长；至少保证两个符号有码，避免解码器拒绝不完整的码表
+void buildCodeLengths(uint32_t* freq, int count, int maxBits, unsigned char* lengths) {
+    std::fill(lengths, lengths + count, 0);
+
+    int used = 0;
+    for (int i = 0; i < count; ++i) {
+        if (freq[i]) used++;
+    }
+    for (int i = 0; used < 2 && i < count; ++i) {
+        if (!freq[i]) {
+            freq[i] = 1;
+            used++;
+        }
+    }
+
+    struct Node {
+        uint64_t weight;
+        int left;
+        int right;
+    };
+    std::vector<Node> nodes;
+    nodes.reserve(count * 2);
+    typedef std::pair<uint64_t, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+
+    std::vector<int> symbols;
+    for (int i = 0; i < count; ++i) {
+        if (freq[i]) {
+            Node leaf = {freq[i], -1, i};
+            queue.push(Entry(leaf.weight, (int)nodes.size()));
+            nodes.push_back(leaf);
+            symbols.push_back(i);
+        }
+    }
+
+    while (queue.size() > 1) {
+        Entry a = queue.top();
+        queue.pop();
+        Entry b = queue.top();
+        queue.pop();
+        Node parent = {a.first + b.first, a.second, b.second};
+        queue.push(Entry(parent.weight, (int)nodes.size()));
+        nodes.push_back(parent);
+    }
+
+    // 统计各深度的叶子数量
+    int lengthCount[64] = {0};
+    std::vector<std::pair<int, int> > stack;
+    stack.push_back(std::make_pair(queue.top().second, 0));
+    while (!stack.empty()) {
+        std::pair<int, int> item = stack.back();
+        stack.pop_back();
+        const Node& node = nodes[item.first];
+        if (node.left < 0) {
+            lengthCount[(std::min)(item.second, 63)]++;
+        } else {
+            stack.push_back(std::make_pair(node.left, item.second + 1));
+            stack.push_back(std::make_pair(node.right, item.second + 1));
+        }
+    }
+
+    // 超长码折叠到 maxBits，再调整直到满足 Kraft 等式
+    for (int i = maxBits + 1; i < 64; ++i) {
+        lengthCount[maxBits] += lengthCount[i];
+        lengthCount[i] = 0;
+    }
+    uint32_t total = 0;
+    for (int i = maxBits; i > 0; --i) {
+        total += (uint32_t)lengthCount[i] << (maxBits - i);
+    }
+    while (total != (1u << maxBits)) {
+        lengthCount[maxBits]--;
+        for (int i = maxBits - 1; i > 0; --i) {
+            if (lengthCount[i]) {
+                lengthCount[i]--;
+                lengthCount[i + 1] += 2;
+                break;
+            }
+        }
+        total--;
+    }
+
+    // 频率最低的符号分配最长的码
+    std::stable_sort(symbols.begin(), symbols.end(), [freq](int a, int b) { return freq[a] < freq[b]; });
+    size_t index = 0;
+    for (int bits = maxBits; bits > 0; --bits) {
+        for (int n = lengthCount[bits]; n > 0; --n) {
+            lengths[symbols[index++]] = (unsigned char)bits;
+        }
+    }
+}
+
+struct CodeTables {
+    unsigned char lengthCode[MAX_MATCH + 1];
+    unsigned char distCode[512];
+    unsigned char fixedLitLengths[288];
+    uint16_t fixedLitCodes[288];
+    unsigned char fixedDistLengths[30];
+    uint16_t fixedDistCodes[30];
+
+    CodeTables() {
+        for (int code = 0; code < 29; ++code) {
+            for (int len = LENGTH_BASE[code]; len < LENGTH_BASE[code] + (1 << LENGTH_EXTRA[code]) && len <= (int)MAX_MATCH; ++len) {
+                lengthCode[len] = (unsigned char)code;
+            }
+        }
+        for (int code = 0; code < 30; ++code) {
+            for (int dist = DIST_BASE[code]; dist < DIST_BASE[code] + (1 << DIST_EXTRA[code]); ++dist) {
+                if (dist - 1 < 256) {
+                    distCode[dist - 1] = (unsigned char)code;
+                } else {
+                    distCode[256 + ((dist - 1) >> 7)] = (unsigned char)code;
+                }
+            }
+        }
+
+        for (int i = 0; i < 288; ++i) {
+            fixedLitLengths[i] = (unsigned char)(i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8);
+        }
+        buildCanonicalCodes(fixedLitLengths, 288, fixedLitCodes);
+        for (int i = 0; i < 30; ++i) {
+            fixedDistLengths[i] = 5;
+        }
+        buildCanonicalCodes(fixedDistLengths, 30, fixedDistCodes);
+    }
+
+    int distanceCode(size_t distance) const {
+        return distance <= 256 ? distCode[distance - 1] : distCode[256 + ((distance - 1) >> 7)];
+    }
+};
+
+const CodeTables& codeTables() {
+    static const CodeTables tables;
+    return tables;
+}
+
+inline int countTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (int)index;
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+// 比较两段数据的公共前缀长度，每次比较 8 字节
+inline size_t matchLength(const unsigned char* a, const unsigned char* b, size_t maxLength) {
+    size_t length = 0;
+    while (length + 8 <= maxLength) {
+        uint64_t x, y;
+        memcpy(&x, a + length, 8);
+        memcpy(&y, b + length, 8);
+        uint64_t diff = x ^ y;
+        if (diff) {
+            return length + (countTrailingZeros(diff) >> 3);
+        }
+        length += 8;
+    }
+    while (length < maxLength && a[length] == b[length]) {
+        length++;
+    }
+    return length;
+}
+
+inline uint32_t hash3(const unsigned char* p) {
+    uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+uint32_t updateAdler32(uint32_t adler, const unsigned char* data, size_t size) {
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+    while (size > 0) {
+        size_t n = (std::min)(size, (size_t)5552);
+        size -= n;
+        while (n >= 8) {
+            a += data[0]; b += a;
+            a += data[1]; b += a;
+            a += data[2]; b += a;
+            a += data[3]; b += a;
+            a += data[4]; b += a;
+            a += data[5]; b += a;
+            a += data[6]; b += a;
+            a += data[7]; b += a;
+            data += 8;
+            n -= 8;
+        }
+        while (n--) {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+} // namespace
+
+DeflateEncoder::DeflateEncoder(DeflateLevel level, Sink sink)
+    : level(level), sink(sink), rowDistance(0), maxChain(0), niceLength(0), lazyMatching(false),
+      processed(0), insertedUpTo(0), adler(1), headerWritten(false), finished(false),
+      bitBuffer(0), bitCount(0), totalOutput(0) {
+
+    switch (level) {
+        case DeflateLevel::Fastest: maxChain = 0; niceLength = (int)MAX_MATCH; break;
+        case DeflateLevel::Fast: maxChain = 4; niceLength = 32; break;
+        case DeflateLevel::Default: maxChain = 32; niceLength = 128; lazyMatching = true; break;
+        case DeflateLevel::Best: maxChain = 512; niceLength = (int)MAX_MATCH; lazyMatching = true; break;
+    }
+
+    if (maxChain > 0) {
+        head.assign(HASH_SIZE, -1);
+        prev.assign(WINDOW_SIZE, -1);
+    }
+    window.reserve(3 * WINDOW_SIZE + BLOCK_SIZE);
+    symbols.reserve(BLOCK_SIZE);
+    output.reserve(2 * BLOCK_SIZE);
+}
+
+void DeflateEncoder::setRowDistance(size_t distance) {
+    rowDistance = distance <= WINDOW_SIZE ? distance : 0;
+}
+
+void DeflateEncoder::write(const unsigned char* data, size_t size) {
+    if (finished) return;
+
+    if (!headerWritten) {
+        // CMF = 0x78（32KB 窗口），FLG 的压缩级别位仅供参考，需满足 (CMF*256+FLG) % 31 == 0
+        static const unsigned char levelFlags[4] = {0x01, 0x5E, 0x9C, 0xDA};
+        output.push_back(0x78);
+        output.push_back(levelFlags[(int)level]);
+        headerWritten = true;
+    }
+
+    adler = updateAdler32(adler, data, size);
+
+    while (size > 0) {
+        size_t pending = window.size() - processed;
+        size_t n = (std::min)(size, BLOCK_SIZE - pending);
+        window.insert(window.end(), data, data + n);
+        data += n;
+        size -= n;
+
+        if (window.size() - processed == BLOCK_SIZE) {
+            compressBlock(window.size(), false);
+        }
+    }
+}
+
+void DeflateEncoder::finish() {
+    if (finished) return;
+
+    if (!headerWritten) {
+        write(nullptr, 0);
+    }
+
+    compressBlock(window.size(), true);
+    alignToByte();
+
+    output.push_back((unsigned char)(adler >> 24));
+    output.push_back((unsigned char)(adler >> 16));
+    output.push_back((unsigned char)(adler >> 8));
+    output.push_back((unsigned char)adler);
+
+    flushOutput();
+    finished = true;
+}
+
+void DeflateEncoder::compressBlock(size_t end, bool final) {
+    size_t start = processed;
+    findSymbols(start, end);
+    emitBlock(start, end, final);
+    processed = end;
+
+    // 把已完整的字节交给 sink，让调用方可以边压缩边发送
+    while (bitCount >= 8) {
+        output.push_back((unsigned char)bitBuffer);
+        bitBuffer >>= 8;
+        bitCount -= 8;
+    }
+    flushOutput();
+
+    slideWindow();
+}
+
+void DeflateEncoder::slideWindow() {
+    // 只保留最近 32KB 历史；按窗口大小的整数倍平移，使 prev 的下标映射保持不变
+    if (processed < 3 * WINDOW_SIZE) return;
+
+    size_t drop = ((processed - WINDOW_SIZE) / WINDOW_SIZE) * WINDOW_SIZE;
+    window.erase(window.begin(), window.begin() + drop);
+    processed -= drop;
+    insertedUpTo = insertedUpTo > drop ? insertedUpTo - drop : 0;
+
+    int32_t offset = (int32_t)drop;
+    for (size_t i = 0; i < head.size(); ++i) {
+        head[i] = head[i] >= offset ? head[i] - offset : -1;
+    }
+    for (size_t i = 0; i < prev.size(); ++i) {
+        prev[i] = prev[i] >= offset ? prev[i] - offset : -1;
+    }
+}
+
+void DeflateEncoder::insertHash(size_t pos, size_t end) {
+    // 插入 [insertedUpTo, pos) 中所有还能取到 3 字节的位置
+    while (insertedUpTo < pos && insertedUpTo + MIN_MATCH <= end) {
+        uint32_t h = hash3(&window[insertedUpTo]);
+        prev[insertedUpTo & WINDOW_MASK] = head[h];
+        head[h] = (int32_t)insertedUpTo;
+        insertedUpTo++;
+    }
+}
+
+size_t DeflateEncoder::longestMatch(size_t pos, size_t end, size_t& distance) {
+    size_t maxLength = (std::min)(MAX_MATCH, end - pos);
+    if (maxLength < MIN_MATCH) return 0;
+
+    const unsigned char* current = &window[pos];
+    size_t bestLength = 0;
+
+    // 截图中大量纯色区域和逐行重复，先试游程（距离 1）与上一行同位置
+    if (pos >= 1) {
+        size_t length = matchLength(current, current - 1, maxLength);
+        if (length > bestLength) {
+            bestLength = length;
+            distance = 1;
+        }
+    }
+    if (rowDistance > 1 && pos >= rowDistance) {
+        size_t length = matchLength(current, current - rowDistance, maxLength);
+        if (length > bestLength) {
+            bestLength = length;
+            distance = rowDistance;
+        }
+    }
+
+    if (maxChain == 0 || bestLength >= (size_t)niceLength) {
+        return bestLength;
+    }
+
+    int chain = maxChain;
+    int32_t candidate = head[hash3(current)];
+    while (candidate >= 0 && chain-- > 0) {
+        size_t dist = pos - (size_t)candidate;
+        if (dist > WINDOW_SIZE) break;
+
+        const unsigned char* match = &window[candidate];
+        if (bestLength < maxLength && match[bestLength] == current[bestLength]) {
+            size_t length = matchLength(current, match, maxLength);
+            if (length > bestLength) {
+                bestLength = length;
+                distance = dist;
+                if (length >= (size_t)niceLength) break;
+            }
+        }
+
+        int32_t next = prev[candidate & WINDOW_MASK];
+        if (next >= candidate) break;
+        candidate = next;
+    }
+
+    return bestLength;
+}
+
+void DeflateEncoder::findSymbols(size_t start, size_t end) {
+    symbols.clear();
+    const bool useHash = maxChain > 0;
+
+    size_t pos = start;
+    bool haveNext = false;
+    size_t nextLength = 0, nextDistance = 0;
+
+    while (pos < end) {
+        size_t length = 0, distance = 0;
+        if (useHash) insertHash(pos, end);
+
+        if (haveNext) {
+            length = nextLength;
+            distance = nextDistance;
+            haveNext = false;
+        } else {
+            length = longestMatch(pos, end, distance);
+        }
+
+        if (length == MIN_MATCH && distance > TOO_FAR) {
+            length = 0;
+        }
+
+        // 惰性匹配：下一位置的匹配更长时，当前位置先输出字面量
+        if (lazyMatching && length >= MIN_MATCH && length < (size_t)niceLength && pos + 1 < end) {
+            insertHash(pos + 1, end);
+            size_t d2 = 0;
+            size_t l2 = longestMatch(pos + 1, end, d2);
+            if (l2 > length && !(l2 == MIN_MATCH && d2 > TOO_FAR)) {
+                Symbol literal = {window[pos], 0};
+                symbols.push_back(literal);
+                pos++;
+                haveNext = true;
+                nextLength = l2;
+                nextDistance = d2;
+                continue;
+            }
+        }
+
+        if (length >= MIN_MATCH) {
+            Symbol match = {(uint16_t)length, (uint16_t)distance};
+            symbols.push_back(match);
+            pos += length;
+        } else {
+            Symbol literal = {window[pos], 0};
+            symbols.push_back(literal);
+            pos++;
+        }
+    }
+
+    if (useHash) insertHash(end, end);
+}
+
+void DeflateEncoder::emitBlock(size_t start, size_t end, bool final) {
+    const CodeTables& tables = codeTables();
+
+    uint32_t litFreq[286] = {0};
+    uint32_t distFreq[30] = {0};
+    uint64_t extraBits = 0;
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        const Symbol& s = symbols[i];
+        if (s.distance == 0) {
+            litFreq[s.litLen]++;
+        } else {
+            int lc = tables.lengthCode[s.litLen];
+            int dc = tables.distanceCode(s.distance);
+            litFreq[257 + lc]++;
+            distFreq[dc]++;
+            extraBits += LENGTH_EXTRA[lc] + DIST_EXTRA[dc];
+        }
+    }
+    litFreq[256] = 1;
+
+    // 动态 Huffman 码表
+    uint32_t litWeights[286], distWeights[30];
+    memcpy(litWeights, litFreq, sizeof(litFreq));
+    memcpy(distWeights, distFreq, sizeof(distFreq));
+    unsigned char litLengths[286], distLengths[30];
+    buildCodeLengths(litWeights, 286, MAX_CODE_BITS, litLengths);
+    buildCodeLengths(distWeights, 30, MAX_CODE_BITS, distLengths);
+
+    int hlit = 286;
+    while (hlit > 257 && litLengths[hlit - 1] == 0) hlit--;
+    int hdist = 30;
+    while (hdist > 1 && distLengths[hdist - 1] == 0) hdist--;
+
+    // 码长序列做游程编码（16 重复前值，17/18 重复 0）
+    unsigned char allLengths[286 + 30];
+    memcpy(allLengths, litLengths, hlit);
+    memcpy(allLengths + hlit, distLengths, hdist);
+    int total = hlit + hdist;
+
+    std::vector<std::pair<unsigned char, unsigned char> > rle;
+    for (int i = 0; i < total;) {
+        unsigned char value = allLengths[i];
+        int run = 1;
+        while (i + run < total && allLengths[i + run] == value) run++;
+        i += run;
+
+        if (value == 0) {
+            while (run >= 11) {
+                int n = (std::min)(run, 138);
+                rle.push_back(std::make_pair((unsigned char)18, (unsigned char)(n - 11)));
+                run -= n;
+            }
+            if (run >= 3) {
+                rle.push_back(std::make_pair((unsigned char)17, (unsigned char)(run - 3)));
+                run = 0;
+            }
+        } else {
+            rle.push_back(std::make_pair(value, (unsigned char)0));
+            run--;
+            while (run >= 3) {
+                int n = (std::min)(run, 6);
+                rle.push_back(std::make_pair((unsigned char)16, (unsigned char)(n - 3)));
+                run -= n;
+            }
+        }
+        while (run-- > 0) {
+            rle.push_back(std::make_pair(value, (unsigned char)0));
+        }
+    }
+
+    uint32_t clFreq[19] = {0};
+    for (size_t i = 0; i < rle.size(); ++i) {
+        clFreq[rle[i].first]++;
+    }
+    unsigned char clLengths[19];
+    buildCodeLengths(clFreq, 19, MAX_CODE_LENGTH_BITS, clLengths);
+    int hclen = 19;
+    while (hclen > 4 && clLengths[CODE_LENGTH_ORDER[hclen - 1]] == 0) hclen--;
+
+    // 比较 dynamic / fixed / stored 三种块的位数，选最小者
+    uint64_t dynamicBits = 3 + 5 + 5 + 4 + 3 * (uint64_t)hclen + extraBits;
+    for (size_t i = 0; i < rle.size(); ++i) {
+        unsigned char sym = rle[i].first;
+        dynamicBits += clLengths[sym] + (sym == 16 ? 2 : sym == 17 ? 3 : sym == 18 ? 7 : 0);
+    }
+    uint64_t fixedBits = 3 + extraBits;
+    for (int i = 0; i < 286; ++i) {
+        dynamicBits += (uint64_t)litFreq[i] * litLengths[i];
+        fixedBits += (uint64_t)litFreq[i] * tables.fixedLitLengths[i];
+    }
+    for (int i = 0; i < 30; ++i) {
+        dynamicBits += (uint64_t)distFreq[i] * distLengths[i];
+        fixedBits += (uint64_t)distFreq[i] * tables.fixedDistLengths[i];
+    }
+    size_t rawSize = end - start;
+    uint64_t storedBits = 3 + 7 + 32 + 8 * (uint64_t)rawSize;
+
+    if (storedBits < dynamicBits && storedBits < fixedBits) {
+        writeBits(final ? 1 : 0, 1);
+        writeBits(0, 2);
+        alignToByte();
+        output.push_back((unsigned char)(rawSize & 0xFF));
+        output.push_back((unsigned char)(rawSize >> 8));
+        output.push_back((unsigned char)(~rawSize & 0xFF));
+        output.push_back((unsigned char)((~rawSize >> 8) & 0xFF));
+        output.insert(output.end(), window.begin() + start, window.begin() + end);
+        return;
+    }
+
+    uint16_t litCodesBuf[286], distCodesBuf[30];
+    const unsigned char* litLen;
+    const uint16_t* litCodes;
+    const unsigned char* distLen;
+    const uint16_t* distCodes;
+
+    if (fixedBits <= dynamicBits) {
+        writeBits(final ? 1 : 0, 1);
+        writeBits(1, 2);
+        litLen = tables.fixedLitLengths;
+        litCodes = tables.fixedLitCodes;
+        distLen = tables.fixedDistLengths;
+        distCodes = tables.fixedDistCodes;
+    } else {
+        uint16_t clCodes[19];
+        buildCanonicalCodes(clLengths, 19, clCodes);
+        buildCanonicalCodes(litLengths, 286, litCodesBuf);
+        buildCanonicalCodes(distLengths, 30, distCodesBuf);
+
+        writeBits(final ? 1 : 0, 1);
+        writeBits(2, 2);
+        writeBits(hlit - 257, 5);
+        writeBits(hdist - 1, 5);
+        writeBits(hclen - 4, 4);
+        for (int i = 0; i < hclen; ++i) {
+            writeBits(clLengths[CODE_LENGTH_ORDER[i]], 3);
+        }
+        for (size_t i = 0; i < rle.size(); ++i) {
+            unsigned char sym = rle[i].first;
+            writeBits(clCodes[sym], clLengths[sym]);
+            if (sym == 16) writeBits(rle[i].second, 2);
+            else if (sym == 17) writeBits(rle[i].second, 3);
+            else if (sym == 18) writeBits(rle[i].second, 7);
+        }
+
+        litLen = litLengths;
+        litCodes = litCodesBuf;
+        distLen = distLengths;
+        distCodes = distCodesBuf;
+    }
+
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        const Symbol& s = symbols[i];
+        if (s.distance == 0) {
+            writeBits(litCodes[s.litLen], litLen[s.litLen]);
+        } else {
+            int lc = tables.lengthCode[s.litLen];
+            writeBits(litCodes[257 + lc], litLen[257 + lc]);
+            if (LENGTH_EXTRA[lc]) writeBits(s.litLen - LENGTH_BASE[lc], LENGTH_EXTRA[lc]);
+
+            int dc = tables.distanceCode(s.distance);
+            writeBits(distCodes[dc], distLen[dc]);
+            if (DIST_EXTRA[dc]) writeBits(s.distance - DIST_BASE[dc], DIST_EXTRA[dc]);
+        }
+    }
+    writeBits(litCodes[256], litLen[256]);
+}
+
+void DeflateEncoder::writeBits(uint32_t value, int count) {
+    bitBuffer |= (uint64_t)value << bitCount;
+    bitCount += count;
+    if (bitCount >= 32) {
+        output.push_back((unsigned char)bitBuffer);
+        output.push_back((unsigned char)(bitBuffer >> 8));
+        output.push_back((unsigned char)(bitBuffer >> 16));
+        output.push_back((unsigned char)(bitBuffer >> 24));
+        bitBuffer >>= 32;
+        bitCount -= 32;
+    }
+}
+
+void DeflateEncoder::alignToByte() {
+    while (bitCount > 0) {
+        output.push_back((unsigned char)bitBuffer);
+        bitBuffer >>= 8;
+        bitCount -= 8;
+    }
+    bitBuffer = 0;
+    bitCount = 0;
+}
+
+void DeflateEncoder::flushOutput() {
+    if (output.empty()) return;
+
+    totalOutput += output.size();
+    if (sink) {
+        sink(output.data(), output.size());
+    }
+    output.clear();
+}
+
+std::vector<unsigned char> ZlibCompress(const unsigned char* data, size_t size, DeflateLevel level) {
+    std::vector<unsigned char> result;
+    DeflateEncoder encoder(level, [&result](const unsigned char* chunk, size_t n) {
+        result.insert(result.end(), chunk, chunk + n);
+    });
+    encoder.write(data, size);
+    encoder.finish();
+    return result;
+}
@@ -0,0 +1,229 @@
+#include "../include/Executor.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+const size_t WAIT_SAMPLES = 1024;
+
+// 当前线程所属的池与队列下标（不是池线程时为空）
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local size_t currentQueue = 0;
+
+double msSince(std::chrono::steady_clock::time_point from) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - from).count();
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(const std::string& name, int workers, size_t capacity, bool stealing)
+    : poolName(name), capacity((std::max)(capacity, (size_t)1)), stealing(stealing), nextQueue(0), queued(0),
+      stopping(false), waitNext(0), waitTotalMs(0), runTotalMs(0) {
+    workers = (std::max)(workers, 1);
+    counters.workers = workers;
+    counters.capacity = this->capacity;
+    size_t queueCount = stealing ? (size_t)workers : 1;
+    for (size_t i = 0; i < queueCount; ++i) queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    waits.reserve(WAIT_SAMPLES);
+    for (int i = 0; i < workers; ++i) threads.push_back(std::thread(&ThreadPool::workerLoop, this, (size_t)i));
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+    space.notify_all();
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+}
+
+// 调用方持有 mutex 且已确认有空位
+void ThreadPool::enqueueLocked(const Task& task) {
+    size_t target = 0;
+    bool own = stealing && currentPool == this;
+    if (stealing) target = own ? currentQueue : nextQueue.fetch_add(1) % queues.size();
+    Entry entry;
+    entry.task = task;
+    entry.enqueued = Clock::now();
+    {
+        WorkerQueue& queue = *queues[target];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.entries.push_back(entry);
+    }
+    queued++;
+    counters.submitted++;
+    counters.maxQueueDepth = (std::max)(counters.maxQueueDepth, queued);
+}
+
+bool ThreadPool::submit(const Task& task) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (queued >= capacity && !stopping) {
+            counters.blocked++;
+            space.wait(lock, [this]() { return queued < capacity || stopping; });
+        }
+        if (stopping) return false;
+        enqueueLocked(task);
+    }
+    available.notify_one();
+    return true;
+}
+
+bool ThreadPool::trySubmit(const Task& task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) return false;
+        if (queued >= capacity) {
+            counters.rejected++;
+            return false;
+        }
+        enqueueLocked(task);
+    }
+    available.notify_one();
+    return true;
+}
+
+void ThreadPool::run(const Task& task) {
+    if (isWorkerThread()) {
+        task();
+        return;
+    }
+    std::mutex doneMutex;
+    std::condition_variable doneChanged;
+    bool done = false;
+    bool queuedTask = submit([&]() {
+        try {
+            task();
+        } catch (...) {
+        }
+        std::lock_guard<std::mutex> lock(doneMutex);
+        done = true;
+        doneChanged.notify_all();
+    });
+    // 池已停止时改为在调用线程执行
+    if (!queuedTask) {
+        task();
+        return;
+    }
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneChanged.wait(lock, [&done]() { return done; });
+}
+
+bool ThreadPool::isWorkerThread() const {
+    return currentPool == this;
+}
+
+// 先取自己队列的尾部（最近提交的），再从其他队列的头部窃取；调用方已预留一个排队任务。
+// 这里只持有队列锁，不能再取 mutex（入队时的顺序是 mutex -> 队列锁）
+bool ThreadPool::takeEntry(size_t self, Entry& entry, bool& stolen) {
+    stolen = false;
+    {
+        WorkerQueue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.entries.empty()) {
+            if (stealing) {
+                entry = own.entries.back();
+                own.entries.pop_back();
+            } else {
+                entry = own.entries.front();
+                own.entries.pop_front();
+            }
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); ++i) {
+        WorkerQueue& other = *queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (!other.entries.empty()) {
+            entry = other.entries.front();
+            other.entries.pop_front();
+            stolen = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentQueue = stealing ? index : 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this]() { return queued > 0 || stopping; });
+            // 停止时先做完已排队的任务
+            if (queued == 0) return;
+            // 预留一个任务：计数与入队在同一把锁下完成，预留数不会超过队列中的任务数
+            queued--;
+        }
+        space.notify_one();
+
+        Entry entry;
+        bool stolen;
+        while (!takeEntry(currentQueue, entry, stolen)) std::this_thread::yield();
+
+        double waited = msSince(entry.enqueued);
+        Clock::time_point started = Clock::now();
+        // 任务自己处理错误；这里只保证一个任务抛出的异常不会让工作线程退出
+        try {
+            entry.task();
+        } catch (...) {
+        }
+        double ran = msSince(started);
+        entry.task = Task();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.completed++;
+        if (stolen) counters.steals++;
+        waitTotalMs += waited;
+        runTotalMs += ran;
+        if (waits.size() < WAIT_SAMPLES) waits.push_back(waited);
+        else waits[waitNext] = waited;
+        waitNext = (waitNext + 1) % WAIT_SAMPLES;
+    }
+}
+
+ThreadPoolStats ThreadPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    ThreadPoolStats stats = counters;
+    stats.queueDepth = queued;
+    if (counters.completed > 0) {
+        stats.waitMeanMs = waitTotalMs / counters.completed;
+        stats.runMeanMs = runTotalMs / counters.completed;
+    }
+    if (!waits.empty()) {
+        std::vector<double> sorted(waits);
+        size_t rank = (sorted.size() * 99) / 100;
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+        stats.waitP99Ms = sorted[rank];
+    }
+    return stats;
+}
+
+Executor::Executor(int cpuWorkers, int ioWorkers) {
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    if (cpuWorkers <= 0) cpuWorkers = (std::max)((int)std::thread::hardware_concurrency(), 2);
+    // I/O 池的任务大多在等网络或设备；识别任务会等待它发起的请求，线程数须大于同时进行的任务数
+    if (ioWorkers <= 0) ioWorkers = 8;
+    cpuPool.reset(new ThreadPool("cpu", cpuWorkers, 256, true));
+    ioPool.reset(new ThreadPool("io", ioWorkers, 64, false));
+    startup = msSince(begin);
+}
+
+Executor& SharedExecutor() {
+    // 进程退出时不析构：池线程可能还停在截图选区的消息循环或网络请求里，等它们会让退出卡住
+    static Executor* executor = new Executor();
+    return *executor;
+}
+
+std::string DescribeThreadPoolStats(const std::string& name, const ThreadPoolStats& stats) {
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "[pool %s] workers=%d tasks=%ld queued=%lu/%lu max=%lu blocked=%ld rejected=%ld steals=%ld "
+                  "wait mean/p99=%.3f/%.3f ms run mean=%.3f ms",
+                  name.c_str(), stats.workers, stats.completed, (unsigned long)stats.queueDepth,
+                  (unsigned long)stats.capacity, (unsigned long)stats.maxQueueDepth, stats.blocked, stats.rejected,
+                  stats.steals, stats.waitMeanMs, stats.waitP99Ms, stats.runMeanMs);
+    return line;
+}
@@ -0,0 +1,131 @@
+#include "../include/FileReplayCaptureSource.h"
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// PPM 头部字段之间可以有空白和以 # 开头的注释
+bool readPpmToken(FILE* f, int& value) {
+    int c = std::fgetc(f);
+    while (c != EOF) {
+        if (c == '#') {
+            while (c != EOF && c != '\n') c = std::fgetc(f);
+        } else if (!std::isspace(c)) {
+            break;
+        }
+        c = std::fgetc(f);
+    }
+    if (c == EOF || !std::isdigit(c)) return false;
+
+    value = 0;
+    while (c != EOF && std::isdigit(c)) {
+        value = value * 10 + (c - '0');
+        if (value > (1 << 24)) return false;
+        c = std::fgetc(f);
+    }
+    // 数字后紧跟的单个空白字符属于头部
+    return c != EOF && std::isspace(c);
+}
+
+// 从文件名中解析 "_<宽>x<高>." 形式的尺寸
+bool parseSizeFromName(const std::string& path, int& width, int& height) {
+    size_t dot = path.find_last_of('.');
+    size_t underscore = path.find_last_of('_', dot);
+    if (dot == std::string::npos || underscore == std::string::npos) return false;
+    return std::sscanf(path.c_str() + underscore + 1, "%dx%d", &width, &height) == 2 && width > 0 && height > 0;
+}
+
+bool endsWith(const std::string& value, const char* suffix) {
+    size_t length = std::strlen(suffix);
+    return value.size() >= length && value.compare(value.size() - length, length, suffix) == 0;
+}
+
+} // namespace
+
+bool LoadPpmAsBgra(const std::string& path, int& width, int& height, std::vector<unsigned char>& bgra) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    int maxValue = 0;
+    bool ok = std::fgetc(f) == 'P' && std::fgetc(f) == '6' &&
+              readPpmToken(f, width) && readPpmToken(f, height) && readPpmToken(f, maxValue) &&
+              width > 0 && height > 0 && maxValue == 255;
+    if (ok) {
+        std::vector<unsigned char> rgb((size_t)width * height * 3);
+        ok = std::fread(rgb.data(), 1, rgb.size(), f) == rgb.size();
+        if (ok) {
+            bgra.resize((size_t)width * height * 4);
+            for (size_t i = 0, n = (size_t)width * height; i < n; ++i) {
+                bgra[i * 4 + 0] = rgb[i * 3 + 2];
+                bgra[i * 4 + 1] = rgb[i * 3 + 1];
+                bgra[i * 4 + 2] = rgb[i * 3 + 0];
+                bgra[i * 4 + 3] = 255;
+            }
+        }
+    }
+    std::fclose(f);
+    return ok;
+}
+
+FileReplayCaptureSource::FileReplayCaptureSource(int dpi) : nextFrame(0), dpi(dpi) {
+}
+
+bool FileReplayCaptureSource::addFile(const std::string& path) {
+    if (endsWith(path, ".ppm")) {
+        Frame frame;
+        if (!LoadPpmAsBgra(path, frame.width, frame.height, frame.bgra)) return false;
+        frames.push_back(std::move(frame));
+        return true;
+    }
+
+    int width = 0, height = 0;
+    if (!parseSizeFromName(path, width, height)) return false;
+    return addRawFile(path, width, height);
+}
+
+bool FileReplayCaptureSource::addRawFile(const std::string& path, int width, int height) {
+    if (width <= 0 || height <= 0) return false;
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    Frame frame;
+    frame.width = width;
+    frame.height = height;
+    frame.bgra.resize((size_t)width * height * 4);
+    bool ok = std::fread(frame.bgra.data(), 1, frame.bgra.size(), f) == frame.bgra.size();
+    std::fclose(f);
+
+    if (ok) frames.push_back(std::move(frame));
+    return ok;
+}
+
+void FileReplayCaptureSource::addFrame(int width, int height, const std::vector<unsigned char>& bgra) {
+    Frame frame;
+    frame.width = width;
+    frame.height = height;
+    frame.bgra = bgra;
+    frames.push_back(std::move(frame));
+}
+
+bool FileReplayCaptureSource::capture(int x, int y, int width, int height, PixelBufferView& view) {
+    if (frames.empty()) return false;
+    const Frame& frame = frames[nextFrame];
+    nextFrame = (nextFrame + 1) % frames.size();
+
+    if (width <= 0 || height <= 0) {
+        x = 0;
+        y = 0;
+        width = frame.width;
+        height = frame.height;
+    }
+    if (!ClipCaptureRegion(x, y, width, height, frame.width, frame.height)) return false;
+
+    // 区域直接指向帧内存，不做复制
+    view.pixels = &frame.bgra[((size_t)y * frame.width + x) * 4];
+    view.width = width;
+    view.height = height;
+    view.stride = frame.width * 4;
+    view.dpi = dpi;
+    return true;
+}
@@ -0,0 +1,756 @@
+#include "../include/FlacCodec.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const int BITS_PER_SAMPLE = 16;
+const int MAX_FIXED_ORDER = 4;
+const int MAX_LPC_ORDER = 32;
+const int MAX_PARTITION_ORDER = 8;
+const int MAX_RICE_PARAMETER = 14;      // 4 位参数，15 表示转义（原样存放）
+const int MAX_QLP_SHIFT = 15;
+const int MIN_BLOCK_SIZE = 16;
+const int MAX_BLOCK_SIZE = 65535;
+// LPC 残差超过该值时放弃 LPC（系数量化误差过大），改用固定预测
+const int64_t MAX_LPC_RESIDUAL = (int64_t)1 << 30;
+
+// 帧头 CRC-8（x^8 + x^2 + x + 1）与整帧 CRC-16（x^16 + x^15 + x^2 + 1），初值都为 0
+struct CrcTables {
+    uint8_t crc8[256];
+    uint16_t crc16[256];
+
+    CrcTables() {
+        for (int i = 0; i < 256; ++i) {
+            uint8_t c8 = (uint8_t)i;
+            uint16_t c16 = (uint16_t)(i << 8);
+            for (int bit = 0; bit < 8; ++bit) {
+                c8 = (uint8_t)(c8 & 0x80 ? (c8 << 1) ^ 0x07 : c8 << 1);
+                c16 = (uint16_t)(c16 & 0x8000 ? (c16 << 1) ^ 0x8005 : c16 << 1);
+            }
+            crc8[i] = c8;
+            crc16[i] = c16;
+        }
+    }
+};
+
+const CrcTables& crcTables() {
+    static const CrcTables tables;
+    return tables;
+}
+
+uint8_t crc8(const unsigned char* data, size_t size) {
+    const CrcTables& tables = crcTables();
+    uint8_t crc = 0;
+    for (size_t i = 0; i < size; ++i) crc = tables.crc8[crc ^ data[i]];
+    return crc;
+}
+
+uint16_t crc16(const unsigned char* data, size_t size) {
+    const CrcTables& tables = crcTables();
+    uint16_t crc = 0;
+    for (size_t i = 0; i < size; ++i) crc = (uint16_t)((crc << 8) ^ tables.crc16[(crc >> 8) ^ data[i]]);
+    return crc;
+}
+
+// 高位在前写出，满一个字节即追加到 out
+class BitWriter {
+public:
+    explicit BitWriter(std::string& out) : out(out), acc(0), bits(0) {}
+
+    // count 不超过 32，只写 value 的低 count 位
+    void write(uint32_t value, int count) {
+        if (count == 0) return;
+        acc = (acc << count) | (count == 32 ? value : value & ((1u << count) - 1));
+        bits += count;
+        while (bits >= 8) {
+            bits -= 8;
+            out.push_back((char)(acc >> bits));
+        }
+    }
+
+    // folded >> k 个 0、一个 1，再写 folded 的低 k 位
+    void writeRice(uint32_t folded, int k) {
+        uint32_t quotient = folded >> k;
+        if (quotient + 1 + k <= 32) {
+            write((1u << k) | (folded & ((1u << k) - 1)), (int)quotient + 1 + k);
+            return;
+        }
+        while (quotient >= 32) {
+            write(0, 32);
+            quotient -= 32;
+        }
+        write(1, (int)quotient + 1);
+        write(folded, k);
+    }
+
+    void alignByte() {
+        if (bits > 0) write(0, 8 - bits);
+    }
+
+private:
+    std::string& out;
+    uint64_t acc;
+    int bits;
+};
+
+class BitReader {
+public:
+    BitReader(const unsigned char* data, size_t size, size_t bytePos)
+        : data(data), totalBits(size * 8), pos(bytePos * 8), failed(false) {}
+
+    uint32_t read(int count) {
+        uint64_t value = 0;
+        while (count > 0) {
+            if (pos >= totalBits) {
+                failed = true;
+                return 0;
+            }
+            int offset = (int)(pos & 7);
+            int available = 8 - offset;
+            int take = (std::min)(available, count);
+            uint32_t chunk = (data[pos >> 3] >> (available - take)) & ((1u << take) - 1);
+            value = (value << take) | chunk;
+            pos += take;
+            count -= take;
+        }
+        return (uint32_t)value;
+    }
+
+    int32_t readSigned(int count) {
+        if (count == 0) return 0;
+        uint32_t value = read(count);
+        if (count < 32 && (value >> (count - 1)) & 1) value |= ~((1u << count) - 1);
+        return (int32_t)value;
+    }
+
+    uint32_t readUnary() {
+        uint32_t zeros = 0;
+        for (;;) {
+            if (pos >= totalBits) {
+                failed = true;
+                return 0;
+            }
+            int bit = (data[pos >> 3] >> (7 - (pos & 7))) & 1;
+            pos++;
+            if (bit) return zeros;
+            zeros++;
+        }
+    }
+
+    int32_t readRice(int k) {
+        uint32_t folded = (readUnary() << k) | read(k);
+        return (int32_t)(folded >> 1) ^ -(int32_t)(folded & 1);
+    }
+
+    void alignByte() { pos = (pos + 7) & ~(size_t)7; }
+    size_t bytePos() const { return pos >> 3; }
+    bool ok() const { return !failed; }
+
+private:
+    const unsigned char* data;
+    size_t totalBits;
+    size_t pos;
+    bool failed;
+};
+
+inline uint32_t foldResidual(int32_t residual) {
+    return ((uint32_t)residual << 1) ^ (uint32_t)(residual >> 31);
+}
+
+int blockSizeCode(int samples) {
+    if (samples == 192) return 1;
+    for (int code = 2; code <= 5; ++code) {
+        if (samples == 576 << (code - 2)) return code;
+    }
+    for (int code = 8; code <= 15; ++code) {
+        if (samples == 256 << (code - 8)) return code;
+    }
+    // 6、7：帧头末尾另存 8 位或 16 位的块长 - 1
+    return samples <= 256 ? 6 : 7;
+}
+
+int sampleRateCode(int sampleRate) {
+    switch (sampleRate) {
+        case 88200: return 1;
+        case 176400: return 2;
+        case 192000: return 3;
+        case 8000: return 4;
+        case 16000: return 5;
+        case 22050: return 6;
+        case 24000: return 7;
+        case 32000: return 8;
+        case 44100: return 9;
+        case 48000: return 10;
+        case 96000: return 11;
+        default: return 0;  // 以 STREAMINFO 为准
+    }
+}
+
+// 帧号按 UTF-8 的方式变长编码
+void writeFrameNumber(BitWriter& writer, uint32_t number) {
+    if (number < 0x80) {
+        writer.write(number, 8);
+        return;
+    }
+    int extra = number < 0x800 ? 1 : number < 0x10000 ? 2 : number < 0x200000 ? 3 : number < 0x4000000 ? 4 : 5;
+    writer.write(((0xFF00u >> (extra + 1)) & 0xFF) | (number >> (6 * extra)), 8);
+    for (int i = extra - 1; i >= 0; --i) writer.write(0x80 | ((number >> (6 * i)) & 0x3F), 8);
+}
+
+// 残差的分区 Rice 编码方案
+struct RicePlan {
+    int partitionOrder;
+    int parameters[1 << MAX_PARTITION_ORDER];
+};
+
+class FrameEncoder {
+public:
+    FrameEncoder(const FlacOptions& options, int sampleRate) : options(options), sampleRate(sampleRate), windowSize(0) {
+        fixedResidual.resize(options.blockSize);
+        lpcResidual.resize(options.blockSize);
+        windowed.resize(options.blockSize);
+    }
+
+    void encode(const int32_t* samples, int count, uint32_t frameNumber, std::string& out, FlacEncodeStats& stats);
+
+private:
+    FlacOptions options;
+    int sampleRate;
+    std::vector<uint32_t> fixedResidual;
+    std::vector<uint32_t> lpcResidual;
+    std::vector<double> window;
+    std::vector<double> windowed;
+    int windowSize;
+
+    void writeSubframe(BitWriter& writer, const int32_t* samples, int count, FlacEncodeStats& stats);
+    uint64_t planRice(const uint32_t* folded, int count, int order, RicePlan& plan) const;
+    void writeResidual(BitWriter& writer, const uint32_t* folded, int count, int order, const RicePlan& plan) const;
+    int chooseFixedOrder(const int32_t* samples, int count) const;
+    bool computeLpc(const int32_t* samples, int count, int& order, int32_t* coefficients, int& shift);
+};
+
+void FrameEncoder::encode(const int32_t* samples, int count, uint32_t frameNumber, std::string& out,
+                          FlacEncodeStats& stats) {
+    size_t frameStart = out.size();
+    BitWriter writer(out);
+    int blockCode = blockSizeCode(count);
+    writer.write(0x3FFE, 14);   // 同步码
+    writer.write(0, 1);
+    writer.write(0, 1);         // 固定块长
+    writer.write((uint32_t)blockCode, 4);
+    writer.write((uint32_t)sampleRateCode(sampleRate), 4);
+    writer.write(0, 4);         // 单声道
+    writer.write(4, 3);         // 16 位
+    writer.write(0, 1);
+    writeFrameNumber(writer, frameNumber);
+    if (blockCode == 6) writer.write((uint32_t)count - 1, 8);
+    if (blockCode == 7) writer.write((uint32_t)count - 1, 16);
+    // 帧头到这里按字节对齐
+    writer.write(crc8((const unsigned char*)out.data() + frameStart, out.size() - frameStart), 8);
+
+    writeSubframe(writer, samples, count, stats);
+
+    writer.alignByte();
+    writer.write(crc16((const unsigned char*)out.data() + frameStart, out.size() - frameStart), 16);
+    stats.frames++;
+}
+
+void FrameEncoder::writeSubframe(BitWriter& writer, const int32_t* samples, int count, FlacEncodeStats& stats) {
+    // 数字静音等整块同值的快速路径
+    bool constant = true;
+    for (int i = 1; i < count && constant; ++i) constant = samples[i] == samples[0];
+    if (constant) {
+        writer.write(0, 8);
+        writer.write((uint32_t)samples[0], BITS_PER_SAMPLE);
+        stats.constantSubframes++;
+        return;
+    }
+
+    uint64_t verbatimBits = (uint64_t)count * BITS_PER_SAMPLE;
+
+    int fixedOrder = chooseFixedOrder(samples, count);
+    for (int i = fixedOrder; i < count; ++i) {
+        int32_t residual;
+        switch (fixedOrder) {
+            case 0: residual = samples[i]; break;
+            case 1: residual = samples[i] - samples[i - 1]; break;
+            case 2: residual = samples[i] - 2 * samples[i - 1] + samples[i - 2]; break;
+            case 3: residual = samples[i] - 3 * samples[i - 1] + 3 * samples[i - 2] - samples[i - 3]; break;
+            default:
+                residual = samples[i] - 4 * samples[i - 1] + 6 * samples[i - 2] - 4 * samples[i - 3] + samples[i - 4];
+                break;
+        }
+        fixedResidual[i] = foldResidual(residual);
+    }
+    RicePlan fixedPlan;
+    uint64_t fixedBits = (uint64_t)fixedOrder * BITS_PER_SAMPLE + planRice(fixedResidual.data(), count, fixedOrder,
+                                                                           fixedPlan);
+
+    int lpcOrder = 0;
+    int shift = 0;
+    int32_t coefficients[MAX_LPC_ORDER];
+    RicePlan lpcPlan;
+    uint64_t lpcBits = UINT64_MAX;
+    if (options.maxLpcOrder > 0 && computeLpc(samples, count, lpcOrder, coefficients, shift)) {
+        bool fits = true;
+        for (int i = lpcOrder; i < count && fits; ++i) {
+            int64_t sum = 0;
+            for (int j = 0; j < lpcOrder; ++j) sum += (int64_t)coefficients[j] * samples[i - 1 - j];
+            int64_t residual = samples[i] - (sum >> shift);
+            fits = residual < MAX_LPC_RESIDUAL && residual > -MAX_LPC_RESIDUAL;
+            lpcResidual[i] = foldResidual((int32_t)residual);
+        }
+        if (fits) {
+            lpcBits = (uint64_t)lpcOrder * (BITS_PER_SAMPLE + options.qlpPrecision) + 4 + 5 +
+                      planRice(lpcResidual.data(), count, lpcOrder, lpcPlan);
+        }
+    }
+
+    if (verbatimBits <= fixedBits && verbatimBits <= lpcBits) {
+        writer.write(1 << 1, 8);
+        for (int i = 0; i < count; ++i) writer.write((uint32_t)samples[i], BITS_PER_SAMPLE);
+        stats.verbatimSubframes++;
+    } else if (fixedBits <= lpcBits) {
+        writer.write((uint32_t)(0x08 | fixedOrder) << 1, 8);
+        for (int i = 0; i < fixedOrder; ++i) writer.write((uint32_t)samples[i], BITS_PER_SAMPLE);
+        writeResidual(writer, fixedResidual.data(), count, fixedOrder, fixedPlan);
+        stats.fixedSubframes++;
+    } else {
+        writer.write((uint32_t)(0x20 | (lpcOrder - 1)) << 1, 8);
+        for (int i = 0; i < lpcOrder; ++i) writer.write((uint32_t)samples[i], BITS_PER_SAMPLE);
+        writer.write((uint32_t)options.qlpPrecision - 1, 4);
+        writer.write((uint32_t)shift, 5);
+        for (int i = 0; i < lpcOrder; ++i) writer.write((uint32_t)coefficients[i], options.qlpPrecision);
+        writeResidual(writer, lpcResidual.data(), count, lpcOrder, lpcPlan);
+        stats.lpcSubframes++;
+    }
+}
+
+// 各固定阶数残差的绝对值之和，取最小的阶数
+int FrameEncoder::chooseFixedOrder(const int32_t* samples, int count) const {
+    if (count <= MAX_FIXED_ORDER) return 0;
+    uint64_t totals[MAX_FIXED_ORDER + 1] = {0, 0, 0, 0, 0};
+    int32_t d0 = samples[3];
+    int32_t d1 = samples[3] - samples[2];
+    int32_t d2 = d1 - (samples[2] - samples[1]);
+    int32_t d3 = d2 - (samples[2] - samples[1] - (samples[1] - samples[0]));
+    for (int i = MAX_FIXED_ORDER; i < count; ++i) {
+        int32_t e0 = samples[i];
+        int32_t e1 = e0 - d0;
+        int32_t e2 = e1 - d1;
+        int32_t e3 = e2 - d2;
+        int32_t e4 = e3 - d3;
+        totals[0] += (uint32_t)std::abs(e0);
+        totals[1] += (uint32_t)std::abs(e1);
+        totals[2] += (uint32_t)std::abs(e2);
+        totals[3] += (uint32_t)std::abs(e3);
+        totals[4] += (uint32_t)std::abs(e4);
+        d0 = e0;
+        d1 = e1;
+        d2 = e2;
+        d3 = e3;
+    }
+    int best = 0;
+    for (int order = 1; order <= MAX_FIXED_ORDER; ++order) {
+        if (totals[order] < totals[best]) best = order;
+    }
+    return best;
+}
+
+// 按估计的位数（每个值 k + 1 位加上商）选分区阶数与各分区的参数，返回残差部分的总位数
+uint64_t FrameEncoder::planRice(const uint32_t* folded, int count, int order, RicePlan& plan) const {
+    int maxOrder = 0;
+    while (maxOrder < options.maxPartitionOrder && count % (2 << maxOrder) == 0 &&
+           (count >> (maxOrder + 1)) > order) {
+        maxOrder++;
+    }
+
+    // 最细的分区上求和，逐级合并
+    uint64_t sums[1 << MAX_PARTITION_ORDER];
+    int partitions = 1 << maxOrder;
+    int partitionSamples = count >> maxOrder;
+    for (int p = 0, i = order; p < partitions; ++p) {
+        uint64_t sum = 0;
+        for (int end = (p + 1) * partitionSamples; i < end; ++i) sum += folded[i];
+        sums[p] = sum;
+    }
+
+    uint64_t bestBits = UINT64_MAX;
+    for (int partitionOrder = maxOrder; partitionOrder >= 0; --partitionOrder) {
+        int currentPartitions = 1 << partitionOrder;
+        int samplesPer = count >> partitionOrder;
+        uint64_t bits = 2 + 4;
+        int parameters[1 << MAX_PARTITION_ORDER];
+        for (int p = 0; p < currentPartitions; ++p) {
+            uint64_t values = (uint64_t)(p == 0 ? samplesPer - order : samplesPer);
+            uint64_t sum = sums[p];
+            int k = 0;
+            if (values > 0) {
+                while (k < MAX_RICE_PARAMETER && (values << (k + 1)) < sum) k++;
+            }
+            // 均值附近的两个参数中取较省的
+            uint64_t cost = values * (k + 1) + (sum >> k);
+            if (k > 0 && values * k + (sum >> (k - 1)) < cost) {
+                k--;
+                cost = values * (k + 1) + (sum >> k);
+            }
+            parameters[p] = k;
+            bits += 4 + cost;
+        }
+        if (bits < bestBits) {
+            bestBits = bits;
+            plan.partitionOrder = partitionOrder;
+            std::memcpy(plan.parameters, parameters, sizeof(int) * currentPartitions);
+        }
+        // 相邻分区合并，得到上一级
+        for (int p = 0; p < currentPartitions / 2; ++p) sums[p] = sums[2 * p] + sums[2 * p + 1];
+    }
+    return bestBits;
+}
+
+void FrameEncoder::writeResidual(BitWriter& writer, const uint32_t* folded, int count, int order,
+                                 const RicePlan& plan) const {
+    writer.write(0, 2);     // 4 位 Rice 参数
+    writer.write((uint32_t)plan.partitionOrder, 4);
+    int partitions = 1 << plan.partitionOrder;
+    int samplesPer = count >> plan.partitionOrder;
+    for (int p = 0, i = order; p < partitions; ++p) {
+        int k = plan.parameters[p];
+        writer.write((uint32_t)k, 4);
+        for (int end = (p + 1) * samplesPer; i < end; ++i) writer.writeRice(folded[i], k);
+    }
+}
+
+// 加窗（Tukey 0.5）自相关 + Levinson-Durbin 得到各阶系数，按预计位数选阶数后量化系数
+bool FrameEncoder::computeLpc(const int32_t* samples, int count, int& order, int32_t* coefficients, int& shift) {
+    int maxOrder = (std::min)(options.maxLpcOrder, count / 2);
+    if (maxOrder <= 0) return false;
+
+    if (windowSize != count) {
+        window.resize(count);
+        int taper = count / 4;
+        for (int i = 0; i < count; ++i) {
+            double weight = 1.0;
+            if (i < taper) weight = 0.5 - 0.5 * std::cos(3.14159265358979 * i / taper);
+            else if (i >= count - taper) weight = 0.5 - 0.5 * std::cos(3.14159265358979 * (count - 1 - i) / taper);
+            window[i] = weight;
+        }
+        windowSize = count;
+    }
+    for (int i = 0; i < count; ++i) windowed[i] = samples[i] * window[i];
+
+    double autocorrelation[MAX_LPC_ORDER + 1];
+    for (int lag = 0; lag <= maxOrder; ++lag) {
+        double sum = 0;
+        for (int i = lag; i < count; ++i) sum += windowed[i] * windowed[i - lag];
+        autocorrelation[lag] = sum;
+    }
+    if (autocorrelation[0] <= 0) return false;
+
+    double lpc[MAX_LPC_ORDER];
+    double predictors[MAX_LPC_ORDER][MAX_LPC_ORDER];
+    double errors[MAX_LPC_ORDER];
+    double error = autocorrelation[0];
+    int computed = 0;
+    for (int i = 0; i < maxOrder; ++i) {
+        double reflection = -autocorrelation[i + 1];
+        for (int j = 0; j < i; ++j) reflection -= lpc[j] * autocorrelation[i - j];
+        reflection /= error;
+        lpc[i] = reflection;
+        int j = 0;
+        for (; j < (i >> 1); ++j) {
+            double saved = lpc[j];
+            lpc[j] += reflection * lpc[i - 1 - j];
+            lpc[i - 1 - j] += reflection * saved;
+        }
+        if (i & 1) lpc[j] += lpc[j] * reflection;
+        error *= 1.0 - reflection * reflection;
+        for (j = 0; j <= i; ++j) predictors[i][j] = -lpc[j];
+        errors[i] = error;
+        computed = i + 1;
+        if (error <= 0) break;
+    }
+
+    // 预计位数：每个残差约 0.5 * log2(误差 / 样本数) 位，另加系数
+    double bestBits = 1e300;
+    order = 0;
+    for (int i = 0; i < computed; ++i) {
+        double perSample = errors[i] > 0 ? 0.5 * std::log(errors[i] * 0.5 / count) / std::log(2.0) : 0;
+        double bits = (std::max)(perSample, 0.0) * (count - i - 1) + (i + 1) * (BITS_PER_SAMPLE + options.qlpPrecision);
+        if (bits < bestBits) {
+            bestBits = bits;
+            order = i + 1;
+        }
+    }
+    if (order == 0) return false;
+
+    // 量化：最大的系数用满 qlpPrecision - 1 位（另有符号位），误差累积到下一个系数
+    const double* lp = predictors[order - 1];
+    int precision = options.qlpPrecision - 1;
+    int32_t qmax = (1 << precision) - 1;
+    int32_t qmin = -(1 << precision);
+    double cmax = 0;
+    for (int i = 0; i < order; ++i) cmax = (std::max)(cmax, std::fabs(lp[i]));
+    if (cmax <= 0) return false;
+    int log2cmax;
+    std::frexp(cmax, &log2cmax);
+    shift = precision - log2cmax;
+    if (shift < 0) return false;
+    if (shift > MAX_QLP_SHIFT) shift = MAX_QLP_SHIFT;
+    double carried = 0;
+    for (int i = 0; i < order; ++i) {
+        carried += lp[i] * (1 << shift);
+        long quantized = std::lround(carried);
+        quantized = (std::max)((long)qmin, (std::min)((long)qmax, quantized));
+        carried -= quantized;
+        coefficients[i] = (int32_t)quantized;
+    }
+    return true;
+}
+
+void appendBigEndian(unsigned char* out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) out[i] = (unsigned char)(value >> (8 * (bytes - 1 - i)));
+}
+
+bool decodeResidual(BitReader& reader, int32_t* samples, int count, int order) {
+    uint32_t method = reader.read(2);
+    if (method > 1) return false;
+    int parameterBits = method == 0 ? 4 : 5;
+    uint32_t escape = method == 0 ? 15 : 31;
+    int partitionOrder = (int)reader.read(4);
+    int partitions = 1 << partitionOrder;
+    int samplesPer = count >> partitionOrder;
+    if ((partitionOrder > 0 && count % partitions != 0) || samplesPer < order) return false;
+    for (int p = 0, i = order; p < partitions; ++p) {
+        uint32_t k = reader.read(parameterBits);
+        int end = (p + 1) * samplesPer;
+        if (k == escape) {
+            int rawBits = (int)reader.read(5);
+            for (; i < end; ++i) samples[i] = reader.readSigned(rawBits);
+        } else {
+            for (; i < end; ++i) samples[i] = reader.readRice((int)k);
+        }
+        if (!reader.ok()) return false;
+    }
+    return true;
+}
+
+bool decodeSubframe(BitReader& reader, int32_t* samples, int count, int bitsPerSample) {
+    if (reader.read(1) != 0) return false;
+    uint32_t type = reader.read(6);
+    int wasted = 0;
+    if (reader.read(1)) wasted = (int)reader.readUnary() + 1;
+    int bits = bitsPerSample - wasted;
+    if (bits <= 0) return false;
+
+    if (type == 0) {
+        int32_t value = reader.readSigned(bits);
+        for (int i = 0; i < count; ++i) samples[i] = value;
+    } else if (type == 1) {
+        for (int i = 0; i < count; ++i) samples[i] = reader.readSigned(bits);
+    } else if (type >= 8 && type <= 12) {
+        int order = (int)type - 8;
+        if (order > count) return false;
+        for (int i = 0; i < order; ++i) samples[i] = reader.readSigned(bits);
+        if (!decodeResidual(reader, samples, count, order)) return false;
+        for (int i = order; i < count; ++i) {
+            switch (order) {
+                case 1: samples[i] += samples[i - 1]; break;
+                case 2: samples[i] += 2 * samples[i - 1] - samples[i - 2]; break;
+                case 3: samples[i] += 3 * samples[i - 1] - 3 * samples[i - 2] + samples[i - 3]; break;
+                case 4: samples[i] += 4 * samples[i - 1] - 6 * samples[i - 2] + 4 * samples[i - 3] - samples[i - 4]; break;
+                default: break;
+            }
+        }
+    } else if (type >= 32) {
+        int order = (int)(type & 31) + 1;
+        if (order > count) return false;
+        for (int i = 0; i < order; ++i) samples[i] = reader.readSigned(bits);
+        uint32_t precisionCode = reader.read(4);
+        if (precisionCode == 15) return false;
+        int precision = (int)precisionCode + 1;
+        int shift = reader.readSigned(5);
+        if (shift < 0) return false;
+        int32_t coefficients[MAX_LPC_ORDER];
+        for (int i = 0; i < order; ++i) coefficients[i] = reader.readSigned(precision);
+        if (!decodeResidual(reader, samples, count, order)) return false;
+        for (int i = order; i < count; ++i) {
+            int64_t sum = 0;
+            for (int j = 0; j < order; ++j) sum += (int64_t)coefficients[j] * samples[i - 1 - j];
+            samples[i] += (int32_t)(sum >> shift);
+        }
+    } else {
+        return false;
+    }
+    if (wasted > 0) {
+        for (int i = 0; i < count; ++i) samples[i] = (int32_t)((uint32_t)samples[i] << wasted);
+    }
+    return reader.ok();
+}
+
+} // namespace
+
+std::string EncodeFlac(const char* pcm, size_t bytes, int sampleRate, const FlacOptions& options,
+                       FlacEncodeStats* stats) {
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+    FlacOptions clamped = options;
+    clamped.blockSize = (std::max)(MIN_BLOCK_SIZE, (std::min)(MAX_BLOCK_SIZE, options.blockSize));
+    clamped.maxLpcOrder = (std::max)(0, (std::min)(MAX_LPC_ORDER, options.maxLpcOrder));
+    clamped.maxPartitionOrder = (std::max)(0, (std::min)(MAX_PARTITION_ORDER, options.maxPartitionOrder));
+    // 解码器按 32 位累加预测值：样本位数 + 系数位数 + log2(阶数) 不超过 32
+    int orderBits = 0;
+    while ((1 << orderBits) < clamped.maxLpcOrder) orderBits++;
+    clamped.qlpPrecision = (std::max)(4, (std::min)((std::min)(15, 32 - BITS_PER_SAMPLE - orderBits),
+                                                    options.qlpPrecision));
+
+    size_t total = bytes / 2;
+    std::string out;
+    out.reserve(bytes / 2 + 1024);
+    out.append("fLaC", 4);
+    BitWriter writer(out);
+    writer.write(1, 1);         // 最后一个元数据块
+    writer.write(0, 7);         // STREAMINFO
+    writer.write(34, 24);
+    writer.write((uint32_t)clamped.blockSize, 16);
+    writer.write((uint32_t)clamped.blockSize, 16);
+    writer.write(0, 24);        // 帧长的最小、最大值，编码完回填
+    writer.write(0, 24);
+    writer.write((uint32_t)sampleRate, 20);
+    writer.write(0, 3);         // 声道数 - 1
+    writer.write(BITS_PER_SAMPLE - 1, 5);
+    writer.write((uint32_t)((uint64_t)total >> 32), 4);
+    writer.write((uint32_t)total, 32);
+    out.append(16, '\0');       // MD5 未计算
+
+    FlacEncodeStats local;
+    FrameEncoder encoder(clamped, sampleRate);
+    std::vector<int32_t> samples(clamped.blockSize);
+    size_t minFrame = 0;
+    size_t maxFrame = 0;
+    uint32_t frameNumber = 0;
+    for (size_t offset = 0; offset < total; offset += samples.size(), ++frameNumber) {
+        int count = (int)(std::min)((size_t)clamped.blockSize, total - offset);
+        const unsigned char* source = (const unsigned char*)pcm + offset * 2;
+        for (int i = 0; i < count; ++i) samples[i] = (int16_t)(source[2 * i] | (source[2 * i + 1] << 8));
+        size_t before = out.size();
+        encoder.encode(samples.data(), count, frameNumber, out, local);
+        size_t frameBytes = out.size() - before;
+        minFrame = minFrame == 0 ? frameBytes : (std::min)(minFrame, frameBytes);
+        maxFrame = (std::max)(maxFrame, frameBytes);
+    }
+    appendBigEndian((unsigned char*)&out[12], (uint32_t)minFrame, 3);
+    appendBigEndian((unsigned char*)&out[15], (uint32_t)maxFrame, 3);
+
+    if (stats) {
+        local.pcmBytes = total * 2;
+        local.flacBytes = out.size();
+        local.encodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        *stats = local;
+    }
+    return out;
+}
+
+bool DecodeFlac(const unsigned char* data, size_t size, FlacStreamInfo& info, std::vector<char>& pcm) {
+    info = FlacStreamInfo();
+    pcm.clear();
+    if (size < 4 || std::memcmp(data, "fLaC", 4) != 0) return false;
+
+    size_t pos = 4;
+    bool haveInfo = false;
+    bool last = false;
+    while (!last) {
+        if (pos + 4 > size) return false;
+        last = (data[pos] & 0x80) != 0;
+        int type = data[pos] & 0x7F;
+        size_t length = ((size_t)data[pos + 1] << 16) | ((size_t)data[pos + 2] << 8) | data[pos + 3];
+        size_t body = pos + 4;
+        if (body + length > size) return false;
+        if (type == 0) {
+            if (length < 34) return false;
+            BitReader reader(data, body + length, body);
+            info.minBlockSize = (int)reader.read(16);
+            info.maxBlockSize = (int)reader.read(16);
+            reader.read(24);
+            reader.read(24);
+            info.sampleRate = (int)reader.read(20);
+            info.channels = (int)reader.read(3) + 1;
+            info.bitsPerSample = (int)reader.read(5) + 1;
+            info.totalSamples = (uint64_t)reader.read(4) << 32;
+            info.totalSamples |= reader.read(32);
+            haveInfo = true;
+        }
+        pos = body + length;
+    }
+    if (!haveInfo || info.channels != 1 || info.bitsPerSample > BITS_PER_SAMPLE || info.maxBlockSize <= 0) {
+        return false;
+    }
+
+    pcm.reserve((size_t)info.totalSamples * 2);
+    std::vector<int32_t> samples(MAX_BLOCK_SIZE + 1);
+    while (pos < size) {
+        size_t frameStart = pos;
+        BitReader reader(data, size, pos);
+        if (reader.read(14) != 0x3FFE || reader.read(1) != 0) return false;
+        reader.read(1);
+        uint32_t blockCode = reader.read(4);
+        uint32_t rateCode = reader.read(4);
+        uint32_t channelCode = reader.read(4);
+        uint32_t sizeCode = reader.read(3);
+        reader.read(1);
+        if (channelCode != 0 || rateCode == 15) return false;
+
+        // 帧号（或样本号），UTF-8 方式变长编码
+        uint32_t first = reader.read(8);
+        int extra = 0;
+        while (extra < 8 && (first & (0x80 >> extra))) extra++;
+        if (extra == 1 || extra == 8) return false;
+        for (int i = 1; i < extra; ++i) {
+            if ((reader.read(8) & 0xC0) != 0x80) return false;
+        }
+
+        int count;
+        if (blockCode == 0) return false;
+        else if (blockCode == 1) count = 192;
+        else if (blockCode <= 5) count = 576 << (blockCode - 2);
+        else if (blockCode == 6) count = (int)reader.read(8) + 1;
+        else if (blockCode == 7) count = (int)reader.read(16) + 1;
+        else count = 256 << (blockCode - 8);
+        if (rateCode == 12) reader.read(8);
+        else if (rateCode == 13 || rateCode == 14) reader.read(16);
+
+        static const int SAMPLE_SIZES[8] = {0, 8, 12, -1, 16, 20, 24, 32};
+        int bits = sizeCode == 0 ? info.bitsPerSample : SAMPLE_SIZES[sizeCode];
+        if (bits <= 0 || bits > BITS_PER_SAMPLE || count > MAX_BLOCK_SIZE + 1) return false;
+
+        size_t headerBytes = reader.bytePos() - frameStart;
+        if (reader.read(8) != crc8(data + frameStart, headerBytes)) return false;
+        if (!decodeSubframe(reader, samples.data(), count, bits)) return false;
+        reader.alignByte();
+        size_t frameBytes = reader.bytePos() - frameStart;
+        if (reader.read(16) != crc16(data + frameStart, frameBytes) || !reader.ok()) return false;
+
+        for (int i = 0; i < count; ++i) {
+            int32_t sample = (int32_t)((uint32_t)samples[i] << (BITS_PER_SAMPLE - bits));
+            pcm.push_back((char)(sample & 0xFF));
+            pcm.push_back((char)((sample >> 8) & 0xFF));
+        }
+        pos = reader.bytePos();
+    }
+    return info.totalSamples == 0 || pcm.size() / 2 == info.totalSamples;
+}
+
+std::string DescribeFlacEncode(const FlacEncodeStats& stats) {
+    char line[200];
+    std::snprintf(line, sizeof(line),
+                  "[flac] %lu -> %lu B (%.1f%%) frames=%lu constant=%lu fixed=%lu lpc=%lu verbatim=%lu encode=%.1f ms",
+                  (unsigned long)stats.pcmBytes, (unsigned long)stats.flacBytes,
+                  stats.pcmBytes > 0 ? 100.0 * stats.flacBytes / stats.pcmBytes : 0.0, (unsigned long)stats.frames,
+                  (unsigned long)stats.constantSubframes, (unsigned long)stats.fixedSubframes,
+                  (unsigned long)stats.lpcSubframes, (unsigned long)stats.verbatimSubframes, stats.encodeMs);
+    return line;
+}
@@ -0,0 +1,123 @@
+#include "../include/FormEncoder.h"
+#include "../include/Base64.h"
+
+namespace {
+
+// 每个字节编码后的长度（1 或 3）及编码内容
+struct EscapeTable {
+    unsigned char length[256];
+    char code[256][3];
+
+    EscapeTable() {
+        const char* hex = "0123456789ABCDEF";
+        for (int c = 0; c < 256; ++c) {
+            bool unreserved = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                              c == '-' || c == '_' || c == '.' || c == '~';
+            if (unreserved) {
+                length[c] = 1;
+                code[c][0] = (char)c;
+                code[c][1] = 0;
+                code[c][2] = 0;
+            } else {
+                length[c] = 3;
+                code[c][0] = '%';
+                code[c][1] = hex[c >> 4];
+                code[c][2] = hex[c & 0x0F];
+            }
+        }
+    }
+};
+
+const EscapeTable& escapeTable() {
+    static const EscapeTable table;
+    return table;
+}
+
+// 分块处理的原始字节数，必须是 3 的倍数，保证分块后的 base64 与整体编码一致
+const size_t CHUNK_INPUT = 3 * 1024;
+const size_t CHUNK_OUTPUT = CHUNK_INPUT / 3 * 4;
+
+} // namespace
+
+size_t FormUrlEncodedLength(const char* data, size_t size) {
+    const EscapeTable& table = escapeTable();
+    size_t length = 0;
+    for (size_t i = 0; i < size; ++i) {
+        length += table.length[(unsigned char)data[i]];
+    }
+    return length;
+}
+
+char* FormUrlEncode(const char* data, size_t size, char* out) {
+    const EscapeTable& table = escapeTable();
+    size_t i = 0;
+    
+    // 无分支写法：每个字节固定写 3 字节再按实际长度前进，多写的部分会被后续字节覆盖；
+    // 最后两个字节之后可能没有足够的输出空间，改用下面的分支写法
+    for (; i + 2 < size; ++i) {
+        unsigned char c = (unsigned char)data[i];
+        out[0] = table.code[c][0];
+        out[1] = table.code[c][1];
+        out[2] = table.code[c][2];
+        out += table.length[c];
+    }
+    
+    for (; i < size; ++i) {
+        unsigned char c = (unsigned char)data[i];
+        if (table.length[c] == 1) {
+            *out++ = (char)c;
+        } else {
+            out[0] = table.code[c][0];
+            out[1] = table.code[c][1];
+            out[2] = table.code[c][2];
+            out += 3;
+        }
+    }
+    return out;
+}
+
+void AppendFormUrlEncoded(std::string& out, const std::string& value) {
+    size_t offset = out.size();
+    out.resize(offset + FormUrlEncodedLength(value.data(), value.size()));
+    if (out.size() > offset) {
+        FormUrlEncode(value.data(), value.size(), &out[offset]);
+    }
+}
+
+size_t Base64FormEncodedLength(const unsigned char* data, size_t size) {
+    // base64 字母表中只有 '+'（62）、'/'（63）和填充 '=' 需要转义（各多 2 字节）。
+    // 直接从输入字节算出每个 6 位组，不做编码；值不小于 62 即高 5 位全为 1
+    size_t escapes = 0;
+    size_t full = size - size % 3;
+    for (size_t i = 0; i < full; i += 3) {
+        unsigned b0 = data[i], b1 = data[i + 1], b2 = data[i + 2];
+        escapes += (b0 >> 2) >= 62;
+        escapes += (((b0 & 0x03) << 4) | (b1 >> 4)) >= 62;
+        escapes += (((b1 & 0x0F) << 2) | (b2 >> 6)) >= 62;
+        escapes += (b2 & 0x3F) >= 62;
+    }
+    // 结尾不足 3 字节：缺少的位补 0，其余位置为填充
+    if (size % 3 == 1) {
+        unsigned b0 = data[full];
+        escapes += (b0 >> 2) >= 62;
+        escapes += 2;
+    } else if (size % 3 == 2) {
+        unsigned b0 = data[full], b1 = data[full + 1];
+        escapes += (b0 >> 2) >= 62;
+        escapes += (((b0 & 0x03) << 4) | (b1 >> 4)) >= 62;
+        escapes += ((b1 & 0x0F) << 2) >= 62;
+        escapes += 1;
+    }
+    return (size + 2) / 3 * 4 + escapes * 2;
+}
+
+char* WriteBase64FormEncoded(const unsigned char* data, size_t size, char* out) {
+    // base64 结果只在栈上的小块中停留，不产生整幅图片大小的中间字符串
+    char chunk[CHUNK_OUTPUT];
+    for (size_t offset = 0; offset < size; offset += CHUNK_INPUT) {
+        size_t n = (size - offset < CHUNK_INPUT) ? size - offset : CHUNK_INPUT;
+        size_t encoded = Base64Encode(data + offset, n, chunk);
+        out = FormUrlEncode(chunk, encoded, out);
+    }
+    return out;
+}
@@ -0,0 +1,72 @@
+#include "../include/GdiCaptureSource.h"
+
+GdiCaptureSource::GdiCaptureSource()
+    : screenDC(nullptr), memDC(nullptr), bitmap(nullptr), oldBitmap(nullptr), bits(nullptr),
+      capacityWidth(0), capacityHeight(0) {
+    screenDC = CreateDC("DISPLAY", nullptr, nullptr, nullptr);
+    memDC = CreateCompatibleDC(screenDC);
+}
+
+GdiCaptureSource::~GdiCaptureSource() {
+    releaseBitmap();
+    if (memDC) DeleteDC(memDC);
+    if (screenDC) DeleteDC(screenDC);
+}
+
+bool GdiCaptureSource::ensureCapacity(int width, int height) {
+    if (bitmap && width <= capacityWidth && height <= capacityHeight) return true;
+
+    // 按两个维度的最大值扩容，避免交替的宽图/高图反复重建
+    int newWidth = width > capacityWidth ? width : capacityWidth;
+    int newHeight = height > capacityHeight ? height : capacityHeight;
+    releaseBitmap();
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = newWidth;
+    bmi.bmiHeader.biHeight = -newHeight;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    bitmap = CreateDIBSection(screenDC, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0);
+    if (!bitmap || !bits) {
+        releaseBitmap();
+        return false;
+    }
+    oldBitmap = (HBITMAP)SelectObject(memDC, bitmap);
+    capacityWidth = newWidth;
+    capacityHeight = newHeight;
+    return true;
+}
+
+void GdiCaptureSource::releaseBitmap() {
+    if (bitmap) {
+        SelectObject(memDC, oldBitmap);
+        DeleteObject(bitmap);
+    }
+    bitmap = nullptr;
+    oldBitmap = nullptr;
+    bits = nullptr;
+    capacityWidth = 0;
+    capacityHeight = 0;
+}
+
+bool GdiCaptureSource::capture(int x, int y, int width, int height, PixelBufferView& view) {
+    if (!screenDC || !memDC) return false;
+
+    int screenWidth = GetSystemMetrics(SM_CXSCREEN);
+    int screenHeight = GetSystemMetrics(SM_CYSCREEN);
+    if (!ClipCaptureRegion(x, y, width, height, screenWidth, screenHeight)) return false;
+    if (!ensureCapacity(width, height)) return false;
+
+    if (!BitBlt(memDC, 0, 0, width, height, screenDC, x, y, SRCCOPY)) return false;
+    GdiFlush();
+
+    view.pixels = static_cast<const unsigned char*>(bits);
+    view.width = width;
+    view.height = height;
+    view.stride = capacityWidth * 4;
+    view.dpi = GetDeviceCaps(screenDC, LOGPIXELSY);
+    return true;
+}
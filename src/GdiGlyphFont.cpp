@@ -0,0 +1,62 @@
+#include "../include/GdiGlyphFont.h"
+#include <windows.h>
+#include <algorithm>
+
+bool RenderGdiGlyphFont(const wchar_t* face, int pixelHeight, const std::string& name, GlyphFont& font) {
+    HDC dc = CreateCompatibleDC(nullptr);
+    if (!dc) return false;
+    // 负的高度按字符高度（不含内部行距）选字号，与界面上的字号一致
+    HFONT hfont = CreateFontW(-pixelHeight, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET, OUT_TT_PRECIS,
+                              CLIP_DEFAULT_PRECIS, ANTIALIASED_QUALITY, DEFAULT_PITCH, face);
+    if (!hfont) {
+        DeleteDC(dc);
+        return false;
+    }
+    HGDIOBJ oldFont = SelectObject(dc, hfont);
+
+    wchar_t selected[LF_FACESIZE] = {0};
+    GetTextFaceW(dc, LF_FACESIZE, selected);
+    bool ok = lstrcmpiW(selected, face) == 0;
+    if (ok) {
+        font = GlyphFont();
+        font.name = name;
+        SIZE space;
+        if (GetTextExtentPoint32W(dc, L" ", 1, &space)) font.space = space.cx;
+
+        const MAT2 identity = {{0, 1}, {0, 0}, {0, 0}, {0, 1}};
+        std::vector<unsigned char> buffer;
+        for (wchar_t ch = L'!'; ch <= L'~'; ++ch) {
+            GLYPHMETRICS metrics;
+            DWORD size = GetGlyphOutlineW(dc, ch, GGO_GRAY8_BITMAP, &metrics, 0, nullptr, &identity);
+            if (size == GDI_ERROR || size == 0) continue;
+            buffer.resize(size);
+            if (GetGlyphOutlineW(dc, ch, GGO_GRAY8_BITMAP, &metrics, size, buffer.data(), &identity) == GDI_ERROR) continue;
+
+            // GGO_GRAY8_BITMAP：每行按 4 字节对齐，灰度 0..64
+            GlyphBitmap glyph;
+            glyph.ch = (char)ch;
+            glyph.width = (int)metrics.gmBlackBoxX;
+            glyph.height = (int)metrics.gmBlackBoxY;
+            glyph.left = metrics.gmptGlyphOrigin.x;
+            glyph.top = metrics.gmptGlyphOrigin.y;
+            glyph.advance = metrics.gmCellIncX;
+            int pitch = (glyph.width + 3) & ~3;
+            if ((size_t)pitch * glyph.height > buffer.size()) continue;
+            glyph.coverage.resize((size_t)glyph.width * glyph.height);
+            for (int y = 0; y < glyph.height; ++y) {
+                for (int x = 0; x < glyph.width; ++x) {
+                    int level = buffer[(size_t)y * pitch + x];
+                    glyph.coverage[(size_t)y * glyph.width + x] = (unsigned char)(std::min)(255, level * 255 / 64);
+                }
+            }
+            if (ch == L'H') font.capHeight = glyph.height;
+            font.glyphs.push_back(glyph);
+        }
+        ok = font.capHeight > 0;
+    }
+
+    SelectObject(dc, oldFont);
+    DeleteObject(hfont);
+    DeleteDC(dc);
+    return ok;
+}
@@ -2,12 +2,24 @@
 #include "../include/AppManager.h"
 #include "../include/ScreenCapture.h"
 #include "../include/VoiceRecognizer.h"
-#include <thread>
+#include "../include/HttpUpload.h"
+#include "../include/Executor.h"
+
+namespace {
+
+// 修饰键不拦截，截图或录音时仍可配合鼠标使用
+bool isModifierKey(DWORD vkCode) {
+    return vkCode == VK_LCONTROL || vkCode == VK_RCONTROL || vkCode == VK_LSHIFT || vkCode == VK_RSHIFT ||
+           vkCode == VK_LMENU || vkCode == VK_RMENU;
+}
+
+} // namespace
 
 HotkeyManager* HotkeyManager::instance = nullptr;
 
 HotkeyManager::HotkeyManager(AppManager* app) 
-    : appManager(app), keyboardHook(nullptr), mouseHook(nullptr) {
+    : appManager(app), keyboardHook(nullptr), mouseHook(nullptr),
+      dispatcher([this](const InputEvent& event) { handleInput(event); }) {
     instance = this;
 }
 
@@ -17,6 +29,8 @@ HotkeyManager::~HotkeyManager() {
 }
 
 void HotkeyManager::startListening() {
+    dispatcher.start();
+    
     // 安装键盘钩子
     keyboardHook = SetWindowsHookEx(WH_KEYBOARD_LL, LowLevelKeyboardProc, GetModuleHandle(nullptr), 0);
     
@@ -25,6 +39,7 @@ void HotkeyManager::startListening() {
 }
 
 void HotkeyManager::stopListening() {
+    bool listening = keyboardHook || mouseHook;
     if (keyboardHook) {
         UnhookWindowsHookEx(keyboardHook);
         keyboardHook = nullptr;
@@ -33,133 +48,97 @@ void HotkeyManager::stopListening() {
         UnhookWindowsHookEx(mouseHook);
         mouseHook = nullptr;
     }
+    dispatcher.stop();
+    
+    if (listening) {
+        std::string log = DescribeInputStats(dispatcher.stats()) + "\n";
+        OutputDebugStringA(log.c_str());
+    }
 }
 
+// 钩子回调在系统的超时时间内必须返回：这里只分类按键并交给分发器查表，动作由分发线程执行
 LRESULT CALLBACK HotkeyManager::LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam) {
-    if (nCode >= 0 && instance && instance->appManager) {
+    // 只处理按键按下事件
+    if (nCode >= 0 && instance && (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN)) {
+        std::chrono::steady_clock::time_point entered = std::chrono::steady_clock::now();
         KBDLLHOOKSTRUCT* kb = (KBDLLHOOKSTRUCT*)lParam;
         
-        // 只处理按键按下事件
-        if (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN) {
-            // 检查是否在截图状态
-            bool isCapturing = instance->appManager->screenCapture && 
-                              instance->appManager->screenCapture->windowCreated;
-            
-            // 检查是否在录音状态
-            bool isRecording = instance->appManager->voiceRecognizer && 
-                              instance->appManager->voiceRecognizer->keyListeningActive;
-            
-            // 截图状态下的按键处理
-            if (isCapturing) {
-                // ESC键交给ScreenCapture处理，其他按键拦截避免误操作
-                if (kb->vkCode == VK_ESCAPE) {
-                    // 通知ScreenCapture处理按键
-                    std::thread([vkCode = kb->vkCode]() {
-                        if (instance && instance->appManager && instance->appManager->screenCapture) {
-                            instance->appManager->screenCapture->onKeyPressed(vkCode);
-                        }
-                    }).detach();
-                    
-                    return 1; // 拦截ESC键
-                }
-                
-                // 拦截其他按键，避免误操作（除了Ctrl、Shift等修饰键）
-                if (kb->vkCode != VK_LCONTROL && kb->vkCode != VK_RCONTROL &&
-                    kb->vkCode != VK_LSHIFT && kb->vkCode != VK_RSHIFT &&
-                    kb->vkCode != VK_LMENU && kb->vkCode != VK_RMENU) {
-                    return 1;
-                }
-            }
-            
-            // 录音状态下的按键处理
-            if (isRecording) {
-                // ESC、空格键交给VoiceRecognizer处理，其他按键拦截
-                if (kb->vkCode == VK_ESCAPE || kb->vkCode == VK_SPACE) {
-                    
-                    // 通知VoiceRecognizer处理按键
-                    std::thread([vkCode = kb->vkCode]() {
-                        if (instance && instance->appManager && instance->appManager->voiceRecognizer) {
-                            instance->appManager->voiceRecognizer->onKeyPressed(vkCode);
-                        }
-                    }).detach();
-                    
-                    return 1; // 拦截按键
-                }
-                
-                // 拦截其他按键，避免误操作
-                if (kb->vkCode != VK_LCONTROL && kb->vkCode != VK_RCONTROL &&
-                    kb->vkCode != VK_LSHIFT && kb->vkCode != VK_RSHIFT &&
-                    kb->vkCode != VK_LMENU && kb->vkCode != VK_RMENU) {
-                    return 1;
-                }
-            }
-            
-            // 正常状态下的快捷键处理
-            if (!isCapturing && !isRecording && instance->isCtrlShiftPressed()) {
-                // Ctrl+Shift+S - 截图OCR
-                if (kb->vkCode == 'S') {
-                    std::thread([](){ 
-                        if (instance && instance->appManager && instance->appManager->screenCapture) {
-                            instance->appManager->screenCapture->startCapture(); 
-                        }
-                    }).detach();
-                    return 1;
-                }
-                // Ctrl+Shift+H - 语音识别
-                else if (kb->vkCode == 'H') {
-                    std::thread([](){ 
-                        if (instance && instance->appManager && instance->appManager->voiceRecognizer) {
-                            instance->appManager->voiceRecognizer->startRecording(); 
-                        }
-                    }).detach();
-                    return 1;
-                }
-            }
-        }
+        InputKey key = INPUT_KEY_OTHER;
+        if (kb->vkCode == VK_ESCAPE) key = INPUT_KEY_ESCAPE;
+        else if (kb->vkCode == VK_SPACE) key = INPUT_KEY_SPACE;
+        else if (isModifierKey(kb->vkCode)) key = INPUT_KEY_MODIFIER;
+        else if (kb->vkCode == 'S' && isCtrlShiftPressed()) key = INPUT_KEY_CAPTURE_HOTKEY;
+        else if (kb->vkCode == 'H' && isCtrlShiftPressed()) key = INPUT_KEY_RECORD_HOTKEY;
+        
+        bool intercept = instance->dispatcher.onInput(key);
+        instance->dispatcher.recordHookLatency(entered);
+        if (intercept) return 1;
     }
     
     return CallNextHookEx(instance ? instance->keyboardHook : nullptr, nCode, wParam, lParam);
 }
 
 LRESULT CALLBACK HotkeyManager::LowLevelMouseProc(int nCode, WPARAM wParam, LPARAM lParam) {
-    if (nCode >= 0 && instance && instance->appManager) {
-        // 只处理右键按下事件
-        if (wParam == WM_RBUTTONDOWN) {
-            bool isCapturing = instance->appManager->screenCapture && 
-                              instance->appManager->screenCapture->windowCreated;
-            bool isRecording = instance->appManager->voiceRecognizer && 
-                              instance->appManager->voiceRecognizer->keyListeningActive;
-            
-            // 临时调试输出
-            // OutputDebugStringA(("Mouse right button - isRecording: " + std::to_string(isRecording) + ", isCapturing: " + std::to_string(isCapturing) + "\n").c_str());
-            
-            if (isRecording) {
-                // 通知VoiceRecognizer处理右键
-                std::thread([]() {
-                    if (instance && instance->appManager && instance->appManager->voiceRecognizer) {
-                        // OutputDebugStringA("Sending VK_RBUTTON to VoiceRecognizer\n");
-                        instance->appManager->voiceRecognizer->onKeyPressed(VK_RBUTTON);
-                    }
-                }).detach();
-                return 1; // 拦截右键
-            }
-            
-            if (isCapturing) {
-                // 通知ScreenCapture处理右键
-                std::thread([]() {
-                    if (instance && instance->appManager && instance->appManager->screenCapture) {
-                        // OutputDebugStringA("Sending VK_RBUTTON to ScreenCapture\n");
-                        instance->appManager->screenCapture->onKeyPressed(VK_RBUTTON);
-                    }
-                }).detach();
-                return 1; // 拦截右键
-            }
-        }
+    // 只处理右键按下事件
+    if (nCode >= 0 && instance && wParam == WM_RBUTTONDOWN) {
+        std::chrono::steady_clock::time_point entered = std::chrono::steady_clock::now();
+        bool intercept = instance->dispatcher.onInput(INPUT_KEY_RBUTTON);
+        instance->dispatcher.recordHookLatency(entered);
+        if (intercept) return 1;
     }
     
     return CallNextHookEx(instance ? instance->mouseHook : nullptr, nCode, wParam, lParam);
 }
 
+// 分发线程：截图选区、录音等会阻塞的操作交给 I/O 池，分发线程马上处理下一个事件
+void HotkeyManager::handleInput(const InputEvent& event) {
+    AppManager* app = appManager;
+    ThreadPool& io = SharedExecutor().io();
+    switch (event.action) {
+    case INPUT_ACTION_START_CAPTURE:
+        prewarmConnection();
+        io.submit([app]() {
+            if (app->screenCapture) app->screenCapture->startCapture();
+        });
+        break;
+    case INPUT_ACTION_CANCEL_CAPTURE: {
+        int vkCode = event.key == INPUT_KEY_RBUTTON ? VK_RBUTTON : VK_ESCAPE;
+        io.submit([app, vkCode]() {
+            if (app->screenCapture) app->screenCapture->onKeyPressed(vkCode);
+        });
+        break;
+    }
+    case INPUT_ACTION_START_RECORDING:
+        prewarmConnection();
+        io.submit([app]() {
+            if (app->voiceRecognizer) app->voiceRecognizer->startRecording();
+        });
+        break;
+    case INPUT_ACTION_STOP_RECORDING:
+        if (app->voiceRecognizer) app->voiceRecognizer->onKeyPressed(VK_SPACE);
+        break;
+    case INPUT_ACTION_CANCEL_RECORDING:
+        if (app->voiceRecognizer) {
+            app->voiceRecognizer->onKeyPressed(event.key == INPUT_KEY_RBUTTON ? VK_RBUTTON : VK_ESCAPE);
+        }
+        break;
+    case INPUT_ACTION_CANCEL_RECOGNITION:
+        io.submit([app]() {
+            if (app->voiceRecognizer) app->voiceRecognizer->cancelRecognition();
+        });
+        break;
+    case INPUT_ACTION_NONE:
+        break;
+    }
+}
+
+void HotkeyManager::prewarmConnection() {
+    // 用户框选或说话期间完成 DNS 与 TLS 握手，松开鼠标/按空格后的请求直接复用连接
+    SharedExecutor().io().submit([]() {
+        WinInetSession::instance().prewarm(YOUDAO_API_HOST, INTERNET_DEFAULT_HTTPS_PORT, true);
+    });
+}
+
 bool HotkeyManager::isCtrlShiftPressed() {
     return (GetAsyncKeyState(VK_CONTROL) & 0x8000) && (GetAsyncKeyState(VK_SHIFT) & 0x8000);
 }
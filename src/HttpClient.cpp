@@ -0,0 +1,320 @@
+#include "../include/HttpClient.h"
+#include "../include/Socket.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// 头部超过此大小视为异常响应
+const size_t MAX_HEADER_BYTES = 64 * 1024;
+
+std::string toLower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return value;
+}
+
+std::string trim(const std::string& value) {
+    size_t start = value.find_first_not_of(" \t");
+    if (start == std::string::npos) return std::string();
+    size_t end = value.find_last_not_of(" \t\r");
+    return value.substr(start, end - start + 1);
+}
+
+} // namespace
+
+bool ParseHttpUrl(const std::string& url, HttpUrl& out) {
+    size_t schemeEnd = url.find("://");
+    if (schemeEnd == std::string::npos) return false;
+    out.scheme = toLower(url.substr(0, schemeEnd));
+    if (out.scheme != "http" && out.scheme != "https") return false;
+
+    size_t hostStart = schemeEnd + 3;
+    size_t pathStart = url.find('/', hostStart);
+    std::string authority = url.substr(hostStart, pathStart == std::string::npos ? std::string::npos : pathStart - hostStart);
+    out.path = pathStart == std::string::npos ? "/" : url.substr(pathStart);
+
+    out.port = out.scheme == "https" ? 443 : 80;
+    size_t colon = authority.rfind(':');
+    if (colon != std::string::npos && authority.find(']', colon) == std::string::npos) {
+        out.port = std::atoi(authority.c_str() + colon + 1);
+        authority = authority.substr(0, colon);
+    }
+    // [::1] 形式的 IPv6 地址去掉方括号
+    if (authority.size() >= 2 && authority[0] == '[' && authority[authority.size() - 1] == ']') {
+        authority = authority.substr(1, authority.size() - 2);
+    }
+    out.host = authority;
+    return !out.host.empty() && out.port > 0 && out.port < 65536;
+}
+
+HttpResponseParser::HttpResponseParser()
+    : state(STATE_HEADERS), status(0), keepAlive(true), remaining(0) {
+}
+
+void HttpResponseParser::fail(const std::string& message) {
+    state = STATE_ERROR;
+    error = message;
+}
+
+bool HttpResponseParser::parseHeaders() {
+    // 状态行：HTTP/1.x 200 OK
+    size_t lineEnd = headerBlock.find("\r\n");
+    std::string statusLine = headerBlock.substr(0, lineEnd);
+    if (statusLine.compare(0, 5, "HTTP/") != 0 || statusLine.size() < 12) {
+        fail("malformed status line");
+        return false;
+    }
+    keepAlive = statusLine.compare(0, 8, "HTTP/1.0") != 0;
+    status = std::atoi(statusLine.c_str() + 9);
+
+    bool chunked = false;
+    bool hasLength = false;
+    size_t contentLength = 0;
+
+    size_t pos = lineEnd == std::string::npos ? headerBlock.size() : lineEnd + 2;
+    while (pos < headerBlock.size()) {
+        size_t end = headerBlock.find("\r\n", pos);
+        if (end == std::string::npos) end = headerBlock.size();
+        std::string header = headerBlock.substr(pos, end - pos);
+        pos = end + 2;
+
+        size_t colon = header.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = toLower(trim(header.substr(0, colon)));
+        std::string value = toLower(trim(header.substr(colon + 1)));
+
+        if (name == "content-length") {
+            hasLength = true;
+            contentLength = (size_t)std::strtoull(value.c_str(), nullptr, 10);
+        } else if (name == "transfer-encoding") {
+            chunked = value.find("chunked") != std::string::npos;
+        } else if (name == "connection") {
+            if (value.find("close") != std::string::npos) keepAlive = false;
+            else if (value.find("keep-alive") != std::string::npos) keepAlive = true;
+        }
+    }
+
+    // 1xx 为中间响应，继续等待最终响应；204、304 没有响应体
+    if (status >= 100 && status < 200) {
+        headerBlock.clear();
+        state = STATE_HEADERS;
+    } else if (status == 204 || status == 304) {
+        state = STATE_DONE;
+    } else if (chunked) {
+        state = STATE_CHUNK_SIZE;
+    } else if (hasLength) {
+        remaining = contentLength;
+        body.reserve((std::min)(contentLength, (size_t)16 * 1024 * 1024));
+        state = contentLength == 0 ? STATE_DONE : STATE_BODY_LENGTH;
+    } else {
+        keepAlive = false;
+        state = STATE_BODY_UNTIL_CLOSE;
+    }
+    return true;
+}
+
+size_t HttpResponseParser::feed(const char* data, size_t size) {
+    size_t used = 0;
+    while (used < size && state != STATE_DONE && state != STATE_ERROR) {
+        switch (state) {
+            case STATE_HEADERS: {
+                // 逐字节找空行，头部通常只有几百字节
+                const char* start = data + used;
+                size_t available = size - used;
+                size_t consumed = 0;
+                bool finished = false;
+                while (consumed < available) {
+                    headerBlock.push_back(start[consumed++]);
+                    size_t length = headerBlock.size();
+                    if (length >= 4 && headerBlock.compare(length - 4, 4, "\r\n\r\n") == 0) {
+                        finished = true;
+                        break;
+                    }
+                }
+                used += consumed;
+                if (finished) {
+                    headerBlock.resize(headerBlock.size() - 4);
+                    parseHeaders();
+                } else if (headerBlock.size() > MAX_HEADER_BYTES) {
+                    fail("response headers too large");
+                }
+                break;
+            }
+
+            case STATE_BODY_LENGTH: {
+                size_t take = (std::min)(remaining, size - used);
+                body.append(data + used, take);
+                used += take;
+                remaining -= take;
+                if (remaining == 0) state = STATE_DONE;
+                break;
+            }
+
+            case STATE_CHUNK_SIZE:
+            case STATE_CHUNK_DATA_END:
+            case STATE_TRAILERS: {
+                char c = data[used++];
+                if (c != '\n') {
+                    line.push_back(c);
+                    if (line.size() > 1024) fail("chunk line too long");
+                    break;
+                }
+                if (!line.empty() && line[line.size() - 1] == '\r') line.resize(line.size() - 1);
+
+                if (state == STATE_CHUNK_SIZE) {
+                    char* end = nullptr;
+                    remaining = (size_t)std::strtoull(line.c_str(), &end, 16);
+                    if (end == line.c_str()) {
+                        fail("malformed chunk size");
+                    } else {
+                        state = remaining == 0 ? STATE_TRAILERS : STATE_CHUNK_DATA;
+                    }
+                } else if (state == STATE_CHUNK_DATA_END) {
+                    if (!line.empty()) fail("missing CRLF after chunk");
+                    else state = STATE_CHUNK_SIZE;
+                } else if (line.empty()) {
+                    state = STATE_DONE; // 尾部头字段以空行结束
+                }
+                line.clear();
+                break;
+            }
+
+            case STATE_CHUNK_DATA: {
+                size_t take = (std::min)(remaining, size - used);
+                body.append(data + used, take);
+                used += take;
+                remaining -= take;
+                if (remaining == 0) state = STATE_CHUNK_DATA_END;
+                break;
+            }
+
+            case STATE_BODY_UNTIL_CLOSE:
+                body.append(data + used, size - used);
+                used = size;
+                break;
+
+            default:
+                break;
+        }
+    }
+    return used;
+}
+
+void HttpResponseParser::finishOnClose() {
+    if (state == STATE_BODY_UNTIL_CLOSE) {
+        state = STATE_DONE;
+    } else if (state != STATE_DONE && state != STATE_ERROR) {
+        fail("connection closed before response completed");
+    }
+}
+
+void HttpResponseParser::takeResponse(HttpResponse& response) {
+    response.status = status;
+    response.keepAlive = keepAlive;
+    response.body.swap(body);
+    response.error = error;
+}
+
+bool WriteHttpRequestHead(SocketHandle socket, const char* method, const HttpUrl& url, const std::string& headers,
+                          long long contentLength, bool keepAlive) {
+    std::string head = std::string(method) + " " + url.path + " HTTP/1.1\r\n";
+    head += "Host: " + url.host + (url.port != 80 ? ":" + std::to_string(url.port) : std::string()) + "\r\n";
+    if (contentLength >= 0) head += "Content-Length: " + std::to_string(contentLength) + "\r\n";
+    else head += "Transfer-Encoding: chunked\r\n";
+    if (!keepAlive) head += "Connection: close\r\n";
+    head += headers;
+    head += "\r\n";
+    return SendAll(socket, head.data(), head.size());
+}
+
+bool WriteHttpRequest(SocketHandle socket, const char* method, const HttpUrl& url, const std::string& headers,
+                      const RequestBody& body, bool keepAlive) {
+    return WriteHttpRequestHead(socket, method, url, headers, (long long)body.size(), keepAlive) &&
+           body.writeTo([socket](const char* data, size_t size) {
+               return SendAll(socket, data, size);
+           });
+}
+
+bool WriteStreamBody(SocketHandle socket, const BodyStream& stream, long long contentLength) {
+    if (contentLength >= 0) {
+        long long written = 0;
+        bool ok = stream([socket, &written](const char* data, size_t size) {
+            written += (long long)size;
+            return SendAll(socket, data, size);
+        });
+        return ok && written == contentLength;
+    }
+
+    // 上一块数据的结尾 CRLF 与下一块的长度行合并发送，每块只需两次写调用
+    bool first = true;
+    bool ok = stream([socket, &first](const char* data, size_t size) {
+        if (size == 0) return true; // 零长度块表示结束，不能在中途发出
+        char line[32];
+        int length = std::snprintf(line, sizeof(line), "%s%zx\r\n", first ? "" : "\r\n", size);
+        first = false;
+        return SendAll(socket, line, (size_t)length) && SendAll(socket, data, size);
+    });
+    if (!ok) return false;
+    const char* terminator = first ? "0\r\n\r\n" : "\r\n0\r\n\r\n";
+    return SendAll(socket, terminator, std::strlen(terminator));
+}
+
+bool ReadHttpResponse(SocketHandle socket, HttpResponse& response, bool& closedBeforeResponse) {
+    response = HttpResponse();
+    closedBeforeResponse = false;
+    bool receivedAny = false;
+
+    HttpResponseParser parser;
+    bool trailingBytes = false;
+    char buffer[16 * 1024];
+    while (!parser.complete() && !parser.failed()) {
+        long received = ReceiveSome(socket, buffer, sizeof(buffer));
+        if (received < 0) {
+            bool timedOut = SocketTimedOut();
+            response.error = timedOut ? "receive timed out" : "receive failed";
+            closedBeforeResponse = !receivedAny && !timedOut;
+            return false;
+        }
+        if (received == 0) {
+            closedBeforeResponse = !receivedAny;
+            parser.finishOnClose();
+            break;
+        }
+        receivedAny = true;
+        // 不做流水线，响应之后多出的字节说明连接状态不可信
+        trailingBytes = parser.feed(buffer, (size_t)received) < (size_t)received;
+    }
+
+    if (parser.failed()) {
+        response.error = parser.errorMessage();
+        return false;
+    }
+    parser.takeResponse(response);
+    if (trailingBytes) response.keepAlive = false;
+    return true;
+}
+
+bool HttpPost(const HttpUrl& url, const std::string& headers, const RequestBody& body,
+              int timeoutMs, HttpResponse& response) {
+    response = HttpResponse();
+    if (url.scheme != "http") {
+        response.error = "only http:// is supported by the socket transport";
+        return false;
+    }
+
+    SocketHandle socket = ConnectTcp(url.host, url.port, timeoutMs, response.error);
+    if (socket == INVALID_SOCKET_HANDLE) return false;
+
+    bool ok = false;
+    bool closedBeforeResponse = false;
+    if (!WriteHttpRequest(socket, "POST", url, headers, body, false)) {
+        response.error = "send failed";
+    } else {
+        ok = ReadHttpResponse(socket, response, closedBeforeResponse);
+    }
+    CloseSocket(socket);
+    return ok;
+}
@@ -0,0 +1,244 @@
+#include "../include/HttpConnectionPool.h"
+#include "../include/RequestCancel.h"
+
+namespace {
+
+std::string poolKey(const HttpUrl& url) {
+    return url.host + ":" + std::to_string(url.port);
+}
+
+void closeAll(const std::vector<SocketHandle>& sockets) {
+    for (size_t i = 0; i < sockets.size(); ++i) CloseSocket(sockets[i]);
+}
+
+} // namespace
+
+HttpConnectionPool::HttpConnectionPool(const HttpPoolOptions& options) : poolOptions(options) {
+}
+
+HttpConnectionPool::~HttpConnectionPool() {
+    closeIdle();
+}
+
+void HttpConnectionPool::collectExpired(std::chrono::steady_clock::time_point now, std::vector<SocketHandle>& expired) {
+    std::chrono::milliseconds limit(poolOptions.idleTimeoutMs);
+    for (std::map<std::string, std::vector<IdleConnection> >::iterator it = idle.begin(); it != idle.end(); ++it) {
+        std::vector<IdleConnection>& list = it->second;
+        size_t kept = 0;
+        for (size_t i = 0; i < list.size(); ++i) {
+            if (now - list[i].idleSince > limit) {
+                expired.push_back(list[i].socket);
+                countEvicted(list[i]);
+            } else {
+                list[kept++] = list[i];
+            }
+        }
+        list.resize(kept);
+    }
+}
+
+void HttpConnectionPool::countEvicted(const IdleConnection& connection) {
+    counters.idleEvicted++;
+    if (connection.warm) counters.prewarmExpired++;
+}
+
+SocketHandle HttpConnectionPool::acquire(const HttpUrl& url, bool allowReuse, bool& reused, std::string& error) {
+    std::string key = poolKey(url);
+    std::vector<SocketHandle> expired;
+    SocketHandle socket = INVALID_SOCKET_HANDLE;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        collectExpired(std::chrono::steady_clock::now(), expired);
+        std::vector<IdleConnection>& list = idle[key];
+        // 后进先出：优先用最近归还的连接，让旧连接自然超时
+        while (allowReuse && !list.empty() && socket == INVALID_SOCKET_HANDLE) {
+            IdleConnection candidate = list.back();
+            list.pop_back();
+            // 空闲连接上不应有数据；可读说明对端已关闭（或发来了意外数据）
+            if (WaitReadable(candidate.socket, 0)) {
+                expired.push_back(candidate.socket);
+                countEvicted(candidate);
+            } else {
+                socket = candidate.socket;
+                if (candidate.warm) counters.prewarmUsed++;
+            }
+        }
+        if (socket != INVALID_SOCKET_HANDLE) counters.connectionsReused++;
+    }
+    closeAll(expired);
+
+    reused = socket != INVALID_SOCKET_HANDLE;
+    if (reused) return socket;
+
+    socket = ConnectTcp(url.host, url.port, poolOptions.connectTimeoutMs, error);
+    if (socket != INVALID_SOCKET_HANDLE) {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.connectionsOpened++;
+    }
+    return socket;
+}
+
+void HttpConnectionPool::release(const std::string& key, SocketHandle socket) {
+    std::vector<SocketHandle> expired;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        collectExpired(now, expired);
+        std::vector<IdleConnection>& list = idle[key];
+        if ((int)list.size() < poolOptions.maxIdlePerHost) {
+            IdleConnection connection = { socket, now, false };
+            list.push_back(connection);
+            socket = INVALID_SOCKET_HANDLE;
+        }
+    }
+    closeAll(expired);
+    CloseSocket(socket);
+}
+
+bool HttpConnectionPool::post(const HttpUrl& url, const std::string& headers, const RequestBody& body,
+                              HttpResponse& response, RequestCancel* cancel) {
+    response = HttpResponse();
+    if (url.scheme != "http") {
+        response.error = "only http:// is supported by the socket transport";
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.requests++;
+    }
+
+    bool keepAlive = poolOptions.maxIdlePerHost > 0;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        bool reused = false;
+        std::string error;
+        SocketHandle socket = acquire(url, attempt == 0, reused, error);
+        if (socket == INVALID_SOCKET_HANDLE) {
+            response.error = error;
+            return false;
+        }
+        SetSocketTimeout(socket, poolOptions.requestTimeoutMs);
+        // 取消时中断阻塞的收发；连接状态随之作废
+        int cancelId = cancel ? cancel->addAction([socket]() { AbortSocket(socket); }) : 0;
+        if (cancel && !cancelId) {
+            CloseSocket(socket);
+            response.error = "cancelled";
+            return false;
+        }
+
+        bool closedBeforeResponse = false;
+        bool sent = WriteHttpRequest(socket, "POST", url, headers, body, keepAlive);
+        bool received = sent && ReadHttpResponse(socket, response, closedBeforeResponse);
+        bool aborted = cancel && !cancel->removeAction(cancelId);
+        if (received) {
+            if (keepAlive && response.keepAlive && !aborted) release(poolKey(url), socket);
+            else CloseSocket(socket);
+            return true;
+        }
+        CloseSocket(socket);
+        if (aborted) {
+            response.error = "cancelled";
+            return false;
+        }
+        if (!sent) response.error = "send failed";
+
+        // 复用的连接可能在借出后才被服务器关闭：在任何响应字节之前断开时按 HTTP/1.1 惯例用新连接重发一次，超时不重发
+        if (!reused || (sent && !closedBeforeResponse)) return false;
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.staleRetries++;
+    }
+    return false;
+}
+
+bool HttpConnectionPool::postStream(const HttpUrl& url, const std::string& headers, long long contentLength,
+                                    const BodyStream& stream, HttpResponse& response) {
+    response = HttpResponse();
+    if (url.scheme != "http") {
+        response.error = "only http:// is supported by the socket transport";
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.requests++;
+    }
+
+    bool reused = false;
+    SocketHandle socket = acquire(url, true, reused, response.error);
+    if (socket == INVALID_SOCKET_HANDLE) return false;
+    SetSocketTimeout(socket, poolOptions.requestTimeoutMs);
+
+    bool keepAlive = poolOptions.maxIdlePerHost > 0;
+    bool closedBeforeResponse = false;
+    if (!WriteHttpRequestHead(socket, "POST", url, headers, contentLength, keepAlive) ||
+        !WriteStreamBody(socket, stream, contentLength)) {
+        // 请求体只发出一部分，连接状态不可再用
+        CloseSocket(socket);
+        response.error = "send failed";
+        return false;
+    }
+    if (!ReadHttpResponse(socket, response, closedBeforeResponse)) {
+        CloseSocket(socket);
+        return false;
+    }
+    if (keepAlive && response.keepAlive) release(poolKey(url), socket);
+    else CloseSocket(socket);
+    return true;
+}
+
+bool HttpConnectionPool::preconnect(const HttpUrl& url) {
+    if (url.scheme != "http" || poolOptions.maxIdlePerHost <= 0) return false;
+    std::string key = poolKey(url);
+    std::vector<SocketHandle> expired;
+    bool haveWarm = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        collectExpired(std::chrono::steady_clock::now(), expired);
+        std::vector<IdleConnection>& list = idle[key];
+        for (size_t i = 0; i < list.size(); ++i) haveWarm = haveWarm || list[i].warm;
+    }
+    closeAll(expired);
+    // 之前请求留下的空闲连接可能在用户框选期间到期，只有尚未使用的预热连接才算数
+    if (haveWarm) return true;
+
+    std::string error;
+    SocketHandle socket = ConnectTcp(url.host, url.port, poolOptions.connectTimeoutMs, error);
+    if (socket == INVALID_SOCKET_HANDLE) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.connectionsOpened++;
+        std::vector<IdleConnection>& list = idle[key];
+        if ((int)list.size() < poolOptions.maxIdlePerHost) {
+            IdleConnection connection = { socket, std::chrono::steady_clock::now(), true };
+            list.push_back(connection);
+            counters.prewarmed++;
+            socket = INVALID_SOCKET_HANDLE;
+        }
+    }
+    CloseSocket(socket);
+    return true;
+}
+
+void HttpConnectionPool::closeIdle() {
+    std::vector<SocketHandle> sockets;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (std::map<std::string, std::vector<IdleConnection> >::iterator it = idle.begin(); it != idle.end(); ++it) {
+            for (size_t i = 0; i < it->second.size(); ++i) {
+                sockets.push_back(it->second[i].socket);
+                if (it->second[i].warm) counters.prewarmExpired++;
+            }
+        }
+        idle.clear();
+    }
+    closeAll(sockets);
+}
+
+HttpPoolStats HttpConnectionPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+HttpConnectionPool& SharedHttpConnectionPool() {
+    static HttpConnectionPool pool;
+    return pool;
+}
@@ -0,0 +1,220 @@
+#include "../include/HttpUpload.h"
+#include "../include/RequestCancel.h"
+#include <cstdio>
+#include <cstring>
+
+#ifdef _MSC_VER
+#pragma comment(lib, "wininet.lib")
+#endif
+
+bool SendRequestBody(HINTERNET request, const std::string& headers, const RequestBody& body) {
+    INTERNET_BUFFERSA buffers = {};
+    buffers.dwStructSize = sizeof(INTERNET_BUFFERSA);
+    buffers.lpcszHeader = headers.c_str();
+    buffers.dwHeadersLength = (DWORD)headers.length();
+    buffers.dwBufferTotal = (DWORD)body.size(); // WinINet 据此生成 Content-Length
+
+    if (!HttpSendRequestExA(request, &buffers, nullptr, 0, 0)) {
+        return false;
+    }
+
+    bool written = body.writeTo([request](const char* data, size_t size) {
+        while (size > 0) {
+            DWORD bytesWritten = 0;
+            if (!InternetWriteFile(request, data, (DWORD)size, &bytesWritten) || bytesWritten == 0) {
+                return false;
+            }
+            data += bytesWritten;
+            size -= bytesWritten;
+        }
+        return true;
+    });
+
+    // 写出失败时仍需结束请求，让句柄回到可关闭的状态
+    BOOL ended = HttpEndRequestA(request, nullptr, 0, 0);
+    return written && ended;
+}
+
+namespace {
+
+// 同步模式下状态回调在发起请求的线程上执行，按线程计数即可知道某个请求是否新建了连接
+thread_local long threadConnections = 0;
+
+} // namespace
+
+WinInetSession& WinInetSession::instance() {
+    static WinInetSession session;
+    return session;
+}
+
+WinInetSession::WinInetSession()
+    : session(nullptr), connections(0), requests(0), prewarms(0), prewarmUsed(0), prewarmExpired(0),
+      prewarmPending(false) {
+    session = InternetOpenA("ShotOcr", INTERNET_OPEN_TYPE_DIRECT, nullptr, nullptr, 0);
+    if (session) {
+        // 回调只对带非零上下文的句柄触发，子句柄继承会话上的回调
+        InternetSetStatusCallbackA(session, &WinInetSession::statusCallback);
+        setTimeouts(10000, 30000, 30000);
+    }
+}
+
+WinInetSession::~WinInetSession() {
+    for (std::map<std::string, HINTERNET>::iterator it = servers.begin(); it != servers.end(); ++it) {
+        InternetCloseHandle(it->second);
+    }
+    if (session) InternetCloseHandle(session);
+}
+
+void WinInetSession::setTimeouts(DWORD connectMs, DWORD sendMs, DWORD receiveMs) {
+    if (!session) return;
+    InternetSetOptionA(session, INTERNET_OPTION_CONNECT_TIMEOUT, &connectMs, sizeof(connectMs));
+    InternetSetOptionA(session, INTERNET_OPTION_SEND_TIMEOUT, &sendMs, sizeof(sendMs));
+    InternetSetOptionA(session, INTERNET_OPTION_RECEIVE_TIMEOUT, &receiveMs, sizeof(receiveMs));
+}
+
+void CALLBACK WinInetSession::statusCallback(HINTERNET, DWORD_PTR context, DWORD status, LPVOID, DWORD) {
+    WinInetSession* self = reinterpret_cast<WinInetSession*>(context);
+    if (self && status == INTERNET_STATUS_CONNECTED_TO_SERVER) {
+        self->connections++;
+        threadConnections++;
+    }
+}
+
+HINTERNET WinInetSession::connectHandle(const char* host, INTERNET_PORT port) {
+    if (!session) return nullptr;
+    std::string key = std::string(host) + ":" + std::to_string(port);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<std::string, HINTERNET>::iterator it = servers.find(key);
+    if (it != servers.end()) return it->second;
+
+    // InternetConnect 只记录服务器信息，不建立连接；句柄可被多个线程同时用于打开请求
+    HINTERNET connect = InternetConnectA(session, host, port, nullptr, nullptr, INTERNET_SERVICE_HTTP, 0,
+                                         reinterpret_cast<DWORD_PTR>(this));
+    if (connect) servers[key] = connect;
+    return connect;
+}
+
+HINTERNET WinInetSession::openRequest(const char* host, INTERNET_PORT port, const char* verb, const char* path,
+                                      bool secure) {
+    HINTERNET connect = connectHandle(host, port);
+    if (!connect) return nullptr;
+
+    DWORD flags = INTERNET_FLAG_KEEP_CONNECTION | INTERNET_FLAG_NO_CACHE_WRITE;
+    if (secure) flags |= INTERNET_FLAG_SECURE;
+    return HttpOpenRequestA(connect, verb, path, nullptr, nullptr, nullptr, flags, reinterpret_cast<DWORD_PTR>(this));
+}
+
+bool WinInetSession::prewarm(const char* host, INTERNET_PORT port, bool secure) {
+    HINTERNET request = openRequest(host, port, "HEAD", "/", secure);
+    if (!request) return false;
+
+    // 响应状态无关紧要，只要连接建立；HEAD 没有响应体，读到结束后连接即回到池中
+    bool ok = HttpSendRequestA(request, nullptr, 0, nullptr, 0) != FALSE;
+    if (ok) {
+        char buffer[256];
+        DWORD bytesRead;
+        while (InternetReadFile(request, buffer, sizeof(buffer), &bytesRead) && bytesRead > 0) {
+        }
+        prewarms++;
+        prewarmPending = true;
+    }
+    InternetCloseHandle(request);
+    return ok;
+}
+
+bool WinInetSession::post(const char* host, INTERNET_PORT port, const char* path, bool secure,
+                          const std::string& headers, const RequestBody& body, std::string& response,
+                          RequestCancel* cancel) {
+    HINTERNET request = openRequest(host, port, "POST", path, secure);
+    if (!request) return false;
+    long requestIndex = ++requests;
+
+    // 已经取消时 addAction 立即关闭句柄，之后的调用直接失败
+    int cancelId = cancel ? cancel->addAction([request]() { InternetCloseHandle(request); }) : 0;
+    threadConnections = 0;
+    bool result = SendRequestBody(request, headers, body);
+    finishRequest(request, requestIndex, result, response, cancel, cancelId);
+    return result && !(cancel && cancel->cancelled());
+}
+
+bool WinInetSession::postStream(const char* host, INTERNET_PORT port, const char* path, bool secure,
+                                const std::string& headers, const BodyWriter& stream, std::string& response,
+                                RequestCancel* cancel, DWORD* status) {
+    if (status) *status = 0;
+    HINTERNET request = openRequest(host, port, "POST", path, secure);
+    if (!request) return false;
+    long requestIndex = ++requests;
+
+    // 关闭句柄后写入失败，编码线程的后续输出被丢弃
+    int cancelId = cancel ? cancel->addAction([request]() { InternetCloseHandle(request); }) : 0;
+    threadConnections = 0;
+    // dwBufferTotal 为 0 时 WinINet 不生成 Content-Length，分块格式由这里自行写出
+    std::string allHeaders = headers + "Transfer-Encoding: chunked\r\n";
+    INTERNET_BUFFERSA buffers = {};
+    buffers.dwStructSize = sizeof(INTERNET_BUFFERSA);
+    buffers.lpcszHeader = allHeaders.c_str();
+    buffers.dwHeadersLength = (DWORD)allHeaders.length();
+
+    bool result = HttpSendRequestExA(request, &buffers, nullptr, 0, 0) != FALSE;
+    if (result) {
+        RequestBody::Writer writeAll = [request](const char* data, size_t size) {
+            while (size > 0) {
+                DWORD bytesWritten = 0;
+                if (!InternetWriteFile(request, data, (DWORD)size, &bytesWritten) || bytesWritten == 0) {
+                    return false;
+                }
+                data += bytesWritten;
+                size -= bytesWritten;
+            }
+            return true;
+        };
+        // 上一块结尾的 CRLF 与下一块的长度行合并写出
+        bool first = true;
+        bool written = stream([&writeAll, &first](const char* data, size_t size) {
+            if (size == 0) return true;
+            char line[32];
+            int length = snprintf(line, sizeof(line), "%s%lx\r\n", first ? "" : "\r\n", (unsigned long)size);
+            first = false;
+            return writeAll(line, (size_t)length) && writeAll(data, size);
+        });
+        const char* terminator = first ? "0\r\n\r\n" : "\r\n0\r\n\r\n";
+        written = written && writeAll(terminator, strlen(terminator));
+        BOOL ended = HttpEndRequestA(request, nullptr, 0, 0);
+        result = written && ended;
+    }
+
+    // 不接受分块请求体的服务器通常回 411 或 400/501，交给调用方改用定长请求
+    if (result) {
+        DWORD code = 0;
+        DWORD codeSize = sizeof(code);
+        if (HttpQueryInfoA(request, HTTP_QUERY_STATUS_CODE | HTTP_QUERY_FLAG_NUMBER, &code, &codeSize, nullptr)) {
+            if (status) *status = code;
+            if (code >= 400) result = false;
+        }
+    }
+    finishRequest(request, requestIndex, result, response, cancel, cancelId);
+    return result && !(cancel && cancel->cancelled());
+}
+
+void WinInetSession::finishRequest(HINTERNET request, long requestIndex, bool sent, std::string& response,
+                                   RequestCancel* cancel, int cancelId) {
+    if (sent) {
+        char buffer[4096];
+        DWORD bytesRead;
+        while (InternetReadFile(request, buffer, sizeof(buffer), &bytesRead) && bytesRead > 0) {
+            response.append(buffer, bytesRead);
+        }
+    }
+    if (!cancel || cancel->removeAction(cancelId)) InternetCloseHandle(request);
+
+    if (prewarmPending.exchange(false)) {
+        if (threadConnections == 0) prewarmUsed++;
+        else prewarmExpired++;
+    }
+
+    char log[160];
+    snprintf(log, sizeof(log), "[http] request #%ld, connections opened: %ld, prewarm used/expired: %ld/%ld of %ld\n",
+             requestIndex, (long)connections, (long)prewarmUsed, (long)prewarmExpired, (long)prewarms);
+    OutputDebugStringA(log);
+}
@@ -0,0 +1,311 @@
+#include "../include/ImageAnalyzer.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const int MAX_PALETTE = 256;
+const int HASH_SLOTS = 1024;        // 2 的幂，且远大于 256，保证探测序列短
+const uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+const int SAMPLE_ROWS = 256;        // 边缘、平坦度与熵只统计约 256 行
+const int EDGE_THRESHOLD = 32;
+
+inline uint32_t pixelColor(const unsigned char* p) {
+    return (uint32_t)p[2] << 16 | (uint32_t)p[1] << 8 | p[0];
+}
+
+inline int pixelLuma(const unsigned char* p) {
+    return (p[0] * 29 + p[1] * 150 + p[2] * 77 + 128) >> 8;
+}
+
+// 开放寻址颜色表：颜色 -> 调色板下标，超过 256 色即放弃
+class ColorTable {
+public:
+    ColorTable() : count(0) {
+        for (int i = 0; i < HASH_SLOTS; ++i) keys[i] = EMPTY_SLOT;
+    }
+
+    // 返回颜色下标；表满时返回 -1
+    int lookup(uint32_t color) {
+        uint32_t slot = (color * 2654435761u) >> 22;
+        while (keys[slot] != EMPTY_SLOT) {
+            if (keys[slot] == color) return indices[slot];
+            slot = (slot + 1) & (HASH_SLOTS - 1);
+        }
+        if (count >= MAX_PALETTE) return -1;
+        keys[slot] = color;
+        indices[slot] = (unsigned char)count;
+        palette.push_back(color);
+        return count++;
+    }
+
+    int size() const { return count; }
+    const std::vector<uint32_t>& colors() const { return palette; }
+
+private:
+    uint32_t keys[HASH_SLOTS];
+    unsigned char indices[HASH_SLOTS];
+    std::vector<uint32_t> palette;
+    int count;
+};
+
+// 把 BGRA 映射为调色板下标；超过 256 色返回 false。与左侧像素相同时跳过查表
+bool buildIndexedImage(const unsigned char* bgra, int width, int height, int stride,
+                       std::vector<unsigned char>& indices, std::vector<uint32_t>& palette) {
+    ColorTable table;
+    indices.resize((size_t)width * height);
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* row = bgra + (size_t)y * stride;
+        unsigned char* dst = &indices[(size_t)y * width];
+        uint32_t previous = EMPTY_SLOT;
+        int previousIndex = 0;
+        for (int x = 0; x < width; ++x) {
+            uint32_t color = pixelColor(row + x * 4);
+            if (color != previous) {
+                previousIndex = table.lookup(color);
+                if (previousIndex < 0) return false;
+                previous = color;
+            }
+            dst[x] = (unsigned char)previousIndex;
+        }
+    }
+    palette = table.colors();
+    return true;
+}
+
+PngLevel levelForPixels(size_t pixels) {
+    if (pixels < 250000) return PngLevel::Best;
+    if (pixels < 1000000) return PngLevel::Default;
+    return PngLevel::Fast;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+ContentStats AnalyzeContent(const unsigned char* bgra, int width, int height, int stride) {
+    ContentStats stats;
+    if (!bgra || width <= 0 || height <= 0) return stats;
+
+    // 颜色数与是否纯灰需要逐像素统计；UI 截图大多是同色游程，跳过与左侧相同的像素
+    ColorTable table;
+    bool counting = true;
+    for (int y = 0; y < height && (counting || stats.isGray); ++y) {
+        const unsigned char* row = bgra + (size_t)y * stride;
+        uint32_t previous = EMPTY_SLOT;
+        for (int x = 0; x < width; ++x) {
+            uint32_t color = pixelColor(row + x * 4);
+            if (color == previous) continue;
+            previous = color;
+            if (stats.isGray && (row[x * 4] != row[x * 4 + 1] || row[x * 4 + 1] != row[x * 4 + 2])) {
+                stats.isGray = false;
+            }
+            if (counting && table.lookup(color) < 0) counting = false;
+            if (!counting && !stats.isGray) break;
+        }
+    }
+    stats.distinctColors = counting ? table.size() : MAX_PALETTE + 1;
+
+    // 边缘密度、平坦比例与熵：均匀抽样若干整行
+    size_t histogram[256] = {0};
+    size_t samples = 0, edges = 0, flat = 0;
+    int step = height > SAMPLE_ROWS ? height / SAMPLE_ROWS : 1;
+    for (int y = 0; y < height; y += step) {
+        const unsigned char* row = bgra + (size_t)y * stride;
+        int previousLuma = pixelLuma(row);
+        histogram[previousLuma]++;
+        for (int x = 1; x < width; ++x) {
+            const unsigned char* p = row + x * 4;
+            int luma = pixelLuma(p);
+            histogram[luma]++;
+            if (std::abs(luma - previousLuma) > EDGE_THRESHOLD) edges++;
+            if (pixelColor(p) == pixelColor(p - 4)) flat++;
+            previousLuma = luma;
+        }
+        samples += (size_t)width;
+    }
+
+    size_t pairs = samples - (samples / width);
+    if (pairs > 0) {
+        stats.edgeDensity = (double)edges / pairs;
+        stats.flatFraction = (double)flat / pairs;
+    }
+    for (int v = 0; v < 256; ++v) {
+        if (histogram[v] == 0) continue;
+        double p = (double)histogram[v] / samples;
+        stats.entropy -= p * std::log2(p);
+    }
+    return stats;
+}
+
+const char* ImageFormatName(ImageFormat format) {
+    switch (format) {
+        case ImageFormat::PngPalette: return "png-palette";
+        case ImageFormat::PngGray: return "png-gray";
+        case ImageFormat::Jpeg: return "jpeg";
+        default: return "png-rgb";
+    }
+}
+
+FormatDecision ChooseImageFormat(const ContentStats& stats, int width, int height,
+                                 const FormatPolicy& policy, bool preprocessEnabled) {
+    FormatDecision decision;
+    decision.pngLevel = levelForPixels((size_t)width * height);
+
+    bool photoLike = stats.distinctColors > MAX_PALETTE && stats.entropy >= policy.photoMinEntropy &&
+                     stats.flatFraction <= policy.photoMaxFlat && stats.edgeDensity <= policy.photoMaxEdgeDensity;
+
+    if (policy.allowJpeg && photoLike) {
+        decision.format = ImageFormat::Jpeg;
+        decision.jpegQuality = policy.jpegQuality;
+        decision.reason = "photo-like: many colors, high entropy, few flat runs";
+    } else if (preprocessEnabled) {
+        decision.format = ImageFormat::PngGray;
+        decision.reason = "preprocess enabled";
+    } else if (stats.distinctColors <= MAX_PALETTE) {
+        decision.format = ImageFormat::PngPalette;
+        decision.reason = "few colors";
+    } else if (stats.isGray) {
+        decision.format = ImageFormat::PngGray;
+        decision.reason = "grayscale content";
+    } else {
+        decision.format = ImageFormat::PngRgb;
+        decision.reason = "many colors, not photo-like";
+    }
+    return decision;
+}
+
+bool EncodeCaptureAdaptive(const unsigned char* bgra, int width, int height, int stride,
+                           const PreprocessOptions& preprocess, const FormatPolicy& policy,
+                           const JpegEncodeFunc& jpegEncoder, std::vector<unsigned char>& out,
+                           AdaptiveEncodeResult& result) {
+    out.clear();
+    return EncodeCaptureAdaptive(bgra, width, height, stride, preprocess, policy, jpegEncoder, PngOptions(),
+                                 [&out](const unsigned char* data, size_t size) {
+                                     out.insert(out.end(), data, data + size);
+                                 }, result);
+}
+
+bool EncodeCaptureAdaptive(const unsigned char* bgra, int width, int height, int stride,
+                           const PreprocessOptions& preprocess, const FormatPolicy& policy,
+                           const JpegEncodeFunc& jpegEncoder, const PngOptions& pngBase,
+                           const PngEncoder::Sink& outputSink, AdaptiveEncodeResult& result) {
+    if (!bgra || width <= 0 || height <= 0) return false;
+
+    size_t encodedBytes = 0;
+    PngEncoder::Sink sink = [&outputSink, &encodedBytes](const unsigned char* data, size_t size) {
+        encodedBytes += size;
+        outputSink(data, size);
+    };
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    result.stats = AnalyzeContent(bgra, width, height, stride);
+
+    FormatPolicy effective = policy;
+    if (!jpegEncoder) effective.allowJpeg = false;
+    result.decision = ChooseImageFormat(result.stats, width, height, effective, preprocess.enabled);
+    result.analyzeMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    PngOptions pngOptions = pngBase;
+    pngOptions.level = result.decision.pngLevel;
+    result.width = width;
+    result.height = height;
+
+    bool ok = false;
+    switch (result.decision.format) {
+        case ImageFormat::Jpeg: {
+            // JPEG 编码器一次给出完整结果，失败时尚未输出任何字节，可直接退回 PNG
+            std::vector<unsigned char> jpeg;
+            ok = jpegEncoder(bgra, width, height, stride, result.decision.jpegQuality, jpeg);
+            if (ok) {
+                sink(jpeg.data(), jpeg.size());
+            } else {
+                result.decision.format = ImageFormat::PngRgb;
+                result.decision.reason += " (jpeg failed)";
+                ok = EncodePngBgra(bgra, width, height, stride, pngOptions, sink);
+            }
+            break;
+        }
+
+        case ImageFormat::PngGray: {
+            GrayImage gray;
+            if (!PreprocessCapture(bgra, width, height, stride, preprocess, gray)) {
+                gray.width = width;
+                gray.height = height;
+                gray.pixels.resize((size_t)width * height);
+                ConvertBgraToGray(bgra, width, height, stride, gray.pixels.data());
+            }
+            result.width = gray.width;
+            result.height = gray.height;
+
+            // 灰阶不超过 16 级时（纯色界面上的无抗锯齿文字）用灰度调色板，无损且每像素至多 4 位
+            int bitDepth = preprocess.enabled ? preprocess.bitDepth : 8;
+            bool levelUsed[256] = {false};
+            int levels = 0;
+            for (size_t i = 0; i < gray.pixels.size() && levels <= 16; ++i) {
+                if (!levelUsed[gray.pixels[i]]) {
+                    levelUsed[gray.pixels[i]] = true;
+                    levels++;
+                }
+            }
+            if (bitDepth == 8 && levels <= 16) {
+                unsigned char indexOf[256] = {0};
+                std::vector<uint32_t> palette;
+                for (int v = 0; v < 256; ++v) {
+                    if (!levelUsed[v]) continue;
+                    indexOf[v] = (unsigned char)palette.size();
+                    palette.push_back((uint32_t)v * 0x010101u);
+                }
+                std::vector<unsigned char> indices(gray.pixels.size());
+                for (size_t i = 0; i < indices.size(); ++i) indices[i] = indexOf[gray.pixels[i]];
+                result.decision.format = ImageFormat::PngPalette;
+                result.decision.reason += ", few gray levels";
+                ok = EncodePngIndexed(indices.data(), gray.width, gray.height, palette, pngOptions, sink);
+            } else {
+                ok = EncodePngGray(gray, bitDepth, pngOptions, sink);
+            }
+            break;
+        }
+
+        case ImageFormat::PngPalette: {
+            std::vector<unsigned char> indices;
+            std::vector<uint32_t> palette;
+            if (buildIndexedImage(bgra, width, height, stride, indices, palette)) {
+                ok = EncodePngIndexed(indices.data(), width, height, palette, pngOptions, sink);
+            } else {
+                ok = EncodePngBgra(bgra, width, height, stride, pngOptions, sink);
+            }
+            break;
+        }
+
+        default:
+            ok = EncodePngBgra(bgra, width, height, stride, pngOptions, sink);
+            break;
+    }
+
+    result.encodeMs = elapsedMs(start);
+    result.encodedBytes = encodedBytes;
+    return ok;
+}
+
+std::string DescribeEncodeResult(const AdaptiveEncodeResult& result) {
+    static const char* levelNames[] = {"fastest", "fast", "default", "best"};
+    char line[320];
+    std::snprintf(line, sizeof(line),
+                  "[capture] %s (%s) level=%s q=%d %dx%d bytes=%zu colors=%d%s gray=%d edge=%.3f flat=%.3f "
+                  "entropy=%.2f analyze=%.1fms encode=%.1fms",
+                  ImageFormatName(result.decision.format), result.decision.reason.c_str(),
+                  levelNames[(int)result.decision.pngLevel], result.decision.jpegQuality,
+                  result.width, result.height, result.encodedBytes,
+                  result.stats.distinctColors > MAX_PALETTE ? MAX_PALETTE : result.stats.distinctColors,
+                  result.stats.distinctColors > MAX_PALETTE ? "+" : "", result.stats.isGray ? 1 : 0,
+                  result.stats.edgeDensity, result.stats.flatFraction, result.stats.entropy,
+                  result.analyzeMs, result.encodeMs);
+    return line;
+}
@@ -0,0 +1,294 @@
+#include "../include/ImagePreprocess.h"
+#include "../include/CpuFeatures.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(SHOTOCR_ARCH_X86)
+#include <emmintrin.h>
+#endif
+
+#if defined(SHOTOCR_ARCH_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Y = (29*B + 150*G + 77*R + 128) >> 8，三个 SIMD 实现与标量结果逐位一致
+const int WEIGHT_B = 29;
+const int WEIGHT_G = 150;
+const int WEIGHT_R = 77;
+
+void grayRowScalar(const unsigned char* src, unsigned char* dst, int width) {
+    for (int x = 0; x < width; ++x) {
+        dst[x] = (unsigned char)((src[0] * WEIGHT_B + src[1] * WEIGHT_G + src[2] * WEIGHT_R + 128) >> 8);
+        src += 4;
+    }
+}
+
+#if defined(SHOTOCR_ARCH_X86)
+
+// SSE2：每次 16 个像素，madd 得到 (B*wb + G*wg, R*wr) 两个 32 位和再两两相加
+SHOTOCR_TARGET("sse2")
+void grayRowSse2(const unsigned char* src, unsigned char* dst, int width) {
+    const __m128i weights = _mm_setr_epi16(WEIGHT_B, WEIGHT_G, WEIGHT_R, 0, WEIGHT_B, WEIGHT_G, WEIGHT_R, 0);
+    const __m128i rounding = _mm_set1_epi32(128);
+    const __m128i zero = _mm_setzero_si128();
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i sums[4];
+        for (int i = 0; i < 4; ++i) {
+            __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (x + i * 4) * 4));
+            __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(px, zero), weights);
+            __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(px, zero), weights);
+            // 每个像素的两个部分和位于相邻的 32 位通道
+            lo = _mm_add_epi32(lo, _mm_srli_epi64(lo, 32));
+            hi = _mm_add_epi32(hi, _mm_srli_epi64(hi, 32));
+            lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0));
+            hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0));
+            __m128i four = _mm_unpacklo_epi64(lo, hi);
+            sums[i] = _mm_srli_epi32(_mm_add_epi32(four, rounding), 8);
+        }
+        __m128i words0 = _mm_packs_epi32(sums[0], sums[1]);
+        __m128i words1 = _mm_packs_epi32(sums[2], sums[3]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(words0, words1));
+    }
+
+    grayRowScalar(src + x * 4, dst + x, width - x);
+}
+
+#endif // SHOTOCR_ARCH_X86
+
+#if defined(SHOTOCR_ARCH_ARM64)
+
+// NEON：vld4 解交织 8 个像素，乘加后舍入右移
+void grayRowNeon(const unsigned char* src, unsigned char* dst, int width) {
+    const uint8x8_t wb = vdup_n_u8(WEIGHT_B);
+    const uint8x8_t wg = vdup_n_u8(WEIGHT_G);
+    const uint8x8_t wr = vdup_n_u8(WEIGHT_R);
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        uint8x8x4_t px = vld4_u8(src + x * 4);
+        uint16x8_t sum = vmull_u8(px.val[0], wb);
+        sum = vmlal_u8(sum, px.val[1], wg);
+        sum = vmlal_u8(sum, px.val[2], wr);
+        vst1_u8(dst + x, vrshrn_n_u16(sum, 8));
+    }
+
+    grayRowScalar(src + x * 4, dst + x, width - x);
+}
+
+#endif // SHOTOCR_ARCH_ARM64
+
+typedef void (*GrayRowFunc)(const unsigned char*, unsigned char*, int);
+
+GrayRowFunc selectGrayRow() {
+    const CpuFeatures& cpu = GetCpuFeatures();
+#if defined(SHOTOCR_ARCH_X86)
+    if (cpu.sse2) return grayRowSse2;
+#endif
+#if defined(SHOTOCR_ARCH_ARM64)
+    if (cpu.neon) return grayRowNeon;
+#endif
+    (void)cpu;
+    return grayRowScalar;
+}
+
+// 一维面积权重：目标像素 t 覆盖源区间 [t*scale, (t+1)*scale)
+struct Contribution {
+    int first;
+    std::vector<float> weights;
+};
+
+std::vector<Contribution> buildContributions(int sourceSize, int targetSize) {
+    std::vector<Contribution> result(targetSize);
+    double scale = (double)sourceSize / targetSize;
+    for (int t = 0; t < targetSize; ++t) {
+        double start = t * scale;
+        double end = (std::min)((t + 1) * scale, (double)sourceSize);
+        int first = (int)std::floor(start);
+        int last = (std::min)((int)std::ceil(end), sourceSize);
+        result[t].first = first;
+        for (int i = first; i < last; ++i) {
+            double overlap = (std::min)(end, (double)(i + 1)) - (std::max)(start, (double)i);
+            result[t].weights.push_back((float)(overlap / scale));
+        }
+    }
+    return result;
+}
+
+// Otsu 阈值：最大化前景/背景的类间方差
+int otsuThreshold(const GrayImage& image) {
+    size_t histogram[256] = {0};
+    for (size_t i = 0; i < image.pixels.size(); ++i) {
+        histogram[image.pixels[i]]++;
+    }
+
+    double total = (double)image.pixels.size();
+    double sumAll = 0;
+    for (int v = 0; v < 256; ++v) sumAll += (double)v * histogram[v];
+
+    double sumBackground = 0, weightBackground = 0, bestVariance = -1;
+    int threshold = 127;
+    for (int v = 0; v < 256; ++v) {
+        weightBackground += histogram[v];
+        if (weightBackground == 0) continue;
+        double weightForeground = total - weightBackground;
+        if (weightForeground == 0) break;
+
+        sumBackground += (double)v * histogram[v];
+        double meanBackground = sumBackground / weightBackground;
+        double meanForeground = (sumAll - sumBackground) / weightForeground;
+        double variance = weightBackground * weightForeground * (meanBackground - meanForeground) * (meanBackground - meanForeground);
+        if (variance > bestVariance) {
+            bestVariance = variance;
+            threshold = v;
+        }
+    }
+    return threshold;
+}
+
+} // namespace
+
+void ConvertBgraToGray(const unsigned char* bgra, int width, int height, int stride, unsigned char* gray) {
+    static const GrayRowFunc grayRow = selectGrayRow();
+    for (int y = 0; y < height; ++y) {
+        grayRow(bgra + (size_t)y * stride, gray + (size_t)y * width, width);
+    }
+}
+
+GrayImage DownscaleGrayArea(const GrayImage& source, int targetWidth, int targetHeight) {
+    GrayImage result;
+    if (targetWidth <= 0 || targetHeight <= 0 || targetWidth > source.width || targetHeight > source.height) {
+        return source;
+    }
+
+    result.width = targetWidth;
+    result.height = targetHeight;
+    result.pixels.resize((size_t)targetWidth * targetHeight);
+
+    std::vector<Contribution> columns = buildContributions(source.width, targetWidth);
+    std::vector<Contribution> rows = buildContributions(source.height, targetHeight);
+
+    // 源行先做水平缩小；相邻目标行最多共享一条边界源行，缓存最近一行即可
+    std::vector<float> horizontal(targetWidth);
+    std::vector<float> accumulator(targetWidth);
+    int cachedRow = -1;
+
+    for (int ty = 0; ty < targetHeight; ++ty) {
+        std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+        const Contribution& rowContribution = rows[ty];
+
+        for (size_t k = 0; k < rowContribution.weights.size(); ++k) {
+            int sy = rowContribution.first + (int)k;
+            if (sy != cachedRow) {
+                const unsigned char* src = &source.pixels[(size_t)sy * source.width];
+                for (int tx = 0; tx < targetWidth; ++tx) {
+                    const Contribution& c = columns[tx];
+                    float sum = 0.0f;
+                    for (size_t j = 0; j < c.weights.size(); ++j) {
+                        sum += src[c.first + j] * c.weights[j];
+                    }
+                    horizontal[tx] = sum;
+                }
+                cachedRow = sy;
+            }
+
+            float weight = rowContribution.weights[k];
+            for (int tx = 0; tx < targetWidth; ++tx) {
+                accumulator[tx] += horizontal[tx] * weight;
+            }
+        }
+
+        unsigned char* dst = &result.pixels[(size_t)ty * targetWidth];
+        for (int tx = 0; tx < targetWidth; ++tx) {
+            float v = accumulator[tx] + 0.5f;
+            dst[tx] = (unsigned char)(v >= 255.0f ? 255 : v <= 0.0f ? 0 : (int)v);
+        }
+    }
+
+    return result;
+}
+
+std::vector<unsigned char> PackGrayRows(const GrayImage& image, int bitDepth, size_t& rowBytes) {
+    if (bitDepth != 1 && bitDepth != 2 && bitDepth != 4) {
+        rowBytes = (size_t)image.width;
+        return image.pixels;
+    }
+
+    rowBytes = ((size_t)image.width * bitDepth + 7) / 8;
+    std::vector<unsigned char> packed(rowBytes * image.height, 0);
+
+    // 每个灰度值对应的量化等级
+    unsigned char levels[256];
+    if (bitDepth == 1) {
+        int threshold = otsuThreshold(image);
+        for (int v = 0; v < 256; ++v) levels[v] = v > threshold ? 1 : 0;
+    } else {
+        int maxLevel = (1 << bitDepth) - 1;
+        for (int v = 0; v < 256; ++v) levels[v] = (unsigned char)((v * maxLevel + 127) / 255);
+    }
+
+    int pixelsPerByte = 8 / bitDepth;
+    for (int y = 0; y < image.height; ++y) {
+        const unsigned char* src = &image.pixels[(size_t)y * image.width];
+        unsigned char* dst = &packed[(size_t)y * rowBytes];
+        for (int x = 0; x < image.width; ++x) {
+            int shift = 8 - bitDepth * (x % pixelsPerByte + 1);
+            dst[x / pixelsPerByte] |= (unsigned char)(levels[src[x]] << shift);
+        }
+    }
+    return packed;
+}
+
+bool PreprocessCapture(const unsigned char* bgra, int width, int height, int stride,
+                       const PreprocessOptions& options, GrayImage& out) {
+    if (!options.enabled || !bgra || width <= 0 || height <= 0) return false;
+
+    GrayImage gray;
+    gray.width = width;
+    gray.height = height;
+    gray.pixels.resize((size_t)width * height);
+    ConvertBgraToGray(bgra, width, height, stride, gray.pixels.data());
+
+    // 高 DPI 屏幕上按比例缩小到目标 DPI，但不低于最小高度
+    if (options.targetDpi > 0 && options.sourceDpi > options.targetDpi) {
+        double scale = (double)options.targetDpi / options.sourceDpi;
+        int targetHeight = (std::max)((int)(height * scale + 0.5), (std::min)(options.minHeight, height));
+        if (targetHeight < height) {
+            int targetWidth = (std::max)(1, (int)((double)width * targetHeight / height + 0.5));
+            out = DownscaleGrayArea(gray, targetWidth, targetHeight);
+            return true;
+        }
+    }
+
+    out.width = gray.width;
+    out.height = gray.height;
+    out.pixels.swap(gray.pixels);
+    return true;
+}
+
+bool EncodePngGray(const GrayImage& image, int bitDepth, const PngOptions& pngOptions, std::vector<unsigned char>& out) {
+    out.clear();
+    return EncodePngGray(image, bitDepth, pngOptions, [&out](const unsigned char* data, size_t size) {
+        out.insert(out.end(), data, data + size);
+    });
+}
+
+bool EncodePngGray(const GrayImage& image, int bitDepth, const PngOptions& pngOptions, const PngEncoder::Sink& sink) {
+    if (image.width <= 0 || image.height <= 0) return false;
+    if (bitDepth != 1 && bitDepth != 2 && bitDepth != 4) bitDepth = 8;
+
+    size_t rowBytes = 0;
+    std::vector<unsigned char> packed = PackGrayRows(image, bitDepth, rowBytes);
+
+    PngEncoder encoder(pngOptions, sink);
+    encoder.begin(image.width, image.height, PngColorType::Gray, bitDepth);
+    for (int y = 0; y < image.height; ++y) {
+        encoder.writeRow(&packed[(size_t)y * rowBytes]);
+    }
+    encoder.finish();
+    return true;
+}
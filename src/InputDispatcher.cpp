@@ -0,0 +1,225 @@
+#include "../include/InputDispatcher.h"
+#include <algorithm>
+#include <cstdio>
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+// 查表用的行：空闲且语音识别进行中单独一行
+enum InputRow {
+    ROW_IDLE,
+    ROW_RECOGNIZING,
+    ROW_CAPTURING,
+    ROW_RECORDING,
+    ROW_COUNT
+};
+
+// 按键只负责进入截图/录音状态；离开由组件在遮罩窗口关闭、录音停止时报告，
+// 因此取消、结束等动作保持当前状态，组件收尾前的按键仍被拦截
+const InputTransition TRANSITIONS[ROW_COUNT][INPUT_KEY_COUNT] = {
+    // 空闲：只响应两个热键，其他按键照常传递
+    {
+        {false, INPUT_ACTION_NONE, INPUT_IDLE},                         // 其他
+        {false, INPUT_ACTION_NONE, INPUT_IDLE},                         // 修饰键
+        {false, INPUT_ACTION_NONE, INPUT_IDLE},                         // Esc
+        {false, INPUT_ACTION_NONE, INPUT_IDLE},                         // 空格
+        {false, INPUT_ACTION_NONE, INPUT_IDLE},                         // 右键
+        {true, INPUT_ACTION_START_CAPTURE, INPUT_CAPTURING},            // Ctrl+Shift+S
+        {true, INPUT_ACTION_START_RECORDING, INPUT_RECORDING},          // Ctrl+Shift+H
+    },
+    // 空闲、语音识别进行中：Esc 取消识别
+    {
+        {false, INPUT_ACTION_NONE, INPUT_IDLE},
+        {false, INPUT_ACTION_NONE, INPUT_IDLE},
+        {true, INPUT_ACTION_CANCEL_RECOGNITION, INPUT_IDLE},
+        {false, INPUT_ACTION_NONE, INPUT_IDLE},
+        {false, INPUT_ACTION_NONE, INPUT_IDLE},
+        {true, INPUT_ACTION_START_CAPTURE, INPUT_CAPTURING},
+        {true, INPUT_ACTION_START_RECORDING, INPUT_RECORDING},
+    },
+    // 截图中：Esc、右键取消，修饰键以外的按键一律拦截，避免误操作
+    {
+        {true, INPUT_ACTION_NONE, INPUT_CAPTURING},
+        {false, INPUT_ACTION_NONE, INPUT_CAPTURING},
+        {true, INPUT_ACTION_CANCEL_CAPTURE, INPUT_CAPTURING},
+        {true, INPUT_ACTION_NONE, INPUT_CAPTURING},
+        {true, INPUT_ACTION_CANCEL_CAPTURE, INPUT_CAPTURING},
+        {true, INPUT_ACTION_NONE, INPUT_CAPTURING},
+        {true, INPUT_ACTION_NONE, INPUT_CAPTURING},
+    },
+    // 录音中：Esc、右键取消，空格结束，其他按键拦截
+    {
+        {true, INPUT_ACTION_NONE, INPUT_RECORDING},
+        {false, INPUT_ACTION_NONE, INPUT_RECORDING},
+        {true, INPUT_ACTION_CANCEL_RECORDING, INPUT_RECORDING},
+        {true, INPUT_ACTION_STOP_RECORDING, INPUT_RECORDING},
+        {true, INPUT_ACTION_CANCEL_RECORDING, INPUT_RECORDING},
+        {true, INPUT_ACTION_NONE, INPUT_RECORDING},
+        {true, INPUT_ACTION_NONE, INPUT_RECORDING},
+    },
+};
+
+double msBetween(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+} // namespace
+
+const InputTransition& LookupInputTransition(InputMode mode, bool recognizing, InputKey key) {
+    InputRow row = ROW_IDLE;
+    if (mode == INPUT_CAPTURING) row = ROW_CAPTURING;
+    else if (mode == INPUT_RECORDING) row = ROW_RECORDING;
+    else if (recognizing) row = ROW_RECOGNIZING;
+    return TRANSITIONS[row][key];
+}
+
+const char* InputActionName(InputAction action) {
+    static const char* const NAMES[] = {"none", "start-capture", "cancel-capture", "start-recording",
+                                        "stop-recording", "cancel-recording", "cancel-recognition"};
+    return NAMES[action];
+}
+
+InputDispatcher::InputDispatcher(const Handler& handler, size_t queueCapacity)
+    : handler(handler), queue(queueCapacity), currentMode(INPUT_IDLE), recognizing(false), sleeping(false),
+      stopping(false), hookCalls(0), intercepted(0), queued(0), dropped(0), hookTotalNs(0), hookMaxNs(0),
+      dispatched(0), dispatchTotalMs(0), dispatchMaxMs(0) {
+    for (int i = 0; i < LATENCY_BUCKETS; ++i) hookBuckets[i] = 0;
+}
+
+InputDispatcher::~InputDispatcher() {
+    stop();
+}
+
+void InputDispatcher::start() {
+    if (worker.joinable()) return;
+    stopping = false;
+    worker = std::thread(&InputDispatcher::run, this);
+}
+
+void InputDispatcher::stop() {
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+bool InputDispatcher::onInput(InputKey key) {
+    hookCalls.fetch_add(1, std::memory_order_relaxed);
+    int mode = currentMode.load();
+    const InputTransition* transition;
+    // 组件可能同时报告状态变化：比较交换失败时按新状态重新查表
+    for (;;) {
+        transition = &LookupInputTransition((InputMode)mode, recognizing.load(), key);
+        if (transition->next == mode || currentMode.compare_exchange_weak(mode, transition->next)) break;
+    }
+    if (transition->intercept) intercepted.fetch_add(1, std::memory_order_relaxed);
+    if (transition->action == INPUT_ACTION_NONE) return transition->intercept;
+
+    InputEvent event;
+    event.key = key;
+    event.action = transition->action;
+    event.posted = Clock::now();
+    if (!queue.push(event)) {
+        // 动作丢了就不能停在新状态，否则之后的按键都会被拦截
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        changeMode(transition->next, (InputMode)mode);
+        return transition->intercept;
+    }
+    queued.fetch_add(1, std::memory_order_relaxed);
+    // 与分发线程的 sleeping 标志构成先写后读：双方至少有一方看到对方的写入，唤醒不会丢失
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load()) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wake.notify_one();
+    }
+    return transition->intercept;
+}
+
+void InputDispatcher::recordHookLatency(Clock::time_point entered) {
+    long long ns = (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - entered).count();
+    hookTotalNs.fetch_add(ns, std::memory_order_relaxed);
+    long long previous = hookMaxNs.load(std::memory_order_relaxed);
+    while (ns > previous && !hookMaxNs.compare_exchange_weak(previous, ns, std::memory_order_relaxed)) {
+    }
+    int bucket = 0;
+    while (bucket < LATENCY_BUCKETS - 1 && (ns >> (bucket + 1)) > 0) bucket++;
+    hookBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+bool InputDispatcher::changeMode(InputMode from, InputMode to) {
+    int expected = from;
+    return currentMode.compare_exchange_strong(expected, to);
+}
+
+void InputDispatcher::setRecognizing(bool value) {
+    recognizing = value;
+}
+
+void InputDispatcher::run() {
+    for (;;) {
+        InputEvent event;
+        if (queue.pop(event)) {
+            double waited = msBetween(event.posted, Clock::now());
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                dispatched++;
+                dispatchTotalMs += waited;
+                dispatchMaxMs = (std::max)(dispatchMaxMs, waited);
+            }
+            handler(event);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        if (stopping) break;
+        sleeping = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // 超时只是保险，正常情况下由钩子唤醒
+        if (queue.empty()) wake.wait_for(lock, std::chrono::milliseconds(100));
+        sleeping = false;
+    }
+    // 停止前执行完已入队的动作
+    InputEvent event;
+    while (queue.pop(event)) handler(event);
+}
+
+InputStats InputDispatcher::stats() const {
+    InputStats stats;
+    stats.hookCalls = hookCalls.load();
+    stats.intercepted = intercepted.load();
+    stats.queued = queued.load();
+    stats.dropped = dropped.load();
+    long measured = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; ++i) measured += hookBuckets[i].load();
+    if (measured > 0) {
+        stats.hookMeanUs = hookTotalNs.load() / 1000.0 / measured;
+        stats.hookMaxUs = hookMaxNs.load() / 1000.0;
+        long rank = measured - measured / 100;
+        long seen = 0;
+        for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+            seen += hookBuckets[i].load();
+            if (seen >= rank) {
+                stats.hookP99Us = (double)(1LL << (i + 1)) / 1000.0;
+                break;
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.dispatched = dispatched;
+    if (dispatched > 0) stats.dispatchMeanMs = dispatchTotalMs / dispatched;
+    stats.dispatchMaxMs = dispatchMaxMs;
+    return stats;
+}
+
+std::string DescribeInputStats(const InputStats& stats) {
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "[input] hook calls=%ld intercepted=%ld queued=%ld dropped=%ld dispatched=%ld "
+                  "hook mean/p99/max=%.1f/%.1f/%.1f us dispatch mean/max=%.3f/%.3f ms",
+                  stats.hookCalls, stats.intercepted, stats.queued, stats.dropped, stats.dispatched,
+                  stats.hookMeanUs, stats.hookP99Us, stats.hookMaxUs, stats.dispatchMeanMs, stats.dispatchMaxMs);
+    return line;
+}
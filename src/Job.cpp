@@ -0,0 +1,193 @@
+#include "../include/Job.h"
+#include "../include/Executor.h"
+#include <algorithm>
+#include <cstdio>
+
+typedef std::chrono::steady_clock Clock;
+
+// 运行器与其任务共享的状态：任务线程与看门狗都持有它，运行器析构时仍未退出的任务也能安全收尾
+struct JobRunnerShared {
+    std::mutex mutex;
+    std::condition_variable changed;        // 时限变化、任务结束、停止
+    std::vector<std::shared_ptr<Job> > active;
+    bool stopping;
+    JobStats counters;
+    double cancelLatencyTotalMs;
+
+    JobRunnerShared() : stopping(false), cancelLatencyTotalMs(0) {}
+
+    // 调用方持有 mutex；把运行中的任务标为 state 并返回 true，之后应在锁外触发令牌
+    static bool markStopped(Job& job, JobState state) {
+        if (job.jobState != JOB_RUNNING) return false;
+        job.jobState = state;
+        job.cancelRequested = Clock::now();
+        return true;
+    }
+
+    // 看门狗：等到最早的阶段时限，把超时的任务标为超时并触发其令牌
+    void watch() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            Clock::time_point now = Clock::now();
+            Clock::time_point next = Clock::time_point::max();
+            std::vector<std::shared_ptr<Job> > expired;
+            for (size_t i = 0; i < active.size(); ++i) {
+                Job& job = *active[i];
+                if (!job.hasDeadline || job.jobState != JOB_RUNNING) continue;
+                if (job.deadline <= now) {
+                    if (JobRunnerShared::markStopped(job, JOB_TIMED_OUT)) expired.push_back(active[i]);
+                } else {
+                    next = (std::min)(next, job.deadline);
+                }
+            }
+            if (!expired.empty()) {
+                // 取消动作可能阻塞（关闭 WinINet 句柄），不在锁内执行
+                lock.unlock();
+                for (size_t i = 0; i < expired.size(); ++i) expired[i]->token().cancel();
+                lock.lock();
+                continue;
+            }
+            if (next == Clock::time_point::max()) changed.wait(lock);
+            else changed.wait_until(lock, next);
+        }
+    }
+};
+
+namespace {
+
+double msBetween(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+} // namespace
+
+Job::Job(const std::string& name, const std::shared_ptr<JobRunnerShared>& shared)
+    : jobName(name), shared(shared), jobState(JOB_RUNNING), stageName("start"), started(Clock::now()),
+      hasDeadline(false), done(false) {
+}
+
+bool Job::enterStage(const char* stage, int deadlineMs) {
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        if (jobState != JOB_RUNNING) return false;
+        stageName = stage;
+        hasDeadline = deadlineMs > 0;
+        if (hasDeadline) deadline = Clock::now() + std::chrono::milliseconds(deadlineMs);
+    }
+    shared->changed.notify_all();
+    return !cancelToken.cancelled();
+}
+
+void Job::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        if (!JobRunnerShared::markStopped(*this, JOB_CANCELLED)) return;
+    }
+    cancelToken.cancel();
+}
+
+JobState Job::state() const {
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    return jobState;
+}
+
+const char* Job::stage() const {
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    return stageName;
+}
+
+double Job::elapsedMs() const {
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    return msBetween(started, done ? ended : Clock::now());
+}
+
+JobRunner::JobRunner(ThreadPool* pool) : shared(std::make_shared<JobRunnerShared>()), pool(pool) {
+    watchdog = std::thread(&JobRunnerShared::watch, shared);
+}
+
+JobRunner::~JobRunner() {
+    cancelAll();
+    // 取消后网络请求立即返回；截图、编码等阶段只在边界检查取消，给它们留出收尾时间
+    waitAll(5000);
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->stopping = true;
+    }
+    shared->changed.notify_all();
+    watchdog.join();
+}
+
+std::shared_ptr<Job> JobRunner::start(const std::string& name, const std::function<void(Job& job)>& body) {
+    std::shared_ptr<Job> job(new Job(name, shared));
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->active.push_back(job);
+        shared->counters.started++;
+    }
+    std::shared_ptr<JobRunnerShared> state = shared;
+    Task run = [state, job, body]() {
+        body(*job);
+
+        std::lock_guard<std::mutex> lock(state->mutex);
+        job->done = true;
+        job->ended = Clock::now();
+        job->hasDeadline = false;
+        state->active.erase(std::remove(state->active.begin(), state->active.end(), job), state->active.end());
+        JobStats& counters = state->counters;
+        if (job->jobState == JOB_RUNNING) {
+            job->jobState = JOB_FINISHED;
+            counters.finished++;
+        } else {
+            if (job->jobState == JOB_CANCELLED) counters.cancelled++;
+            else counters.timedOut++;
+            double latency = msBetween(job->cancelRequested, job->ended);
+            state->cancelLatencyTotalMs += latency;
+            counters.cancelLatencyMaxMs = (std::max)(counters.cancelLatencyMaxMs, latency);
+            counters.cancelLatencyMeanMs = state->cancelLatencyTotalMs / (counters.cancelled + counters.timedOut);
+        }
+        state->changed.notify_all();
+    };
+    // 池已停止（进程退出中）时退回独立线程
+    if (!pool || !pool->submit(run)) std::thread(run).detach();
+    return job;
+}
+
+void JobRunner::cancelAll() {
+    std::vector<std::shared_ptr<Job> > jobs;
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        jobs = shared->active;
+    }
+    for (size_t i = 0; i < jobs.size(); ++i) jobs[i]->cancel();
+}
+
+bool JobRunner::waitAll(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    return shared->changed.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                    [this]() { return shared->active.empty(); });
+}
+
+JobStats JobRunner::stats() const {
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    JobStats stats = shared->counters;
+    stats.active = (long)shared->active.size();
+    return stats;
+}
+
+std::string DescribeJob(const Job& job) {
+    static const char* const STATES[] = {"running", "finished", "cancelled", "timed out"};
+    char line[160];
+    std::snprintf(line, sizeof(line), "[job] %s %s in stage %s after %.0f ms", job.name().c_str(),
+                  STATES[job.state()], job.stage(), job.elapsedMs());
+    return line;
+}
+
+std::string DescribeJobStats(const JobStats& stats) {
+    char line[200];
+    std::snprintf(line, sizeof(line),
+                  "[jobs] started=%ld finished=%ld cancelled=%ld timed_out=%ld active=%ld "
+                  "cancel latency mean/max=%.1f/%.1f ms",
+                  stats.started, stats.finished, stats.cancelled, stats.timedOut, stats.active,
+                  stats.cancelLatencyMeanMs, stats.cancelLatencyMaxMs);
+    return line;
+}
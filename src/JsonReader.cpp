@@ -0,0 +1,493 @@
+#include "../include/JsonReader.h"
+#include "../include/CpuFeatures.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(SHOTOCR_ARCH_X86)
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(SHOTOCR_ARCH_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// 超过该嵌套层数按格式错误处理，防止恶意响应耗尽内存
+const size_t MAX_DEPTH = 256;
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// 字符串内需要停下来处理的字符：结束引号与转义
+size_t findSpecialScalar(const char* p, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (p[i] == '"' || p[i] == '\\') return i;
+    }
+    return n;
+}
+
+#if defined(SHOTOCR_ARCH_X86) || defined(SHOTOCR_ARCH_ARM64)
+
+inline int countTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (int)index;
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+#endif
+
+#if defined(SHOTOCR_ARCH_X86)
+
+// SSE2：每次比较 16 字节，掩码的最低位即第一个命中
+SHOTOCR_TARGET("sse2")
+size_t findSpecialSse2(const char* p, size_t n) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)));
+        if (mask) return i + countTrailingZeros((uint64_t)mask);
+    }
+    return i + findSpecialScalar(p + i, n - i);
+}
+
+#endif // SHOTOCR_ARCH_X86
+
+#if defined(SHOTOCR_ARCH_ARM64)
+
+// NEON 没有 movemask：比较结果右移窄化为每字节 4 位的 64 位掩码
+size_t findSpecialNeon(const char* p, size_t n) {
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p + i));
+        uint8x16_t hit = vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash));
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+        if (mask) return i + (countTrailingZeros(mask) >> 2);
+    }
+    return i + findSpecialScalar(p + i, n - i);
+}
+
+#endif // SHOTOCR_ARCH_ARM64
+
+// 跳过容器时关心的字符：引号与四种括号。'{' '[' 与 '}' ']' 分别只差 0x20 位
+inline bool isStructural(char c) {
+    char folded = (char)(c | 0x20);
+    return c == '"' || folded == '{' || folded == '}';
+}
+
+size_t findStructuralScalar(const char* p, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (isStructural(p[i])) return i;
+    }
+    return n;
+}
+
+#if defined(SHOTOCR_ARCH_X86)
+
+SHOTOCR_TARGET("sse2")
+size_t findStructuralSse2(const char* p, size_t n) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i folded = _mm_or_si128(v, caseBit);
+        __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                   _mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)));
+        int mask = _mm_movemask_epi8(hit);
+        if (mask) return i + countTrailingZeros((uint64_t)mask);
+    }
+    return i + findStructuralScalar(p + i, n - i);
+}
+
+#endif // SHOTOCR_ARCH_X86
+
+#if defined(SHOTOCR_ARCH_ARM64)
+
+size_t findStructuralNeon(const char* p, size_t n) {
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t caseBit = vdupq_n_u8(0x20);
+    const uint8x16_t open = vdupq_n_u8('{');
+    const uint8x16_t close = vdupq_n_u8('}');
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p + i));
+        uint8x16_t folded = vorrq_u8(v, caseBit);
+        uint8x16_t hit = vorrq_u8(vceqq_u8(v, quote), vorrq_u8(vceqq_u8(folded, open), vceqq_u8(folded, close)));
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+        if (mask) return i + (countTrailingZeros(mask) >> 2);
+    }
+    return i + findStructuralScalar(p + i, n - i);
+}
+
+#endif // SHOTOCR_ARCH_ARM64
+
+typedef size_t (*FindFunc)(const char*, size_t);
+
+struct ScanKernels {
+    FindFunc findSpecial;
+    FindFunc findStructural;
+};
+
+ScanKernels selectKernels() {
+    const CpuFeatures& cpu = GetCpuFeatures();
+    ScanKernels kernels = {findSpecialScalar, findStructuralScalar};
+#if defined(SHOTOCR_ARCH_X86)
+    if (cpu.sse2) {
+        kernels.findSpecial = findSpecialSse2;
+        kernels.findStructural = findStructuralSse2;
+    }
+#endif
+#if defined(SHOTOCR_ARCH_ARM64)
+    if (cpu.neon) {
+        kernels.findSpecial = findSpecialNeon;
+        kernels.findStructural = findStructuralNeon;
+    }
+#endif
+    (void)cpu;
+    return kernels;
+}
+
+const ScanKernels& scanKernels() {
+    static const ScanKernels kernels = selectKernels();
+    return kernels;
+}
+
+// 十六进制数字的值，其他字符为 -1
+struct HexTable {
+    signed char value[256];
+
+    HexTable() {
+        std::memset(value, -1, sizeof(value));
+        for (int i = 0; i < 10; ++i) value['0' + i] = (signed char)i;
+        for (int i = 0; i < 6; ++i) {
+            value['a' + i] = (signed char)(10 + i);
+            value['A' + i] = (signed char)(10 + i);
+        }
+    }
+};
+
+const HexTable HEX_TABLE;
+
+inline bool readHex4(const char* p, size_t available, unsigned int& code) {
+    if (available < 4) return false;
+    int d0 = HEX_TABLE.value[(unsigned char)p[0]];
+    int d1 = HEX_TABLE.value[(unsigned char)p[1]];
+    int d2 = HEX_TABLE.value[(unsigned char)p[2]];
+    int d3 = HEX_TABLE.value[(unsigned char)p[3]];
+    // 任一位不是十六进制数字时按位或的结果为负
+    if ((d0 | d1 | d2 | d3) < 0) return false;
+    code = (unsigned int)((d0 << 12) | (d1 << 8) | (d2 << 4) | d3);
+    return true;
+}
+
+// 写出一个码点的 UTF-8 编码，返回字节数
+size_t encodeUtf8(char* dst, unsigned int code) {
+    if (code < 0x80) {
+        dst[0] = (char)code;
+        return 1;
+    }
+    if (code < 0x800) {
+        dst[0] = (char)(0xC0 | (code >> 6));
+        dst[1] = (char)(0x80 | (code & 0x3F));
+        return 2;
+    }
+    if (code < 0x10000) {
+        dst[0] = (char)(0xE0 | (code >> 12));
+        dst[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+        dst[2] = (char)(0x80 | (code & 0x3F));
+        return 3;
+    }
+    dst[0] = (char)(0xF0 | (code >> 18));
+    dst[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+    dst[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+    dst[3] = (char)(0x80 | (code & 0x3F));
+    return 4;
+}
+
+} // namespace
+
+bool AppendJsonUnescaped(std::string& out, const char* data, size_t size) {
+    // 解码结果不会比原文长：先按原文长度扩展，直接写入后再截到实际长度
+    size_t base = out.size();
+    out.resize(base + size);
+    char* begin = &out[0] + base;
+    char* dst = begin;
+    bool ok = true;
+    size_t i = 0;
+    while (i < size) {
+        if (data[i] != '\\') {
+            // 两个转义之间的原文整段复制
+            const void* found = std::memchr(data + i, '\\', size - i);
+            size_t run = found ? (size_t)((const char*)found - (data + i)) : size - i;
+            std::memcpy(dst, data + i, run);
+            dst += run;
+            i += run;
+            if (i >= size) break;
+        }
+        if (i + 1 >= size) {
+            ok = false;
+            break;
+        }
+
+        char c = data[i + 1];
+        i += 2;
+        switch (c) {
+            case '"': case '\\': case '/': *dst++ = c; continue;
+            case 'b': *dst++ = '\b'; continue;
+            case 'f': *dst++ = '\f'; continue;
+            case 'n': *dst++ = '\n'; continue;
+            case 'r': *dst++ = '\r'; continue;
+            case 't': *dst++ = '\t'; continue;
+            case 'u': break;
+            default: ok = false; break;
+        }
+        unsigned int code;
+        if (!ok || !readHex4(data + i, size - i, code)) {
+            ok = false;
+            break;
+        }
+        i += 4;
+        if (code >= 0xD800 && code <= 0xDBFF) {
+            // 高代理项后面紧跟低代理项时合成一个码点
+            unsigned int low;
+            if (i + 1 < size && data[i] == '\\' && data[i + 1] == 'u' && readHex4(data + i + 2, size - i - 2, low) &&
+                low >= 0xDC00 && low <= 0xDFFF) {
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                i += 6;
+            } else {
+                code = 0xFFFD;
+            }
+        } else if (code >= 0xDC00 && code <= 0xDFFF) {
+            code = 0xFFFD;
+        }
+        dst += encodeUtf8(dst, code);
+    }
+    out.resize(base + (dst - begin));
+    return ok;
+}
+
+JsonReader::JsonReader()
+    : data(nullptr), size(0), pos(0), scanPos(0), skipLevel(0), escaped(false), finished(false), state(STATE_VALUE) {
+    stack.reserve(16);
+}
+
+JsonReader::JsonReader(const char* data, size_t size)
+    : data(data), size(size), pos(0), scanPos(0), skipLevel(0), escaped(false), finished(true), state(STATE_VALUE) {
+    stack.reserve(16);
+}
+
+void JsonReader::feed(const char* bytes, size_t length) {
+    if (data != buffer.data()) {
+        // 由完整文档构造或尚未送入过数据：剩余部分转入自己的缓冲区
+        buffer.assign(data ? data : "", size);
+        finished = false;
+    } else if (pos > 0 && pos >= buffer.size() / 2) {
+        // 已读过的部分超过一半时丢弃，缓冲区只保留未读完的记号与之后的数据
+        buffer.erase(0, pos);
+        if (scanPos > 0) scanPos -= pos;
+        pos = 0;
+    }
+    buffer.append(bytes, length);
+    data = buffer.data();
+    size = buffer.size();
+}
+
+void JsonReader::finish() {
+    finished = true;
+}
+
+JsonToken JsonReader::fail() {
+    state = STATE_ERROR;
+    return JSON_ERROR;
+}
+
+JsonToken JsonReader::afterValue(JsonToken token) {
+    state = stack.empty() ? STATE_DONE : STATE_COMMA_OR_END;
+    return token;
+}
+
+void JsonReader::skipContainer() {
+    if (state == STATE_KEY_OR_END || state == STATE_VALUE_OR_END) skipLevel = 1;
+}
+
+JsonToken JsonReader::continueSkip() {
+    const ScanKernels& kernels = scanKernels();
+    size_t i = pos;
+    for (;;) {
+        i += kernels.findStructural(data + i, size - i);
+        if (i >= size) break;
+        char c = data[i];
+        if (c == '"') {
+            // 跳过字符串，其中的括号不计
+            size_t end = i + 1;
+            for (;;) {
+                end += kernels.findSpecial(data + end, size - end);
+                if (end >= size || data[end] == '"') break;
+                if (end + 1 >= size) {
+                    end = size;
+                    break;
+                }
+                end += 2;
+            }
+            if (end >= size) break;
+            i = end + 1;
+        } else if (c == '{' || c == '[') {
+            if (stack.size() + skipLevel >= MAX_DEPTH) return fail();
+            skipLevel++;
+            i++;
+        } else if (--skipLevel > 0) {
+            i++;
+        } else {
+            // 回到被跳过的容器本身的结束括号
+            pos = i;
+            state = STATE_COMMA_OR_END;
+            return next();
+        }
+        // 已完整跳过的部分不再重新扫描
+        pos = i;
+    }
+    return finished ? fail() : JSON_NEED_MORE;
+}
+
+JsonToken JsonReader::next() {
+    for (;;) {
+        if (state == STATE_ERROR) return JSON_ERROR;
+        if (state == STATE_DONE) return JSON_END;
+        if (skipLevel > 0) return continueSkip();
+        while (pos < size && isSpace(data[pos])) pos++;
+        if (pos >= size) return finished ? fail() : JSON_NEED_MORE;
+
+        char c = data[pos];
+        switch (state) {
+            case STATE_COLON:
+                if (c != ':') return fail();
+                pos++;
+                state = STATE_VALUE;
+                continue;
+            case STATE_COMMA_OR_END:
+                if (c == ',') {
+                    pos++;
+                    state = stack.back() == '{' ? STATE_KEY : STATE_VALUE;
+                    continue;
+                }
+                break;
+            case STATE_KEY_OR_END:
+                if (c == '}') break;
+                if (c != '"') return fail();
+                return readString(true);
+            case STATE_KEY:
+                if (c != '"') return fail();
+                return readString(true);
+            case STATE_VALUE_OR_END:
+                if (c == ']') break;
+                return readValue(c);
+            case STATE_VALUE:
+                return readValue(c);
+            default:
+                return fail();
+        }
+
+        // 对象或数组结束
+        if (stack.empty() || c != (stack.back() == '{' ? '}' : ']')) return fail();
+        stack.pop_back();
+        pos++;
+        return afterValue(c == '}' ? JSON_END_OBJECT : JSON_END_ARRAY);
+    }
+}
+
+JsonToken JsonReader::readValue(char c) {
+    switch (c) {
+        case '{':
+        case '[':
+            if (stack.size() >= MAX_DEPTH) return fail();
+            stack.push_back(c);
+            pos++;
+            state = c == '{' ? STATE_KEY_OR_END : STATE_VALUE_OR_END;
+            return c == '{' ? JSON_BEGIN_OBJECT : JSON_BEGIN_ARRAY;
+        case '"': return readString(false);
+        case 't': return readLiteral("true", 4, JSON_TRUE);
+        case 'f': return readLiteral("false", 5, JSON_FALSE);
+        case 'n': return readLiteral("null", 4, JSON_NULL);
+        default:
+            if (c == '-' || (c >= '0' && c <= '9')) return readNumber();
+            return fail();
+    }
+}
+
+JsonToken JsonReader::readString(bool key) {
+    size_t start = pos + 1;
+    size_t i = (std::max)(scanPos, start);
+    const ScanKernels& kernels = scanKernels();
+    for (;;) {
+        i += kernels.findSpecial(data + i, size - i);
+        if (i < size && data[i] == '"') break;
+        // 连续的转义（如整段 \uXXXX 编码的汉字）在这里逐个跳过，不必每次重新扫描；
+        // 转义不完整时等下一段数据，从该转义重新开始
+        while (i < size && data[i] == '\\') {
+            size_t length = i + 1 < size && data[i + 1] == 'u' ? 6 : 2;
+            if (i + length > size) break;
+            unsigned int code;
+            if (length == 6 && !readHex4(data + i + 2, 4, code)) return fail();
+            escaped = true;
+            i += length;
+        }
+        if (i >= size || data[i] == '\\') {
+            scanPos = i;
+            return finished ? fail() : JSON_NEED_MORE;
+        }
+    }
+
+    if (escaped) {
+        scratch.clear();
+        if (!AppendJsonUnescaped(scratch, data + start, i - start)) return fail();
+        value = JsonText(scratch.data(), scratch.size());
+    } else {
+        value = JsonText(data + start, i - start);
+    }
+    pos = i + 1;
+    scanPos = 0;
+    escaped = false;
+    if (key) {
+        state = STATE_COLON;
+        return JSON_KEY;
+    }
+    return afterValue(JSON_STRING);
+}
+
+JsonToken JsonReader::readNumber() {
+    size_t end = pos;
+    while (end < size) {
+        char c = data[end];
+        if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) break;
+        end++;
+    }
+    // 数字在数据末尾时可能还没完
+    if (end >= size && !finished) return JSON_NEED_MORE;
+    value = JsonText(data + pos, end - pos);
+    pos = end;
+    return afterValue(JSON_NUMBER);
+}
+
+JsonToken JsonReader::readLiteral(const char* literal, size_t length, JsonToken token) {
+    size_t available = (std::min)(length, size - pos);
+    if (std::memcmp(data + pos, literal, available) != 0) return fail();
+    if (available < length) return finished ? fail() : JSON_NEED_MORE;
+    pos += length;
+    return afterValue(token);
+}
@@ -0,0 +1,37 @@
+#include "../include/JsonUtil.h"
+#include "../include/JsonReader.h"
+
+std::string UnescapeJsonString(const std::string& escapedStr) {
+    std::string result;
+    result.reserve(escapedStr.length());
+    // 转义不完整（被截断的响应）时保留已解码的部分
+    AppendJsonUnescaped(result, escapedStr.data(), escapedStr.size());
+    return result;
+}
+
+void AppendJsonString(std::string& out, const std::string& value) {
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    for (size_t i = 0; i < value.size(); ++i) {
+        unsigned char c = (unsigned char)value[i];
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 15];
+                } else {
+                    out += (char)c;
+                }
+                break;
+        }
+    }
+    out += '"';
+}
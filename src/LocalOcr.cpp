@@ -0,0 +1,735 @@
+#include "../include/LocalOcr.h"
+#include "../include/CpuFeatures.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(SHOTOCR_ARCH_X86)
+#include <emmintrin.h>
+#endif
+
+#if defined(SHOTOCR_ARCH_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// 形状特征：外接正方形（保持宽高比、居中）缩放到 GRID x GRID，减去均值后归一化为定点数，
+// 两个特征的点积 / FEATURE_SCALE^2 即归一化相关系数
+const int GRID = 16;
+const int FEATURE_SIZE = GRID * GRID;
+const int SUBSAMPLES = 4;               // 每个网格单元每个方向的采样点数
+const double FEATURE_SCALE = 1024.0;
+
+const int INK_THRESHOLD = 128;          // 覆盖率达到该值的像素参与连通域
+const double GEOMETRY_WEIGHT = 0.6;     // 宽、高、相对基线位置之差（大写字母高度为单位）的权重
+const double AMBIGUITY_MARGIN = 0.12;   // 与另一个字符的最好得分相差不到该值时，
+const double AMBIGUITY_WEIGHT = 2.0;    // 按不足部分的这个倍数降低置信度
+const double MERGE_GAP = 0.25;          // 间距不超过该值的相邻连通域可以合成一个字形（如 '"'）
+const double MAX_GLYPH_WIDTH = 1.4;
+const int MAX_MERGE = 3;
+const double SPLIT_WIDTH = 0.75;        // 宽于该值且整体匹配不好的连通域尝试切成两个字形（粘连）
+const double SPLIT_BELOW = 0.75;
+
+int dotScalar(const int16_t* a, const int16_t* b) {
+    int sum = 0;
+    for (int i = 0; i < FEATURE_SIZE; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+#if defined(SHOTOCR_ARCH_X86)
+
+// SSE2：madd 每次完成 8 个 16 位乘法并两两相加
+SHOTOCR_TARGET("sse2")
+int dotSse2(const int16_t* a, const int16_t* b) {
+    __m128i acc = _mm_setzero_si128();
+    for (int i = 0; i < FEATURE_SIZE; i += 8) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(va, vb));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(acc);
+}
+
+#endif // SHOTOCR_ARCH_X86
+
+#if defined(SHOTOCR_ARCH_ARM64)
+
+int dotNeon(const int16_t* a, const int16_t* b) {
+    int32x4_t acc = vdupq_n_s32(0);
+    for (int i = 0; i < FEATURE_SIZE; i += 8) {
+        int16x8_t va = vld1q_s16(a + i);
+        int16x8_t vb = vld1q_s16(b + i);
+        acc = vmlal_s16(acc, vget_low_s16(va), vget_low_s16(vb));
+        acc = vmlal_s16(acc, vget_high_s16(va), vget_high_s16(vb));
+    }
+    return vaddvq_s32(acc);
+}
+
+#endif // SHOTOCR_ARCH_ARM64
+
+typedef int (*DotFunc)(const int16_t*, const int16_t*);
+
+DotFunc selectDot() {
+    const CpuFeatures& cpu = GetCpuFeatures();
+#if defined(SHOTOCR_ARCH_X86)
+    if (cpu.sse2) return dotSse2;
+#endif
+#if defined(SHOTOCR_ARCH_ARM64)
+    if (cpu.neon) return dotNeon;
+#endif
+    (void)cpu;
+    return dotScalar;
+}
+
+DotFunc dotProduct() {
+    static const DotFunc func = selectDot();
+    return func;
+}
+
+// 覆盖率位图，外部为 0
+struct Bitmap {
+    const unsigned char* data;
+    int width;
+    int height;
+    int stride;
+
+    int at(int x, int y) const {
+        if (x < 0 || y < 0 || x >= width || y >= height) return 0;
+        return data[(size_t)y * stride + x];
+    }
+
+    double bilinear(double x, double y) const {
+        int x0 = (int)std::floor(x);
+        int y0 = (int)std::floor(y);
+        double fx = x - x0;
+        double fy = y - y0;
+        double top = at(x0, y0) * (1 - fx) + at(x0 + 1, y0) * fx;
+        double bottom = at(x0, y0 + 1) * (1 - fx) + at(x0 + 1, y0 + 1) * fx;
+        return top * (1 - fy) + bottom * fy;
+    }
+};
+
+// 计算形状特征，返回 false 表示外接正方形内几乎是实心的（没有形状可比）
+bool makeFeature(const Bitmap& bitmap, int16_t* out) {
+    int side = (std::max)(bitmap.width, bitmap.height);
+    double offsetX = (side - bitmap.width) / 2.0;
+    double offsetY = (side - bitmap.height) / 2.0;
+    double cell = (double)side / GRID;
+    double step = cell / SUBSAMPLES;
+
+    double values[FEATURE_SIZE];
+    double sum = 0;
+    for (int gy = 0; gy < GRID; ++gy) {
+        for (int gx = 0; gx < GRID; ++gx) {
+            double acc = 0;
+            for (int sy = 0; sy < SUBSAMPLES; ++sy) {
+                double y = gy * cell + (sy + 0.5) * step - offsetY - 0.5;
+                for (int sx = 0; sx < SUBSAMPLES; ++sx) {
+                    double x = gx * cell + (sx + 0.5) * step - offsetX - 0.5;
+                    acc += bitmap.bilinear(x, y);
+                }
+            }
+            values[gy * GRID + gx] = acc / (SUBSAMPLES * SUBSAMPLES);
+            sum += values[gy * GRID + gx];
+        }
+    }
+
+    double mean = sum / FEATURE_SIZE;
+    double variance = 0;
+    for (int i = 0; i < FEATURE_SIZE; ++i) variance += (values[i] - mean) * (values[i] - mean);
+    if (variance < FEATURE_SIZE * 16.0 * 16.0) {
+        std::fill(out, out + FEATURE_SIZE, (int16_t)0);
+        return false;
+    }
+    double scale = FEATURE_SCALE / std::sqrt(variance);
+    for (int i = 0; i < FEATURE_SIZE; ++i) out[i] = (int16_t)std::floor((values[i] - mean) * scale + 0.5);
+    return true;
+}
+
+// 覆盖率达到 INK_THRESHOLD 的像素的外接矩形；没有时取所有非零像素
+bool inkBounds(const Bitmap& bitmap, int& x0, int& y0, int& x1, int& y1) {
+    for (int pass = 0; pass < 2; ++pass) {
+        int threshold = pass == 0 ? INK_THRESHOLD : 1;
+        x0 = bitmap.width;
+        y0 = bitmap.height;
+        x1 = y1 = 0;
+        for (int y = 0; y < bitmap.height; ++y) {
+            for (int x = 0; x < bitmap.width; ++x) {
+                if (bitmap.at(x, y) < threshold) continue;
+                x0 = (std::min)(x0, x);
+                y0 = (std::min)(y0, y);
+                x1 = (std::max)(x1, x + 1);
+                y1 = (std::max)(y1, y + 1);
+            }
+        }
+        if (x1 > x0) return true;
+    }
+    return false;
+}
+
+// 选区中的一个候选字形：特征与几何量（几何量以大写字母高度为单位），及其覆盖的列范围
+struct Candidate {
+    int16_t feature[FEATURE_SIZE];
+    bool shaped;
+    float width;
+    float height;
+    float top;
+    int x0;
+    int x1;
+};
+
+struct Component {
+    int x0, y0, x1, y1;
+    int pixels;
+};
+
+// 水平方向重叠的连通域（'i' 的点与竖、':'、'%' 等）合成一列
+struct Column {
+    int x0, y0, x1, y1;
+    std::vector<int> components;
+};
+
+// 候选字形在某种字体下最好的模板
+struct Match {
+    char ch;
+    double confidence;
+    float leftBearing;
+    float rightBearing;
+    double score;       // 最好的模板得分
+    double second;      // 本字体中另一个字符的最好得分
+};
+
+int find(std::vector<int>& parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// 8 邻域连通域标记，labels 中 0 为非墨迹，其余为 components 下标 + 1
+void labelComponents(const std::vector<unsigned char>& coverage, int width, int height, std::vector<int>& labels,
+                     std::vector<Component>& components) {
+    labels.assign((size_t)width * height, 0);
+    std::vector<int> parent(1, 0);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            size_t i = (size_t)y * width + x;
+            if (coverage[i] < INK_THRESHOLD) continue;
+            int neighbors[4] = {0, 0, 0, 0};
+            if (x > 0) neighbors[0] = labels[i - 1];
+            if (y > 0) {
+                neighbors[1] = labels[i - width];
+                if (x > 0) neighbors[2] = labels[i - width - 1];
+                if (x + 1 < width) neighbors[3] = labels[i - width + 1];
+            }
+            int label = 0;
+            for (int k = 0; k < 4; ++k) {
+                if (!neighbors[k]) continue;
+                int root = find(parent, neighbors[k]);
+                if (!label) {
+                    label = root;
+                } else if (root != label) {
+                    parent[(std::max)(root, label)] = (std::min)(root, label);
+                    label = (std::min)(root, label);
+                }
+            }
+            if (!label) {
+                label = (int)parent.size();
+                parent.push_back(label);
+            }
+            labels[i] = label;
+        }
+    }
+
+    // 第二遍：合并等价标记并统计外接矩形
+    std::vector<int> index(parent.size(), -1);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            size_t i = (size_t)y * width + x;
+            if (!labels[i]) continue;
+            int root = find(parent, labels[i]);
+            if (index[root] < 0) {
+                index[root] = (int)components.size();
+                Component c = {x, y, x + 1, y + 1, 0};
+                components.push_back(c);
+            }
+            Component& c = components[index[root]];
+            c.x0 = (std::min)(c.x0, x);
+            c.y0 = (std::min)(c.y0, y);
+            c.x1 = (std::max)(c.x1, x + 1);
+            c.y1 = (std::max)(c.y1, y + 1);
+            c.pixels++;
+            labels[i] = index[root] + 1;
+        }
+    }
+}
+
+} // namespace
+
+LocalOcr::LocalOcr(const LocalOcrOptions& options) : options(options) {}
+
+void LocalOcr::addFont(const GlyphFont& font) {
+    // 大写字母高度以 'H' 的墨迹高度为准，与选区中的估计方式一致
+    double capHeight = font.capHeight;
+    for (size_t i = 0; i < font.glyphs.size(); ++i) {
+        const GlyphBitmap& glyph = font.glyphs[i];
+        if (glyph.ch != 'H') continue;
+        Bitmap bitmap = {glyph.coverage.data(), glyph.width, glyph.height, glyph.width};
+        int x0, y0, x1, y1;
+        if (inkBounds(bitmap, x0, y0, x1, y1)) capHeight = y1 - y0;
+    }
+    if (capHeight <= 0) return;
+
+    FontTemplates* templates = nullptr;
+    for (size_t i = 0; i < fonts.size(); ++i) {
+        if (fonts[i].name == font.name) templates = &fonts[i];
+    }
+    if (!templates) {
+        fonts.push_back(FontTemplates());
+        templates = &fonts.back();
+        templates->name = font.name;
+        templates->space = (float)(font.space / capHeight);
+    }
+
+    for (size_t i = 0; i < font.glyphs.size(); ++i) {
+        const GlyphBitmap& glyph = font.glyphs[i];
+        Bitmap bitmap = {glyph.coverage.data(), glyph.width, glyph.height, glyph.width};
+        int x0, y0, x1, y1;
+        if (glyph.width <= 0 || glyph.height <= 0 || !inkBounds(bitmap, x0, y0, x1, y1)) continue;
+
+        Template t;
+        t.ch = glyph.ch;
+        t.feature.resize(FEATURE_SIZE);
+        Bitmap ink = {glyph.coverage.data() + (size_t)y0 * glyph.width + x0, x1 - x0, y1 - y0, glyph.width};
+        t.solid = !makeFeature(ink, t.feature.data());
+        t.width = (float)((x1 - x0) / capHeight);
+        t.height = (float)((y1 - y0) / capHeight);
+        t.top = (float)((glyph.top - y0) / capHeight);
+        t.capPixels = (int)capHeight;
+        t.leftBearing = (float)((glyph.left + x0) / capHeight);
+        t.rightBearing = (float)((glyph.advance - glyph.left - x1) / capHeight);
+        templates->glyphs.push_back(t);
+    }
+}
+
+bool LocalOcr::recognize(const PixelBufferView& view, LocalOcrResult& result) const {
+    result = LocalOcrResult();
+    int width = view.width;
+    int height = view.height;
+    int dpi = view.dpi > 0 ? view.dpi : 96;
+    if (fonts.empty()) {
+        result.reason = "no templates";
+        return false;
+    }
+    if (height * 96 > options.maxHeight * dpi || width > options.maxWidth || width < 4 || height < 4) {
+        result.reason = "not a single short line";
+        return false;
+    }
+
+    // 亮度
+    std::vector<unsigned char> luma((size_t)width * height);
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* row = view.pixels + (size_t)y * view.stride;
+        for (int x = 0; x < width; ++x) {
+            const unsigned char* px = row + (size_t)x * 4;
+            luma[(size_t)y * width + x] = (unsigned char)((px[2] * 77 + px[1] * 150 + px[0] * 29) >> 8);
+        }
+    }
+
+    // 背景取边框像素亮度的众数，边框须大部分是背景（纯色控件、编辑框等）
+    int borderHistogram[256] = {0};
+    int borderCount = 0;
+    for (int x = 0; x < width; ++x) {
+        borderHistogram[luma[x]]++;
+        borderHistogram[luma[(size_t)(height - 1) * width + x]]++;
+        borderCount += 2;
+    }
+    for (int y = 1; y + 1 < height; ++y) {
+        borderHistogram[luma[(size_t)y * width]]++;
+        borderHistogram[luma[(size_t)y * width + width - 1]]++;
+        borderCount += 2;
+    }
+    int background = (int)(std::max_element(borderHistogram, borderHistogram + 256) - borderHistogram);
+    int nearBackground = 0;
+    for (int l = (std::max)(0, background - 12); l <= (std::min)(255, background + 12); ++l) nearBackground += borderHistogram[l];
+    if (nearBackground * 10 < borderCount * 6) {
+        result.reason = "busy background";
+        return false;
+    }
+
+    // 文字颜色：明显不同于背景的像素中多数所在的一侧，对比度取其第 90 百分位
+    std::vector<int> darker, lighter;
+    for (size_t i = 0; i < luma.size(); ++i) {
+        int difference = luma[i] - background;
+        if (difference > 24) lighter.push_back(difference);
+        else if (difference < -24) darker.push_back(-difference);
+    }
+    std::vector<int>& ink = darker.size() >= lighter.size() ? darker : lighter;
+    int polarity = darker.size() >= lighter.size() ? -1 : 1;
+    if (ink.size() < 8) {
+        result.reason = "no text";
+        return false;
+    }
+    std::nth_element(ink.begin(), ink.begin() + ink.size() * 9 / 10, ink.end());
+    int contrast = ink[ink.size() * 9 / 10];
+    if (contrast < options.minContrast) {
+        result.reason = "low contrast";
+        return false;
+    }
+
+    std::vector<unsigned char> coverage(luma.size());
+    for (size_t i = 0; i < luma.size(); ++i) {
+        int value = polarity * (luma[i] - background) * 255 / contrast;
+        coverage[i] = (unsigned char)(std::max)(0, (std::min)(255, value));
+    }
+
+    // 单行：有墨迹的行只能连成一段（与主段相距很近的小段，如下划线，并入主段）
+    std::vector<int> rowInk(height, 0);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) rowInk[y] += coverage[(size_t)y * width + x] >= INK_THRESHOLD;
+    }
+    std::vector<std::pair<int, int> > bands;
+    for (int y = 0; y < height; ++y) {
+        if (!rowInk[y]) continue;
+        if (bands.empty() || bands.back().second != y) bands.push_back(std::make_pair(y, y + 1));
+        else bands.back().second = y + 1;
+    }
+    if (bands.empty()) {
+        result.reason = "no text";
+        return false;
+    }
+    size_t mainBand = 0;
+    for (size_t i = 1; i < bands.size(); ++i) {
+        if (bands[i].second - bands[i].first > bands[mainBand].second - bands[mainBand].first) mainBand = i;
+    }
+    int mainHeight = bands[mainBand].second - bands[mainBand].first;
+    for (size_t i = 0; i < bands.size(); ++i) {
+        if (i == mainBand) continue;
+        int bandHeight = bands[i].second - bands[i].first;
+        int gap = i < mainBand ? bands[mainBand].first - bands[i].second : bands[i].first - bands[mainBand].second;
+        if (bandHeight * 2 > mainHeight || gap * 2 > mainHeight) {
+            result.reason = "multiple lines";
+            return false;
+        }
+    }
+
+    std::vector<int> labels;
+    std::vector<Component> components;
+    labelComponents(coverage, width, height, labels, components);
+    std::vector<Column> columns;
+    {
+        std::vector<int> order;
+        for (size_t i = 0; i < components.size(); ++i) {
+            const Component& c = components[i];
+            // 碰到选区边缘的字形可能被截断
+            if (c.x0 == 0 || c.y0 == 0 || c.x1 == width || c.y1 == height) {
+                result.reason = "text touches the selection edge";
+                return false;
+            }
+            order.push_back((int)i);
+        }
+        std::sort(order.begin(), order.end(), [&components](int a, int b) { return components[a].x0 < components[b].x0; });
+        for (size_t k = 0; k < order.size(); ++k) {
+            const Component& c = components[order[k]];
+            Column* target = nullptr;
+            // 与最近两列之一水平重叠超过较窄者一半时并入
+            for (size_t back = 0; back < 2 && back < columns.size(); ++back) {
+                Column& column = columns[columns.size() - 1 - back];
+                int overlap = (std::min)(column.x1, c.x1) - (std::max)(column.x0, c.x0);
+                if (overlap * 2 >= (std::min)(column.x1 - column.x0, c.x1 - c.x0)) {
+                    target = &column;
+                    break;
+                }
+            }
+            if (!target) {
+                Column column = {c.x0, c.y0, c.x1, c.y1, std::vector<int>()};
+                columns.push_back(column);
+                target = &columns.back();
+            }
+            target->x0 = (std::min)(target->x0, c.x0);
+            target->y0 = (std::min)(target->y0, c.y0);
+            target->x1 = (std::max)(target->x1, c.x1);
+            target->y1 = (std::max)(target->y1, c.y1);
+            target->components.push_back(order[k]);
+        }
+        std::sort(columns.begin(), columns.end(), [](const Column& a, const Column& b) { return a.x0 < b.x0; });
+    }
+    if (columns.empty()) {
+        result.reason = "no text";
+        return false;
+    }
+    result.eligible = true;
+
+    // 没有达到墨迹阈值的浅色痕迹（小字号的 '.'、','）不在任何字形中，漏掉会把 "1.2" 读成 "1 2"
+    {
+        std::vector<char> covered(width, 0);
+        for (size_t i = 0; i < columns.size(); ++i) {
+            for (int x = (std::max)(0, columns[i].x0 - 1); x < (std::min)(width, columns[i].x1 + 1); ++x) covered[x] = 1;
+        }
+        long run = 0;
+        for (int x = 0; x < width; ++x) {
+            if (covered[x]) {
+                run = 0;
+                continue;
+            }
+            for (int y = 0; y < height; ++y) run += coverage[(size_t)y * width + x];
+            if (run >= 255) {
+                result.reason = "faint marks between glyphs";
+                return false;
+            }
+        }
+    }
+
+    // 基线取较高字形底边的中位数，大写字母高度取坐在基线上的最高字形
+    std::vector<int> bottoms;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if ((columns[i].y1 - columns[i].y0) * 5 >= mainHeight * 2) bottoms.push_back(columns[i].y1);
+    }
+    if (bottoms.empty()) {
+        result.reason = "no text";
+        return false;
+    }
+    std::nth_element(bottoms.begin(), bottoms.begin() + bottoms.size() / 2, bottoms.end());
+    int baseline = bottoms[bottoms.size() / 2];
+    int tolerance = (std::max)(1, mainHeight / 12);
+    int capPixels = 0;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (std::abs(columns[i].y1 - baseline) <= tolerance) capPixels = (std::max)(capPixels, baseline - columns[i].y0);
+    }
+    if (capPixels < options.minCapHeight * dpi / 96) {
+        result.reason = "text too small";
+        return false;
+    }
+    double capHeight = capPixels;
+
+    // 候选字形：1..MAX_MERGE 个相邻列合成一个，以及过宽的列切成两半
+    std::vector<Candidate> candidates;
+    std::vector<unsigned char> crop;
+    std::vector<char> member(components.size() + 1, 0);
+    auto addCandidate = [&](const std::vector<int>& parts, int limitX0, int limitX1) -> int {
+        for (size_t k = 0; k < parts.size(); ++k) member[parts[k] + 1] = 1;
+        // 本字形的墨迹加上未成连通域的抗锯齿边缘，其他字形的像素置 0
+        int bx0 = width, by0 = height, bx1 = 0, by1 = 0;
+        for (size_t k = 0; k < parts.size(); ++k) {
+            const Component& c = components[parts[k]];
+            for (int y = c.y0; y < c.y1; ++y) {
+                for (int x = (std::max)(c.x0, limitX0); x < (std::min)(c.x1, limitX1); ++x) {
+                    if (labels[(size_t)y * width + x] != parts[k] + 1) continue;
+                    bx0 = (std::min)(bx0, x);
+                    by0 = (std::min)(by0, y);
+                    bx1 = (std::max)(bx1, x + 1);
+                    by1 = (std::max)(by1, y + 1);
+                }
+            }
+        }
+        int index = -1;
+        if (bx1 > bx0) {
+            int cropWidth = bx1 - bx0;
+            int cropHeight = by1 - by0;
+            crop.assign((size_t)cropWidth * cropHeight, 0);
+            for (int y = by0; y < by1; ++y) {
+                for (int x = bx0; x < bx1; ++x) {
+                    size_t i = (size_t)y * width + x;
+                    if (member[labels[i]] || !labels[i]) crop[(size_t)(y - by0) * cropWidth + x - bx0] = coverage[i];
+                }
+            }
+            Candidate candidate;
+            Bitmap bitmap = {crop.data(), cropWidth, cropHeight, cropWidth};
+            candidate.shaped = makeFeature(bitmap, candidate.feature);
+            candidate.width = (float)(cropWidth / capHeight);
+            candidate.height = (float)(cropHeight / capHeight);
+            candidate.top = (float)((baseline - by0) / capHeight);
+            candidate.x0 = bx0;
+            candidate.x1 = bx1;
+            index = (int)candidates.size();
+            candidates.push_back(candidate);
+        }
+        for (size_t k = 0; k < parts.size(); ++k) member[parts[k] + 1] = 0;
+        return index;
+    };
+
+    size_t n = columns.size();
+    // spans[i * MAX_MERGE + (L - 1)]：从第 i 列起 L 列合成的候选；splits[i]：第 i 列切开后的左右两个候选
+    std::vector<int> spans(n * MAX_MERGE, -1);
+    std::vector<std::pair<int, int> > splits(n, std::make_pair(-1, -1));
+    for (size_t i = 0; i < n; ++i) {
+        std::vector<int> parts;
+        for (int length = 1; length <= MAX_MERGE && i + length <= n; ++length) {
+            const Column& last = columns[i + length - 1];
+            if (length > 1 && last.x0 - columns[i + length - 2].x1 > MERGE_GAP * capHeight) break;
+            if (last.x1 - columns[i].x0 > MAX_GLYPH_WIDTH * capHeight) break;
+            parts.insert(parts.end(), last.components.begin(), last.components.end());
+            spans[i * MAX_MERGE + length - 1] = addCandidate(parts, 0, width);
+        }
+
+        const Column& column = columns[i];
+        int columnWidth = column.x1 - column.x0;
+        if (columnWidth > SPLIT_WIDTH * capHeight) {
+            // 在中间一半范围内找墨迹最少的竖线切开
+            int bestX = -1;
+            long bestInk = 0;
+            for (int x = column.x0 + columnWidth / 4; x < column.x1 - columnWidth / 4; ++x) {
+                long inkSum = 0;
+                for (int y = column.y0; y < column.y1; ++y) inkSum += coverage[(size_t)y * width + x];
+                if (bestX < 0 || inkSum < bestInk) {
+                    bestX = x;
+                    bestInk = inkSum;
+                }
+            }
+            if (bestX > 0) {
+                splits[i].first = addCandidate(column.components, 0, bestX);
+                splits[i].second = addCandidate(column.components, bestX, width);
+            }
+        }
+    }
+
+    // 逐个候选、逐种字体找最好的模板
+    DotFunc dot = dotProduct();
+    const double nccScale = 1.0 / (FEATURE_SCALE * FEATURE_SCALE);
+    std::vector<std::vector<Match> > fontMatches(fonts.size(), std::vector<Match>(candidates.size()));
+    for (size_t f = 0; f < fonts.size(); ++f) {
+        const FontTemplates& font = fonts[f];
+        // 微调使小字号的形状随像素大小变化：有与选区字号接近的模板时只用这些模板
+        int sizeTolerance = (std::max)(1, capPixels / 8);
+        bool sizeMatched = false;
+        for (size_t t = 0; t < font.glyphs.size() && !sizeMatched; ++t) {
+            sizeMatched = std::abs(font.glyphs[t].capPixels - capPixels) <= sizeTolerance;
+        }
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            const Candidate& candidate = candidates[c];
+            Match& match = fontMatches[f][c];
+            match.ch = 0;
+            match.score = match.second = -1;
+            const Template* bestGlyph = nullptr;
+            for (size_t t = 0; t < font.glyphs.size(); ++t) {
+                const Template& glyph = font.glyphs[t];
+                if (sizeMatched && std::abs(glyph.capPixels - capPixels) > sizeTolerance) continue;
+                double ncc;
+                if (glyph.solid || !candidate.shaped) ncc = glyph.solid == !candidate.shaped ? 1.0 : 0.0;
+                else ncc = dot(candidate.feature, glyph.feature.data()) * nccScale;
+                double geometry = std::fabs(candidate.width - glyph.width) + std::fabs(candidate.height - glyph.height) +
+                                  std::fabs(candidate.top - glyph.top);
+                double score = ncc - GEOMETRY_WEIGHT * geometry;
+                if (score > match.score) {
+                    if (glyph.ch != match.ch) match.second = match.score;
+                    match.score = score;
+                    match.ch = glyph.ch;
+                    bestGlyph = &glyph;
+                } else if (score > match.second && glyph.ch != match.ch) {
+                    match.second = score;
+                }
+            }
+            match.leftBearing = bestGlyph ? bestGlyph->leftBearing : 0;
+            match.rightBearing = bestGlyph ? bestGlyph->rightBearing : 0;
+        }
+    }
+
+    // 置信度：与任何一种字体中另一个字符的最好得分相差不够大时扣分（一种字体的 'O' 可能就是另一种的 '0'）
+    for (size_t c = 0; c < candidates.size(); ++c) {
+        for (size_t f = 0; f < fonts.size(); ++f) {
+            Match& match = fontMatches[f][c];
+            double rival = -1;
+            for (size_t g = 0; g < fonts.size(); ++g) {
+                const Match& other = fontMatches[g][c];
+                rival = (std::max)(rival, other.ch != match.ch ? other.score : other.second);
+            }
+            double confidence = match.score - AMBIGUITY_WEIGHT * (std::max)(0.0, AMBIGUITY_MARGIN - (match.score - rival));
+            match.confidence = (std::max)(0.0, (std::min)(1.0, confidence));
+        }
+    }
+
+    // 每种字体用动态规划选出切分，取平均代价最小的字体
+    double bestCost = 0;
+    for (size_t f = 0; f < fonts.size(); ++f) {
+        const FontTemplates& font = fonts[f];
+        const std::vector<Match>& matches = fontMatches[f];
+
+        // cost[k]：前 k 列的最小代价。代价为 (1 - 置信度) x 所含列数，合并与切分都不占便宜
+        std::vector<double> cost(n + 1, 1e30);
+        std::vector<int> choice(n + 1, 0);  // >0：最后一段的列数；-1：最后一列切成两个字形
+        cost[0] = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (cost[i] >= 1e30) continue;
+            for (int length = 1; length <= MAX_MERGE && i + length <= n; ++length) {
+                int c = spans[i * MAX_MERGE + length - 1];
+                if (c < 0) continue;
+                double total = cost[i] + (1.0 - matches[c].confidence) * length;
+                if (total < cost[i + length]) {
+                    cost[i + length] = total;
+                    choice[i + length] = length;
+                }
+            }
+            int whole = spans[i * MAX_MERGE];
+            if (splits[i].first >= 0 && splits[i].second >= 0 && (whole < 0 || matches[whole].confidence < SPLIT_BELOW)) {
+                double total = cost[i] + (1.0 - matches[splits[i].first].confidence) +
+                               (1.0 - matches[splits[i].second].confidence);
+                if (total < cost[i + 1]) {
+                    cost[i + 1] = total;
+                    choice[i + 1] = -1;
+                }
+            }
+        }
+        if (cost[n] >= 1e30) continue;
+
+        std::vector<int> chosen;
+        for (size_t k = n; k > 0;) {
+            if (choice[k] < 0) {
+                chosen.push_back(splits[k - 1].second);
+                chosen.push_back(splits[k - 1].first);
+                k -= 1;
+            } else {
+                chosen.push_back(spans[(k - choice[k]) * MAX_MERGE + choice[k] - 1]);
+                k -= choice[k];
+            }
+        }
+        std::reverse(chosen.begin(), chosen.end());
+
+        std::string text;
+        double confidence = 1.0;
+        for (size_t k = 0; k < chosen.size(); ++k) {
+            const Candidate& candidate = candidates[chosen[k]];
+            if (k > 0) {
+                // 空格：实际间距减去两个字形按模板应有的左右空白，再按空格宽度折算
+                const Candidate& previous = candidates[chosen[k - 1]];
+                double expected = (matches[chosen[k - 1]].rightBearing + matches[chosen[k]].leftBearing) * capHeight;
+                double excess = candidate.x0 - previous.x1 - expected;
+                int spaces = font.space > 0 ? (int)std::floor(excess / (font.space * capHeight) + 0.5) : 0;
+                text.append((size_t)(std::max)(0, (std::min)(spaces, 8)), ' ');
+            }
+            text += matches[chosen[k]].ch;
+            confidence = (std::min)(confidence, matches[chosen[k]].confidence);
+        }
+
+        double averageCost = cost[n] / n;
+        if (result.text.empty() || averageCost < bestCost) {
+            bestCost = averageCost;
+            result.text = text;
+            result.confidence = confidence;
+            result.font = font.name;
+            result.glyphs = (int)chosen.size();
+        }
+    }
+
+    if (result.text.empty()) {
+        result.reason = "no match";
+        return false;
+    }
+    if (result.confidence < options.minConfidence) {
+        result.reason = "low confidence";
+        return false;
+    }
+    return true;
+}
+
+std::string DescribeLocalOcrResult(const LocalOcrResult& result) {
+    char buffer[160];
+    std::snprintf(buffer, sizeof(buffer), "local OCR: %s, confidence %.2f, %d glyphs, font %s",
+                  result.reason ? result.reason : "accepted", result.confidence, result.glyphs,
+                  result.font.empty() ? "-" : result.font.c_str());
+    return buffer;
+}
@@ -0,0 +1,146 @@
+#include "../include/MappedFile.h"
+#include <cstdio>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+namespace {
+
+std::wstring widePath(const std::string& path) {
+    int size = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), (int)path.length(), nullptr, 0);
+    std::wstring wide(size, 0);
+    if (size > 0) MultiByteToWideChar(CP_UTF8, 0, path.c_str(), (int)path.length(), &wide[0], size);
+    return wide;
+}
+
+} // namespace
+
+MappedFile::MappedFile() : view(nullptr), length(0), writable(false), file(INVALID_HANDLE_VALUE), mapping(nullptr) {
+}
+
+bool MappedFile::openRead(const std::string& path) {
+    close();
+    file = CreateFileW(widePath(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        close();
+        return false;
+    }
+    mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping) view = (unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        close();
+        return false;
+    }
+    length = (size_t)size.QuadPart;
+    return true;
+}
+
+bool MappedFile::create(const std::string& path, size_t size) {
+    close();
+    if (size == 0) return false;
+    file = CreateFileW(widePath(path).c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                       FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    unsigned long long size64 = size;
+    // 映射对象按给定大小扩展文件
+    mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, (DWORD)(size64 >> 32), (DWORD)size64, nullptr);
+    if (mapping) view = (unsigned char*)MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+    if (!view) {
+        close();
+        return false;
+    }
+    length = size;
+    writable = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (view) {
+        if (writable) FlushViewOfFile(view, 0);
+        UnmapViewOfFile(view);
+    }
+    if (mapping) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    view = nullptr;
+    mapping = nullptr;
+    file = INVALID_HANDLE_VALUE;
+    length = 0;
+    writable = false;
+}
+
+bool ReplaceFileAtomically(const std::string& from, const std::string& to) {
+    return MoveFileExW(widePath(from).c_str(), widePath(to).c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+}
+#else
+MappedFile::MappedFile() : view(nullptr), length(0), writable(false), fd(-1) {
+}
+
+bool MappedFile::openRead(const std::string& path) {
+    close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close();
+        return false;
+    }
+    void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        close();
+        return false;
+    }
+    view = (unsigned char*)mapped;
+    length = (size_t)info.st_size;
+    return true;
+}
+
+bool MappedFile::create(const std::string& path, size_t size) {
+    close();
+    if (size == 0) return false;
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) return false;
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close();
+        return false;
+    }
+    void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        close();
+        return false;
+    }
+    view = (unsigned char*)mapped;
+    length = size;
+    writable = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (view) {
+        if (writable) msync(view, length, MS_SYNC);
+        munmap(view, length);
+    }
+    if (fd >= 0) ::close(fd);
+    view = nullptr;
+    fd = -1;
+    length = 0;
+    writable = false;
+}
+
+bool ReplaceFileAtomically(const std::string& from, const std::string& to) {
+    return std::rename(from.c_str(), to.c_str()) == 0;
+}
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
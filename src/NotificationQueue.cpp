@@ -0,0 +1,134 @@
+#include "../include/NotificationQueue.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+double msBetween(NotificationTime from, NotificationTime to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+} // namespace
+
+NotificationQueue::NotificationQueue(NotificationSink& sink, const NotificationOptions& options)
+    : sink(sink), options(options), showing(false), wakePending(false), delayTotalMs(0) {
+    if (this->options.maxPending == 0) this->options.maxPending = 1;
+}
+
+bool NotificationQueue::post(const std::string& text, int durationMs, NotificationTime now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.posted++;
+    // 与正在显示的消息相同：只延长显示时间，已安排的 pump 会按新的时间继续
+    if (showing && pending.empty() && text == currentText) {
+        hideAt = (std::max)(hideAt, now + std::chrono::milliseconds(durationMs));
+        counters.coalesced++;
+        return false;
+    }
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (pending[i].text == text) {
+            pending[i].durationMs = (std::max)(pending[i].durationMs, durationMs);
+            counters.coalesced++;
+            return false;
+        }
+    }
+    Entry entry;
+    entry.text = text;
+    entry.durationMs = durationMs;
+    entry.posted = now;
+    pending.push_back(entry);
+    while (pending.size() > options.maxPending) {
+        pending.pop_front();
+        counters.superseded++;
+    }
+    if (wakePending) return false;
+    wakePending = true;
+    counters.wakeups++;
+    return true;
+}
+
+NotificationTime NotificationQueue::pump(NotificationTime now) {
+    bool show = false;
+    bool hide = false;
+    std::string text;
+    NotificationTime next = NotificationTime::max();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        wakePending = false;
+        if (showing && now >= hideAt && pending.empty()) {
+            showing = false;
+            hide = true;
+        }
+        if (!pending.empty() &&
+            (!showing || now >= hideAt || now - shownAt >= std::chrono::milliseconds(options.minVisibleMs))) {
+            Entry entry = pending.front();
+            pending.pop_front();
+            showing = true;
+            currentText = entry.text;
+            shownAt = now;
+            hideAt = now + std::chrono::milliseconds(entry.durationMs);
+            counters.shown++;
+            // post 的时间由调用线程在取锁前读取，可能略晚于这里的 now
+            double delay = (std::max)(0.0, msBetween(entry.posted, now));
+            delayTotalMs += delay;
+            counters.delayMaxMs = (std::max)(counters.delayMaxMs, delay);
+            counters.delayMeanMs = delayTotalMs / counters.shown;
+            text = entry.text;
+            show = true;
+        }
+        if (showing) {
+            next = hideAt;
+            if (!pending.empty()) next = (std::min)(next, shownAt + std::chrono::milliseconds(options.minVisibleMs));
+        }
+    }
+    // 显示端可能较慢（重绘窗口），不在锁内调用，post 不会被拖住
+    if (show) sink.show(text);
+    else if (hide) sink.hide();
+    return next;
+}
+
+void NotificationQueue::dismiss(NotificationTime now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!showing) return;
+    hideAt = now;
+    counters.dismissed++;
+}
+
+bool NotificationQueue::visible() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return showing;
+}
+
+NotificationStats NotificationQueue::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void HeadlessNotificationSink::show(const std::string& text) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Event event;
+    event.shown = true;
+    event.text = text;
+    recorded.push_back(event);
+}
+
+void HeadlessNotificationSink::hide() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Event event;
+    event.shown = false;
+    recorded.push_back(event);
+}
+
+std::vector<HeadlessNotificationSink::Event> HeadlessNotificationSink::events() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return recorded;
+}
+
+std::string DescribeNotificationStats(const NotificationStats& stats) {
+    char line[200];
+    std::snprintf(line, sizeof(line),
+                  "[toast] posted=%ld shown=%ld coalesced=%ld superseded=%ld dismissed=%ld wakeups=%ld "
+                  "delay mean/max=%.0f/%.0f ms",
+                  stats.posted, stats.shown, stats.coalesced, stats.superseded, stats.dismissed, stats.wakeups,
+                  stats.delayMeanMs, stats.delayMaxMs);
+    return line;
+}
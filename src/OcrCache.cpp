@@ -0,0 +1,444 @@
+#include "../include/OcrCache.h"
+#include "../include/MappedFile.h"
+#include "../include/RequestCancel.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// xxHash64 的常数与轮函数
+const uint64_t PRIME1 = 11400714785074694791ULL;
+const uint64_t PRIME2 = 14029467366897019727ULL;
+const uint64_t PRIME3 = 1609587929392839161ULL;
+const uint64_t PRIME4 = 9650029242287828579ULL;
+const uint64_t PRIME5 = 2870177450012600261ULL;
+
+// BGRA 每 8 字节两个像素，去掉两个 alpha 字节
+const uint64_t PIXEL_MASK = 0x00FFFFFF00FFFFFFULL;
+
+inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline uint64_t round64(uint64_t acc, uint64_t input) {
+    acc += input * PRIME2;
+    acc = rotl(acc, 31);
+    return acc * PRIME1;
+}
+
+inline uint64_t merge64(uint64_t acc, uint64_t value) {
+    acc ^= round64(0, value);
+    return acc * PRIME1 + PRIME4;
+}
+
+// 输入的每个 8 字节字先与 mask 相与；mask 为全 1 时即标准 xxHash64
+uint64_t hashMasked(const unsigned char* p, size_t size, uint64_t seed, uint64_t mask) {
+    const unsigned char* end = p + size;
+    uint64_t h;
+    if (size >= 32) {
+        uint64_t v1 = seed + PRIME1 + PRIME2;
+        uint64_t v2 = seed + PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME1;
+        const unsigned char* limit = end - 32;
+        do {
+            v1 = round64(v1, read64(p) & mask);
+            v2 = round64(v2, read64(p + 8) & mask);
+            v3 = round64(v3, read64(p + 16) & mask);
+            v4 = round64(v4, read64(p + 24) & mask);
+            p += 32;
+        } while (p <= limit);
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = merge64(h, v1);
+        h = merge64(h, v2);
+        h = merge64(h, v3);
+        h = merge64(h, v4);
+    } else {
+        h = seed + PRIME5;
+    }
+    h += (uint64_t)size;
+
+    while (p + 8 <= end) {
+        h ^= round64(0, read64(p) & mask);
+        h = rotl(h, 27) * PRIME1 + PRIME4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= (uint64_t)(read32(p) & (uint32_t)mask) * PRIME1;
+        h = rotl(h, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= (*p++) * PRIME5;
+        h = rotl(h, 11) * PRIME1;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+// 9x8 网格的平均亮度，每行相邻格比较得到 64 位。每格最多取 32x32 个采样点，4K 截图也只读几万像素
+uint64_t differenceHash(const unsigned char* bgra, int width, int height, int stride) {
+    const int COLUMNS = 9;
+    const int ROWS = 8;
+    const int MAX_SAMPLES = 32;
+    uint64_t hash = 0;
+    for (int cy = 0; cy < ROWS; ++cy) {
+        int y0 = cy * height / ROWS;
+        int y1 = (cy + 1) * height / ROWS;
+        int stepY = (y1 - y0 + MAX_SAMPLES - 1) / MAX_SAMPLES;
+        unsigned long cells[COLUMNS];
+        for (int cx = 0; cx < COLUMNS; ++cx) {
+            int x0 = cx * width / COLUMNS;
+            int x1 = (cx + 1) * width / COLUMNS;
+            int stepX = (x1 - x0 + MAX_SAMPLES - 1) / MAX_SAMPLES;
+            unsigned long sum = 0;
+            unsigned long count = 0;
+            for (int y = y0; y < y1; y += stepY) {
+                const unsigned char* row = bgra + (size_t)y * stride;
+                for (int x = x0; x < x1; x += stepX) {
+                    const unsigned char* px = row + (size_t)x * 4;
+                    sum += (px[2] * 77u + px[1] * 150u + px[0] * 29u) >> 8;
+                    count++;
+                }
+            }
+            cells[cx] = count > 0 ? sum * 16 / count : 0;
+        }
+        for (int cx = 0; cx + 1 < COLUMNS; ++cx) {
+            hash = (hash << 1) | (cells[cx] < cells[cx + 1] ? 1u : 0u);
+        }
+    }
+    return hash;
+}
+
+// 每个条目在文字之外的估计开销（链表节点、索引项与键）
+const size_t ENTRY_OVERHEAD = 96;
+
+// 持久化文件：文件头后依次为条目，最久未用的在前
+const char FILE_MAGIC[8] = {'S', 'H', 'O', 'T', 'O', 'C', 'R', 'C'};
+const uint32_t FILE_VERSION = 1;
+const size_t FILE_HEADER_SIZE = 16;
+const size_t RECORD_HEADER_SIZE = 36;
+
+inline void put32(unsigned char*& p, uint32_t v) {
+    std::memcpy(p, &v, 4);
+    p += 4;
+}
+
+inline void put64(unsigned char*& p, uint64_t v) {
+    std::memcpy(p, &v, 8);
+    p += 8;
+}
+
+} // namespace
+
+uint64_t HashBytes64(const void* data, size_t size, uint64_t seed) {
+    return hashMasked(static_cast<const unsigned char*>(data), size, seed, ~0ULL);
+}
+
+OcrCacheKey MakeOcrCacheKey(const unsigned char* bgra, int width, int height, int stride, bool perceptual) {
+    OcrCacheKey key;
+    key.width = width;
+    key.height = height;
+    // 逐行哈希，上一行的结果作为下一行的种子，跳过行尾填充
+    uint64_t h = ((uint64_t)(uint32_t)width << 32) | (uint32_t)height;
+    size_t rowBytes = (size_t)width * 4;
+    for (int y = 0; y < height; ++y) {
+        h = hashMasked(bgra + (size_t)y * stride, rowBytes, h, PIXEL_MASK);
+    }
+    key.hash = h;
+    if (perceptual && width >= 9 && height >= 8) {
+        key.perceptual = differenceHash(bgra, width, height, stride);
+        key.hasPerceptual = true;
+    }
+    return key;
+}
+
+OcrCacheKey MakeOcrCacheKeyForBytes(const unsigned char* data, size_t size) {
+    OcrCacheKey key;
+    key.hash = HashBytes64(data, size, (uint64_t)size);
+    return key;
+}
+
+int PerceptualDistance(uint64_t a, uint64_t b) {
+    uint64_t x = a ^ b;
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+}
+
+std::string DescribeOcrCacheStats(const OcrCacheStats& stats) {
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "[ocr-cache] entries=%zu bytes=%zu lookups=%ld hit_rate=%.1f%% (hits=%ld perceptual=%ld "
+                  "coalesced=%ld) evictions=%ld saved=%.1f KB",
+                  stats.entries, stats.bytes, stats.lookups, stats.hitRate() * 100.0, stats.hits,
+                  stats.perceptualHits, stats.coalesced, stats.evictions, stats.bytesSaved / 1024.0);
+    return line;
+}
+
+OcrCache::OcrCache(const OcrCacheOptions& options) : options(options), bytes(0) {
+}
+
+size_t OcrCache::entryBytes(const std::string& text) {
+    return text.size() + ENTRY_OVERHEAD;
+}
+
+bool OcrCache::findLocked(const OcrCacheKey& key, std::string& text) {
+    std::unordered_map<uint64_t, std::list<Entry>::iterator>::iterator found = index.find(key.hash);
+    std::list<Entry>::iterator match = entries.end();
+    if (found != index.end() && found->second->key.width == key.width && found->second->key.height == key.height) {
+        match = found->second;
+    } else if (options.perceptualMaxDistance >= 0 && key.hasPerceptual) {
+        // 精确未命中时线性查找最相近的条目；只比较尺寸相差不超过 2 像素的（框选边缘抖动）
+        int best = options.perceptualMaxDistance + 1;
+        for (std::list<Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+            if (!it->key.hasPerceptual || std::abs(it->key.width - key.width) > 2 ||
+                std::abs(it->key.height - key.height) > 2) {
+                continue;
+            }
+            int distance = PerceptualDistance(it->key.perceptual, key.perceptual);
+            if (distance < best) {
+                best = distance;
+                match = it;
+            }
+        }
+        if (match != entries.end()) counters.perceptualHits++;
+    }
+    if (match == entries.end()) return false;
+
+    entries.splice(entries.begin(), entries, match);
+    counters.hits++;
+    counters.bytesSaved += (long long)match->requestBytes;
+    text = match->text;
+    return true;
+}
+
+void OcrCache::insertLocked(const OcrCacheKey& key, const std::string& text, size_t requestBytes) {
+    std::unordered_map<uint64_t, std::list<Entry>::iterator>::iterator found = index.find(key.hash);
+    if (found != index.end()) {
+        std::list<Entry>::iterator it = found->second;
+        bytes -= entryBytes(it->text);
+        it->key = key;
+        it->text = text;
+        it->requestBytes = requestBytes;
+        entries.splice(entries.begin(), entries, it);
+    } else {
+        Entry entry;
+        entry.key = key;
+        entry.text = text;
+        entry.requestBytes = requestBytes;
+        entries.push_front(entry);
+        index[key.hash] = entries.begin();
+    }
+    bytes += entryBytes(text);
+    evictLocked();
+}
+
+void OcrCache::evictLocked() {
+    while (bytes > options.maxBytes && !entries.empty()) {
+        Entry& oldest = entries.back();
+        bytes -= entryBytes(oldest.text);
+        index.erase(oldest.key.hash);
+        entries.pop_back();
+        counters.evictions++;
+    }
+}
+
+bool OcrCache::lookup(const OcrCacheKey& key, std::string& text) {
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.lookups++;
+    if (findLocked(key, text)) return true;
+    counters.misses++;
+    return false;
+}
+
+void OcrCache::insert(const OcrCacheKey& key, const std::string& text, size_t requestBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.insertions++;
+    insertLocked(key, text, requestBytes);
+}
+
+void OcrCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    bytes = 0;
+}
+
+bool OcrCache::getOrCompute(const OcrCacheKey& key, const Compute& compute, std::string& text,
+                            OcrCacheSource* source, RequestCancel* cancel) {
+    std::unique_lock<std::mutex> lock(mutex);
+    counters.lookups++;
+    for (;;) {
+        if (findLocked(key, text)) {
+            if (source) *source = OCR_FROM_CACHE;
+            return true;
+        }
+
+        std::unordered_map<uint64_t, std::shared_ptr<InFlight> >::iterator pending = inFlight.find(key.hash);
+        if (pending == inFlight.end()) break;
+        std::shared_ptr<InFlight> flight = pending->second;
+        counters.coalesced++;
+        // 取消动作在 cancel 的锁内执行并获取本缓存的锁，所以登记与注销都在释放本缓存的锁之后进行
+        bool waitCancelled = false;
+        if (cancel) {
+            lock.unlock();
+            int cancelId = cancel->addAction([this, &waitCancelled]() {
+                std::lock_guard<std::mutex> wake(mutex);
+                waitCancelled = true;
+                flightDone.notify_all();
+            });
+            lock.lock();
+            flightDone.wait(lock, [&flight, &waitCancelled]() { return flight->done || waitCancelled; });
+            lock.unlock();
+            cancel->removeAction(cancelId);
+            lock.lock();
+        } else {
+            flightDone.wait(lock, [&flight]() { return flight->done; });
+        }
+        if (source) *source = OCR_FROM_IN_FLIGHT;
+        if (!flight->done) return false;
+        if (flight->cancelled) {
+            // 发起者取消了，结果并非失败：不算合并，重新查找（可能已有别的等待者接手）或自己计算
+            counters.coalesced--;
+            continue;
+        }
+        if (!flight->ok) return false;
+        counters.bytesSaved += (long long)flight->requestBytes;
+        text = flight->text;
+        return true;
+    }
+
+    counters.misses++;
+    std::shared_ptr<InFlight> flight = std::make_shared<InFlight>();
+    inFlight[key.hash] = flight;
+    lock.unlock();
+
+    std::string result;
+    size_t requestBytes = 0;
+    bool ok;
+    try {
+        ok = compute(result, requestBytes);
+    } catch (...) {
+        // 异常时也要唤醒等待者，否则它们会一直阻塞
+        completeFlight(key, flight, false, false, result, requestBytes);
+        throw;
+    }
+    completeFlight(key, flight, ok, !ok && cancel && cancel->cancelled(), result, requestBytes);
+    text = result;
+    if (source) *source = OCR_FROM_CALL;
+    return ok;
+}
+
+void OcrCache::completeFlight(const OcrCacheKey& key, const std::shared_ptr<InFlight>& flight, bool ok,
+                              bool cancelled, const std::string& text, size_t requestBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    flight->done = true;
+    flight->ok = ok;
+    flight->cancelled = cancelled;
+    flight->text = text;
+    flight->requestBytes = requestBytes;
+    inFlight.erase(key.hash);
+    if (ok) {
+        counters.insertions++;
+        insertLocked(key, text, requestBytes);
+    }
+    flightDone.notify_all();
+}
+
+OcrCacheStats OcrCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    OcrCacheStats snapshot = counters;
+    snapshot.entries = entries.size();
+    snapshot.bytes = bytes;
+    return snapshot;
+}
+
+bool OcrCache::save(const std::string& path) const {
+    std::vector<Entry> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot.assign(entries.rbegin(), entries.rend());
+    }
+
+    size_t total = FILE_HEADER_SIZE;
+    for (size_t i = 0; i < snapshot.size(); ++i) total += RECORD_HEADER_SIZE + snapshot[i].text.size();
+
+    std::string temporary = path + ".tmp";
+    {
+        MappedFile file;
+        if (!file.create(temporary, total)) return false;
+        unsigned char* p = file.mutableData();
+        std::memcpy(p, FILE_MAGIC, sizeof(FILE_MAGIC));
+        p += sizeof(FILE_MAGIC);
+        put32(p, FILE_VERSION);
+        put32(p, (uint32_t)snapshot.size());
+        for (size_t i = 0; i < snapshot.size(); ++i) {
+            const Entry& entry = snapshot[i];
+            put64(p, entry.key.hash);
+            put64(p, entry.key.perceptual);
+            put32(p, entry.key.hasPerceptual ? 1u : 0u);
+            put32(p, (uint32_t)entry.key.width);
+            put32(p, (uint32_t)entry.key.height);
+            put32(p, (uint32_t)entry.requestBytes);
+            put32(p, (uint32_t)entry.text.size());
+            std::memcpy(p, entry.text.data(), entry.text.size());
+            p += entry.text.size();
+        }
+    }
+    if (!ReplaceFileAtomically(temporary, path)) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool OcrCache::load(const std::string& path) {
+    MappedFile file;
+    if (!file.openRead(path)) return false;
+    const unsigned char* p = file.data();
+    const unsigned char* end = p + file.size();
+    if (file.size() < FILE_HEADER_SIZE || std::memcmp(p, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+        read32(p + 8) != FILE_VERSION) {
+        return false;
+    }
+    uint32_t count = read32(p + 12);
+    p += FILE_HEADER_SIZE;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (uint32_t i = 0; i < count; ++i) {
+        if ((size_t)(end - p) < RECORD_HEADER_SIZE) return false;
+        OcrCacheKey key;
+        key.hash = read64(p);
+        key.perceptual = read64(p + 8);
+        key.hasPerceptual = read32(p + 16) != 0;
+        key.width = (int)read32(p + 20);
+        key.height = (int)read32(p + 24);
+        size_t requestBytes = read32(p + 28);
+        size_t textLength = read32(p + 32);
+        p += RECORD_HEADER_SIZE;
+        if ((size_t)(end - p) < textLength) return false;
+        // 文件中最久未用的在前，依次插到表头后顺序即恢复
+        insertLocked(key, std::string((const char*)p, textLength), requestBytes);
+        p += textLength;
+    }
+    return true;
+}
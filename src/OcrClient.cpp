@@ -0,0 +1,235 @@
+#include "../include/OcrClient.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+const char OCR_FORM_PREFIX[] = "lang=auto&imgBase=base64,";
+
+// 编码器与发送之间最多缓冲的压缩数据，上行慢时编码器在此处等待
+const size_t STREAM_PIPE_CAPACITY = 1024 * 1024;
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void completeResult(OcrResult& result, bool delivered, const HttpResponse& response,
+                    std::chrono::steady_clock::time_point start) {
+    result.latencyMs = elapsedMs(start);
+    result.status = response.status;
+    result.responseBytes = response.body.size();
+
+    if (!delivered) {
+        result.error = response.error;
+    } else if (response.status != 200) {
+        result.error = "HTTP " + std::to_string(response.status);
+    } else {
+        result.ok = true;
+        result.lines = ParseOcrLines(response.body);
+        result.text = JoinOcrLines(result.lines);
+    }
+}
+
+} // namespace
+
+const char OCR_REQUEST_HEADERS[] = "Content-Type: application/x-www-form-urlencoded\r\n";
+
+RequestBody BuildOcrRequestBody(const std::vector<unsigned char>& imageData) {
+    RequestBody body;
+    body.appendOwned(std::string(OCR_FORM_PREFIX));
+    body.appendBase64FormEncoded(imageData.data(), imageData.size());
+    return body;
+}
+
+namespace {
+
+// "x1,y1,x2,y2,..." 形式的顶点坐标，取外接矩形
+bool parseBoundingBox(const JsonText& text, OcrLine& line) {
+    int values[16];
+    size_t count = 0;
+    size_t i = 0;
+    while (i < text.size && count < 16) {
+        char c = text.data[i];
+        bool negative = c == '-';
+        size_t digits = negative ? i + 1 : i;
+        if (digits >= text.size || text.data[digits] < '0' || text.data[digits] > '9') {
+            i++;
+            continue;
+        }
+        int value = 0;
+        for (i = digits; i < text.size && text.data[i] >= '0' && text.data[i] <= '9'; ++i) {
+            value = value * 10 + (text.data[i] - '0');
+        }
+        values[count++] = negative ? -value : value;
+    }
+    if (count < 4 || count % 2 != 0) return false;
+    line.left = line.right = values[0];
+    line.top = line.bottom = values[1];
+    for (size_t k = 2; k < count; k += 2) {
+        line.left = (std::min)(line.left, values[k]);
+        line.right = (std::max)(line.right, values[k]);
+        line.top = (std::min)(line.top, values[k + 1]);
+        line.bottom = (std::max)(line.bottom, values[k + 1]);
+    }
+    line.hasBox = true;
+    return true;
+}
+
+} // namespace
+
+OcrResponseParser::OcrResponseParser()
+    : pendingField(FIELD_NONE), linesDepth(0), inLine(false), hasWords(false), failed(false) {}
+
+OcrResponseParser::OcrResponseParser(const char* data, size_t size)
+    : reader(data, size), pendingField(FIELD_NONE), linesDepth(0), inLine(false), hasWords(false), failed(false) {}
+
+void OcrResponseParser::feed(const char* data, size_t size) {
+    reader.feed(data, size);
+    drain();
+}
+
+bool OcrResponseParser::finish() {
+    reader.finish();
+    drain();
+    return !failed;
+}
+
+std::vector<OcrLine> OcrResponseParser::takeLines() {
+    std::vector<OcrLine> lines;
+    lines.swap(parsed);
+    return lines;
+}
+
+void OcrResponseParser::drain() {
+    for (;;) {
+        JsonToken token = reader.next();
+        Field field = pendingField;
+        pendingField = FIELD_NONE;
+        switch (token) {
+            case JSON_NEED_MORE:
+                // 键之后的值还没收到
+                pendingField = field;
+                return;
+            case JSON_END:
+                return;
+            case JSON_ERROR:
+                failed = true;
+                return;
+            case JSON_BEGIN_ARRAY:
+                if (inLine) {
+                    reader.skipContainer();
+                } else if (field == FIELD_LINES && linesDepth == 0) {
+                    linesDepth = reader.depth();
+                }
+                break;
+            case JSON_BEGIN_OBJECT:
+                if (inLine) {
+                    reader.skipContainer();
+                } else if (linesDepth > 0 && reader.depth() == linesDepth + 1) {
+                    inLine = true;
+                    hasWords = false;
+                    line.text.clear();
+                    line.hasBox = false;
+                }
+                break;
+            case JSON_END_OBJECT:
+                if (inLine && reader.depth() == linesDepth) {
+                    inLine = false;
+                    if (hasWords && !line.text.empty()) parsed.push_back(line);
+                }
+                break;
+            case JSON_END_ARRAY:
+                if (linesDepth > 0 && reader.depth() == linesDepth - 1) linesDepth = 0;
+                break;
+            case JSON_KEY: {
+                JsonText key = reader.text();
+                if (inLine) {
+                    if (key.equals("words")) pendingField = FIELD_WORDS;
+                    else if (key.equals("boundingBox")) pendingField = FIELD_BOX;
+                } else if (linesDepth == 0 && key.equals("lines")) {
+                    pendingField = FIELD_LINES;
+                }
+                break;
+            }
+            case JSON_STRING:
+                if (field == FIELD_WORDS) {
+                    JsonText value = reader.text();
+                    line.text.assign(value.data, value.size);
+                    hasWords = true;
+                } else if (field == FIELD_BOX) {
+                    parseBoundingBox(reader.text(), line);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+std::vector<OcrLine> ParseOcrLines(const std::string& response_data) {
+    OcrResponseParser parser(response_data.data(), response_data.size());
+    parser.finish();
+    return parser.takeLines();
+}
+
+std::string JoinOcrLines(const std::vector<OcrLine>& lines) {
+    std::string text;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (i > 0) text += " ";
+        text += lines[i].text;
+    }
+    return text;
+}
+
+std::string ParseOcrResponse(const std::string& response_data) {
+    return JoinOcrLines(ParseOcrLines(response_data));
+}
+
+OcrResult CallOcrEndpoint(HttpConnectionPool& pool, const HttpUrl& url, const std::vector<unsigned char>& imageData) {
+    OcrResult result;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    RequestBody body = BuildOcrRequestBody(imageData);
+    result.requestBytes = body.size();
+
+    HttpResponse response;
+    bool delivered = pool.post(url, OCR_REQUEST_HEADERS, body, response);
+    completeResult(result, delivered, response, start);
+    return result;
+}
+
+bool WriteOcrRequestStream(const ByteProducer& encodeImage, const RequestBody::Writer& write, size_t& bytesWritten) {
+    size_t prefixSize = std::strlen(OCR_FORM_PREFIX);
+    if (!write(OCR_FORM_PREFIX, prefixSize)) return false;
+    bytesWritten = prefixSize;
+
+    Base64FormStreamEncoder encoder;
+    std::string encoded;
+    bool ok = RunPipelined(encodeImage, STREAM_PIPE_CAPACITY,
+                           [&encoder, &encoded, &write, &bytesWritten](const unsigned char* data, size_t size) {
+                               encoded.clear();
+                               encoder.update(data, size, encoded);
+                               bytesWritten += encoded.size();
+                               return encoded.empty() || write(encoded.data(), encoded.size());
+                           });
+    if (!ok) return false;
+    encoded.clear();
+    encoder.finish(encoded);
+    bytesWritten += encoded.size();
+    return encoded.empty() || write(encoded.data(), encoded.size());
+}
+
+OcrResult CallOcrEndpointStreaming(HttpConnectionPool& pool, const HttpUrl& url, const ByteProducer& encodeImage) {
+    OcrResult result;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    BodyStream stream = [&encodeImage, &result](const RequestBody::Writer& write) {
+        return WriteOcrRequestStream(encodeImage, write, result.requestBytes);
+    };
+
+    HttpResponse response;
+    bool delivered = pool.postStream(url, OCR_REQUEST_HEADERS, -1, stream, response);
+    completeResult(result, delivered, response, start);
+    return result;
+}
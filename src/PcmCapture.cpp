@@ -0,0 +1,166 @@
+#include "../include/PcmCapture.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+
+namespace {
+
+const size_t CACHE_LINE = 64;
+
+size_t roundUp(size_t value, size_t unit) {
+    return (value + unit - 1) / unit * unit;
+}
+
+} // namespace
+
+PcmCapture::PcmCapture(size_t bufferCount, size_t bufferBytes, size_t maxBytes)
+    : count(bufferCount), bytesPerBuffer(bufferBytes), stride(roundUp(bufferBytes, CACHE_LINE)), maxBytes(maxBytes),
+      // 设备最多持有 count 个缓冲区，发布的编号不会超过 count 个，队列不会满
+      queue(bufferCount * 2), sleeping(false), stopping(false), published(0), requeued(0), wakeups(0),
+      callbackTotalNs(0), callbackMaxNs(0), callbacks(0), assembled(0), truncated(0), maxQueued(0) {
+    bufferStorage.resize(count * stride + CACHE_LINE);
+    uintptr_t base = reinterpret_cast<uintptr_t>(bufferStorage.data());
+    buffers = bufferStorage.data() + (roundUp(base, CACHE_LINE) - base);
+    // 整段录音的存储一次分配到位，之后的拼接不会重新分配、拷贝已录的数据
+    pcm.reserve(maxBytes);
+}
+
+PcmCapture::~PcmCapture() {
+    if (!consumer.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    consumer.join();
+}
+
+void PcmCapture::start(const PcmRecycler& recycler) {
+    if (consumer.joinable()) return;
+    recycle = recycler;
+    stopping = false;
+    consumer = std::thread(&PcmCapture::run, this);
+}
+
+void PcmCapture::publish(size_t index, size_t size) {
+    Filled filled;
+    filled.index = index;
+    filled.size = (std::min)(size, bytesPerBuffer);
+    queue.push(filled);
+    published.fetch_add(1, std::memory_order_release);
+    // 与消费线程的 sleeping 标志构成先写后读，唤醒不会丢失；消费线程醒着时回调不碰锁
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load()) {
+        wakeups.fetch_add(1, std::memory_order_relaxed);
+        // 取一次锁保证消费线程已进入等待；通知放在锁外，被唤醒的线程不会马上又阻塞在锁上
+        { std::lock_guard<std::mutex> lock(wakeMutex); }
+        wake.notify_one();
+    }
+}
+
+void PcmCapture::recordCallbackTime(std::chrono::steady_clock::time_point entered) {
+    long long ns = (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - entered).count();
+    callbacks.fetch_add(1, std::memory_order_relaxed);
+    callbackTotalNs.fetch_add(ns, std::memory_order_relaxed);
+    long long previous = callbackMaxNs.load(std::memory_order_relaxed);
+    while (ns > previous && !callbackMaxNs.compare_exchange_weak(previous, ns, std::memory_order_relaxed)) {
+    }
+}
+
+long PcmCapture::drain() {
+    long popped = 0;
+    Filled filled;
+    while (queue.pop(filled)) {
+        popped++;
+        size_t room = maxBytes - pcm.size();
+        size_t take = (std::min)(filled.size, room);
+        const char* data = buffer(filled.index);
+        pcm.insert(pcm.end(), data, data + take);
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            assembled += (long long)take;
+            truncated += (long long)(filled.size - take);
+        }
+        // 存储已满（超过最长录音时间）后监听者仍收到完整的录音：交还之前直接用设备缓冲区通知
+        bool full = take < filled.size;
+        if (listener && full) listener(data, filled.size);
+        // 数据已取走才把缓冲区交还设备；停止录音后不再交还。
+        // 先计数再交还：finish 看到的设备持有数只会偏大，不会在缓冲区还没交回时提前结束
+        requeued.fetch_add(1, std::memory_order_release);
+        if (!recycle || !recycle(filled.index)) requeued.fetch_sub(1, std::memory_order_release);
+        // 缓冲区交还之后再通知，处理较慢时也不耽误设备继续录音
+        if (listener && !full && take > 0) listener(pcm.data() + pcm.size() - take, take);
+    }
+    return popped;
+}
+
+void PcmCapture::run() {
+    long consumed = 0;
+    for (;;) {
+        long ready = published.load(std::memory_order_acquire);
+        if (ready > consumed) {
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                maxQueued = (std::max)(maxQueued, (size_t)(ready - consumed));
+            }
+            consumed += drain();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        if (stopping) break;
+        sleeping = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // 超时只是保险，正常情况下由回调唤醒
+        if (queue.empty()) wake.wait_for(lock, std::chrono::milliseconds(100));
+        sleeping = false;
+    }
+    drain();
+}
+
+std::vector<char> PcmCapture::finish(int timeoutMs) {
+    // 停止录音后设备会把所有缓冲区（包括只录了一部分的）交回，等它们都发布出来
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (published.load(std::memory_order_acquire) < (long)count + requeued.load(std::memory_order_acquire) &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (consumer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        consumer.join();
+    } else {
+        drain();
+    }
+    return std::move(pcm);
+}
+
+PcmCaptureStats PcmCapture::stats() const {
+    PcmCaptureStats stats;
+    stats.buffers = published.load();
+    stats.wakeups = wakeups.load();
+    long measured = callbacks.load();
+    if (measured > 0) {
+        stats.callbackMeanUs = callbackTotalNs.load() / 1000.0 / measured;
+        stats.callbackMaxUs = callbackMaxNs.load() / 1000.0;
+    }
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.truncatedBytes = truncated;
+    stats.bytes = assembled;
+    stats.maxQueued = maxQueued;
+    return stats;
+}
+
+std::string DescribePcmCaptureStats(const PcmCaptureStats& stats) {
+    char line[200];
+    std::snprintf(line, sizeof(line),
+                  "[audio] buffers=%ld bytes=%lld truncated=%lld wakeups=%ld max queued=%lu "
+                  "callback mean/max=%.1f/%.1f us",
+                  stats.buffers, stats.bytes, stats.truncatedBytes, stats.wakeups, (unsigned long)stats.maxQueued,
+                  stats.callbackMeanUs, stats.callbackMaxUs);
+    return line;
+}
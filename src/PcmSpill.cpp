@@ -0,0 +1,168 @@
+#include "../include/PcmSpill.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#if defined(_WIN32)
+std::wstring widePath(const std::string& path) {
+    int size = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), (int)path.length(), nullptr, 0);
+    std::wstring wide(size, 0);
+    if (size > 0) MultiByteToWideChar(CP_UTF8, 0, path.c_str(), (int)path.length(), &wide[0], size);
+    return wide;
+}
+
+// 按偏移读写，不移动文件指针，多个线程可同时调用
+bool writeAt(HANDLE file, unsigned long long offset, const char* data, size_t size) {
+    while (size > 0) {
+        OVERLAPPED position = {};
+        position.Offset = (DWORD)offset;
+        position.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : (DWORD)size;
+        DWORD written = 0;
+        if (!WriteFile(file, data, chunk, &written, &position) || written == 0) return false;
+        data += written;
+        size -= written;
+        offset += written;
+    }
+    return true;
+}
+
+bool readAt(HANDLE file, unsigned long long offset, char* data, size_t size) {
+    while (size > 0) {
+        OVERLAPPED position = {};
+        position.Offset = (DWORD)offset;
+        position.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : (DWORD)size;
+        DWORD read = 0;
+        if (!ReadFile(file, data, chunk, &read, &position) || read == 0) return false;
+        data += read;
+        size -= read;
+        offset += read;
+    }
+    return true;
+}
+#else
+bool writeAt(int fd, unsigned long long offset, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = pwrite(fd, data, size, (off_t)offset);
+        if (written <= 0) return false;
+        data += written;
+        size -= (size_t)written;
+        offset += (unsigned long long)written;
+    }
+    return true;
+}
+
+bool readAt(int fd, unsigned long long offset, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t read = pread(fd, data, size, (off_t)offset);
+        if (read <= 0) return false;
+        data += read;
+        size -= (size_t)read;
+        offset += (unsigned long long)read;
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+#if defined(_WIN32)
+PcmSpill::PcmSpill() : end(0), file(INVALID_HANDLE_VALUE) {
+}
+
+bool PcmSpill::open(const std::string& path) {
+    close();
+    // 临时属性让系统尽量只在缓存中保留；关闭句柄（含进程异常退出）时删除
+    file = CreateFileW(widePath(path).c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                       FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    return file != INVALID_HANDLE_VALUE;
+}
+
+bool PcmSpill::isOpen() const {
+    return file != INVALID_HANDLE_VALUE;
+}
+
+void PcmSpill::close() {
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+    extents.clear();
+    end = 0;
+}
+#else
+PcmSpill::PcmSpill() : end(0), fd(-1) {
+}
+
+bool PcmSpill::open(const std::string& path) {
+    close();
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) return false;
+    // 打开后立即删除目录项，文件随描述符关闭而释放
+    unlink(path.c_str());
+    return true;
+}
+
+bool PcmSpill::isOpen() const {
+    return fd >= 0;
+}
+
+void PcmSpill::close() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    extents.clear();
+    end = 0;
+}
+#endif
+
+PcmSpill::~PcmSpill() {
+    close();
+}
+
+bool PcmSpill::write(const std::vector<char>& pcm, size_t& index) {
+    if (!isOpen()) return false;
+    unsigned long long offset;
+    {
+        // 先占下位置再写，各段的写入互不等待
+        std::lock_guard<std::mutex> lock(mutex);
+        offset = end;
+        end += pcm.size();
+    }
+#if defined(_WIN32)
+    bool ok = writeAt(file, offset, pcm.data(), pcm.size());
+#else
+    bool ok = writeAt(fd, offset, pcm.data(), pcm.size());
+#endif
+    if (!ok) return false;
+    std::lock_guard<std::mutex> lock(mutex);
+    index = extents.size();
+    Extent extent = {offset, pcm.size()};
+    extents.push_back(extent);
+    return true;
+}
+
+bool PcmSpill::read(size_t index, std::vector<char>& pcm) {
+    Extent extent;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (index >= extents.size()) return false;
+        extent = extents[index];
+    }
+    pcm.resize(extent.size);
+#if defined(_WIN32)
+    return readAt(file, extent.offset, pcm.data(), extent.size);
+#else
+    return readAt(fd, extent.offset, pcm.data(), extent.size);
+#endif
+}
+
+unsigned long long PcmSpill::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return end;
+}
@@ -0,0 +1,302 @@
+#include "../include/PngEncoder.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+struct Crc32Table {
+    uint32_t values[256];
+
+    Crc32Table() {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            values[n] = c;
+        }
+    }
+};
+
+uint32_t updateCrc32(uint32_t crc, const unsigned char* data, size_t size) {
+    static const Crc32Table table;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+void appendUint32(std::vector<unsigned char>& out, uint32_t value) {
+    out.push_back((unsigned char)(value >> 24));
+    out.push_back((unsigned char)(value >> 16));
+    out.push_back((unsigned char)(value >> 8));
+    out.push_back((unsigned char)value);
+}
+
+DeflateLevel toDeflateLevel(PngLevel level) {
+    switch (level) {
+        case PngLevel::Fastest: return DeflateLevel::Fastest;
+        case PngLevel::Default: return DeflateLevel::Default;
+        case PngLevel::Best: return DeflateLevel::Best;
+        default: return DeflateLevel::Fast;
+    }
+}
+
+int channelCount(PngColorType colorType) {
+    switch (colorType) {
+        case PngColorType::Rgb: return 3;
+        case PngColorType::RgbAlpha: return 4;
+        default: return 1;
+    }
+}
+
+inline unsigned char paethPredictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return (unsigned char)a;
+    if (pb <= pc) return (unsigned char)b;
+    return (unsigned char)c;
+}
+
+enum FilterType {
+    FILTER_NONE = 0,
+    FILTER_SUB = 1,
+    FILTER_UP = 2,
+    FILTER_AVERAGE = 3,
+    FILTER_PAETH = 4
+};
+
+} // namespace
+
+PngEncoder::PngEncoder(const PngOptions& options, Sink sink)
+    : options(options), sink(sink),
+      deflater(toDeflateLevel(options.level), [this](const unsigned char* data, size_t size) {
+          idat.insert(idat.end(), data, data + size);
+          if (idat.size() >= this->options.idatChunkSize) flushIdat();
+      }),
+      height(0), rowsWritten(0), rowSize(0), bytesPerPixel(1), adaptiveFilter(false) {
+}
+
+void PngEncoder::begin(int width, int height, PngColorType colorType, int bitDepth,
+                       const std::vector<uint32_t>& palette) {
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    sink(signature, sizeof(signature));
+
+    this->height = height;
+    rowsWritten = 0;
+
+    int channels = channelCount(colorType);
+    rowSize = ((size_t)width * channels * bitDepth + 7) / 8;
+    bytesPerPixel = (size_t)(channels * bitDepth / 8);
+    if (bytesPerPixel == 0) bytesPerPixel = 1;
+
+    // 调色板与低位深图像按规范建议不做自适应滤波
+    adaptiveFilter = options.level != PngLevel::Fastest && colorType != PngColorType::Palette && bitDepth >= 8;
+
+    std::vector<unsigned char> header;
+    appendUint32(header, (uint32_t)width);
+    appendUint32(header, (uint32_t)height);
+    header.push_back((unsigned char)bitDepth);
+    header.push_back((unsigned char)colorType);
+    header.push_back(0); // deflate
+    header.push_back(0); // 自适应滤波
+    header.push_back(0); // 不隔行
+    writeChunk("IHDR", header.data(), header.size());
+
+    if (colorType == PngColorType::Palette) {
+        std::vector<unsigned char> plte;
+        for (size_t i = 0; i < palette.size(); ++i) {
+            plte.push_back((unsigned char)(palette[i] >> 16));
+            plte.push_back((unsigned char)(palette[i] >> 8));
+            plte.push_back((unsigned char)palette[i]);
+        }
+        writeChunk("PLTE", plte.data(), plte.size());
+    }
+
+    previousRow.assign(rowSize, 0);
+    for (int f = 0; f < 5; ++f) {
+        filtered[f].assign(rowSize + 1, 0);
+        filtered[f][0] = (unsigned char)f;
+    }
+    deflater.setRowDistance(rowSize + 1);
+}
+
+int PngEncoder::chooseFilter(const unsigned char* row) {
+    const unsigned char* prior = previousRow.data();
+    bool sameAsPrevious = rowsWritten > 0 && memcmp(row, prior, rowSize) == 0;
+
+    if (sameAsPrevious) {
+        // 与上一行完全相同（截图背景中很常见），Up 滤波得到全 0
+        memset(&filtered[FILTER_UP][1], 0, rowSize);
+        return FILTER_UP;
+    }
+
+    if (!adaptiveFilter) {
+        if (options.level == PngLevel::Fastest && bytesPerPixel > 1) {
+            unsigned char* sub = &filtered[FILTER_SUB][1];
+            for (size_t i = 0; i < rowSize; ++i) {
+                sub[i] = (unsigned char)(row[i] - (i >= bytesPerPixel ? row[i - bytesPerPixel] : 0));
+            }
+            return FILTER_SUB;
+        }
+        memcpy(&filtered[FILTER_NONE][1], row, rowSize);
+        return FILTER_NONE;
+    }
+
+    // 逐个滤波计算结果，并以有符号绝对值之和作为代价（libpng 的经典启发式）
+    unsigned char* none = &filtered[FILTER_NONE][1];
+    unsigned char* sub = &filtered[FILTER_SUB][1];
+    unsigned char* up = &filtered[FILTER_UP][1];
+    unsigned char* avg = &filtered[FILTER_AVERAGE][1];
+    unsigned char* paeth = &filtered[FILTER_PAETH][1];
+    unsigned long cost[5] = {0, 0, 0, 0, 0};
+
+    for (size_t i = 0; i < rowSize; ++i) {
+        int x = row[i];
+        int a = i >= bytesPerPixel ? row[i - bytesPerPixel] : 0;
+        int b = prior[i];
+        int c = i >= bytesPerPixel ? prior[i - bytesPerPixel] : 0;
+
+        none[i] = (unsigned char)x;
+        sub[i] = (unsigned char)(x - a);
+        up[i] = (unsigned char)(x - b);
+        avg[i] = (unsigned char)(x - ((a + b) >> 1));
+        paeth[i] = (unsigned char)(x - paethPredictor(a, b, c));
+
+        cost[0] += std::abs((int)(signed char)none[i]);
+        cost[1] += std::abs((int)(signed char)sub[i]);
+        cost[2] += std::abs((int)(signed char)up[i]);
+        cost[3] += std::abs((int)(signed char)avg[i]);
+        cost[4] += std::abs((int)(signed char)paeth[i]);
+    }
+
+    int best = 0;
+    for (int f = 1; f < 5; ++f) {
+        if (cost[f] < cost[best]) best = f;
+    }
+    return best;
+}
+
+void PngEncoder::writeRow(const unsigned char* row) {
+    if (rowsWritten >= height) return;
+
+    int filter = chooseFilter(row);
+    deflater.write(filtered[filter].data(), rowSize + 1);
+
+    memcpy(previousRow.data(), row, rowSize);
+    rowsWritten++;
+}
+
+void PngEncoder::finish() {
+    // 行数不足时补空行，保证输出仍是合法 PNG
+    if (rowsWritten < height) {
+        std::vector<unsigned char> blank(rowSize, 0);
+        while (rowsWritten < height) {
+            writeRow(blank.data());
+        }
+    }
+
+    deflater.finish();
+    flushIdat();
+    writeChunk("IEND", nullptr, 0);
+}
+
+void PngEncoder::flushIdat() {
+    if (idat.empty()) return;
+    writeChunk("IDAT", idat.data(), idat.size());
+    idat.clear();
+}
+
+void PngEncoder::writeChunk(const char* type, const unsigned char* data, size_t size) {
+    unsigned char header[8] = {
+        (unsigned char)(size >> 24), (unsigned char)(size >> 16), (unsigned char)(size >> 8), (unsigned char)size,
+        (unsigned char)type[0], (unsigned char)type[1], (unsigned char)type[2], (unsigned char)type[3]
+    };
+    uint32_t crc = updateCrc32(0xFFFFFFFFu, header + 4, 4);
+    if (size > 0) {
+        crc = updateCrc32(crc, data, size);
+    }
+    crc ^= 0xFFFFFFFFu;
+    unsigned char trailer[4] = {
+        (unsigned char)(crc >> 24), (unsigned char)(crc >> 16), (unsigned char)(crc >> 8), (unsigned char)crc
+    };
+
+    sink(header, sizeof(header));
+    if (size > 0) {
+        sink(data, size);
+    }
+    sink(trailer, sizeof(trailer));
+}
+
+bool EncodePngBgra(const unsigned char* bgra, int width, int height, int stride,
+                   const PngOptions& options, std::vector<unsigned char>& out) {
+    out.clear();
+    return EncodePngBgra(bgra, width, height, stride, options, [&out](const unsigned char* data, size_t size) {
+        out.insert(out.end(), data, data + size);
+    });
+}
+
+bool EncodePngBgra(const unsigned char* bgra, int width, int height, int stride,
+                   const PngOptions& options, const PngEncoder::Sink& sink) {
+    if (!bgra || width <= 0 || height <= 0) return false;
+
+    PngEncoder encoder(options, sink);
+    encoder.begin(width, height, PngColorType::Rgb, 8);
+
+    std::vector<unsigned char> rgb((size_t)width * 3);
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* src = bgra + (size_t)y * stride;
+        unsigned char* dst = rgb.data();
+        for (int x = 0; x < width; ++x) {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+            src += 4;
+            dst += 3;
+        }
+        encoder.writeRow(rgb.data());
+    }
+
+    encoder.finish();
+    return true;
+}
+
+bool EncodePngIndexed(const unsigned char* indices, int width, int height, const std::vector<uint32_t>& palette,
+                      const PngOptions& options, std::vector<unsigned char>& out) {
+    out.clear();
+    return EncodePngIndexed(indices, width, height, palette, options, [&out](const unsigned char* data, size_t size) {
+        out.insert(out.end(), data, data + size);
+    });
+}
+
+bool EncodePngIndexed(const unsigned char* indices, int width, int height, const std::vector<uint32_t>& palette,
+                      const PngOptions& options, const PngEncoder::Sink& sink) {
+    if (!indices || width <= 0 || height <= 0 || palette.empty() || palette.size() > 256) return false;
+
+    int bitDepth = palette.size() <= 2 ? 1 : palette.size() <= 4 ? 2 : palette.size() <= 16 ? 4 : 8;
+    int pixelsPerByte = 8 / bitDepth;
+
+    PngEncoder encoder(options, sink);
+    encoder.begin(width, height, PngColorType::Palette, bitDepth, palette);
+
+    std::vector<unsigned char> row(encoder.rowBytes());
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* src = indices + (size_t)y * width;
+        if (bitDepth == 8) {
+            memcpy(row.data(), src, width);
+        } else {
+            std::fill(row.begin(), row.end(), 0);
+            for (int x = 0; x < width; ++x) {
+                int shift = 8 - bitDepth * (x % pixelsPerByte + 1);
+                row[x / pixelsPerByte] |= (unsigned char)(src[x] << shift);
+            }
+        }
+        encoder.writeRow(row.data());
+    }
+
+    encoder.finish();
+    return true;
+}
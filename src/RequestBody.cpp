@@ -0,0 +1,131 @@
+#include "../include/RequestBody.h"
+#include "../include/FormEncoder.h"
+#include <cstring>
+
+namespace {
+
+// 小于此值的片段先复制进暂存缓冲区，与相邻片段合并后再写出
+const size_t STAGING_SIZE = 16 * 1024;
+
+// 编码片段每次处理的输入字节数，必须是 3 的倍数，保证分块结果与整体编码一致
+const size_t ENCODE_CHUNK = 48 * 1024;
+
+class StagedWriter {
+public:
+    explicit StagedWriter(const RequestBody::Writer& writer) : writer(writer), used(0), ok(true) {
+        staging.resize(STAGING_SIZE);
+    }
+
+    void write(const char* data, size_t size) {
+        if (!ok || size == 0) return;
+        if (used + size <= STAGING_SIZE) {
+            memcpy(&staging[used], data, size);
+            used += size;
+            return;
+        }
+        flush();
+        if (size < STAGING_SIZE) {
+            memcpy(&staging[0], data, size);
+            used = size;
+        } else if (ok) {
+            ok = writer(data, size);
+        }
+    }
+
+    void flush() {
+        if (ok && used > 0) ok = writer(staging.data(), used);
+        used = 0;
+    }
+
+    bool succeeded() const { return ok; }
+
+private:
+    const RequestBody::Writer& writer;
+    std::vector<char> staging;
+    size_t used;
+    bool ok;
+};
+
+} // namespace
+
+RequestBody::RequestBody() : totalSize(0) {
+}
+
+void RequestBody::appendBorrowed(const void* data, size_t size) {
+    Span span;
+    span.kind = SPAN_BORROWED;
+    span.data = static_cast<const char*>(data);
+    span.size = size;
+    span.outputSize = size;
+    totalSize += size;
+    spans.push_back(std::move(span));
+}
+
+void RequestBody::appendOwned(const std::string& data) {
+    appendOwned(std::string(data));
+}
+
+void RequestBody::appendOwned(std::string&& data) {
+    Span span;
+    span.kind = SPAN_OWNED;
+    span.data = nullptr;
+    span.size = data.size();
+    span.outputSize = data.size();
+    span.owned = std::move(data);
+    totalSize += span.outputSize;
+    spans.push_back(std::move(span));
+}
+
+void RequestBody::appendBase64FormEncoded(const unsigned char* data, size_t size) {
+    Span span;
+    span.kind = SPAN_BASE64_FORM;
+    span.data = reinterpret_cast<const char*>(data);
+    span.size = size;
+    span.outputSize = Base64FormEncodedLength(data, size);
+    totalSize += span.outputSize;
+    spans.push_back(std::move(span));
+}
+
+bool RequestBody::writeTo(const Writer& writer) const {
+    StagedWriter out(writer);
+    std::vector<char> encoded;
+
+    for (size_t i = 0; i < spans.size() && out.succeeded(); ++i) {
+        const Span& span = spans[i];
+        switch (span.kind) {
+            case SPAN_BORROWED:
+                out.write(span.data, span.size);
+                break;
+
+            case SPAN_OWNED:
+                out.write(span.owned.data(), span.owned.size());
+                break;
+
+            case SPAN_BASE64_FORM: {
+                // 编码缓冲区按一个分块输出的上限分配一次（每 3 字节最多 4 个字符，每字符最多 3 字节，
+                // 另加结尾补齐的一组），按编码器返回的结束位置写出，不再预先计算长度
+                const unsigned char* source = reinterpret_cast<const unsigned char*>(span.data);
+                if (encoded.empty()) encoded.resize(ENCODE_CHUNK / 3 * 4 * 3 + 12);
+                for (size_t offset = 0; offset < span.size && out.succeeded(); offset += ENCODE_CHUNK) {
+                    size_t chunk = span.size - offset < ENCODE_CHUNK ? span.size - offset : ENCODE_CHUNK;
+                    char* end = WriteBase64FormEncoded(source + offset, chunk, encoded.data());
+                    out.write(encoded.data(), (size_t)(end - encoded.data()));
+                }
+                break;
+            }
+        }
+    }
+
+    out.flush();
+    return out.succeeded();
+}
+
+std::string RequestBody::toString() const {
+    std::string result;
+    result.reserve(totalSize);
+    writeTo([&result](const char* data, size_t size) {
+        result.append(data, size);
+        return true;
+    });
+    return result;
+}
@@ -0,0 +1,33 @@
+#include "../include/RequestCancel.h"
+
+void RequestCancel::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (flag) return;
+    flag = true;
+    // 在锁内执行：removeAction() 返回后动作不会再运行，调用方可以放心释放资源
+    for (std::map<int, std::function<void()> >::iterator it = actions.begin(); it != actions.end(); ++it) {
+        it->second();
+    }
+    actions.clear();
+}
+
+bool RequestCancel::cancelled() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return flag;
+}
+
+int RequestCancel::addAction(const std::function<void()>& action) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (flag) {
+        action();
+        return 0;
+    }
+    int id = nextId++;
+    actions[id] = action;
+    return id;
+}
+
+bool RequestCancel::removeAction(int id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return actions.erase(id) > 0;
+}
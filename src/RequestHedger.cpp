@@ -0,0 +1,223 @@
+#include "../include/RequestHedger.h"
+#include "../include/Executor.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double elapsedMs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// 一次请求的两个尝试共享的状态；运行副本的池任务持有它的共享所有权，run() 返回后仍可安全收尾
+struct HedgeRace {
+    std::mutex mutex;
+    std::condition_variable changed;
+    int launched;
+    int finished;
+    int winner;
+    bool aborted;           // 调用方取消
+    std::string result;
+    RequestCancel cancels[2];
+    bool done[2];
+    Clock::time_point started[2];
+    Clock::time_point ended[2];
+    std::vector<double> censored;   // 被取消一方取消时已等待的时长
+
+    HedgeRace() : launched(0), finished(0), winner(-1), aborted(false) {
+        done[0] = done[1] = false;
+    }
+
+    bool settled() const { return winner >= 0 || finished == launched || aborted; }
+
+    void abort() {
+        std::lock_guard<std::mutex> lock(mutex);
+        aborted = true;
+        for (int i = 0; i < launched; ++i) {
+            if (!done[i]) cancels[i].cancel();
+        }
+        changed.notify_all();
+    }
+};
+
+// 调用方持有 race->mutex
+void beginAttempt(HedgeRace& race, int index) {
+    race.started[index] = Clock::now();
+    race.launched++;
+}
+
+// 在当前线程运行一次尝试。先得到有效结果的一方立即取消另一方：原请求在 run() 的线程上运行，
+// 副本获胜时要中断它 run() 才能返回
+void runAttempt(const std::shared_ptr<HedgeRace>& race, const HedgedAttempt& attempt, int index) {
+    std::string out;
+    bool ok = attempt(index, race->cancels[index], out);
+    std::lock_guard<std::mutex> lock(race->mutex);
+    race->finished++;
+    race->done[index] = true;
+    race->ended[index] = Clock::now();
+    if (ok && race->winner < 0) {
+        race->winner = index;
+        race->result.swap(out);
+        for (int i = 0; i < race->launched; ++i) {
+            if (race->done[i] || race->aborted) continue;
+            race->cancels[i].cancel();
+            race->censored.push_back(elapsedMs(race->started[i], race->ended[index]));
+        }
+    }
+    race->changed.notify_all();
+}
+
+double percentileOf(const std::vector<double>& values, double p) {
+    if (values.empty()) return 0;
+    std::vector<double> sorted(values);
+    size_t index = (std::min)(sorted.size() - 1, (size_t)(p * sorted.size()));
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+} // namespace
+
+RequestHedger::RequestHedger(const HedgeOptions& options) : options(options), attemptNext(0), requestNext(0) {
+}
+
+bool RequestHedger::isEnabled() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return options.enabled;
+}
+
+void RequestHedger::setEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex);
+    options.enabled = enabled;
+}
+
+int RequestHedger::delayMs() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return delayLocked();
+}
+
+int RequestHedger::delayLocked() const {
+    if ((int)attemptLatencies.size() < options.minSamples) return options.initialDelayMs;
+    int delay = (int)percentileOf(attemptLatencies, options.percentile);
+    return (std::max)(options.minDelayMs, (std::min)(options.maxDelayMs, delay));
+}
+
+void RequestHedger::record(std::vector<double>& ring, size_t& next, double ms) {
+    if (options.window <= 0) return;
+    if ((int)ring.size() < options.window) {
+        ring.push_back(ms);
+    } else {
+        ring[next] = ms;
+        next = (next + 1) % ring.size();
+    }
+}
+
+bool RequestHedger::run(const HedgedAttempt& attempt, std::string& result, RequestCancel* cancel) {
+    bool enabled;
+    int delay;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.requests++;
+        enabled = options.enabled;
+        delay = delayLocked();
+    }
+
+    // 调用方的取消动作会锁 race->mutex，登记与注销都在持有它之外进行
+    std::shared_ptr<HedgeRace> race = std::make_shared<HedgeRace>();
+    int cancelId = 0;
+    if (cancel) {
+        cancelId = cancel->addAction([race]() { race->abort(); });
+        if (!cancelId) {
+            std::lock_guard<std::mutex> lock(mutex);
+            counters.aborted++;
+            return false;
+        }
+    }
+    Clock::time_point start = Clock::now();
+    {
+        std::lock_guard<std::mutex> raceLock(race->mutex);
+        beginAttempt(*race, 0);
+    }
+
+    // 原请求在调用线程上运行，不另开线程；副本由 I/O 池中的任务等到时间后发出并在该任务中运行。
+    // 池已满时放弃副本。任务只在 run() 等待结果期间（race 未结束）使用 this
+    if (enabled) {
+        Clock::time_point deadline = start + std::chrono::milliseconds(delay);
+        SharedExecutor().io().trySubmit([this, race, attempt, deadline]() {
+            std::unique_lock<std::mutex> raceLock(race->mutex);
+            race->changed.wait_until(raceLock, deadline, [&race]() { return race->settled(); });
+            if (race->settled() || !reserveHedge()) return;
+            beginAttempt(*race, 1);
+            raceLock.unlock();
+            runAttempt(race, attempt, 1);
+        });
+    }
+    runAttempt(race, attempt, 0);
+
+    std::unique_lock<std::mutex> raceLock(race->mutex);
+    race->changed.wait(raceLock, [&race]() { return race->settled(); });
+    Clock::time_point end = Clock::now();
+
+    // 落败的一方已在对方获胜时取消并记下等待时长；调用方取消时仍在收尾的副本不计入统计
+    int winner = race->winner;
+    bool aborted = race->aborted;
+    std::vector<double> censored;
+    censored.swap(race->censored);
+    double winnerMs = winner >= 0 ? elapsedMs(race->started[winner], race->ended[winner]) : 0;
+    if (winner >= 0) result.swap(race->result);
+    raceLock.unlock();
+    if (cancel) cancel->removeAction(cancelId);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (aborted && winner < 0) {
+        counters.aborted++;
+        return false;
+    }
+    counters.cancelled += (long)censored.size();
+    for (size_t i = 0; i < censored.size(); ++i) record(attemptLatencies, attemptNext, censored[i]);
+    if (winner < 0) {
+        counters.failed++;
+        return false;
+    }
+    if (winner == 1) counters.hedgeWins++;
+    record(attemptLatencies, attemptNext, winnerMs);
+    record(requestLatencies, requestNext, elapsedMs(start, end));
+    return true;
+}
+
+bool RequestHedger::reserveHedge() {
+    std::lock_guard<std::mutex> lock(mutex);
+    bool allowed = counters.hedged < options.maxHedgeRatio * counters.requests + 1;
+    if (allowed) counters.hedged++;
+    else counters.budgetSkipped++;
+    return allowed;
+}
+
+HedgeStats RequestHedger::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    HedgeStats stats = counters;
+    stats.delayMs = delayLocked();
+    stats.attemptP50Ms = percentileOf(attemptLatencies, 0.5);
+    stats.attemptP90Ms = percentileOf(attemptLatencies, 0.9);
+    stats.attemptP99Ms = percentileOf(attemptLatencies, 0.99);
+    stats.requestP50Ms = percentileOf(requestLatencies, 0.5);
+    stats.requestP90Ms = percentileOf(requestLatencies, 0.9);
+    stats.requestP99Ms = percentileOf(requestLatencies, 0.99);
+    return stats;
+}
+
+std::string DescribeHedgeStats(const HedgeStats& stats) {
+    char line[320];
+    double rate = stats.requests > 0 ? 100.0 * stats.hedged / stats.requests : 0.0;
+    std::snprintf(line, sizeof(line),
+                  "[hedge] requests=%ld hedge_rate=%.1f%% (hedged=%ld wins=%ld cancelled=%ld skipped=%ld) failed=%ld "
+                  "aborted=%ld delay=%d ms attempt p50/p90/p99=%.0f/%.0f/%.0f ms request p50/p90/p99=%.0f/%.0f/%.0f ms",
+                  stats.requests, rate, stats.hedged, stats.hedgeWins, stats.cancelled, stats.budgetSkipped,
+                  stats.failed, stats.aborted, stats.delayMs, stats.attemptP50Ms, stats.attemptP90Ms,
+                  stats.attemptP99Ms, stats.requestP50Ms, stats.requestP90Ms, stats.requestP99Ms);
+    return line;
+}
@@ -1,6 +1,11 @@
 #include "../include/ScreenCapture.h"
 #include "../include/AppManager.h"
 #include "../include/StringUtils.h"
+#include "../include/HttpUpload.h"
+#include "../include/OcrClient.h"
+#include "../include/OcrCache.h"
+#include "../include/GdiGlyphFont.h"
+#include "../include/Executor.h"
 #include <thread>
 #include <gdiplus.h>
 #include <wininet.h>
@@ -11,6 +16,8 @@
 #include <windowsx.h>
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <utility>
 
 // 链接库只在 MSVC 编译器下有效
 #ifdef _MSC_VER
@@ -19,17 +26,128 @@
 #pragma comment(lib, "shlwapi.lib")
 #endif
 
+namespace {
+
+// 达到该像素数的截图边编码边上传
+const long long STREAM_UPLOAD_MIN_PIXELS = 1000 * 1000;
+// 流式上传时 IDAT 块取小一些，压缩数据更早交给发送线程
+const size_t STREAM_IDAT_CHUNK_SIZE = 16 * 1024;
+
+// 识别任务各阶段的时限（毫秒），超过即取消任务。上传阶段含对冲副本与分块识别的全部请求
+const int CAPTURE_DEADLINE_MS = 3000;
+const int LOCAL_OCR_DEADLINE_MS = 2000;
+const int ENCODE_DEADLINE_MS = 10000;
+const int UPLOAD_DEADLINE_MS = 30000;
+
+// 识别结果缓存的持久化文件：%LOCALAPPDATA%\ShotOcr\ocr-cache.bin，取不到目录时不持久化
+std::string ocrCachePath() {
+    wchar_t buffer[MAX_PATH];
+    DWORD length = GetEnvironmentVariableW(L"LOCALAPPDATA", buffer, MAX_PATH);
+    if (length == 0 || length >= MAX_PATH) return std::string();
+    std::wstring directory = std::wstring(buffer) + L"\\ShotOcr";
+    CreateDirectoryW(directory.c_str(), nullptr);
+    return WideToUtf8(directory + L"\\ocr-cache.bin");
+}
+
+// 本地识别的模板：常见界面与代码字体，覆盖 100%~200% 缩放下的常用字号
+void loadLocalOcrTemplates(LocalOcr& localOcr) {
+    struct Face {
+        const wchar_t* face;
+        const char* name;
+    };
+    const Face faces[] = {
+        {L"Segoe UI", "Segoe UI"},
+        {L"Microsoft YaHei UI", "Microsoft YaHei UI"},
+        {L"Consolas", "Consolas"},
+        {L"Tahoma", "Tahoma"},
+        {L"Arial", "Arial"},
+        {L"Courier New", "Courier New"},
+    };
+    const int sizes[] = {11, 12, 13, 14, 15, 16, 17, 18, 20, 22, 24, 28, 32};
+    for (const Face& face : faces) {
+        for (int size : sizes) {
+            GlyphFont font;
+            if (!RenderGdiGlyphFont(face.face, size, face.name, font)) break;
+            localOcr.addFont(font);
+        }
+    }
+}
+
+// 照片类截图交给 GDI+ 编码 JPEG（GdiplusStartup 已在 AppManager 中调用）
+bool encodeJpegGdiplus(const unsigned char* bgra, int width, int height, int stride, int quality,
+                       std::vector<unsigned char>& out) {
+    Gdiplus::Bitmap bitmap(width, height, stride, PixelFormat32bppRGB, const_cast<BYTE*>(bgra));
+    if (bitmap.GetLastStatus() != Gdiplus::Ok) return false;
+    
+    CLSID jpegClsid;
+    CLSIDFromString(L"{557CF401-1A04-11D3-9A73-0000F81EF32E}", &jpegClsid);
+    
+    ULONG qualityValue = (ULONG)quality;
+    Gdiplus::EncoderParameters parameters;
+    parameters.Count = 1;
+    parameters.Parameter[0].Guid = Gdiplus::EncoderQuality;
+    parameters.Parameter[0].Type = Gdiplus::EncoderParameterValueTypeLong;
+    parameters.Parameter[0].NumberOfValues = 1;
+    parameters.Parameter[0].Value = &qualityValue;
+    
+    IStream* stream = nullptr;
+    if (CreateStreamOnHGlobal(nullptr, TRUE, &stream) != S_OK) return false;
+    
+    bool ok = bitmap.Save(stream, &jpegClsid, &parameters) == Gdiplus::Ok;
+    if (ok) {
+        HGLOBAL memory = nullptr;
+        GetHGlobalFromStream(stream, &memory);
+        STATSTG stat = {};
+        stream->Stat(&stat, STATFLAG_NONAME);
+        const unsigned char* data = static_cast<const unsigned char*>(GlobalLock(memory));
+        ok = data != nullptr;
+        if (ok) {
+            out.assign(data, data + (size_t)stat.cbSize.QuadPart);
+            GlobalUnlock(memory);
+        }
+    }
+    stream->Release();
+    return ok;
+}
+
+} // namespace
+
 ScreenCapture::ScreenCapture(AppManager* app) 
     : appManager(app), overlayWindow(nullptr),
-      startX(0), startY(0), endX(0), endY(0), dragging(false), windowCreated(false) {
+      startX(0), startY(0), endX(0), endY(0), dragging(false), windowCreated(false),
+      ocrJobs(&SharedExecutor().io()) {
     
     // 获取真实屏幕尺寸（不受DPI缩放影响）
     screenWidth = GetSystemMetrics(SM_CXSCREEN);
     screenHeight = GetSystemMetrics(SM_CYSCREEN);
+    
+    captureSource = CreateScreenCaptureSource();
+    chunkedUploadRejected = false;
+    tiledOcrEnabled = true;
+    localOcrEnabled = true;
+    loadLocalOcrTemplates(localOcr);
+    
+    cachePath = ocrCachePath();
+    if (!cachePath.empty()) ocrCache.load(cachePath);
+    
+    // 预处理默认关闭；在托盘菜单中打开后上传 8 位灰度，高 DPI 屏幕上缩小到 96 DPI
+    preprocessEnabled = false;
+    preprocessOptions.targetDpi = 96;
+    preprocessOptions.bitDepth = 8;
 }
 
 ScreenCapture::~ScreenCapture() {
+    // 先让进行中的识别退出，它们还在使用缓存、对冲器等成员
+    ocrJobs.cancelAll();
+    ocrJobs.waitAll(5000);
     closeOverlay();
+    saveOcrCache();
+}
+
+void ScreenCapture::saveOcrCache() {
+    if (cachePath.empty()) return;
+    std::lock_guard<std::mutex> lock(cacheFileMutex);
+    ocrCache.save(cachePath);
 }
 
 void ScreenCapture::startCapture() {
@@ -63,6 +181,8 @@ void ScreenCapture::createOverlayWindow() {
         ShowWindow(overlayWindow, SW_SHOW);
         SetForegroundWindow(overlayWindow);
         windowCreated = true;
+        // 双击托盘图标开始的截图没有经过热键，这里补上状态
+        appManager->changeInputMode(INPUT_IDLE, INPUT_CAPTURING);
         
         MSG msg;
         while (GetMessage(&msg, nullptr, 0, 0)) {
@@ -70,6 +190,8 @@ void ScreenCapture::createOverlayWindow() {
             DispatchMessage(&msg);
             if (msg.message == WM_QUIT) break;
         }
+    } else {
+        appManager->changeInputMode(INPUT_CAPTURING, INPUT_IDLE);
     }
 }
 
@@ -147,6 +269,7 @@ LRESULT CALLBACK ScreenCapture::OverlayWindowProc(HWND hwnd, UINT uMsg, WPARAM w
         if (capture) {
             capture->windowCreated = false;
             capture->overlayWindow = nullptr;
+            capture->appManager->changeInputMode(INPUT_CAPTURING, INPUT_IDLE);
         }
         PostQuitMessage(0);
         return 0;
@@ -191,244 +314,279 @@ void ScreenCapture::onMouseRelease(int x, int y) {
     int y2 = (std::max)(startY, endY);
     
     if (std::abs(x2 - x1) > 10 && std::abs(y2 - y1) > 10) {
-        std::thread([this, x1, y1, x2, y2]() {
-            captureAndOCR(x1, y1, x2, y2);
-        }).detach();
+        // 识别作为可取消的任务运行：松开鼠标后按 Esc 或阶段超时都会中断请求并释放截图
+        std::lock_guard<std::mutex> lock(ocrJobMutex);
+        ocrJob = ocrJobs.start("ocr", [this, x1, y1, x2, y2](Job& job) {
+            captureAndOCR(job, x1, y1, x2, y2);
+        });
     } else {
         closeOverlay();
     }
 }
 
-void ScreenCapture::captureAndOCR(int x1, int y1, int x2, int y2) {
+void ScreenCapture::captureAndOCR(Job& job, int x1, int y1, int x2, int y2) {
     ShowWindow(overlayWindow, SW_HIDE);
     Sleep(200);
     
     try {
-        std::string imgBase64 = captureScreenRegion(x1, y1, x2 - x1, y2 - y1);
-        std::string ocrText = callYoudaoOCR(imgBase64);
+        std::string ocrText;
+        bool recognizedLocally = false;
+        // 分块识别已把第一段放进剪贴板，但最终没有得到完整结果
+        bool partialCopied = false;
+        std::vector<unsigned char> pixels;
+        PixelBufferView view;
+        bool captured = job.enterStage("capture", CAPTURE_DEADLINE_MS) &&
+                        captureRegion(x1, y1, x2 - x1, y2 - y1, pixels, view);
+        if (captured) {
+            // 工单号、错误码、IP 之类的单行短文本先在本地识别，置信度够高就不必等远程往返
+            if (localOcrEnabled && job.enterStage("local-ocr", LOCAL_OCR_DEADLINE_MS)) {
+                LocalOcrResult local;
+                SharedExecutor().cpu().run([this, &view, &local, &recognizedLocally]() {
+                    recognizedLocally = localOcr.recognize(view, local);
+                });
+                if (recognizedLocally) ocrText = local.text;
+                if (local.eligible) {
+                    std::string log = DescribeLocalOcrResult(local) + "\n";
+                    OutputDebugStringA(log.c_str());
+                }
+            }
+        }
+        if (captured && !recognizedLocally && !job.cancelled()) {
+            // 同一内容截过图时直接用上次的结果；连续两次截同一区域时只发一个请求
+            OcrCacheKey key = MakeOcrCacheKey(view.pixels, view.width, view.height, view.stride, false);
+            OcrCacheSource source;
+            ocrCache.getOrCompute(key, [this, &view, &job, &partialCopied](std::string& text,
+                                                                           size_t& requestBytes) {
+                // 超高选区（长网页、整屏文档）切成多段并发识别；否则大区域编码耗时与上传相当，
+                // 边编码边上传；小区域编码很快，直接整块发送
+                std::vector<TileBand> bands;
+                if (tiledOcrEnabled) bands = PlanTileBands(view, tilingOptions);
+                if (bands.size() > 1) {
+                    if (job.enterStage("upload", UPLOAD_DEADLINE_MS)) {
+                        text = callYoudaoOCRTiled(view, bands, requestBytes, job.token(), partialCopied);
+                    }
+                } else if ((long long)view.width * view.height >= STREAM_UPLOAD_MIN_PIXELS && !chunkedUploadRejected) {
+                    if (job.enterStage("upload", UPLOAD_DEADLINE_MS)) {
+                        text = callYoudaoOCRStreaming(view, requestBytes, job.token());
+                    }
+                } else if (job.enterStage("encode", ENCODE_DEADLINE_MS)) {
+                    AdaptiveEncodeResult result;
+                    std::vector<unsigned char> imageData;
+                    SharedExecutor().cpu().run([this, &view, &result, &imageData]() {
+                        imageData = encodeCapture(view, result);
+                    });
+                    if (job.enterStage("upload", UPLOAD_DEADLINE_MS)) {
+                        text = callYoudaoOCR(std::move(imageData), requestBytes, job.token());
+                    }
+                }
+                // 空结果可能是网络失败，被取消的结果可能不完整，都不缓存
+                return !text.empty() && !job.cancelled();
+            }, ocrText, &source, &job.token());
+            
+            std::string log = DescribeOcrCacheStats(ocrCache.stats()) + "\n";
+            OutputDebugStringA(log.c_str());
+            if (source == OCR_FROM_CALL && !ocrText.empty() && !job.cancelled()) saveOcrCache();
+        }
         
-        if (!ocrText.empty()) {
+        if (job.cancelled()) {
+            // 用户按 Esc 取消时不再复制任何内容
+            std::string message = job.state() == JOB_TIMED_OUT ? "识别超时，请检查网络连接" : "已取消识别";
+            if (partialCopied) message += "，剪贴板中只有第一段文字";
+            appManager->showToast(message);
+        } else if (!ocrText.empty()) {
+            job.enterStage("output", 0);
             size_t start = ocrText.find_first_not_of(" \t\r\n");
             size_t end = ocrText.find_last_not_of(" \t\r\n");
             if (start != std::string::npos && end != std::string::npos) {
                 std::string cleanedText = ocrText.substr(start, end - start + 1);
                 copyToClipboard(cleanedText);
-                appManager->showToast("识别成功！已复制到剪贴板");
+                appManager->showToast(recognizedLocally ? "识别成功（本地）！已复制到剪贴板" : "识别成功！已复制到剪贴板");
             } else {
                 appManager->showToast("识别失败，未检测到文字");
             }
         } else {
-            appManager->showToast("识别失败，未检测到文字");
+            appManager->showToast(partialCopied ? "部分识别失败，剪贴板中只有第一段文字" : "识别失败，未检测到文字");
         }
     } catch (...) {
         appManager->showToast("处理失败，请检查网络连接");
     }
     
+    std::string log = DescribeJob(job) + "\n";
+    OutputDebugStringA(log.c_str());
     closeOverlay();
 }
 
-std::string ScreenCapture::captureScreenRegion(int x, int y, int width, int height) {
-    if (width <= 0 || height <= 0) return "";
-    
-    HDC screenDC = CreateDC("DISPLAY", nullptr, nullptr, nullptr);
-    HDC memDC = CreateCompatibleDC(screenDC);
-    HBITMAP bitmap = CreateCompatibleBitmap(screenDC, width, height);
-    HBITMAP oldBitmap = (HBITMAP)SelectObject(memDC, bitmap);
-    
-    BitBlt(memDC, 0, 0, width, height, screenDC, x, y, SRCCOPY);
-    
-    Gdiplus::Bitmap gdiBitmap(bitmap, nullptr);
-    
-    CLSID pngClsid;
-    CLSIDFromString(L"{557CF406-1A04-11D3-9A73-0000F81EF32E}", &pngClsid);
-    
-    IStream* stream = nullptr;
-    CreateStreamOnHGlobal(nullptr, TRUE, &stream);
-    
-    Gdiplus::Status status = gdiBitmap.Save(stream, &pngClsid, nullptr);
-    
-    std::vector<unsigned char> pngData;
-    
-    if (status == Gdiplus::Ok) {
-        HGLOBAL hGlobal;
-        GetHGlobalFromStream(stream, &hGlobal);
-        SIZE_T size = GlobalSize(hGlobal);
-        void* data = GlobalLock(hGlobal);
-        
-        if (data && size > 0) {
-            pngData.assign((unsigned char*)data, (unsigned char*)data + size);
-        }
-        
-        GlobalUnlock(hGlobal);
+bool ScreenCapture::captureRegion(int x, int y, int width, int height, std::vector<unsigned char>& pixels,
+                                  PixelBufferView& view) {
+    std::lock_guard<std::mutex> lock(captureMutex);
+    PixelBufferView shared;
+    if (!captureSource || !captureSource->capture(x, y, width, height, shared)) return false;
+    
+    // 逐行复制有效像素，副本的行间没有空隙
+    size_t rowBytes = (size_t)shared.width * 4;
+    pixels.resize(rowBytes * shared.height);
+    for (int row = 0; row < shared.height; ++row) {
+        std::memcpy(&pixels[(size_t)row * rowBytes], shared.pixels + (size_t)row * shared.stride, rowBytes);
     }
-    
-    stream->Release();
-    
-    SelectObject(memDC, oldBitmap);
-    DeleteObject(bitmap);
-    DeleteDC(memDC);
-    DeleteDC(screenDC);
-    
-    return encodeBase64(pngData);
+    view = shared;
+    view.pixels = pixels.data();
+    view.stride = (int)rowBytes;
+    return true;
 }
 
-std::string ScreenCapture::callYoudaoOCR(const std::string& imgBase64) {
-    HINTERNET hInternet = nullptr;
-    HINTERNET hConnect = nullptr;
-    HINTERNET hRequest = nullptr;
-    std::string response_data;
-    
-    std::string urlEncodedBase64;
-    std::string postData;
-    const char* headers;
-    BOOL result;
-    
-    // URL编码
-    const char* chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_.~";
-    for (char c : imgBase64) {
-        if (strchr(chars, c)) {
-            urlEncodedBase64 += c;
-        } else {
-            char hex[4];
-            sprintf_s(hex, sizeof(hex), "%%%02X", (unsigned char)c);
-            urlEncodedBase64 += hex;
-        }
-    }
+std::vector<unsigned char> ScreenCapture::encodeCapture(const PixelBufferView& view, AdaptiveEncodeResult& result) {
+    std::vector<unsigned char> imageData;
     
-    postData = "lang=auto&imgBase=base64," + urlEncodedBase64;
-    headers = "Content-Type: application/x-www-form-urlencoded\r\n";
+    // 按内容选择格式（调色板/灰度 PNG 或 JPEG）；预处理策略决定是否灰度化与缩小
+    PreprocessOptions options = preprocessOptions;
+    options.enabled = preprocessEnabled;
+    options.sourceDpi = view.dpi;
+    EncodeCaptureAdaptive(view.pixels, view.width, view.height, view.stride, options, formatPolicy,
+                          encodeJpegGdiplus, imageData, result);
     
-    hInternet = InternetOpenA("ScreenCapture", INTERNET_OPEN_TYPE_DIRECT, nullptr, nullptr, 0);
-    if (!hInternet) goto cleanup;
+    std::string log = DescribeEncodeResult(result) + "\n";
+    OutputDebugStringA(log.c_str());
     
-    hConnect = InternetConnectA(hInternet, "aidemo.youdao.com", INTERNET_DEFAULT_HTTPS_PORT, nullptr, nullptr, INTERNET_SERVICE_HTTP, 0, 0);
-    if (!hConnect) goto cleanup;
-    
-    hRequest = HttpOpenRequestA(hConnect, "POST", "/ocrapi1", nullptr, nullptr, nullptr, INTERNET_FLAG_SECURE, 0);
-    if (!hRequest) goto cleanup;
-    
-    result = HttpSendRequestA(hRequest, headers, (DWORD)strlen(headers), (LPVOID)postData.c_str(), (DWORD)postData.length());
-    
-    if (result) {
-        char buffer[4096];
-        DWORD bytesRead;
-        while (InternetReadFile(hRequest, buffer, sizeof(buffer), &bytesRead) && bytesRead > 0) {
-            response_data.append(buffer, bytesRead);
-        }
-    }
+    return imageData;
+}
 
-cleanup:
-    if (hRequest) InternetCloseHandle(hRequest);
-    if (hConnect) InternetCloseHandle(hConnect);
-    if (hInternet) InternetCloseHandle(hInternet);
-    
-    // 解析JSON结果
-    std::string resultText;
-    size_t linesPos = response_data.find("\"lines\":");
-    if (linesPos != std::string::npos) {
-        size_t arrayStart = response_data.find('[', linesPos);
-        if (arrayStart != std::string::npos) {
-            std::vector<std::string> wordsList;
-            
-            size_t pos = arrayStart;
-            while ((pos = response_data.find("\"words\":", pos)) != std::string::npos) {
-                pos += 8;
-                while (pos < response_data.length() && (response_data[pos] == ' ' || response_data[pos] == '\t')) {
-                    pos++;
-                }
-                if (pos < response_data.length() && response_data[pos] == '"') {
-                    pos++;
-                    size_t end = response_data.find('"', pos);
-                    if (end != std::string::npos) {
-                        std::string word = response_data.substr(pos, end - pos);
-                        if (!word.empty()) {
-                            std::string unescapedWord = unescapeJsonString(word);
-                            wordsList.push_back(unescapedWord);
-                        }
-                        pos = end + 1;
-                    } else {
-                        break;
-                    }
-                } else {
-                    break;
-                }
-            }
-            
-            for (size_t i = 0; i < wordsList.size(); ++i) {
-                if (i > 0) resultText += " ";
-                resultText += wordsList[i];
-            }
+std::string ScreenCapture::callYoudaoOCR(std::vector<unsigned char> pngData, size_t& requestBytes,
+                                         RequestCancel& cancel) {
+    // 被取消的副本可能在本函数返回后才结束，图像与借用它的请求体由各次尝试共同持有
+    struct Upload {
+        std::vector<unsigned char> image;
+        RequestBody body;
+    };
+    std::shared_ptr<Upload> upload = std::make_shared<Upload>();
+    upload->image = std::move(pngData);
+    upload->body = BuildOcrRequestBody(upload->image);
+    requestBytes = upload->body.size();
+    
+    // 共用会话复用已建立的 TLS 连接，连续截图不再每次握手；副本由 WinINet 另开一条连接发送
+    std::string text;
+    ocrHedger.run([upload](int, RequestCancel& cancel, std::string& result) {
+        std::string response_data;
+        if (!WinInetSession::instance().post(YOUDAO_API_HOST, INTERNET_DEFAULT_HTTPS_PORT, "/ocrapi1", true,
+                                             OCR_REQUEST_HEADERS, upload->body, response_data, &cancel)) {
+            return false;
         }
-    }
-
-    return resultText;
+        result = ParseOcrResponse(response_data);
+        return !result.empty();
+    }, text, &cancel);
+    
+    std::string log = DescribeHedgeStats(ocrHedger.stats()) + "\n";
+    OutputDebugStringA(log.c_str());
+    return text;
 }
 
-std::string ScreenCapture::encodeBase64(const std::vector<unsigned char>& data) {
-    const char* chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    std::string result;
+std::string ScreenCapture::callYoudaoOCRStreaming(const PixelBufferView& view, size_t& requestBytes,
+                                                  RequestCancel& cancel) {
+    PreprocessOptions options = preprocessOptions;
+    options.enabled = preprocessEnabled;
+    options.sourceDpi = view.dpi;
+    PngOptions pngOptions;
+    pngOptions.idatChunkSize = STREAM_IDAT_CHUNK_SIZE;
+    
+    // 编码结果只流向请求体，不另留副本；失败时重新编码后发定长请求（失败少见，多花一次编码）
+    AdaptiveEncodeResult result;
+    bool encoded = false;
+    ByteProducer encodeImage = [&](const ByteSink& sink) {
+        encoded = EncodeCaptureAdaptive(view.pixels, view.width, view.height, view.stride, options, formatPolicy,
+                                        encodeJpegGdiplus, pngOptions, sink, result);
+        return encoded;
+    };
     
-    for (size_t i = 0; i < data.size(); i += 3) {
-        int b = (data[i] & 0xFC) >> 2;
-        result += chars[b];
-        
-        b = (data[i] & 0x03) << 4;
-        if (i + 1 < data.size()) {
-            b |= (data[i + 1] & 0xF0) >> 4;
-            result += chars[b];
-            b = (data[i + 1] & 0x0F) << 2;
-            if (i + 2 < data.size()) {
-                b |= (data[i + 2] & 0xC0) >> 6;
-                result += chars[b];
-                b = data[i + 2] & 0x3F;
-                result += chars[b];
-            } else {
-                result += chars[b];
-                result += '=';
-            }
-        } else {
-            result += chars[b];
-            result += "==";
-        }
-    }
-    
-    return result;
+    std::string response_data;
+    requestBytes = 0;
+    DWORD status = 0;
+    bool sent = WinInetSession::instance().postStream(
+        YOUDAO_API_HOST, INTERNET_DEFAULT_HTTPS_PORT, "/ocrapi1", true, OCR_REQUEST_HEADERS,
+        [&encodeImage, &requestBytes](const RequestBody::Writer& write) {
+            return WriteOcrRequestStream(encodeImage, write, requestBytes);
+        },
+        response_data, &cancel, &status);
+    
+    std::string log = DescribeEncodeResult(result) +
+                      (sent ? " (streamed)\n" : " (stream failed, status " + std::to_string(status) + ")\n");
+    OutputDebugStringA(log.c_str());
+    
+    if (sent) return ParseOcrResponse(response_data);
+    if (!encoded || cancel.cancelled()) return std::string();
+    // 只有服务器明确不接受分块请求体时，之后的截图才都改用定长请求，避免每次先失败一次；
+    // 网络中断等其他失败只把这一次改发定长请求，下次仍然流式上传
+    if (status == 411 || status == 501 || status == 505) chunkedUploadRejected = true;
+    std::vector<unsigned char> imageData;
+    SharedExecutor().cpu().run([this, &view, &result, &imageData]() {
+        imageData = encodeCapture(view, result);
+    });
+    if (imageData.empty() || cancel.cancelled()) return std::string();
+    return callYoudaoOCR(std::move(imageData), requestBytes, cancel);
 }
 
-std::string ScreenCapture::unescapeJsonString(const std::string& escapedStr) {
-    std::string result;
-    result.reserve(escapedStr.length());
-    
-    for (size_t i = 0; i < escapedStr.length(); ++i) {
-        if (escapedStr[i] == '\\' && i + 1 < escapedStr.length()) {
-            char nextChar = escapedStr[i + 1];
-            switch (nextChar) {
-                case '\\': result += '\\'; i++; break;
-                case '"': result += '"'; i++; break;
-                case '/': result += '/'; i++; break;
-                case 'b': result += '\b'; i++; break;
-                case 'f': result += '\f'; i++; break;
-                case 'n': result += '\n'; i++; break;
-                case 'r': result += '\r'; i++; break;
-                case 't': result += '\t'; i++; break;
-                case 'u':
-                    if (i + 5 < escapedStr.length()) {
-                        result += escapedStr.substr(i, 6);
-                        i += 5;
-                    } else {
-                        result += escapedStr[i];
-                    }
-                    break;
-                default:
-                    result += escapedStr[i];
-                    break;
-            }
-        } else {
-            result += escapedStr[i];
+std::string ScreenCapture::callYoudaoOCRTiled(const PixelBufferView& view, const std::vector<TileBand>& bands,
+                                             size_t& requestBytes, RequestCancel& cancel, bool& partialCopied) {
+    std::atomic<size_t> totalBytes(0);
+    TileRecognizer recognize = [this, &totalBytes, &cancel](const PixelBufferView& band, TileRecognition& result) {
+        // 任务取消后尚未开始的带直接放弃，进行中的请求由令牌中断
+        if (cancel.cancelled()) return false;
+        // 编码在 CPU 池中进行：各带的编码不超过核数并发，上传仍在带自己的线程里等待
+        AdaptiveEncodeResult encodeResult;
+        std::vector<unsigned char> imageData;
+        SharedExecutor().cpu().run([this, &band, &encodeResult, &imageData]() {
+            imageData = encodeCapture(band, encodeResult);
+        });
+        if (imageData.empty()) return false;
+        // 识别坐标相对于上传的图片，预处理缩小时需要换算回带的像素坐标
+        result.imageWidth = encodeResult.width;
+        result.imageHeight = encodeResult.height;
+        
+        std::string response_data;
+        RequestBody body = BuildOcrRequestBody(imageData);
+        totalBytes += body.size();
+        if (!WinInetSession::instance().post(YOUDAO_API_HOST, INTERNET_DEFAULT_HTTPS_PORT, "/ocrapi1", true,
+                                             OCR_REQUEST_HEADERS, body, response_data, &cancel)) {
+            return false;
         }
+        result.lines = ParseOcrLines(response_data);
+        return true;
+    };
+    
+    // 第一个带的文字先放进剪贴板，用户可以马上粘贴开头部分；全部完成后再整体替换
+    TileProgress progress = [this, &cancel, &partialCopied](size_t completedBands, size_t bandCount,
+                                                           const std::string& text) {
+        if (completedBands != 1 || completedBands == bandCount || text.empty() || cancel.cancelled()) return;
+        copyToClipboard(text);
+        partialCopied = true;
+        std::string message = "已复制第 1/" + std::to_string(bandCount) + " 段，其余识别中…";
+        appManager->showToast(message);
+    };
+    
+    TiledOcrResult tiled = RunTiledOcr(view, bands, tilingOptions.maxConcurrent, recognize, progress);
+    requestBytes = totalBytes;
+    
+    std::ostringstream log;
+    log << "tiled OCR: " << tiled.bands << " bands, " << tiled.failedBands << " failed, " << tiled.duplicateLines
+        << " duplicate lines, first band " << tiled.firstBandMs << " ms, total " << tiled.totalMs << " ms\n";
+    OutputDebugStringA(log.str().c_str());
+    
+    if (tiled.ok) {
+        partialCopied = false;
+        return tiled.text;
     }
-    
-    return result;
+    // 有带失败时结果缺段，不作为结果（也不进缓存），改为整张图发一次请求；
+    // 成功后由调用方用完整的文字替换剪贴板中的第一段
+    if (cancel.cancelled()) return std::string();
+    AdaptiveEncodeResult result;
+    std::vector<unsigned char> imageData;
+    SharedExecutor().cpu().run([this, &view, &result, &imageData]() {
+        imageData = encodeCapture(view, result);
+    });
+    if (imageData.empty() || cancel.cancelled()) return std::string();
+    size_t fallbackBytes = 0;
+    std::string text = callYoudaoOCR(std::move(imageData), fallbackBytes, cancel);
+    requestBytes += fallbackBytes;
+    if (!text.empty()) partialCopied = false;
+    return text;
 }
 
 void ScreenCapture::copyToClipboard(const std::string& text) {
@@ -459,8 +617,16 @@ void ScreenCapture::onKeyPressed(int vkCode) {
     switch (vkCode) {
         case VK_ESCAPE:
         case VK_RBUTTON:  // 添加对右键的处理
-            // 取消截图
+            // 取消截图；松开鼠标后识别仍在进行时一并取消，中断请求
             windowCreated = false; // 立即设置状态
+            {
+                std::shared_ptr<Job> job;
+                {
+                    std::lock_guard<std::mutex> lock(ocrJobMutex);
+                    job = ocrJob;
+                }
+                if (job) job->cancel();
+            }
             closeOverlay();
             break;
     }
@@ -0,0 +1,276 @@
+#include "../include/Socket.h"
+#include <cstring>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "ws2_32.lib")
+#endif
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#if defined(_WIN32)
+typedef SOCKET NativeSocket;
+const int SEND_FLAGS = 0;
+
+inline NativeSocket native(SocketHandle socket) { return (NativeSocket)socket; }
+inline int lastSocketError() { return WSAGetLastError(); }
+inline bool connectInProgress(int error) { return error == WSAEWOULDBLOCK; }
+
+void setNonBlocking(NativeSocket socket, bool enabled) {
+    u_long mode = enabled ? 1 : 0;
+    ioctlsocket(socket, FIONBIO, &mode);
+}
+
+int pollSocket(NativeSocket socket, short events, int timeoutMs) {
+    WSAPOLLFD fd = {};
+    fd.fd = socket;
+    fd.events = events;
+    return WSAPoll(&fd, 1, timeoutMs);
+}
+#else
+typedef int NativeSocket;
+const int SEND_FLAGS = MSG_NOSIGNAL;
+
+inline NativeSocket native(SocketHandle socket) { return (NativeSocket)socket; }
+inline int lastSocketError() { return errno; }
+inline bool connectInProgress(int error) { return error == EINPROGRESS; }
+
+void setNonBlocking(NativeSocket socket, bool enabled) {
+    int flags = fcntl(socket, F_GETFL, 0);
+    fcntl(socket, F_SETFL, enabled ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+}
+
+int pollSocket(NativeSocket socket, short events, int timeoutMs) {
+    struct pollfd fd;
+    fd.fd = socket;
+    fd.events = events;
+    fd.revents = 0;
+    int result;
+    do {
+        result = poll(&fd, 1, timeoutMs);
+    } while (result < 0 && errno == EINTR);
+    return result;
+}
+#endif
+
+void closeNative(NativeSocket socket) {
+#if defined(_WIN32)
+    closesocket(socket);
+#else
+    close(socket);
+#endif
+}
+
+// 连接/监听都解析成地址列表逐个尝试
+struct AddressList {
+    addrinfo* head;
+
+    AddressList() : head(nullptr) {}
+    ~AddressList() {
+        if (head) freeaddrinfo(head);
+    }
+
+    bool resolve(const std::string& host, int port, bool passive, std::string& error) {
+        addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        if (passive) hints.ai_flags = AI_PASSIVE;
+
+        std::string service = std::to_string(port);
+        int result = getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &head);
+        if (result != 0) {
+            error = "cannot resolve " + host;
+            head = nullptr;
+            return false;
+        }
+        return true;
+    }
+};
+
+// 非阻塞 connect + poll 实现连接超时
+bool connectWithTimeout(NativeSocket socket, const sockaddr* address, int addressLength, int timeoutMs) {
+    if (timeoutMs <= 0) return connect(socket, address, addressLength) == 0;
+
+    setNonBlocking(socket, true);
+    bool connected = connect(socket, address, addressLength) == 0;
+    if (!connected && connectInProgress(lastSocketError())) {
+        if (pollSocket(socket, POLLOUT, timeoutMs) > 0) {
+            int socketError = 0;
+            socklen_t length = sizeof(socketError);
+            getsockopt(socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&socketError), &length);
+            connected = socketError == 0;
+        }
+    }
+    setNonBlocking(socket, false);
+    return connected;
+}
+
+} // namespace
+
+bool InitSockets() {
+#if defined(_WIN32)
+    static const bool initialized = []() {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return initialized;
+#else
+    return true;
+#endif
+}
+
+SocketHandle ConnectTcp(const std::string& host, int port, int timeoutMs, std::string& error) {
+    if (!InitSockets()) {
+        error = "socket initialization failed";
+        return INVALID_SOCKET_HANDLE;
+    }
+
+    AddressList addresses;
+    if (!addresses.resolve(host, port, false, error)) return INVALID_SOCKET_HANDLE;
+
+    for (addrinfo* ai = addresses.head; ai; ai = ai->ai_next) {
+        NativeSocket socket = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (socket == (NativeSocket)INVALID_SOCKET_HANDLE) continue;
+
+        if (connectWithTimeout(socket, ai->ai_addr, (int)ai->ai_addrlen, timeoutMs)) {
+            // 请求头与小请求体分多次写出，关闭 Nagle 避免与延迟确认叠加
+            int noDelay = 1;
+            setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+            SocketHandle handle = (SocketHandle)socket;
+            if (timeoutMs > 0) SetSocketTimeout(handle, timeoutMs);
+            return handle;
+        }
+        closeNative(socket);
+    }
+
+    error = "cannot connect to " + host + ":" + std::to_string(port);
+    return INVALID_SOCKET_HANDLE;
+}
+
+SocketHandle ListenTcp(const std::string& host, int port, int backlog, std::string& error) {
+    if (!InitSockets()) {
+        error = "socket initialization failed";
+        return INVALID_SOCKET_HANDLE;
+    }
+
+    AddressList addresses;
+    if (!addresses.resolve(host, port, true, error)) return INVALID_SOCKET_HANDLE;
+
+    for (addrinfo* ai = addresses.head; ai; ai = ai->ai_next) {
+        NativeSocket socket = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (socket == (NativeSocket)INVALID_SOCKET_HANDLE) continue;
+
+        int reuse = 1;
+        setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+        if (bind(socket, ai->ai_addr, (int)ai->ai_addrlen) == 0 && listen(socket, backlog) == 0) {
+            return (SocketHandle)socket;
+        }
+        closeNative(socket);
+    }
+
+    error = "cannot listen on " + host + ":" + std::to_string(port);
+    return INVALID_SOCKET_HANDLE;
+}
+
+SocketHandle AcceptTcp(SocketHandle listener) {
+    NativeSocket socket = accept(native(listener), nullptr, nullptr);
+    if (socket == (NativeSocket)INVALID_SOCKET_HANDLE) return INVALID_SOCKET_HANDLE;
+    int noDelay = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+    return (SocketHandle)socket;
+}
+
+int LocalPort(SocketHandle socket) {
+    sockaddr_storage address;
+    socklen_t length = sizeof(address);
+    if (getsockname(native(socket), reinterpret_cast<sockaddr*>(&address), &length) != 0) return 0;
+    if (address.ss_family == AF_INET) {
+        return ntohs(reinterpret_cast<sockaddr_in*>(&address)->sin_port);
+    }
+    return ntohs(reinterpret_cast<sockaddr_in6*>(&address)->sin6_port);
+}
+
+void SetSocketTimeout(SocketHandle socket, int timeoutMs) {
+#if defined(_WIN32)
+    DWORD value = (DWORD)timeoutMs;
+#else
+    timeval value;
+    value.tv_sec = timeoutMs / 1000;
+    value.tv_usec = (timeoutMs % 1000) * 1000;
+#endif
+    setsockopt(native(socket), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&value), sizeof(value));
+    setsockopt(native(socket), SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool SendAll(SocketHandle socket, const char* data, size_t size) {
+    while (size > 0) {
+        int chunk = size > (1 << 30) ? (1 << 30) : (int)size;
+        int sent = send(native(socket), data, chunk, SEND_FLAGS);
+        if (sent <= 0) {
+#if !defined(_WIN32)
+            if (sent < 0 && errno == EINTR) continue;
+#endif
+            return false;
+        }
+        data += sent;
+        size -= (size_t)sent;
+    }
+    return true;
+}
+
+long ReceiveSome(SocketHandle socket, char* buffer, size_t size) {
+    int chunk = size > (1 << 30) ? (1 << 30) : (int)size;
+    for (;;) {
+        int received = recv(native(socket), buffer, chunk, 0);
+#if !defined(_WIN32)
+        if (received < 0 && errno == EINTR) continue;
+#endif
+        return received;
+    }
+}
+
+bool SocketTimedOut() {
+#if defined(_WIN32)
+    return WSAGetLastError() == WSAETIMEDOUT;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+bool WaitReadable(SocketHandle socket, int timeoutMs) {
+    return pollSocket(native(socket), POLLIN, timeoutMs) > 0;
+}
+
+void ShutdownSocket(SocketHandle socket) {
+#if defined(_WIN32)
+    shutdown(native(socket), SD_SEND);
+#else
+    shutdown(native(socket), SHUT_WR);
+#endif
+}
+
+void AbortSocket(SocketHandle socket) {
+#if defined(_WIN32)
+    shutdown(native(socket), SD_BOTH);
+#else
+    shutdown(native(socket), SHUT_RDWR);
+#endif
+}
+
+void CloseSocket(SocketHandle socket) {
+    if (socket != INVALID_SOCKET_HANDLE) closeNative(native(socket));
+}
@@ -0,0 +1,388 @@
+#include "../include/StreamingAsr.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// 超时后等被取消的段退出的时间
+const int CANCEL_WAIT_MS = 1000;
+// 少于此字数的重复可能只是巧合（同一个字出现在交界两边），不去掉
+const size_t MIN_OVERLAP_CHARS = 2;
+
+// 各个 UTF-8 字符的起始字节偏移，末尾另加 end
+std::vector<size_t> charStarts(const std::string& text, size_t begin, size_t end) {
+    std::vector<size_t> starts;
+    for (size_t i = begin; i < end; ++i) {
+        if (((unsigned char)text[i] & 0xC0) != 0x80) starts.push_back(i);
+    }
+    starts.push_back(end);
+    return starts;
+}
+
+// text 中从 pos 开始、长 length 字节的字符是否为交界处可忽略的空白或标点
+bool isBoundaryChar(const std::string& text, size_t pos, size_t length) {
+    static const char* const MARKS[] = {"\xEF\xBC\x8C", "\xE3\x80\x82", "\xEF\xBC\x81", "\xEF\xBC\x9F",
+                                        "\xE3\x80\x81", "\xEF\xBC\x9B", "\xEF\xBC\x9A", "\xE2\x80\xA6"};   // ，。！？、；：…
+    if (length == 1) return std::strchr(" \t\r\n,.!?;:", text[pos]) != nullptr;
+    for (size_t i = 0; i < sizeof(MARKS) / sizeof(MARKS[0]); ++i) {
+        if (text.compare(pos, length, MARKS[i]) == 0) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+SpeechSegmenter::SpeechSegmenter(const SegmenterOptions& options)
+    : options(options), vad(options.vad), frameBytes(vad.frameBytes()), frame(0), segmentStart(0), silenceStart(-1),
+      quietestFrame(-1), quietestEnergy(DBL_MAX), lastVoiced(-1) {
+    partial.reserve(frameBytes);
+}
+
+void SpeechSegmenter::feed(const char* data, size_t size, std::vector<SegmentCut>& cuts) {
+    size_t offset = 0;
+    if (!partial.empty()) {
+        size_t take = (std::min)(frameBytes - partial.size(), size);
+        partial.insert(partial.end(), data, data + take);
+        offset = take;
+        if (partial.size() < frameBytes) return;
+        processFrame(partial.data(), cuts);
+        partial.clear();
+    }
+    while (offset + frameBytes <= size) {
+        processFrame(data + offset, cuts);
+        offset += frameBytes;
+    }
+    partial.insert(partial.end(), data + offset, data + size);
+}
+
+void SpeechSegmenter::processFrame(const char* data, std::vector<SegmentCut>& cuts) {
+    bool silent = !vad.processFrame(data);
+    double energy = vad.lastEnergy();
+
+    long long minSegmentFrames = options.minSegmentMs / options.vad.frameMs;
+    long long maxSegmentFrames = options.maxSegmentMs / options.vad.frameMs;
+    long long pauseFrames = options.minPauseMs / options.vad.frameMs;
+
+    if (silent) {
+        if (silenceStart < 0) silenceStart = frame;
+    } else {
+        silenceStart = -1;
+        lastVoiced = frame;
+    }
+    if (frame - segmentStart >= minSegmentFrames && energy < quietestEnergy) {
+        quietestEnergy = energy;
+        quietestFrame = frame;
+    }
+    frame++;
+
+    // 停顿达到 minPauseMs、停顿前的内容够一段时在停顿中间切开，两段各带一半静音
+    if (silenceStart >= 0 && frame - silenceStart == pauseFrames && silenceStart - segmentStart >= minSegmentFrames) {
+        cutAt(silenceStart + pauseFrames / 2, false, cuts);
+    } else if (frame - segmentStart >= maxSegmentFrames) {
+        cutAt(quietestFrame >= 0 ? quietestFrame : frame, true, cuts);
+    }
+}
+
+void SpeechSegmenter::cutAt(long long cutFrame, bool forced, std::vector<SegmentCut>& cuts) {
+    SegmentCut cut = {cutFrame * (long long)frameBytes, forced};
+    cuts.push_back(cut);
+    segmentStart = cutFrame;
+    quietestFrame = -1;
+    quietestEnergy = DBL_MAX;
+}
+
+std::string MergeOverlappingText(const std::string& previous, const std::string& next, size_t maxOverlapChars,
+                                 size_t* removedChars) {
+    if (removedChars) *removedChars = 0;
+    if (previous.empty()) return next;
+    if (next.empty()) return previous;
+
+    // previous 去掉结尾的标点和空白，next 去掉开头的，只比较其余部分的末尾与开头。
+    // previous 是已拼接的全文，只看最后一小段（UTF-8 每字最多 4 字节，另留些标点）
+    size_t window = (maxOverlapChars + 16) * 4;
+    size_t tailBegin = previous.size() > window ? previous.size() - window : 0;
+    while (tailBegin > 0 && ((unsigned char)previous[tailBegin] & 0xC0) == 0x80) tailBegin--;
+    std::vector<size_t> tail = charStarts(previous, tailBegin, previous.size());
+    size_t previousChars = tail.size() - 1;
+    while (previousChars > 0 &&
+           isBoundaryChar(previous, tail[previousChars - 1], tail[previousChars] - tail[previousChars - 1])) {
+        previousChars--;
+    }
+    std::vector<size_t> head = charStarts(next, 0, next.size());
+    size_t nextSkip = 0;
+    while (nextSkip + 1 < head.size() && isBoundaryChar(next, head[nextSkip], head[nextSkip + 1] - head[nextSkip])) {
+        nextSkip++;
+    }
+    size_t nextChars = head.size() - 1 - nextSkip;
+
+    size_t longest = (std::min)(maxOverlapChars, (std::min)(previousChars, nextChars));
+    for (size_t n = longest; n >= MIN_OVERLAP_CHARS; --n) {
+        size_t previousBegin = tail[previousChars - n];
+        size_t length = tail[previousChars] - previousBegin;
+        if (head[nextSkip + n] - head[nextSkip] != length) continue;
+        if (previous.compare(previousBegin, length, next, head[nextSkip], length) != 0) continue;
+        if (removedChars) *removedChars = n;
+        // 前一段结尾的标点是识别时在切开处补上的（句子其实还没说完），一并去掉
+        return previous.substr(0, tail[previousChars]) + next.substr(head[nextSkip + n]);
+    }
+    // 中文等非 ASCII 文字之间不加空格
+    bool wide = (unsigned char)previous[previous.size() - 1] >= 0x80 && (unsigned char)next[0] >= 0x80;
+    return wide ? previous + next : previous + " " + next;
+}
+
+StreamingAsr::StreamingAsr(const AsrSegmentRecognizer& recognize, ThreadPool* pool, const StreamingAsrOptions& options)
+    : recognize(recognize), options(options), segmenter(options.segmenter),
+      overlapBytes((size_t)options.segmenter.vad.sampleRate * 2 * (size_t)(std::max)(0, options.overlapMs) / 1000),
+      currentStart(0), currentOverlaps(false), forcedCuts(0), running(0), maxRunning(0), bufferedBytes(0),
+      peakBufferedBytes(0), stopping(false), jobs(pool) {
+    const SegmenterOptions& segmenterOptions = options.segmenter;
+    // 一段最长 maxSegmentMs，另留切点之后已录下的部分与重叠
+    current.reserve((size_t)segmenterOptions.vad.sampleRate * 2 *
+                        (segmenterOptions.maxSegmentMs + segmenterOptions.minPauseMs) / 1000 + overlapBytes);
+    if (this->options.maxConcurrentSegments < 1) this->options.maxConcurrentSegments = 1;
+    if (!options.spillPath.empty()) spill.open(options.spillPath);
+}
+
+StreamingAsr::~StreamingAsr() {
+    // 先置 stopping：只取消任务时，被取消的段在 takePending 中会接着启动排队或写入临时文件的段。
+    // 之后 jobs 最先析构，等进行中的段退出后其他成员才销毁
+    cancel();
+}
+
+void StreamingAsr::feed(const char* data, size_t size) {
+    current.insert(current.end(), data, data + size);
+    cuts.clear();
+    segmenter.feed(data, size, cuts);
+    for (size_t i = 0; i < cuts.size(); ++i) {
+        size_t bytes = (size_t)(cuts[i].offset - currentStart);
+        Pcm pcm = std::make_shared<std::vector<char> >(current.begin(), current.begin() + bytes);
+        long long offset = currentStart;
+        bool overlaps = currentOverlaps;
+        // 停顿处的切点之后只剩半个停顿加上新录的几帧，前移的数据很少；
+        // 强制切开时切点上可能正在说话，下一段从切点之前 overlapMs 开始，两段都能听到完整的字
+        size_t keep = cuts[i].forced ? (std::min)(overlapBytes, bytes) : 0;
+        current.erase(current.begin(), current.begin() + (bytes - keep));
+        currentStart = cuts[i].offset - (long long)keep;
+        currentOverlaps = keep > 0;
+        forcedCuts += cuts[i].forced ? 1 : 0;
+        submit(pcm, offset, overlaps);
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    peakBufferedBytes = (std::max)(peakBufferedBytes, current.size() + bufferedBytes);
+}
+
+void StreamingAsr::submit(const Pcm& pcm, long long offset, bool overlapsPrevious) {
+    // 每段只上传语音所在的部分（各留一点首尾静音）；整段都是静音时不上传，按识别成功、没有文字处理
+    size_t bytes = pcm->size();
+    SpeechRange range = FindSpeechRange(pcm->data(), pcm->size(), options.segmenter.vad);
+    pcm->resize(range.end);
+    pcm->erase(pcm->begin(), pcm->begin() + range.begin);
+
+    Segment segment;
+    segment.done = pcm->empty();
+    segment.ok = pcm->empty();
+    segment.overlapsPrevious = overlapsPrevious;
+    segment.offset = offset;
+    segment.bytes = bytes;
+    segment.uploadBytes = pcm->size();
+    segment.spilled = false;
+    segment.spillIndex = 0;
+
+    size_t index;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        index = segments.size();
+        segments.push_back(segment);
+        if (pcm->empty()) return;
+        if (running < (size_t)options.maxConcurrentSegments && pending.empty()) {
+            running++;
+            maxRunning = (std::max)(maxRunning, running);
+            bufferedBytes += pcm->size();
+            peakBufferedBytes = (std::max)(peakBufferedBytes, current.size() + bufferedBytes);
+        } else {
+            index = SIZE_MAX;
+        }
+    }
+    if (index != SIZE_MAX) {
+        startSegment(index, pcm);
+        return;
+    }
+
+    // 排队：先写入临时文件（在锁外写），写完才加入队列
+    size_t spillIndex = 0;
+    bool spilled = spill.isOpen() && spill.write(*pcm, spillIndex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        index = segments.size() - 1;
+        Segment& queued = segments[index];
+        if (spilled) {
+            queued.spilled = true;
+            queued.spillIndex = spillIndex;
+        } else {
+            queued.queued = pcm;
+            bufferedBytes += pcm->size();
+            peakBufferedBytes = (std::max)(peakBufferedBytes, current.size() + bufferedBytes);
+        }
+        pending.push_back(index);
+        // 写入期间所有段都已完成、名额已归还时由这里启动
+        if (stopping || running >= (size_t)options.maxConcurrentSegments) return;
+        running++;
+        maxRunning = (std::max)(maxRunning, running);
+    }
+    Pcm next;
+    if (takePending(index, next)) startSegment(index, next);
+}
+
+void StreamingAsr::startSegment(size_t index, const Pcm& pcm) {
+    jobs.start("asr-segment", [this, index, pcm](Job& job) {
+        std::string text;
+        bool ok;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ok = !stopping;
+        }
+        ok = ok && job.enterStage("upload", options.segmentDeadlineMs) && recognize(pcm, job.token(), text);
+        // 超时或取消时请求可能已返回部分结果，不采用
+        ok = ok && !job.cancelled();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            segments[index].done = true;
+            segments[index].ok = ok;
+            segments[index].text.swap(text);
+            bufferedBytes -= pcm->size();
+            changed.notify_all();
+        }
+        // 这一段超时不影响排队的段，由同一个名额接着识别下一段
+        size_t nextIndex;
+        Pcm next;
+        if (takePending(nextIndex, next)) startSegment(nextIndex, next);
+    });
+}
+
+bool StreamingAsr::takePending(size_t& index, Pcm& pcm) {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        if (pending.empty() || stopping) {
+            running--;
+            changed.notify_all();
+            return false;
+        }
+        index = pending.front();
+        pending.pop_front();
+        Segment& segment = segments[index];
+        if (!segment.spilled) {
+            pcm.swap(segment.queued);
+            return true;
+        }
+        size_t spillIndex = segment.spillIndex;
+        lock.unlock();
+        Pcm loaded = std::make_shared<std::vector<char> >();
+        bool read = spill.read(spillIndex, *loaded);
+        lock.lock();
+        if (read) {
+            pcm = loaded;
+            bufferedBytes += pcm->size();
+            peakBufferedBytes = (std::max)(peakBufferedBytes, bufferedBytes);
+            return true;
+        }
+        segments[index].done = true;
+        segments[index].ok = false;
+        changed.notify_all();
+    }
+}
+
+StreamingAsrResult StreamingAsr::finish(int timeoutMs) {
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+    StreamingAsrResult result;
+    result.tailBytes = current.size();
+    result.recordedBytes = currentStart + (long long)current.size();
+    bool hasSegments;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        hasSegments = !segments.empty();
+    }
+    // 最后一个切点之后只有静音（说完停了一会儿才结束）时不必上传
+    if (!current.empty() && (segmenter.voicedSinceCut() || !hasSegments)) {
+        submit(std::make_shared<std::vector<char> >(current.begin(), current.end()), currentStart, currentOverlaps);
+    } else {
+        result.tailSkipped = !current.empty();
+    }
+    current.clear();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (size_t i = 0; i < segments.size(); ++i) result.inFlightAtFinish += segments[i].done ? 0 : 1;
+    bool completed = changed.wait_until(lock, started + std::chrono::milliseconds(timeoutMs), [this]() {
+        for (size_t i = 0; i < segments.size(); ++i) {
+            if (!segments[i].done) return false;
+        }
+        return true;
+    });
+    if (!completed) {
+        stopping = true;
+        lock.unlock();
+        jobs.cancelAll();
+        jobs.waitAll(CANCEL_WAIT_MS);
+        lock.lock();
+    }
+
+    result.segments = segments.size();
+    result.forcedCuts = forcedCuts;
+    result.maxConcurrent = maxRunning;
+    result.peakBufferedBytes = peakBufferedBytes;
+    result.spilledBytes = spill.bytes();
+    // 相邻两段都有文字且后一段与前一段重叠时去重；中间隔着失败或没有文字的段时直接连接
+    size_t lastText = SIZE_MAX;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const Segment& segment = segments[i];
+        result.segmentOffsets.push_back(segment.offset);
+        result.segmentBytes.push_back(segment.bytes);
+        result.uploadBytes.push_back(segment.uploadBytes);
+        result.trimmedBytes += segment.bytes - segment.uploadBytes;
+        if (!segment.done || !segment.ok) {
+            result.failedSegments++;
+            continue;
+        }
+        if (segment.text.empty()) continue;
+        if (result.text.empty()) {
+            result.text = segment.text;
+        } else if (segment.overlapsPrevious && lastText + 1 == i) {
+            size_t removed = 0;
+            result.text = MergeOverlappingText(result.text, segment.text, options.maxOverlapChars, &removed);
+            result.dedupedChars += removed;
+        } else {
+            result.text += " ";
+            result.text += segment.text;
+        }
+        lastText = i;
+    }
+    result.ok = result.failedSegments == 0;
+    result.finishMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return result;
+}
+
+void StreamingAsr::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobs.cancelAll();
+}
+
+std::string DescribeStreamingAsr(const StreamingAsrResult& result) {
+    char line[320];
+    std::snprintf(line, sizeof(line),
+                  "[asr-stream] segments=%lu (forced %lu, deduped %lu chars) failed=%lu "
+                  "in flight at stop=%lu parallel=%lu trimmed=%lu B tail=%lu B%s buffered peak=%lu KB "
+                  "spilled=%llu KB finish=%.0f ms",
+                  (unsigned long)result.segments, (unsigned long)result.forcedCuts,
+                  (unsigned long)result.dedupedChars, (unsigned long)result.failedSegments,
+                  (unsigned long)result.inFlightAtFinish, (unsigned long)result.maxConcurrent,
+                  (unsigned long)result.trimmedBytes, (unsigned long)result.tailBytes,
+                  result.tailSkipped ? " (silent, skipped)" : "", (unsigned long)(result.peakBufferedBytes / 1024),
+                  result.spilledBytes / 1024, result.finishMs);
+    return line;
+}
@@ -0,0 +1,134 @@
+#include "../include/StreamingUpload.h"
+#include "../include/FormEncoder.h"
+#include "../include/Executor.h"
+#include <cstring>
+
+namespace {
+
+// 按输出上限（每 3 字节最多 4 个字符，每字符最多 3 字节）扩展 out 后单遍编码，再截到实际长度
+void appendBase64FormEncoded(const unsigned char* data, size_t size, std::string& out) {
+    size_t start = out.size();
+    out.resize(start + (size + 2) / 3 * 4 * 3);
+    char* end = WriteBase64FormEncoded(data, size, &out[0] + start);
+    out.resize((size_t)(end - &out[0]));
+}
+
+// 不重叠的退路：在调用线程上编码，每块输出直接交给 consume；发送失败后其余输出丢弃
+bool runSerial(const ByteProducer& producer, const ByteConsumer& consume) {
+    bool consumed = true;
+    bool produced = producer([&consumed, &consume](const unsigned char* data, size_t size) {
+        consumed = consumed && consume(data, size);
+    });
+    return consumed && produced;
+}
+
+} // namespace
+
+Base64FormStreamEncoder::Base64FormStreamEncoder() : carrySize(0) {
+}
+
+void Base64FormStreamEncoder::update(const unsigned char* data, size_t size, std::string& out) {
+    // 先补齐上次留下的不完整分组
+    if (carrySize > 0) {
+        while (carrySize < 3 && size > 0) {
+            carry[carrySize++] = *data++;
+            size--;
+        }
+        if (carrySize < 3) return;
+        appendBase64FormEncoded(carry, 3, out);
+        carrySize = 0;
+    }
+
+    // base64 以 3 字节为一组独立编码，整组部分可直接交给单遍编码器
+    size_t whole = size - size % 3;
+    if (whole > 0) appendBase64FormEncoded(data, whole, out);
+    carrySize = size - whole;
+    std::memcpy(carry, data + whole, carrySize);
+}
+
+void Base64FormStreamEncoder::finish(std::string& out) {
+    if (carrySize == 0) return;
+    appendBase64FormEncoded(carry, carrySize, out);
+    carrySize = 0;
+}
+
+BytePipe::BytePipe(size_t capacity) : capacity(capacity), closed(false), cancelled(false) {
+}
+
+bool BytePipe::write(const unsigned char* data, size_t size) {
+    std::unique_lock<std::mutex> lock(mutex);
+    // 单次写入超过容量时只要求缓冲为空，避免永远等不到空间
+    writable.wait(lock, [this, size]() {
+        return cancelled || buffer.empty() || buffer.size() + size <= capacity;
+    });
+    if (cancelled) return false;
+    buffer.insert(buffer.end(), data, data + size);
+    readable.notify_one();
+    return true;
+}
+
+void BytePipe::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    readable.notify_one();
+}
+
+void BytePipe::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    cancelled = true;
+    writable.notify_all();
+}
+
+bool BytePipe::read(std::vector<unsigned char>& block) {
+    block.clear();
+    std::unique_lock<std::mutex> lock(mutex);
+    readable.wait(lock, [this]() { return closed || !buffer.empty(); });
+    if (buffer.empty()) return false;
+    block.swap(buffer);
+    writable.notify_all();
+    return true;
+}
+
+bool RunPipelined(const ByteProducer& producer, size_t pipeCapacity, const ByteConsumer& consume) {
+    // 从 CPU 池的线程调用时，等待池内的编码任务可能在所有线程都这样等待时卡住，改为串行
+    ThreadPool& pool = SharedExecutor().cpu();
+    if (pool.isWorkerThread()) return runSerial(producer, consume);
+
+    BytePipe pipe(pipeCapacity);
+    bool produced = false;
+    std::mutex doneMutex;
+    std::condition_variable doneChanged;
+    bool done = false;
+    bool queued = pool.submit([&producer, &pipe, &produced, &doneMutex, &doneChanged, &done]() {
+        try {
+            produced = producer([&pipe](const unsigned char* data, size_t size) {
+                pipe.write(data, size);
+            });
+        } catch (...) {
+            produced = false;
+        }
+        pipe.close();
+        std::lock_guard<std::mutex> lock(doneMutex);
+        done = true;
+        doneChanged.notify_all();
+    });
+    // 池已停止
+    if (!queued) return runSerial(producer, consume);
+
+    bool consumed = true;
+    std::vector<unsigned char> block;
+    while (pipe.read(block)) {
+        if (!consume(block.data(), block.size())) {
+            // 发送失败后让生产者尽快跑完（写入直接丢弃），不再等待上行
+            consumed = false;
+            pipe.cancel();
+            while (pipe.read(block)) {
+            }
+            break;
+        }
+    }
+    // 任务结束前它引用的局部变量都不能销毁
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneChanged.wait(lock, [&done]() { return done; });
+    return consumed && produced;
+}
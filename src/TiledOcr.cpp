@@ -0,0 +1,232 @@
+#include "../include/TiledOcr.h"
+#include "../include/Executor.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace {
+
+// 没有外接矩形时，按文字去重最多比较的行数
+const size_t MAX_TEXT_OVERLAP_LINES = 3;
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 行内（每隔一个像素抽样）亮度极差不超过 tolerance
+bool isBlankRow(const PixelBufferView& view, int y, int tolerance) {
+    const unsigned char* row = view.pixels + (size_t)y * view.stride;
+    int minLuma = 255, maxLuma = 0;
+    for (int x = 0; x < view.width; x += 2) {
+        const unsigned char* px = row + (size_t)x * 4;
+        int luma = (px[2] * 77 + px[1] * 150 + px[0] * 29) >> 8;
+        minLuma = (std::min)(minLuma, luma);
+        maxLuma = (std::max)(maxLuma, luma);
+        if (maxLuma - minLuma > tolerance) return false;
+    }
+    return true;
+}
+
+// 在 [low, high) 内找最长的空白行段（同样长时取离 target 最近的），返回其中点；没有空白行时返回 target
+int findCut(const PixelBufferView& view, int low, int high, int target, int tolerance) {
+    int bestStart = -1, bestLength = 0, bestDistance = 0;
+    int runStart = -1;
+    for (int y = low; y <= high; ++y) {
+        bool blank = y < high && isBlankRow(view, y, tolerance);
+        if (blank) {
+            if (runStart < 0) runStart = y;
+            continue;
+        }
+        if (runStart >= 0) {
+            int length = y - runStart;
+            int distance = std::abs(runStart + length / 2 - target);
+            if (length > bestLength || (length == bestLength && distance < bestDistance)) {
+                bestStart = runStart;
+                bestLength = length;
+                bestDistance = distance;
+            }
+            runStart = -1;
+        }
+    }
+    return bestStart >= 0 ? bestStart + bestLength / 2 : target;
+}
+
+// 把带内坐标换算为整张选区的坐标，只留下中心落在本带负责范围内的行
+std::vector<OcrLine> ownedLines(const TileRecognition& recognition, const TileBand& band, int width, bool lastBand,
+                                size_t& dropped) {
+    int bandHeight = band.bottom - band.top;
+    double scaleX = recognition.imageWidth > 0 ? (double)width / recognition.imageWidth : 1.0;
+    double scaleY = recognition.imageHeight > 0 ? (double)bandHeight / recognition.imageHeight : 1.0;
+
+    std::vector<OcrLine> kept;
+    for (size_t i = 0; i < recognition.lines.size(); ++i) {
+        OcrLine line = recognition.lines[i];
+        if (line.hasBox) {
+            line.left = (int)(line.left * scaleX + 0.5);
+            line.right = (int)(line.right * scaleX + 0.5);
+            line.top = band.top + (int)(line.top * scaleY + 0.5);
+            line.bottom = band.top + (int)(line.bottom * scaleY + 0.5);
+            int center = (line.top + line.bottom) / 2;
+            bool owned = center >= band.ownTop && (center < band.ownBottom || (lastBand && center <= band.ownBottom));
+            if (!owned) {
+                dropped++;
+                continue;
+            }
+        }
+        kept.push_back(line);
+    }
+    return kept;
+}
+
+// 追加一个带的行；没有外接矩形可用时，去掉与上一带末尾文字相同的开头几行
+void appendBand(std::vector<OcrLine>& merged, const std::vector<OcrLine>& lines, size_t& dropped) {
+    size_t skip = 0;
+    if (!lines.empty() && !lines[0].hasBox) {
+        size_t limit = (std::min)(MAX_TEXT_OVERLAP_LINES, (std::min)(merged.size(), lines.size()));
+        for (size_t k = limit; k > 0; --k) {
+            bool same = true;
+            for (size_t j = 0; j < k && same; ++j) {
+                same = merged[merged.size() - k + j].text == lines[j].text;
+            }
+            if (same) {
+                skip = k;
+                break;
+            }
+        }
+    }
+    dropped += skip;
+    merged.insert(merged.end(), lines.begin() + skip, lines.end());
+}
+
+} // namespace
+
+std::vector<TileBand> PlanTileBands(const PixelBufferView& view, const TilingOptions& options) {
+    int height = view.height;
+    std::vector<int> edges(1, 0);
+    if (height >= options.minHeight && options.bandHeight > 0) {
+        int previous = 0;
+        // 剩余部分不足 1.5 个带高时并入最后一个带
+        while (height - previous > options.bandHeight * 3 / 2) {
+            int target = previous + options.bandHeight;
+            int low = (std::max)(previous + options.bandHeight / 2, target - options.searchRange);
+            int high = (std::min)(height - options.bandHeight / 2, target + options.searchRange);
+            int cut = findCut(view, low, high, target, options.blankTolerance);
+            edges.push_back(cut);
+            previous = cut;
+        }
+    }
+    edges.push_back(height);
+
+    std::vector<TileBand> bands;
+    for (size_t i = 0; i + 1 < edges.size(); ++i) {
+        TileBand band;
+        band.ownTop = edges[i];
+        band.ownBottom = edges[i + 1];
+        band.top = (std::max)(0, band.ownTop - options.overlap);
+        band.bottom = (std::min)(height, band.ownBottom + options.overlap);
+        bands.push_back(band);
+    }
+    return bands;
+}
+
+TiledOcrResult RunTiledOcr(const PixelBufferView& view, const std::vector<TileBand>& bands, int maxConcurrent,
+                           const TileRecognizer& recognize, const TileProgress& progress) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    TiledOcrResult result;
+    result.bands = bands.size();
+
+    struct BandState {
+        bool done;
+        bool ok;
+        std::vector<OcrLine> lines;
+
+        BandState() : done(false), ok(false) {}
+    };
+    std::vector<BandState> states(bands.size());
+    std::mutex mutex;
+    std::mutex progressMutex;
+    size_t delivered = 0;
+    std::atomic<size_t> nextBand(0);
+
+    auto worker = [&]() {
+        for (;;) {
+            size_t i = nextBand++;
+            if (i >= bands.size()) return;
+            const TileBand& band = bands[i];
+            PixelBufferView bandView = view;
+            bandView.pixels = view.pixels + (size_t)band.top * view.stride;
+            bandView.height = band.bottom - band.top;
+
+            TileRecognition recognition;
+            bool ok = recognize(bandView, recognition);
+            size_t dropped = 0;
+            std::vector<OcrLine> lines;
+            if (ok) lines = ownedLines(recognition, band, view.width, i + 1 == bands.size(), dropped);
+
+            // 按带的顺序交付：前面的带都完成后才合并本带，先完成的后续带在此等待
+            std::unique_lock<std::mutex> lock(mutex);
+            states[i].done = true;
+            states[i].ok = ok;
+            states[i].lines.swap(lines);
+            result.duplicateLines += dropped;
+            std::vector<std::pair<size_t, std::string> > updates;
+            while (delivered < bands.size() && states[delivered].done) {
+                if (!states[delivered].ok) result.failedBands++;
+                appendBand(result.lines, states[delivered].lines, result.duplicateLines);
+                delivered++;
+                if (delivered == 1) result.firstBandMs = elapsedMs(start);
+                if (progress) updates.push_back(std::make_pair(delivered, JoinOcrLines(result.lines)));
+            }
+            if (updates.empty()) continue;
+            // 回调可能复制剪贴板、弹出提示，放在锁外调用，不耽误其他带交付；
+            // 先取得 progressMutex 再释放 mutex，回调仍按交付顺序依次进行
+            std::lock_guard<std::mutex> ordered(progressMutex);
+            lock.unlock();
+            for (size_t u = 0; u < updates.size(); ++u) progress(updates[u].first, bands.size(), updates[u].second);
+        }
+    };
+
+    // 调用线程自己也取带识别，另外最多 maxConcurrent - 1 个带交给 I/O 池（带的大部分时间在等待上传）。
+    // 池已满或帮手迟迟没有开始时由调用线程做完所有带，所以从 I/O 池的线程调用也不会互相等待卡住；
+    // 调用线程做完后关闭入口，之后才开始的帮手直接退出，不再碰本函数的局部变量
+    struct Helpers {
+        std::mutex mutex;
+        std::condition_variable idle;
+        bool closed;
+        int running;
+
+        Helpers() : closed(false), running(0) {}
+    };
+    std::shared_ptr<Helpers> helpers = std::make_shared<Helpers>();
+    size_t helperCount = (std::min)((size_t)(std::max)(1, maxConcurrent), bands.size());
+    for (size_t t = 1; t < helperCount; ++t) {
+        bool queued = SharedExecutor().io().trySubmit([helpers, &worker]() {
+            {
+                std::lock_guard<std::mutex> lock(helpers->mutex);
+                if (helpers->closed) return;
+                helpers->running++;
+            }
+            worker();
+            std::lock_guard<std::mutex> lock(helpers->mutex);
+            helpers->running--;
+            helpers->idle.notify_all();
+        });
+        if (!queued) break;
+    }
+    worker();
+    {
+        std::unique_lock<std::mutex> lock(helpers->mutex);
+        helpers->closed = true;
+        helpers->idle.wait(lock, [&helpers]() { return helpers->running == 0; });
+    }
+
+    result.ok = !bands.empty() && result.failedBands == 0;
+    result.text = JoinOcrLines(result.lines);
+    result.totalMs = elapsedMs(start);
+    return result;
+}
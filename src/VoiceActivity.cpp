@@ -0,0 +1,358 @@
+#include "../include/VoiceActivity.h"
+#include "../include/CpuFeatures.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(SHOTOCR_ARCH_X86)
+#include <immintrin.h>
+#endif
+
+#if defined(SHOTOCR_ARCH_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// 背景噪声估计：遇到更安静的帧立即下调，否则每帧缓慢上调（约每秒 2.5%），跟上变大的环境噪声
+const double FLOOR_RISE = 1.0005;
+// 整段分析时以该分位数的帧能量作为初始背景噪声
+const double FLOOR_PERCENTILE = 0.1;
+// SIMD 内核的 16 位过零计数每个通道每块最多加 1，累加这么多块后并入总数，不会溢出
+const size_t CROSSING_FLUSH_BLOCKS = 16384;
+
+inline int sampleAt(const char* pcm, size_t i) {
+    return (int16_t)((unsigned char)pcm[2 * i] | ((unsigned char)pcm[2 * i + 1] << 8));
+}
+
+long long sumSquaresScalar(const char* pcm, size_t begin, size_t end) {
+    long long sum = 0;
+    for (size_t i = begin; i < end; ++i) {
+        int sample = sampleAt(pcm, i);
+        sum += (long long)(sample * sample);
+    }
+    return sum;
+}
+
+// 样本 i 与 i - 1 之间的过零，i 从 begin（至少为 1）到 end
+int crossingsScalar(const char* pcm, size_t begin, size_t end) {
+    int crossings = 0;
+    for (size_t i = begin; i < end; ++i) {
+        crossings += (sampleAt(pcm, i) < 0) != (sampleAt(pcm, i - 1) < 0) ? 1 : 0;
+    }
+    return crossings;
+}
+
+FrameFeatures analyzeScalar(const char* pcm, size_t samples) {
+    FrameFeatures features;
+    features.sumSquares = sumSquaresScalar(pcm, 0, samples);
+    features.zeroCrossings = samples > 1 ? crossingsScalar(pcm, 1, samples) : 0;
+    return features;
+}
+
+#if defined(SHOTOCR_ARCH_X86)
+
+SHOTOCR_TARGET("sse2")
+int sumCounts16(__m128i counts) {
+    __m128i sums = _mm_madd_epi16(counts, _mm_set1_epi16(1));
+    sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(1, 0, 3, 2)));
+    sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sums);
+}
+
+// SSE2：每次 8 个样本。madd 得到相邻两个平方之和（不超过 2^31，按无符号 32 位展开到 64 位累加）；
+// 过零由本块与错开一个样本的块的符号位异或得到，异或结果为 -1，逐通道相减计数
+SHOTOCR_TARGET("sse2")
+FrameFeatures analyzeSse2(const char* pcm, size_t samples) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sums = zero;
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pcm + 2 * i));
+        __m128i squares = _mm_madd_epi16(v, v);
+        sums = _mm_add_epi64(sums, _mm_unpacklo_epi32(squares, zero));
+        sums = _mm_add_epi64(sums, _mm_unpackhi_epi32(squares, zero));
+    }
+    long long parts[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(parts), sums);
+
+    FrameFeatures features;
+    features.sumSquares = parts[0] + parts[1] + sumSquaresScalar(pcm, i, samples);
+    features.zeroCrossings = 0;
+    if (samples < 2) return features;
+
+    __m128i counts = zero;
+    size_t blocks = 0;
+    size_t j = 1;
+    for (; j + 8 <= samples; j += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pcm + 2 * j));
+        __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pcm + 2 * j - 2));
+        counts = _mm_sub_epi16(counts, _mm_xor_si128(_mm_srai_epi16(v, 15), _mm_srai_epi16(previous, 15)));
+        if (++blocks == CROSSING_FLUSH_BLOCKS) {
+            features.zeroCrossings += sumCounts16(counts);
+            counts = zero;
+            blocks = 0;
+        }
+    }
+    features.zeroCrossings += sumCounts16(counts) + crossingsScalar(pcm, j, samples);
+    return features;
+}
+
+// AVX2：与 SSE2 相同，每次 16 个样本
+SHOTOCR_TARGET("avx2")
+FrameFeatures analyzeAvx2(const char* pcm, size_t samples) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i sums = zero;
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pcm + 2 * i));
+        __m256i squares = _mm256_madd_epi16(v, v);
+        sums = _mm256_add_epi64(sums, _mm256_unpacklo_epi32(squares, zero));
+        sums = _mm256_add_epi64(sums, _mm256_unpackhi_epi32(squares, zero));
+    }
+    long long parts[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(parts), sums);
+
+    FrameFeatures features;
+    features.sumSquares = parts[0] + parts[1] + parts[2] + parts[3] + sumSquaresScalar(pcm, i, samples);
+    features.zeroCrossings = 0;
+    if (samples < 2) return features;
+
+    __m256i counts = zero;
+    size_t blocks = 0;
+    size_t j = 1;
+    for (; j + 16 <= samples; j += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pcm + 2 * j));
+        __m256i previous = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pcm + 2 * j - 2));
+        counts = _mm256_sub_epi16(counts,
+                                  _mm256_xor_si256(_mm256_srai_epi16(v, 15), _mm256_srai_epi16(previous, 15)));
+        if (++blocks == CROSSING_FLUSH_BLOCKS) {
+            features.zeroCrossings += sumCounts16(_mm_add_epi16(_mm256_castsi256_si128(counts),
+                                                                _mm256_extracti128_si256(counts, 1)));
+            counts = zero;
+            blocks = 0;
+        }
+    }
+    // 两半相加后每通道最多 2 * CROSSING_FLUSH_BLOCKS，仍在 16 位范围内
+    features.zeroCrossings += sumCounts16(_mm_add_epi16(_mm256_castsi256_si128(counts),
+                                                        _mm256_extracti128_si256(counts, 1)));
+    features.zeroCrossings += crossingsScalar(pcm, j, samples);
+    return features;
+}
+
+#endif // SHOTOCR_ARCH_X86
+
+#if defined(SHOTOCR_ARCH_ARM64)
+
+// NEON：每次 8 个样本，平方（不超过 2^30）两两累加到 64 位；过零计数与 SSE2 相同。
+// 按字节加载，PCM 不要求 2 字节对齐
+FrameFeatures analyzeNeon(const char* pcm, size_t samples) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(pcm);
+    uint64x2_t sums = vdupq_n_u64(0);
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        int16x8_t v = vreinterpretq_s16_u8(vld1q_u8(bytes + 2 * i));
+        int32x4_t low = vmull_s16(vget_low_s16(v), vget_low_s16(v));
+        int32x4_t high = vmull_s16(vget_high_s16(v), vget_high_s16(v));
+        sums = vpadalq_u32(sums, vreinterpretq_u32_s32(low));
+        sums = vpadalq_u32(sums, vreinterpretq_u32_s32(high));
+    }
+
+    FrameFeatures features;
+    features.sumSquares = (long long)vaddvq_u64(sums) + sumSquaresScalar(pcm, i, samples);
+    features.zeroCrossings = 0;
+    if (samples < 2) return features;
+
+    int16x8_t counts = vdupq_n_s16(0);
+    size_t blocks = 0;
+    size_t j = 1;
+    for (; j + 8 <= samples; j += 8) {
+        int16x8_t v = vreinterpretq_s16_u8(vld1q_u8(bytes + 2 * j));
+        int16x8_t previous = vreinterpretq_s16_u8(vld1q_u8(bytes + 2 * j - 2));
+        counts = vsubq_s16(counts, veorq_s16(vshrq_n_s16(v, 15), vshrq_n_s16(previous, 15)));
+        if (++blocks == CROSSING_FLUSH_BLOCKS) {
+            features.zeroCrossings += (int)vaddlvq_s16(counts);
+            counts = vdupq_n_s16(0);
+            blocks = 0;
+        }
+    }
+    features.zeroCrossings += (int)vaddlvq_s16(counts) + crossingsScalar(pcm, j, samples);
+    return features;
+}
+
+#endif // SHOTOCR_ARCH_ARM64
+
+VadKernel selectKernel() {
+    const CpuFeatures& cpu = GetCpuFeatures();
+    if (cpu.avx2) return VadKernel::Avx2;
+    if (cpu.sse2) return VadKernel::Sse2;
+    if (cpu.neon) return VadKernel::Neon;
+    return VadKernel::Scalar;
+}
+
+} // namespace
+
+bool VadKernelSupported(VadKernel kernel) {
+    const CpuFeatures& cpu = GetCpuFeatures();
+    switch (kernel) {
+        case VadKernel::Scalar: return true;
+#if defined(SHOTOCR_ARCH_X86)
+        case VadKernel::Sse2: return cpu.sse2;
+        case VadKernel::Avx2: return cpu.avx2;
+#endif
+#if defined(SHOTOCR_ARCH_ARM64)
+        case VadKernel::Neon: return cpu.neon;
+#endif
+        default: break;
+    }
+    (void)cpu;
+    return false;
+}
+
+VadKernel VadActiveKernel() {
+    static const VadKernel kernel = selectKernel();
+    return kernel;
+}
+
+const char* VadKernelName(VadKernel kernel) {
+    switch (kernel) {
+        case VadKernel::Sse2: return "sse2";
+        case VadKernel::Avx2: return "avx2";
+        case VadKernel::Neon: return "neon";
+        default: return "scalar";
+    }
+}
+
+FrameFeatures AnalyzeFrameWithKernel(VadKernel kernel, const char* pcm, size_t samples) {
+    if (!VadKernelSupported(kernel)) {
+        kernel = VadKernel::Scalar;
+    }
+
+    switch (kernel) {
+#if defined(SHOTOCR_ARCH_X86)
+        case VadKernel::Avx2: return analyzeAvx2(pcm, samples);
+        case VadKernel::Sse2: return analyzeSse2(pcm, samples);
+#endif
+#if defined(SHOTOCR_ARCH_ARM64)
+        case VadKernel::Neon: return analyzeNeon(pcm, samples);
+#endif
+        default: return analyzeScalar(pcm, samples);
+    }
+}
+
+FrameFeatures AnalyzeFrame(const char* pcm, size_t samples) {
+    return AnalyzeFrameWithKernel(VadActiveKernel(), pcm, samples);
+}
+
+double FrameEnergy(const char* pcm, size_t samples) {
+    if (samples == 0) return 0;
+    return (double)AnalyzeFrame(pcm, samples).sumSquares / samples;
+}
+
+VoiceActivityDetector::VoiceActivityDetector(const VadOptions& options)
+    : options(options), bytesPerFrame((size_t)options.sampleRate * options.frameMs / 1000 * 2), frame(0),
+      firstSpeech(-1), lastSpeech(-1), energy(0), floor(0), seeded(false) {
+    partial.reserve(bytesPerFrame);
+}
+
+bool VoiceActivityDetector::processFrame(const char* data) {
+    return processFeatures(AnalyzeFrame(data, bytesPerFrame / 2));
+}
+
+bool VoiceActivityDetector::processFeatures(const FrameFeatures& features) {
+    size_t samples = bytesPerFrame / 2;
+    energy = (double)features.sumSquares / samples;
+    double zcr = samples > 1 ? (double)features.zeroCrossings / (samples - 1) : 0;
+    if (!seeded) {
+        floor = energy;
+        seeded = true;
+    } else {
+        floor = energy < floor ? energy : floor * FLOOR_RISE;
+    }
+
+    // 浊音能量远高于背景；清辅音能量低但过零率高，背景噪声（多为低频）过零率低
+    bool speech = energy > options.loudEnergy ||
+                  energy > (std::max)(floor * options.speechRatio, options.minSpeechEnergy) ||
+                  (zcr > options.fricativeZcr &&
+                   energy > (std::max)(floor * options.fricativeRatio, options.minSpeechEnergy));
+    if (speech) {
+        if (firstSpeech < 0) firstSpeech = frame;
+        lastSpeech = frame;
+    }
+    frame++;
+    return speech;
+}
+
+void VoiceActivityDetector::feed(const char* data, size_t size) {
+    size_t offset = 0;
+    if (!partial.empty()) {
+        size_t take = (std::min)(bytesPerFrame - partial.size(), size);
+        partial.insert(partial.end(), data, data + take);
+        offset = take;
+        if (partial.size() < bytesPerFrame) return;
+        processFrame(partial.data());
+        partial.clear();
+    }
+    while (offset + bytesPerFrame <= size) {
+        processFrame(data + offset);
+        offset += bytesPerFrame;
+    }
+    partial.insert(partial.end(), data + offset, data + size);
+}
+
+void VoiceActivityDetector::seedNoiseFloor(double value) {
+    floor = value;
+    seeded = true;
+}
+
+int VoiceActivityDetector::trailingSilenceMs() const {
+    if (lastSpeech < 0) return 0;
+    return (int)((frame - 1 - lastSpeech) * options.frameMs);
+}
+
+SpeechRange FindSpeechRange(const char* pcm, size_t size, const VadOptions& options) {
+    SpeechRange range;
+    range.begin = 0;
+    range.end = 0;
+    VoiceActivityDetector detector(options);
+    size_t frameBytes = detector.frameBytes();
+    size_t frames = frameBytes > 0 ? size / frameBytes : 0;
+    if (frames == 0) return range;
+
+    std::vector<FrameFeatures> features(frames);
+    std::vector<double> energies(frames);
+    for (size_t f = 0; f < frames; ++f) {
+        features[f] = AnalyzeFrame(pcm + f * frameBytes, frameBytes / 2);
+        energies[f] = (double)features[f].sumSquares / (frameBytes / 2);
+    }
+    std::vector<double>::iterator percentile = energies.begin() + (size_t)(frames * FLOOR_PERCENTILE);
+    std::nth_element(energies.begin(), percentile, energies.end());
+    detector.seedNoiseFloor(*percentile);
+    for (size_t f = 0; f < frames; ++f) detector.processFeatures(features[f]);
+    if (!detector.speechSeen()) return range;
+
+    size_t lead = (size_t)options.sampleRate * options.leadPadMs / 1000 * 2;
+    size_t trail = (size_t)options.sampleRate * options.trailPadMs / 1000 * 2;
+    size_t first = (size_t)detector.firstSpeechFrame() * frameBytes;
+    size_t last = (size_t)(detector.lastSpeechFrame() + 1) * frameBytes;
+    range.begin = first > lead ? first - lead : 0;
+    range.end = (std::min)(size, last + trail);
+    return range;
+}
+
+size_t TrimSilence(std::vector<char>& pcm, const VadOptions& options) {
+    SpeechRange range = FindSpeechRange(pcm.data(), pcm.size(), options);
+    size_t removed = pcm.size() - (range.end - range.begin);
+    pcm.resize(range.end);
+    pcm.erase(pcm.begin(), pcm.begin() + range.begin);
+    return removed;
+}
+
+std::string DescribeSilenceTrim(size_t totalBytes, size_t trimmedBytes, int sampleRate) {
+    char line[200];
+    double bytesPerSecond = sampleRate * 2.0;
+    std::snprintf(line, sizeof(line), "[vad] trimmed %lu of %lu B (%.1f s of %.1f s silent)%s",
+                  (unsigned long)trimmedBytes, (unsigned long)totalBytes, trimmedBytes / bytesPerSecond,
+                  totalBytes / bytesPerSecond, totalBytes > 0 && trimmedBytes == totalBytes ? ", no speech" : "");
+    return line;
+}
@@ -1,10 +1,41 @@
 #include "../include/VoiceRecognizer.h"
 #include "../include/AppManager.h"
 #include "../include/StringUtils.h"
+#include "../include/AudioFormat.h"
+#include "../include/AsrClient.h"
+#include "../include/HttpUpload.h"
+#include "../include/Executor.h"
+#include "../include/VoiceActivity.h"
+#include "../include/FlacCodec.h"
+#include <memory>
 #include <wininet.h>
 #include <sstream>
 #include <algorithm>
 
+namespace {
+
+// 识别任务各阶段的时限（毫秒），超过即取消任务
+const int UPLOAD_DEADLINE_MS = 30000;
+const int PARSE_DEADLINE_MS = 2000;
+// 停止录音后等设备交回缓冲区的时限（毫秒）
+const int CAPTURE_DRAIN_MS = 500;
+// 同一段录音以 WAV 上传时的文件头长度，FLAC 不比它小就不用
+const size_t WAV_HEADER_BYTES = 44;
+// 边录边识别时同时识别的段数，其余的排队
+const int MAX_PARALLEL_SEGMENTS = 3;
+
+// 排队等待识别的录音段的临时文件（关闭时由系统删除）；每次录音一个文件，取不到目录时留在内存中
+std::string dictationSpillPath(unsigned recordingId) {
+    wchar_t directory[MAX_PATH];
+    DWORD length = GetTempPathW(MAX_PATH, directory);
+    if (length == 0 || length >= MAX_PATH) return std::string();
+    std::wstring name = L"ShotOcr-dictation-" + std::to_wstring(GetCurrentProcessId()) + L"-" +
+                        std::to_wstring(recordingId) + L".pcm";
+    return WideToUtf8(std::wstring(directory) + name);
+}
+
+} // namespace
+
 // 链接库只在 MSVC 编译器下有效，MinGW 忽略这些指令
 #ifdef _MSC_VER
 #pragma comment(lib, "winmm.lib")
@@ -12,11 +43,16 @@
 #endif
 
 VoiceRecognizer::VoiceRecognizer(AppManager* app) 
-    : appManager(app), hWaveIn(nullptr), keyListeningActive(false), isRecording(false), shouldStop(false) {
+    : appManager(app), hWaveIn(nullptr), keyListeningActive(false), streamingEnabled(true),
+      autoStopMs(DEFAULT_AUTO_STOP_MS), autoStopRequested(false), recordingId(0), isRecording(false),
+      shouldStop(false), asrJobs(&SharedExecutor().io()) {
     initializeWaveFormat();
 }
 
 VoiceRecognizer::~VoiceRecognizer() {
+    // 先让进行中的识别退出，它们还在使用对冲器等成员
+    asrJobs.cancelAll();
+    asrJobs.waitAll(5000);
     if (isRecording) {
         stopRecording();
     }
@@ -38,32 +74,39 @@ void VoiceRecognizer::startRecording() {
     appManager->showToast("开始录音...\nESC或右键取消，空格键结束", 2000);
     
     try {
+        // 设备开始录音前清除：消费线程据此决定是否交还缓冲区
+        shouldStop = false;
+        autoStopRequested = false;
+        recordingId++;
         setupRecording();
         isRecording = true;
-        shouldStop = false;
         keyListeningActive = true;
+        appManager->changeInputMode(INPUT_IDLE, INPUT_RECORDING);
         
-        // 清空之前的录音数据
-        recordedData.clear();
-        
-        // 只启动计时线程，不再需要按键检测线程
-        timerThread = std::thread(&VoiceRecognizer::timerLoop, this);
+        // 只启动计时线程，不再需要按键检测线程。边录边识别时录音长度不受单次请求的上限限制
+        timerThread = std::thread(&VoiceRecognizer::timerLoop, this, !streaming);
         
     } catch (...) {
         appManager->showToast("录音启动失败");
         cleanupRecording();
+        appManager->changeInputMode(INPUT_RECORDING, INPUT_IDLE);
     }
 }
 
 void VoiceRecognizer::stopRecording() {
-    if (!isRecording) return;
+    // 自动结束、空格与 Esc 都把结束或取消排进 I/O 池，可能同时执行：只有先把 isRecording 置为 false 的一方继续，
+    // 否则两边会重复 join 计时线程、重复关闭录音设备
+    if (!isRecording.exchange(false)) return;
     
     // 先设置标志，确保HotkeyManager能立即感知状态变化
     keyListeningActive = false;
-    shouldStop = true;
-    isRecording = false;
+    {
+        std::lock_guard<std::mutex> lock(deviceMutex);
+        shouldStop = true;
+    }
+    appManager->changeInputMode(INPUT_RECORDING, INPUT_IDLE);
     
-    // 停止录音设备
+    // 停止录音设备：所有缓冲区（包括录了一半的）随即交回并发布
     if (hWaveIn) {
         waveInStop(hWaveIn);
         waveInReset(hWaveIn);
@@ -74,34 +117,83 @@ void VoiceRecognizer::stopRecording() {
         timerThread.join();
     }
     
+    std::vector<char> recordedData = finishCapture();
+    // 超过 MAX_RECORD_TIME 的部分只送入了分段识别，存下的录音不完整，不能整段重传
+    bool complete = !capture || capture->stats().truncatedBytes == 0;
+    // 录音已全部送入分段识别，之后由识别任务持有
+    std::shared_ptr<StreamingAsr> stream(streaming.release());
     cleanupRecording();
     
-    if (!recordedData.empty()) {
+    // 整段上传时只上传语音所在的部分；整段都是静音时不再请求
+    bool recorded = !recordedData.empty();
+    size_t recordedBytes = recordedData.size();
+    size_t trimmed = TrimSilence(recordedData);
+    std::string trimLog = DescribeSilenceTrim(recordedBytes, trimmed, SAMPLE_RATE) + "\n";
+    OutputDebugStringA(trimLog.c_str());
+    
+    if (!recordedData.empty() || !complete) {
         appManager->showToast("正在识别...");
         
-        // 创建副本避免在异步操作中访问成员变量
-        std::vector<char> dataCopy = recordedData;
-        recordedData.clear();
+        // 录音数据移交给识别线程，避免在异步操作中访问成员变量，也不产生副本
+        std::shared_ptr<std::vector<char>> pcmData = std::make_shared<std::vector<char>>(std::move(recordedData));
         
-        std::thread([this, dataCopy]() {
-            std::vector<char> wavData = createWavFile(dataCopy);
-            std::string result = sendToYoudaoAPI(wavData);
-            processResult(result);
-        }).detach();
+        // 识别作为可取消的任务运行：Esc 或阶段超时都会中断请求，录音数据随任务结束释放。
+        // 任务进行期间按键分发器把 Esc 转为取消识别
+        std::lock_guard<std::mutex> lock(asrJobMutex);
+        appManager->setRecognizing(true);
+        asrJob = asrJobs.start("asr", [this, pcmData, stream, complete](Job& job) {
+            AsrResult asr;
+            size_t failedSegments = 0;
+            if (stream && job.enterStage("stream", UPLOAD_DEADLINE_MS)) {
+                int cancelId = job.token().addAction([stream]() { stream->cancel(); });
+                StreamingAsrResult streamed = stream->finish(UPLOAD_DEADLINE_MS);
+                job.token().removeAction(cancelId);
+                std::string log = DescribeStreamingAsr(streamed) + "\n";
+                OutputDebugStringA(log.c_str());
+                if (streamed.ok || (!complete && !job.cancelled())) {
+                    // 录音不完整时无法整段重传，有段失败也只能用其余段的文字
+                    failedSegments = streamed.failedSegments;
+                    asr.parsed = true;
+                    asr.errorCode = streamed.text.empty() ? "4304" : "0";
+                    asr.text = streamed.text;
+                }
+            }
+            // 没有分段识别或有段失败时上传整段录音
+            if (!asr.parsed && complete && job.enterStage("upload", UPLOAD_DEADLINE_MS)) {
+                asr = ParseAsrResponse(sendToYoudaoAPI(pcmData, job.token()));
+            }
+            if (job.enterStage("parse", PARSE_DEADLINE_MS)) {
+                processResult(asr);
+                if (failedSegments > 0 && !asr.text.empty()) {
+                    appManager->showToast("有 " + std::to_string(failedSegments) + " 段识别失败，文字不完整");
+                }
+            } else {
+                appManager->showToast(job.state() == JOB_TIMED_OUT ? "识别超时，请检查网络连接" : "已取消识别");
+            }
+            std::string log = DescribeJob(job) + "\n";
+            OutputDebugStringA(log.c_str());
+            // 识别期间可能又录了一段，只有最新的任务结束时才清除
+            std::lock_guard<std::mutex> lock(asrJobMutex);
+            if (asrJob.get() == &job) appManager->setRecognizing(false);
+        });
     } else {
-        appManager->showToast("录音数据为空");
+        appManager->showToast(recorded ? "未检测到语音内容" : "录音数据为空");
     }
 }
 
 void VoiceRecognizer::cancelRecording() {
-    if (!isRecording) return;
+    // 与 stopRecording 相同：结束与取消可能同时排进 I/O 池，只有先把 isRecording 置为 false 的一方继续
+    if (!isRecording.exchange(false)) return;
     
     // 先设置标志，确保HotkeyManager能立即感知状态变化
     keyListeningActive = false;
-    shouldStop = true;
-    isRecording = false;
+    {
+        std::lock_guard<std::mutex> lock(deviceMutex);
+        shouldStop = true;
+    }
+    appManager->changeInputMode(INPUT_RECORDING, INPUT_IDLE);
     
-    // 停止录音设备
+    // 停止录音设备：所有缓冲区（包括录了一半的）随即交回并发布
     if (hWaveIn) {
         waveInStop(hWaveIn);
         waveInReset(hWaveIn);
@@ -112,39 +204,92 @@ void VoiceRecognizer::cancelRecording() {
         timerThread.join();
     }
     
+    finishCapture();
     cleanupRecording();
-    recordedData.clear();
     
     appManager->showToast("录音已取消");
 }
 
 void VoiceRecognizer::setupRecording() {
+    // 回调从 waveInOpen 起就可能到达，先准备好缓冲区
+    capture.reset(new PcmCapture(NUM_BUFFERS, BUFFER_SIZE,
+                                 (size_t)SAMPLE_RATE * CHANNELS * (BITS_PER_SAMPLE / 8) * MAX_RECORD_TIME));
+    
     MMRESULT result = waveInOpen(&hWaveIn, WAVE_MAPPER, &waveFormat, 
                                  (DWORD_PTR)waveInProc, (DWORD_PTR)this, CALLBACK_FUNCTION);
     
     if (result != MMSYSERR_NOERROR) {
+        hWaveIn = nullptr;
         throw std::runtime_error("Failed to open wave input device");
     }
     
-    // 准备录音缓冲区
-    audioBuffers.resize(NUM_BUFFERS);
+    // 准备录音缓冲区，dwUser 记录缓冲区编号
     waveHeaders.resize(NUM_BUFFERS);
     
     for (int i = 0; i < NUM_BUFFERS; i++) {
-        audioBuffers[i].resize(BUFFER_SIZE);
-        
-        waveHeaders[i].lpData = audioBuffers[i].data();
+        ZeroMemory(&waveHeaders[i], sizeof(WAVEHDR));
+        waveHeaders[i].lpData = capture->buffer(i);
         waveHeaders[i].dwBufferLength = BUFFER_SIZE;
-        waveHeaders[i].dwFlags = 0;
-        waveHeaders[i].dwLoops = 0;
+        waveHeaders[i].dwUser = (DWORD_PTR)i;
         
         waveInPrepareHeader(hWaveIn, &waveHeaders[i], sizeof(WAVEHDR));
         waveInAddBuffer(hWaveIn, &waveHeaders[i], sizeof(WAVEHDR));
     }
     
+    if (streamingEnabled) {
+        StreamingAsrOptions options;
+        options.segmentDeadlineMs = UPLOAD_DEADLINE_MS;
+        options.maxConcurrentSegments = MAX_PARALLEL_SEGMENTS;
+        options.spillPath = dictationSpillPath(recordingId);
+        streaming.reset(new StreamingAsr([this](const std::shared_ptr<std::vector<char>>& pcm, RequestCancel& cancel,
+                                                std::string& text) {
+            return recognizeSegment(pcm, cancel, text);
+        }, &SharedExecutor().io(), options));
+    }
+    if (autoStopMs > 0) {
+        autoStopDetector.reset(new VoiceActivityDetector());
+    }
+    if (streaming || autoStopDetector) {
+        capture->setListener([this](const char* data, size_t size) { onRecorded(data, size); });
+    }
+    // 拷贝与交还缓冲区都在消费线程中进行，回调里不再调用 waveIn 函数
+    capture->start([this](size_t index) { return requeueBuffer(index); });
     waveInStart(hWaveIn);
 }
 
+bool VoiceRecognizer::requeueBuffer(size_t index) {
+    std::lock_guard<std::mutex> lock(deviceMutex);
+    if (shouldStop || !hWaveIn || index >= waveHeaders.size()) return false;
+    WAVEHDR& header = waveHeaders[index];
+    header.dwBytesRecorded = 0;
+    header.dwFlags &= ~WHDR_DONE;
+    return waveInAddBuffer(hWaveIn, &header, sizeof(WAVEHDR)) == MMSYSERR_NOERROR;
+}
+
+void VoiceRecognizer::onRecorded(const char* data, size_t size) {
+    // 在 capture 的消费线程中调用；停止录音时先等该线程退出，才移交或释放下面两个对象
+    if (streaming) streaming->feed(data, size);
+    if (!autoStopDetector) return;
+    autoStopDetector->feed(data, size);
+    if (!autoStopDetector->speechSeen() || autoStopDetector->trailingSilenceMs() < autoStopMs) return;
+    if (autoStopRequested.exchange(true)) return;
+    // 交给 I/O 池执行：stopRecording 要等本线程退出。排队期间用户可能已结束并开始了新的录音
+    unsigned id = recordingId;
+    SharedExecutor().io().submit([this, id]() {
+        if (id != recordingId || !isRecording) return;
+        appManager->showToast("检测到说话结束，自动结束录音");
+        stopRecording();
+    });
+}
+
+std::vector<char> VoiceRecognizer::finishCapture() {
+    if (!capture) return std::vector<char>();
+    std::vector<char> pcm = capture->finish(CAPTURE_DRAIN_MS);
+    std::string log = DescribePcmCaptureStats(capture->stats()) + "\n";
+    OutputDebugStringA(log.c_str());
+    return pcm;
+}
+
 void VoiceRecognizer::cleanupRecording() {
     if (hWaveIn) {
         waveInStop(hWaveIn);
@@ -159,7 +304,10 @@ void VoiceRecognizer::cleanupRecording() {
     }
     
     waveHeaders.clear();
-    audioBuffers.clear();
+    // 设备关闭后不会再有回调，消费线程随之退出；取消录音时未移交的分段识别随之取消
+    capture.reset();
+    streaming.reset();
+    autoStopDetector.reset();
 }
 
 // 新增：按键事件处理方法
@@ -173,191 +321,170 @@ void VoiceRecognizer::onKeyPressed(int vkCode) {
         case VK_ESCAPE:
         case VK_RBUTTON:
             // 取消录音
-            std::thread([this]() {
+            SharedExecutor().io().submit([this]() {
                 cancelRecording();
-            }).detach();
+            });
             break;
             
         case VK_SPACE:
             // 结束录音
-            std::thread([this]() {
+            SharedExecutor().io().submit([this]() {
                 stopRecording();
-            }).detach();
+            });
             break;
     }
 }
 
-void VoiceRecognizer::timerLoop() {
+void VoiceRecognizer::timerLoop(bool limited) {
     auto startTime = GetTickCount64();
     
     while (isRecording && !shouldStop) {
         auto elapsed = GetTickCount64() - startTime;
-        if (elapsed >= (MAX_RECORD_TIME-3) * 1000) {
-            // 使用异步方式避免死锁
-            std::thread([this]() {
+        if (limited && elapsed >= (MAX_RECORD_TIME-3) * 1000) {
+            // 交给 I/O 池执行：stopRecording 要等本线程退出
+            SharedExecutor().io().submit([this]() {
                 appManager->showToast("录音时间上限60s，自动结束");
                 stopRecording();
-            }).detach();
+            });
             return;
         }
         Sleep(1000);
     }
 }
 
-void CALLBACK VoiceRecognizer::waveInProc(HWAVEIN hwi, UINT uMsg, DWORD_PTR dwInstance, DWORD_PTR dwParam1, DWORD_PTR /*dwParam2*/) {
+void CALLBACK VoiceRecognizer::waveInProc(HWAVEIN /*hwi*/, UINT uMsg, DWORD_PTR dwInstance, DWORD_PTR dwParam1, DWORD_PTR /*dwParam2*/) {
     VoiceRecognizer* recorder = (VoiceRecognizer*)dwInstance;
     
-    if (uMsg == WIM_DATA && recorder->isRecording) {
+    if (uMsg == WIM_DATA && recorder->capture) {
+        auto entered = std::chrono::steady_clock::now();
         WAVEHDR* header = (WAVEHDR*)dwParam1;
         
-        // 保存录音数据
-        recorder->recordedData.insert(recorder->recordedData.end(),
-                                     header->lpData, 
-                                     header->lpData + header->dwBytesRecorded);
-        
-        // 重新添加缓冲区
-        if (!recorder->shouldStop) {
-            header->dwFlags = 0;
-            waveInPrepareHeader(hwi, header, sizeof(WAVEHDR));
-            waveInAddBuffer(hwi, header, sizeof(WAVEHDR));
-        }
+        // 只发布缓冲区编号与长度：拷贝、交还缓冲区由消费线程完成，回调不分配内存也不等锁
+        recorder->capture->publish((size_t)header->dwUser, header->dwBytesRecorded);
+        recorder->capture->recordCallbackTime(entered);
     }
 }
 
-std::vector<char> VoiceRecognizer::createWavFile(const std::vector<char>& audioData) {
-    std::vector<char> wavFile;
-    
-    // WAV文件头
-    const char* riff = "RIFF";
-    const char* wave = "WAVE";
-    const char* fmt = "fmt ";
-    const char* data = "data";
-    
-    uint32_t fileSize = 36 + audioData.size();
-    uint32_t fmtSize = 16;
-    uint32_t dataSize = audioData.size();
-    
-    // 写入文件头
-    wavFile.insert(wavFile.end(), riff, riff + 4);
-    wavFile.insert(wavFile.end(), (char*)&fileSize, (char*)&fileSize + 4);
-    wavFile.insert(wavFile.end(), wave, wave + 4);
-    
-    // 写入格式块
-    wavFile.insert(wavFile.end(), fmt, fmt + 4);
-    wavFile.insert(wavFile.end(), (char*)&fmtSize, (char*)&fmtSize + 4);
-    wavFile.insert(wavFile.end(), (char*)&waveFormat, (char*)&waveFormat + 16);
-    
-    // 写入数据块
-    wavFile.insert(wavFile.end(), data, data + 4);
-    wavFile.insert(wavFile.end(), (char*)&dataSize, (char*)&dataSize + 4);
-    wavFile.insert(wavFile.end(), audioData.begin(), audioData.end());
+RequestBody VoiceRecognizer::buildAsrRequestBody(const std::vector<char>& pcmData, const std::string& boundary,
+                                                 bool& flac) {
+    std::string preamble = "--" + boundary + "\r\n";
+    preamble += "Content-Disposition: form-data; name=\"audioData\"; filename=\"blob\"\r\n";
+    
+    RequestBody body;
+    if (flac) {
+        FlacEncodeStats stats;
+        std::string encoded = EncodeFlac(pcmData.data(), pcmData.size(), SAMPLE_RATE, FlacOptions(), &stats);
+        std::string log = DescribeFlacEncode(stats) + "\n";
+        OutputDebugStringA(log.c_str());
+        // 噪声等压缩不了的录音仍上传 WAV
+        flac = encoded.size() < pcmData.size() + WAV_HEADER_BYTES;
+        if (flac) {
+            preamble += "Content-Type: audio/flac\r\n\r\n";
+            body.appendOwned(std::move(preamble));
+            body.appendOwned(std::move(encoded));
+            body.appendOwned("\r\n--" + boundary + "--\r\n");
+            return body;
+        }
+    }
     
-    return wavFile;
+    // multipart 前导与 WAV 头合并为一个小片段，PCM 数据直接借用录音缓冲区
+    preamble += "Content-Type: audio/wav\r\n\r\n";
+    preamble += BuildWavHeader(SAMPLE_RATE, CHANNELS, BITS_PER_SAMPLE, (uint32_t)pcmData.size());
+    body.appendOwned(std::move(preamble));
+    body.appendBorrowed(pcmData.data(), pcmData.size());
+    body.appendOwned("\r\n--" + boundary + "--\r\n");
+    return body;
 }
 
-std::string VoiceRecognizer::sendToYoudaoAPI(const std::vector<char>& audioData) {
-    HINTERNET hInternet = nullptr;
-    HINTERNET hConnect = nullptr;
-    HINTERNET hRequest = nullptr;
-    std::string response_data;
-    
-    // 预先声明所有变量以避免跨越 goto 的初始化
+bool VoiceRecognizer::isRecognizing() {
+    std::lock_guard<std::mutex> lock(asrJobMutex);
+    return asrJob && asrJob->state() == JOB_RUNNING;
+}
+
+void VoiceRecognizer::cancelRecognition() {
+    // 取消动作会关闭 WinINet 句柄，不在锁内执行，免得 isRecognizing() 被拖住
+    std::shared_ptr<Job> job;
+    {
+        std::lock_guard<std::mutex> lock(asrJobMutex);
+        job = asrJob;
+    }
+    if (job) job->cancel();
+}
+
+std::string VoiceRecognizer::sendToYoudaoAPI(const std::shared_ptr<std::vector<char>>& pcmData, RequestCancel& cancel) {
+    // 编码器只支持单声道 16 位
+    bool flac = audioFormat.useFlac() && CHANNELS == 1 && BITS_PER_SAMPLE == 16;
+    std::string response = postAsrRequest(pcmData, flac, cancel);
+    // FLAC 请求失败时改传 WAV；WAV 成功才认定服务商不接受 FLAC，网络故障不影响以后的请求
+    if (flac && !cancel.cancelled() && IsAsrAudioRejected(ParseAsrResponse(response))) {
+        bool wav = false;
+        std::string fallback = postAsrRequest(pcmData, wav, cancel);
+        AsrResult asr = ParseAsrResponse(fallback);
+        if (!IsAsrAudioRejected(asr)) {
+            audioFormat.reportFlacRejected();
+            OutputDebugStringA("[flac] rejected by the ASR service, uploading WAV from now on\n");
+        }
+        if (asr.parsed) response.swap(fallback);
+    }
+    return response;
+}
+
+std::string VoiceRecognizer::postAsrRequest(const std::shared_ptr<std::vector<char>>& pcmData, bool& flac,
+                                            RequestCancel& cancel) {
     std::string boundary = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
-    std::string postData;
-    std::string headers;
-    BOOL result = FALSE;
-    
-    // 构建multipart/form-data内容
-    postData += "--" + boundary + "\r\n";
-    postData += "Content-Disposition: form-data; name=\"audioData\"; filename=\"blob\"\r\n";
-    postData += "Content-Type: audio/wav\r\n\r\n";
-    postData.append(audioData.begin(), audioData.end());
-    postData += "\r\n--" + boundary + "--\r\n";
+    // 被取消的副本可能在本函数返回后才结束，请求体与它借用的录音数据由各次尝试共同持有
+    std::shared_ptr<RequestBody> body = std::make_shared<RequestBody>(buildAsrRequestBody(*pcmData, boundary, flac));
     
-    headers = "Content-Type: multipart/form-data; boundary=" + boundary + "\r\n";
+    std::string headers = "Content-Type: multipart/form-data; boundary=" + boundary + "\r\n";
     headers += "Accept: */*\r\n";
     headers += "Origin: https://ai.youdao.com\r\n";
     headers += "Referer: https://ai.youdao.com/\r\n";
     headers += "Accept-Language: zh-CN,zh;q=0.9,en-US;q=0.8,en;q=0.7\r\n";
     
-    hInternet = InternetOpenA("VoiceRecognizer", INTERNET_OPEN_TYPE_DIRECT, nullptr, nullptr, 0);
-    if (!hInternet) goto cleanup;
-    
-    hConnect = InternetConnectA(hInternet, "aidemo.youdao.com", INTERNET_DEFAULT_HTTPS_PORT, nullptr, nullptr, INTERNET_SERVICE_HTTP, 0, 0);
-    if (!hConnect) goto cleanup;
-    
-    hRequest = HttpOpenRequestA(hConnect, "POST", "/asr?lang=zh-CHS&mutiSentences=true", nullptr, nullptr, nullptr, INTERNET_FLAG_SECURE, 0);
-    if (!hRequest) goto cleanup;
-    
-    result = HttpSendRequestA(hRequest, headers.c_str(), (DWORD)headers.length(), (LPVOID)postData.c_str(), (DWORD)postData.length());
-    
-    if (result) {
-        char buffer[4096];
-        DWORD bytesRead;
-        while (InternetReadFile(hRequest, buffer, sizeof(buffer), &bytesRead) && bytesRead > 0) {
-            response_data.append(buffer, bytesRead);
+    // 与截图识别共用同一会话，连接可在两种请求之间复用；副本由 WinINet 另开一条连接发送。
+    // 能解析出 errorCode 的响应（包括“未识别到语音”）即为有效结果
+    std::string response_data;
+    asrHedger.run([pcmData, body, headers](int, RequestCancel& cancel, std::string& result) {
+        std::string response;
+        if (!WinInetSession::instance().post(YOUDAO_API_HOST, INTERNET_DEFAULT_HTTPS_PORT,
+                                             "/asr?lang=zh-CHS&mutiSentences=true", true, headers, *body, response,
+                                             &cancel)) {
+            return false;
         }
-    }
-
-cleanup:
-    if (hRequest) InternetCloseHandle(hRequest);
-    if (hConnect) InternetCloseHandle(hConnect);
-    if (hInternet) InternetCloseHandle(hInternet);
+        if (!ParseAsrResponse(response).parsed) return false;
+        result.swap(response);
+        return true;
+    }, response_data, &cancel);
     
+    std::string log = DescribeHedgeStats(asrHedger.stats()) + "\n";
+    OutputDebugStringA(log.c_str());
     return response_data;
 }
 
-void VoiceRecognizer::processResult(const std::string& result) {
-    std::string recognizedText;
-    
-    // 解析JSON响应
-    size_t errorCodePos = result.find("\"errorCode\":");
-    if (errorCodePos != std::string::npos) {
-        size_t codeStart = result.find('\"', errorCodePos + 12);
-        if (codeStart != std::string::npos) {
-            codeStart++;
-            size_t codeEnd = result.find('\"', codeStart);
-            if (codeEnd != std::string::npos) {
-                std::string errorCode = result.substr(codeStart, codeEnd - codeStart);
-                
-                if (errorCode == "0") {
-                    // 识别成功，提取result数组
-                    size_t resultPos = result.find("\"result\":");
-                    if (resultPos != std::string::npos) {
-                        size_t arrayStart = result.find('[', resultPos);
-                        size_t arrayEnd = result.find(']', arrayStart);
-                        if (arrayStart != std::string::npos && arrayEnd != std::string::npos) {
-                            std::string arrayContent = result.substr(arrayStart + 1, arrayEnd - arrayStart - 1);
-                            
-                            // 提取数组中的字符串
-                            size_t pos = 0;
-                            while ((pos = arrayContent.find('\"', pos)) != std::string::npos) {
-                                pos++;
-                                size_t end = arrayContent.find('\"', pos);
-                                if (end != std::string::npos) {
-                                    if (!recognizedText.empty()) recognizedText += " ";
-                                    recognizedText += arrayContent.substr(pos, end - pos);
-                                    pos = end + 1;
-                                } else {
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                } else if (errorCode == "4304") {
-                    appManager->showToast("未识别到有效语音内容");
-                    return;
-                } else {
-                    appManager->showToast("识别失败，错误代码: " + errorCode);
-                    return;
-                }
-            }
-        }
+bool VoiceRecognizer::recognizeSegment(const std::shared_ptr<std::vector<char>>& pcmData, RequestCancel& cancel,
+                                       std::string& text) {
+    AsrResult asr = ParseAsrResponse(sendToYoudaoAPI(pcmData, cancel));
+    // 这一段没有语音（停顿较长）不算失败
+    if (asr.errorCode == "4304") return true;
+    if (asr.errorCode != "0") return false;
+    text = asr.text;
+    return true;
+}
+
+void VoiceRecognizer::processResult(const AsrResult& asr) {
+    // errorCode 为 "0" 时取 result 数组中的各句
+    if (asr.errorCode == "4304") {
+        appManager->showToast("未识别到有效语音内容");
+        return;
+    }
+    if (!asr.errorCode.empty() && asr.errorCode != "0") {
+        appManager->showToast("识别失败，错误代码: " + asr.errorCode);
+        return;
     }
     
-    if (!recognizedText.empty()) {
-        copyToClipboard(recognizedText);
-        insertTextAtCursor(recognizedText);
+    if (asr.errorCode == "0" && !asr.text.empty()) {
+        copyToClipboard(asr.text);
+        insertTextAtCursor(asr.text);
         appManager->showToast("识别成功！已输入文本并复制到剪贴板");
     } else {
         appManager->showToast("识别失败，未检测到语音内容");
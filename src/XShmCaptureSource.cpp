@@ -0,0 +1,132 @@
+#include "../include/XShmCaptureSource.h"
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+namespace {
+
+// 远程 X 服务器上 XShmAttach 会异步报 BadAccess，默认处理器会直接退出进程
+bool attachFailed = false;
+
+int onAttachError(Display*, XErrorEvent*) {
+    attachFailed = true;
+    return 0;
+}
+
+} // namespace
+
+struct XShmCaptureSource::Impl {
+    Display* display;
+    Window root;
+    Visual* visual;
+    int depth;
+    int screenWidth;
+    int screenHeight;
+    int dpi;
+
+    XShmSegmentInfo segment;
+    bool attached;
+
+    // 当前尺寸的 XImage 头，数据指向共享段
+    XImage* image;
+
+    Impl() : display(nullptr), root(0), visual(nullptr), depth(0), screenWidth(0), screenHeight(0), dpi(96),
+             attached(false), image(nullptr) {
+        segment.shmid = -1;
+        segment.shmaddr = nullptr;
+        segment.readOnly = False;
+    }
+
+    bool open(const char* displayName) {
+        display = XOpenDisplay(displayName);
+        if (!display || !XShmQueryExtension(display)) return false;
+
+        int screen = DefaultScreen(display);
+        root = RootWindow(display, screen);
+        visual = DefaultVisual(display, screen);
+        depth = DefaultDepth(display, screen);
+        screenWidth = DisplayWidth(display, screen);
+        screenHeight = DisplayHeight(display, screen);
+
+        int heightMm = DisplayHeightMM(display, screen);
+        if (heightMm > 0) dpi = (int)(screenHeight * 25.4 / heightMm + 0.5);
+
+        // 只支持每像素 32 位的 TrueColor（内存布局即 BGRA）
+        if ((depth != 24 && depth != 32) || visual->red_mask != 0xFF0000 || visual->blue_mask != 0xFF) return false;
+
+        // 共享段按整屏分配一次，之后任何不超过屏幕的截图都复用它
+        size_t bytes = (size_t)screenWidth * screenHeight * 4;
+        segment.shmid = shmget(IPC_PRIVATE, bytes, IPC_CREAT | 0600);
+        if (segment.shmid < 0) return false;
+        segment.shmaddr = static_cast<char*>(shmat(segment.shmid, nullptr, 0));
+        if (segment.shmaddr == reinterpret_cast<char*>(-1)) {
+            segment.shmaddr = nullptr;
+            return false;
+        }
+        segment.readOnly = False;
+        attachFailed = false;
+        XErrorHandler previousHandler = XSetErrorHandler(onAttachError);
+        Bool ok = XShmAttach(display, &segment);
+        XSync(display, False);
+        XSetErrorHandler(previousHandler);
+        if (!ok || attachFailed) return false;
+        attached = true;
+
+        // 两端都已映射，标记删除，进程退出时内核自动回收
+        shmctl(segment.shmid, IPC_RMID, nullptr);
+        return true;
+    }
+
+    bool ensureImage(int width, int height) {
+        if (image && image->width == width && image->height == height) return true;
+        if (image) {
+            // 数据属于共享段，不能让 XDestroyImage 释放
+            image->data = nullptr;
+            XDestroyImage(image);
+        }
+        image = XShmCreateImage(display, visual, (unsigned int)depth, ZPixmap, segment.shmaddr, &segment,
+                                (unsigned int)width, (unsigned int)height);
+        return image && image->bits_per_pixel == 32;
+    }
+
+    ~Impl() {
+        if (image) {
+            image->data = nullptr;
+            XDestroyImage(image);
+        }
+        if (attached) XShmDetach(display, &segment);
+        if (segment.shmaddr) shmdt(segment.shmaddr);
+        if (segment.shmid >= 0 && !attached) shmctl(segment.shmid, IPC_RMID, nullptr);
+        if (display) XCloseDisplay(display);
+    }
+};
+
+XShmCaptureSource::XShmCaptureSource(const char* displayName) : impl(new Impl()) {
+    if (!impl->open(displayName)) {
+        impl.reset();
+    }
+}
+
+XShmCaptureSource::~XShmCaptureSource() {
+}
+
+bool XShmCaptureSource::isOpen() const {
+    return impl != nullptr;
+}
+
+bool XShmCaptureSource::capture(int x, int y, int width, int height, PixelBufferView& view) {
+    if (!impl) return false;
+    if (!ClipCaptureRegion(x, y, width, height, impl->screenWidth, impl->screenHeight)) return false;
+    if (!impl->ensureImage(width, height)) return false;
+
+    if (!XShmGetImage(impl->display, impl->root, impl->image, x, y, AllPlanes)) return false;
+
+    view.pixels = reinterpret_cast<const unsigned char*>(impl->image->data);
+    view.width = width;
+    view.height = height;
+    view.stride = impl->image->bytes_per_line;
+    view.dpi = impl->dpi;
+    return true;
+}
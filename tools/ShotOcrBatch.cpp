@@ -0,0 +1,380 @@
+#include "../include/FileReplayCaptureSource.h"
+#include "../include/ImageAnalyzer.h"
+#include "../include/JsonUtil.h"
+#include "../include/OcrCache.h"
+#include "../include/OcrClient.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+// 无界面批量 OCR：读取截图文件，按与截图界面相同的流程编码并调用 OCR 接口，结果以 JSON Lines 输出
+
+namespace {
+
+struct BatchOptions {
+    std::string endpoint;
+    int concurrency;
+    std::string outputPath;
+    int timeoutMs;
+    bool preprocess;
+    bool keepAlive;
+    int sourceDpi;
+    std::string cachePath;
+    bool cache;
+    int cacheMb;
+    int perceptualDistance;
+
+    BatchOptions()
+        : endpoint("http://127.0.0.1:8089/ocrapi1"), concurrency(4), timeoutMs(30000), preprocess(false),
+          keepAlive(true), sourceDpi(96), cache(false), cacheMb(64), perceptualDistance(-1) {}
+};
+
+void printUsage() {
+    std::fprintf(stderr,
+        "用法：ShotOcrBatch [选项] <文件或目录>...\n"
+        "  --endpoint URL      OCR 接口地址（默认 http://127.0.0.1:8089/ocrapi1，只支持 http://）\n"
+        "  --concurrency N     同时进行的请求数（默认 4）\n"
+        "  --output FILE       JSONL 输出文件（默认标准输出）\n"
+        "  --timeout-ms N      单个请求超时（默认 30000）\n"
+        "  --preprocess        上传前灰度化并缩小到 96 DPI（与截图界面的开关相同，默认关闭）\n"
+        "  --no-keep-alive     每个请求新建连接（默认复用 keep-alive 连接）\n"
+        "  --dpi N             源图 DPI（默认 96），启用 --preprocess 且高于 96 时缩小到 96\n"
+        "  --cache             按内容缓存识别结果，相同的图片只请求一次\n"
+        "  --cache-file FILE   缓存持久化文件，启动时加载、结束时保存（隐含 --cache）\n"
+        "  --cache-mb N        缓存上限（默认 64 MB）\n"
+        "  --cache-perceptual N  感知哈希距离不超过 N 的原始像素图视为相同（默认关闭）\n"
+        "支持 .png/.jpg（原样上传）、.ppm 与 *_宽x高.bgra（按截图流程编码），目录递归展开\n");
+}
+
+bool hasExtension(const std::string& path, const char* extension) {
+    size_t length = std::strlen(extension);
+    if (path.size() < length) return false;
+    for (size_t i = 0; i < length; ++i) {
+        if (std::tolower((unsigned char)path[path.size() - length + i]) != extension[i]) return false;
+    }
+    return true;
+}
+
+bool isEncodedImage(const std::string& path) {
+    return hasExtension(path, ".png") || hasExtension(path, ".jpg") || hasExtension(path, ".jpeg");
+}
+
+bool isSupportedFile(const std::string& path) {
+    return isEncodedImage(path) || hasExtension(path, ".ppm") || hasExtension(path, ".bgra");
+}
+
+// 递归列出目录中支持的文件
+void collectFiles(const std::string& path, std::vector<std::string>& files) {
+#if defined(_WIN32)
+    DWORD attributes = GetFileAttributesA(path.c_str());
+    if (attributes == INVALID_FILE_ATTRIBUTES) return;
+    if (!(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+        files.push_back(path);
+        return;
+    }
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((path + "\\*").c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE) return;
+    do {
+        std::string name = data.cFileName;
+        if (name == "." || name == "..") continue;
+        std::string child = path + "\\" + name;
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) collectFiles(child, files);
+        else if (isSupportedFile(child)) files.push_back(child);
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return;
+    if (!S_ISDIR(info.st_mode)) {
+        files.push_back(path);
+        return;
+    }
+    DIR* dir = opendir(path.c_str());
+    if (!dir) return;
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") continue;
+        std::string child = path + "/" + name;
+        if (stat(child.c_str(), &info) != 0) continue;
+        if (S_ISDIR(info.st_mode)) collectFiles(child, files);
+        else if (isSupportedFile(child)) files.push_back(child);
+    }
+    closedir(dir);
+#endif
+}
+
+bool readFile(const std::string& path, std::vector<unsigned char>& data) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    bool ok = size >= 0;
+    if (ok) {
+        data.resize((size_t)size);
+        ok = std::fread(data.data(), 1, data.size(), f) == data.size();
+    }
+    std::fclose(f);
+    return ok;
+}
+
+// 读入的一张图片：已编码的文件字节，或待编码的原始像素
+struct InputImage {
+    bool encoded;
+    std::vector<unsigned char> bytes;
+    FileReplayCaptureSource source;
+    PixelBufferView view;
+
+    explicit InputImage(int dpi) : encoded(false), source(dpi) {}
+};
+
+bool loadInput(const std::string& path, InputImage& input, std::string& error) {
+    if (isEncodedImage(path)) {
+        input.encoded = true;
+        if (!readFile(path, input.bytes)) error = "cannot read file";
+        return error.empty();
+    }
+
+    if (!input.source.addFile(path) || !input.source.capture(0, 0, 0, 0, input.view)) {
+        error = "unsupported or unreadable image";
+        return false;
+    }
+    return true;
+}
+
+// 已编码的图片原样上传；原始像素走与截图界面相同的自适应编码
+bool encodeInput(const InputImage& input, const BatchOptions& options, std::vector<unsigned char>& imageData,
+                 std::string& error) {
+    if (input.encoded) {
+        imageData = input.bytes;
+        return true;
+    }
+
+    const PixelBufferView& view = input.view;
+    PreprocessOptions preprocess;
+    preprocess.enabled = options.preprocess;
+    preprocess.sourceDpi = view.dpi;
+    preprocess.targetDpi = 96;
+    AdaptiveEncodeResult result;
+    if (!EncodeCaptureAdaptive(view.pixels, view.width, view.height, view.stride, preprocess, FormatPolicy(),
+                               JpegEncodeFunc(), imageData, result)) {
+        error = "encode failed";
+        return false;
+    }
+    return true;
+}
+
+OcrCacheKey cacheKey(const InputImage& input, const BatchOptions& options) {
+    if (input.encoded) return MakeOcrCacheKeyForBytes(input.bytes.data(), input.bytes.size());
+    const PixelBufferView& view = input.view;
+    return MakeOcrCacheKey(view.pixels, view.width, view.height, view.stride, options.perceptualDistance >= 0);
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(p * (values.size() - 1) + 0.5);
+    return values[(std::min)(index, values.size() - 1)];
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BatchOptions options;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--endpoint" && hasValue) options.endpoint = argv[++i];
+        else if (arg == "--concurrency" && hasValue) options.concurrency = std::atoi(argv[++i]);
+        else if (arg == "--output" && hasValue) options.outputPath = argv[++i];
+        else if (arg == "--timeout-ms" && hasValue) options.timeoutMs = std::atoi(argv[++i]);
+        else if (arg == "--dpi" && hasValue) options.sourceDpi = std::atoi(argv[++i]);
+        else if (arg == "--preprocess") options.preprocess = true;
+        else if (arg == "--no-keep-alive") options.keepAlive = false;
+        else if (arg == "--cache") options.cache = true;
+        else if (arg == "--cache-file" && hasValue) options.cachePath = argv[++i];
+        else if (arg == "--cache-mb" && hasValue) options.cacheMb = std::atoi(argv[++i]);
+        else if (arg == "--cache-perceptual" && hasValue) options.perceptualDistance = std::atoi(argv[++i]);
+        else if (arg == "--help" || arg == "-h" || arg.compare(0, 2, "--") == 0) {
+            printUsage();
+            return arg == "--help" || arg == "-h" ? 0 : 2;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+
+    HttpUrl url;
+    if (!ParseHttpUrl(options.endpoint, url) || url.scheme != "http") {
+        std::fprintf(stderr, "invalid endpoint (only http:// is supported): %s\n", options.endpoint.c_str());
+        return 2;
+    }
+    if (inputs.empty()) {
+        printUsage();
+        return 2;
+    }
+    options.concurrency = (std::max)(1, options.concurrency);
+    if (!options.cachePath.empty()) options.cache = true;
+
+    std::vector<std::string> files;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        std::vector<std::string> found;
+        collectFiles(inputs[i], found);
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+
+    FILE* output = stdout;
+    if (!options.outputPath.empty()) {
+        output = std::fopen(options.outputPath.c_str(), "wb");
+        if (!output) {
+            std::fprintf(stderr, "cannot open %s\n", options.outputPath.c_str());
+            return 2;
+        }
+    }
+
+    // 每个工作线程最多占用一条连接，池中空闲连接数与并发数一致即可
+    HttpPoolOptions poolOptions;
+    poolOptions.connectTimeoutMs = options.timeoutMs;
+    poolOptions.requestTimeoutMs = options.timeoutMs;
+    poolOptions.maxIdlePerHost = options.keepAlive ? options.concurrency : 0;
+    HttpConnectionPool pool(poolOptions);
+
+    OcrCacheOptions cacheOptions;
+    cacheOptions.maxBytes = (size_t)(std::max)(1, options.cacheMb) * 1024 * 1024;
+    cacheOptions.perceptualMaxDistance = options.perceptualDistance;
+    OcrCache cache(cacheOptions);
+    if (!options.cachePath.empty()) cache.load(options.cachePath);
+
+    // 固定数量的工作线程依次领取文件，同时在途的请求数即为并发数
+    std::atomic<size_t> nextFile(0);
+    std::mutex outputMutex;
+    std::vector<double> latencies;
+    size_t succeeded = 0, failed = 0, uploadedBytes = 0;
+    std::chrono::steady_clock::time_point batchStart = std::chrono::steady_clock::now();
+
+    auto worker = [&]() {
+        for (;;) {
+            size_t index = nextFile++;
+            if (index >= files.size()) return;
+            const std::string& path = files[index];
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            std::vector<unsigned char> imageData;
+            std::string loadError;
+            OcrResult result;
+            double encodeMs = 0;
+            bool cached = false;
+            InputImage input(options.sourceDpi);
+            if (loadInput(path, input, loadError)) {
+                // 缓存未命中（且没有同内容的请求在途）时才编码并请求
+                OcrCache::Compute compute = [&](std::string& text, size_t& requestBytes) {
+                    std::chrono::steady_clock::time_point encodeStart = std::chrono::steady_clock::now();
+                    if (!encodeInput(input, options, imageData, loadError)) {
+                        result.error = loadError;
+                        return false;
+                    }
+                    encodeMs = elapsedMs(encodeStart);
+                    result = CallOcrEndpoint(pool, url, imageData);
+                    text = result.text;
+                    requestBytes = result.requestBytes;
+                    return result.ok;
+                };
+                if (options.cache) {
+                    std::string text;
+                    OcrCacheSource source;
+                    bool ok = cache.getOrCompute(cacheKey(input, options), compute, text, &source);
+                    if (source != OCR_FROM_CALL) {
+                        cached = true;
+                        result.ok = ok;
+                        result.status = ok ? 200 : 0;
+                        result.text = text;
+                        result.latencyMs = elapsedMs(start);
+                        if (!ok) result.error = "shared request failed";
+                    }
+                } else {
+                    std::string text;
+                    size_t requestBytes;
+                    compute(text, requestBytes);
+                }
+            } else {
+                result.error = loadError;
+            }
+
+            std::string line = "{\"file\":";
+            AppendJsonString(line, path);
+            line += result.ok ? ",\"ok\":true" : ",\"ok\":false";
+            line += ",\"status\":" + std::to_string(result.status);
+            line += ",\"text\":";
+            AppendJsonString(line, result.text);
+            if (cached) line += ",\"cached\":true";
+            if (!result.error.empty()) {
+                line += ",\"error\":";
+                AppendJsonString(line, result.error);
+            }
+            char numbers[160];
+            std::snprintf(numbers, sizeof(numbers),
+                          ",\"image_bytes\":%zu,\"request_bytes\":%zu,\"encode_ms\":%.2f,\"latency_ms\":%.2f}\n",
+                          imageData.size(), result.requestBytes, encodeMs, result.latencyMs);
+            line += numbers;
+
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::fwrite(line.data(), 1, line.size(), output);
+            std::fflush(output);
+            if (result.ok) {
+                succeeded++;
+                if (!cached) latencies.push_back(result.latencyMs);
+                uploadedBytes += result.requestBytes;
+            } else {
+                failed++;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    int threadCount = (int)(std::min)((size_t)options.concurrency, files.size());
+    for (int i = 0; i < threadCount; ++i) threads.push_back(std::thread(worker));
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+
+    double wallSeconds = elapsedMs(batchStart) / 1000.0;
+    if (output != stdout) std::fclose(output);
+
+    HttpPoolStats poolStats = pool.stats();
+    std::fprintf(stderr,
+                 "files=%zu ok=%zu failed=%zu concurrency=%d wall=%.2fs throughput=%.1f files/s upload=%.2f MB/s\n"
+                 "latency ms: p50=%.1f p90=%.1f p99=%.1f max=%.1f\n"
+                 "connections: opened=%ld reused=%ld stale_retries=%ld\n",
+                 files.size(), succeeded, failed, options.concurrency, wallSeconds,
+                 wallSeconds > 0 ? files.size() / wallSeconds : 0.0,
+                 wallSeconds > 0 ? uploadedBytes / (1024.0 * 1024.0) / wallSeconds : 0.0,
+                 percentile(latencies, 0.50), percentile(latencies, 0.90), percentile(latencies, 0.99),
+                 percentile(latencies, 1.0), poolStats.connectionsOpened, poolStats.connectionsReused,
+                 poolStats.staleRetries);
+    if (options.cache) {
+        std::fprintf(stderr, "%s\n", DescribeOcrCacheStats(cache.stats()).c_str());
+        if (!options.cachePath.empty() && !cache.save(options.cachePath)) {
+            std::fprintf(stderr, "cannot save cache to %s\n", options.cachePath.c_str());
+        }
+    }
+    return failed == 0 ? 0 : 1;
+}